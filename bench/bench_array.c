@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/*
+ * array benchmark: a list of a hundred thousand integers, then floats, written as numbered settings,
+ * "shard.0 = 17", and as a single array, "shard = [17, ...]". reports the time of the parse, the time
+ * of reading every item back, with a getter per setting or a single cfg_get_array_ctx, and the memory
+ * held by the configuration.
+*/
+
+#define ITEMS 100000
+#define ROUNDS 5
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t generate(char* buf, size_t cap, bool array, bool floats) {
+    size_t len = array ? (size_t)snprintf(buf, cap, "shard = [") : 0;
+
+    for (size_t i = 0; i < ITEMS; i++) {
+        if (array) {
+            len += (size_t)snprintf(&buf[len], cap - len, i == 0 ? "" : ", ");
+        } else {
+            len += (size_t)snprintf(&buf[len], cap - len, "shard.%zu = ", i);
+        }
+
+        if (floats) {
+            len += (size_t)snprintf(&buf[len], cap - len, "%zu.%zu", i * 7919 % 100000, i % 1000);
+        } else {
+            len += (size_t)snprintf(&buf[len], cap - len, "%zu", i * 7919);
+        }
+
+        if (!array) {
+            buf[len++] = '\n';
+        }
+    }
+
+    if (array) {
+        len += (size_t)snprintf(&buf[len], cap - len, "]\n");
+    }
+
+    return len;
+}
+
+/* every item read back and summed, so that the reads aren't optimized out */
+static int read_items(cfg_t* cfg, bool array, bool floats, double* sum) {
+    const void* items;
+    size_t len;
+    char id[32];
+    long long integer;
+    cfg_float_t floating;
+
+    *sum = 0;
+
+    if (array) {
+        if (cfg_get_array_ctx(cfg, "shard", floats ? CFG_STYPE_FLOAT : CFG_STYPE_INT, &items, &len) != 0 || len != ITEMS) {
+            return 1;
+        }
+        for (size_t i = 0; i < len; i++) {
+            *sum += floats ? (double)((const cfg_float_t*)items)[i] : (double)((const long long*)items)[i];
+        }
+        return 0;
+    }
+
+    for (size_t i = 0; i < ITEMS; i++) {
+        snprintf(id, sizeof(id), "shard.%zu", i);
+        if (cfg_get_setting_ctx(cfg, id, floats ? (void*)&floating : (void*)&integer) != 0) {
+            return 1;
+        }
+        *sum += floats ? (double)floating : (double)integer;
+    }
+
+    return 0;
+}
+
+static int run(const char* name, bool array, bool floats) {
+    size_t cap = (size_t)ITEMS * 40;
+    char* buf = malloc(cap);
+    double best[2] = { 0 };
+    double elapsed;
+    double sum;
+    size_t len;
+    cfg_stats_t stats;
+
+    if (buf == NULL) {
+        return 1;
+    }
+
+    len = generate(buf, cap, array, floats);
+
+    for (int round = 0; round < ROUNDS; round++) {
+        cfg_t* cfg = cfg_new();
+
+        if (cfg == NULL) {
+            return 1;
+        }
+
+        elapsed = now_ns();
+        if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) != 0) {
+            cfg_perror_ctx(cfg, name);
+            return 1;
+        }
+        elapsed = now_ns() - elapsed;
+        best[0] = round == 0 || elapsed < best[0] ? elapsed : best[0];
+
+        elapsed = now_ns();
+        if (read_items(cfg, array, floats, &sum) != 0) {
+            cfg_perror_ctx(cfg, name);
+            return 1;
+        }
+        elapsed = now_ns() - elapsed;
+        best[1] = round == 0 || elapsed < best[1] ? elapsed : best[1];
+
+        stats = cfg_get_stats_ctx(cfg);
+        cfg_free_ctx(cfg);
+    }
+
+    printf("%-16s items=%d bytes=%zu parse_ms=%.2f read_us=%.1f heap_kb=%llu sum=%.0f\n", name, ITEMS, len, best[0] / 1e6,
+        best[1] / 1e3, (unsigned long long)stats.heap_bytes / 1024, sum);
+    free(buf);
+
+    return 0;
+}
+
+int main(void) {
+    if (run("numbered ints", false, false) != 0 || run("array ints", true, false) != 0
+        || run("numbered floats", false, true) != 0 || run("array floats", true, true) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
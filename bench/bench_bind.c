@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/* binding benchmark: filling a struct of a few hundred fields with cfg_bind against one getter call per field */
+
+#define INTS 120
+#define FLOATS 80
+#define STRINGS 60
+#define BOOLS 40
+#define FIELDS (INTS + FLOATS + STRINGS + BOOLS)
+#define ROUNDS 2000
+
+typedef struct config_s {
+    long long ints[INTS];
+    cfg_float_t floats[FLOATS];
+    char* strings[STRINGS];
+    bool bools[BOOLS];
+} config_t;
+
+static cfg_binding_t bindings[FIELDS];
+static char identifiers[FIELDS][32];
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void add_binding(size_t i, const char* kind, size_t j, enum cfg_setting_type_e type, size_t offset) {
+    snprintf(identifiers[i], sizeof(identifiers[i]), "service.%s_%zu", kind, j);
+    bindings[i].identifier = identifiers[i];
+    bindings[i].type = type;
+    bindings[i].offset = offset;
+}
+
+/* extra settings interleaved between the bound ones, bindings in file order or shuffled */
+static int bench(size_t extra, bool shuffle) {
+    size_t cap = (FIELDS + extra) * 64;
+    size_t len = 0;
+    char* buf = malloc(cap);
+    config_t a;
+    config_t b;
+    double start;
+    double getters_ns;
+    double bind_ns;
+    int status = 0;
+    cfg_binding_t table[FIELDS];
+    cfg_binding_t swap;
+    uint64_t seed = 42;
+    size_t j;
+    cfg_t* cfg = cfg_new();
+
+    for (size_t i = 0; i < FIELDS; i++) {
+        for (size_t e = i * extra / FIELDS; e < (i + 1) * extra / FIELDS; e++) {
+            len += (size_t)snprintf(&buf[len], cap - len, "other.key_%zu = %zu\n", e, e);
+        }
+
+        switch (bindings[i].type) {
+            case CFG_STYPE_INT: len += (size_t)snprintf(&buf[len], cap - len, "%s = %zu\n", identifiers[i], i * 31); break;
+            case CFG_STYPE_FLOAT: len += (size_t)snprintf(&buf[len], cap - len, "%s = %zu.5\n", identifiers[i], i); break;
+            case CFG_STYPE_STRING: len += (size_t)snprintf(&buf[len], cap - len, "%s = \"value %zu\"\n", identifiers[i], i); break;
+            default: len += (size_t)snprintf(&buf[len], cap - len, "%s = %s\n", identifiers[i], i % 2 == 0 ? "true" : "false"); break;
+        }
+    }
+
+    memcpy(table, bindings, sizeof(table));
+    for (size_t i = FIELDS - 1; shuffle && i > 0; i--) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        j = (size_t)(seed >> 33) % (i + 1);
+        swap = table[i];
+        table[i] = table[j];
+        table[j] = swap;
+    }
+
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(cfg, "cfg_parse_ctx");
+        return 1;
+    }
+
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < FIELDS; i++) {
+            status |= cfg_get_setting_ctx(cfg, table[i].identifier, (char*)&a + table[i].offset);
+        }
+    }
+    getters_ns = (now_ns() - start) / ROUNDS;
+
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        status |= cfg_bind_ctx(cfg, table, FIELDS, &b, NULL);
+    }
+    bind_ns = (now_ns() - start) / ROUNDS;
+
+    if (status != 0 || memcmp(a.ints, b.ints, sizeof(a.ints)) != 0 || memcmp(a.strings, b.strings, sizeof(a.strings)) != 0) {
+        fprintf(stderr, "results differ\n");
+        return 1;
+    }
+
+    printf("fields=%d settings=%zu order=%s getters_us=%.2f bind_us=%.2f speedup=%.2fx\n",
+        FIELDS, FIELDS + extra, shuffle ? "shuffled" : "file", getters_ns / 1e3, bind_ns / 1e3, getters_ns / bind_ns);
+
+    cfg_free_ctx(cfg);
+    free(buf);
+
+    return 0;
+}
+
+int main(void) {
+    static const size_t extras[] = { 0, FIELDS, FIELDS * 3, FIELDS * 10 };
+    size_t i = 0;
+
+    for (size_t j = 0; j < INTS; j++, i++) {
+        add_binding(i, "int", j, CFG_STYPE_INT, offsetof(config_t, ints) + j * sizeof(long long));
+    }
+    for (size_t j = 0; j < FLOATS; j++, i++) {
+        add_binding(i, "float", j, CFG_STYPE_FLOAT, offsetof(config_t, floats) + j * sizeof(cfg_float_t));
+    }
+    for (size_t j = 0; j < STRINGS; j++, i++) {
+        add_binding(i, "string", j, CFG_STYPE_STRING, offsetof(config_t, strings) + j * sizeof(char*));
+    }
+    for (size_t j = 0; j < BOOLS; j++, i++) {
+        add_binding(i, "bool", j, CFG_STYPE_BOOL, offsetof(config_t, bools) + j * sizeof(bool));
+    }
+
+    for (i = 0; i < sizeof(extras) / sizeof(extras[0]) * 2; i++) {
+        if (bench(extras[i / 2], i % 2 == 1) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
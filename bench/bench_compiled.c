@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../include/cfg.h"
+
+/* compiled config benchmark: cold startup of a process loading the text file or its compiled form */
+
+#define KEYS 1000000
+#define LOOKUPS 16
+#define RUNS 10
+
+static char text_path[] = "/tmp/libcfg_bench_compiled.cfg";
+static char bin_path[] = "/tmp/libcfg_bench_compiled.cfgc";
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* what a program does at startup: load its config and read a few settings */
+static int startup(bool compiled) {
+    char id[32];
+    long long value;
+    int status = 0;
+    cfg_t* cfg = cfg_new();
+
+    if ((compiled ? cfg_load_compiled_ctx(cfg, text_path, bin_path) : cfg_load_ctx(cfg, text_path, CFG_FLAG_NONE)) != 0) {
+        cfg_perror_ctx(cfg, text_path);
+        status = 1;
+    }
+
+    for (int i = 0; i < LOOKUPS && status == 0; i++) {
+        snprintf(id, sizeof(id), "app.key_%d", i * (KEYS / LOOKUPS));
+        status = cfg_get_setting_ctx(cfg, id, &value) != 0 || value != (long long)i * (KEYS / LOOKUPS) * 7;
+    }
+
+    cfg_free_ctx(cfg);
+
+    return status;
+}
+
+/* best wall time of a child process running startup, from fork to exit */
+static double run_child(bool compiled) {
+    double best = 0;
+    double start;
+    double elapsed;
+    pid_t pid;
+    int status;
+
+    for (int round = 0; round < RUNS; round++) {
+        start = now_ns();
+        pid = fork();
+        if (pid == 0) {
+            _exit(startup(compiled));
+        }
+        waitpid(pid, &status, 0);
+        elapsed = now_ns() - start;
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "child failed\n");
+            exit(1);
+        }
+        best = round == 0 || elapsed < best ? elapsed : best;
+    }
+
+    return best;
+}
+
+int main(void) {
+    FILE* file = fopen(text_path, "w");
+    double start;
+    double text_ms;
+    double compiled_ms;
+
+    if (file == NULL) {
+        perror(text_path);
+        return 1;
+    }
+
+    for (int i = 0; i < KEYS; i++) {
+        switch (i % 4) {
+            case 0: case 2: fprintf(file, "app.key_%d = %lld\n", i, (long long)i * 7); break;
+            case 1: fprintf(file, "app.key_%d = \"value %d\"\n", i, i); break;
+            default: fprintf(file, "app.key_%d = %d.5\n", i, i); break;
+        }
+    }
+    fclose(file);
+
+    start = now_ns();
+    if (cfg_compile(text_path, bin_path) != 0) {
+        cfg_perror("cfg_compile");
+        return 1;
+    }
+    printf("keys=%d compile_ms=%.1f\n", KEYS, (now_ns() - start) / 1e6);
+
+    text_ms = run_child(false) / 1e6;
+    compiled_ms = run_child(true) / 1e6;
+    printf("startup text_ms=%.2f compiled_ms=%.3f speedup=%.0fx\n", text_ms, compiled_ms, text_ms / compiled_ms);
+
+    unlink(text_path);
+    unlink(bin_path);
+
+    return 0;
+}
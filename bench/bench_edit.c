@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/* incremental reparse benchmark: single line edits against a full reparse of the edited buffer */
+
+#define KEYS 2000000
+#define EDITS 100
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* replaces len bytes at pos with str, the buffer has room for it */
+static size_t splice(char* buf, size_t buf_len, size_t pos, size_t len, const char* str) {
+    size_t str_len = strlen(str);
+
+    memmove(&buf[pos + str_len], &buf[pos + len], buf_len - pos - len);
+    memcpy(&buf[pos], str, str_len);
+
+    return buf_len - len + str_len;
+}
+
+int main(void) {
+    static const char* const kinds[] = { "same length", "longer value", "new line" };
+    size_t cap = (size_t)KEYS * 40 + EDITS * 64;
+    char* buf = malloc(cap);
+    size_t len = 0;
+    size_t pos;
+    size_t old_len;
+    char line[64];
+    char* eol;
+    double start;
+    double edit_ns;
+    double full_ns = 0;
+    cfg_t* cfg = cfg_new();
+    cfg_t* full;
+
+    if (buf == NULL || cfg == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < KEYS; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, "app.key_%zu = %zu\n", i, i * 7919);
+    }
+
+    start = now_ns();
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_INCREMENTAL) != 0) {
+        cfg_perror_ctx(cfg, "cfg_parse_ctx");
+        return 1;
+    }
+    printf("keys=%d bytes=%zu initial_parse_ms=%.1f\n", KEYS, len, (now_ns() - start) / 1e6);
+
+    /* a full reparse of the same buffer, as a reload would do */
+    for (int round = 0; round < 3; round++) {
+        full = cfg_new();
+        start = now_ns();
+        cfg_parse_ctx(full, buf, len, CFG_FLAG_NONE);
+        edit_ns = now_ns() - start;
+        full_ns = round == 0 || edit_ns < full_ns ? edit_ns : full_ns;
+        cfg_free_ctx(full);
+    }
+
+    for (size_t kind = 0; kind < sizeof(kinds) / sizeof(kinds[0]); kind++) {
+        edit_ns = 0;
+        srand(42);
+
+        for (int i = 0; i < EDITS; i++) {
+            /* pick the line holding a random offset */
+            pos = (size_t)rand() * 7 % len;
+            while (pos > 0 && buf[pos - 1] != '\n') {
+                pos -= 1;
+            }
+            eol = memchr(&buf[pos], '\n', len - pos);
+            old_len = (size_t)(eol - &buf[pos]) + 1;
+
+            switch (kind) {
+                case 0: {
+                    /* rewrite the value with the same number of digits */
+                    pos = (size_t)(eol - buf) - 1;
+                    old_len = 1;
+                    snprintf(line, sizeof(line), "%d", i % 10);
+                    break;
+                }
+                case 1: {
+                    snprintf(line, sizeof(line), "app.key_edit_%d = %d.5\n", i, i * 1000003);
+                    break;
+                }
+                default: {
+                    old_len = 0;
+                    snprintf(line, sizeof(line), "app.key_new_%d = \"inserted\"\n", i);
+                    break;
+                }
+            }
+
+            len = splice(buf, len, pos, old_len, line);
+
+            start = now_ns();
+            if (cfg_edit_ctx(cfg, buf, len, pos, old_len, strlen(line)) != 0) {
+                cfg_perror_ctx(cfg, "cfg_edit_ctx");
+                return 1;
+            }
+            edit_ns += now_ns() - start;
+        }
+
+        printf("edit=\"%s\" edits=%d edit_us=%.1f full_reparse_ms=%.1f speedup=%.0f\n",
+            kinds[kind],
+            EDITS,
+            edit_ns / EDITS / 1e3,
+            full_ns / 1e6,
+            full_ns / (edit_ns / EDITS)
+        );
+    }
+
+    cfg_free_ctx(cfg);
+    free(buf);
+
+    return 0;
+}
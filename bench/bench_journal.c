@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/*
+ * journal benchmark: a flag of a config file with a hundred thousand settings flipped over and over,
+ * once by writing the whole file and loading it again, once with cfg_set_setting and the journal,
+ * synced or not. also reports the time of a compaction, which writes the file back.
+*/
+
+#define KEYS 100000
+#define REWRITES 20
+#define FLIPS 200000
+#define SYNCED_FLIPS 200
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int generate(const char* path) {
+    FILE* file = fopen(path, "w");
+
+    if (file == NULL) {
+        return 1;
+    }
+    for (size_t i = 0; i < KEYS; i++) {
+        fprintf(file, "key_%zu = %zu\n", i, i * 7919);
+    }
+    fprintf(file, "flag = false\n");
+
+    return fclose(file) != 0;
+}
+
+/* what a change costs without a journal: the whole configuration written and loaded again */
+static int rewrite(cfg_t** cfg, bool flag) {
+    int fd;
+
+    if (cfg_set_setting_ctx(*cfg, "flag", &(cfg_value_t){ .type = CFG_STYPE_BOOL, .boolean = flag }) != 0) {
+        return 1;
+    }
+    fd = open("bench_journal.tmp", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1 || cfg_write_ctx(*cfg, fd) != 0 || close(fd) != 0 || rename("bench_journal.tmp", "bench_journal.cfg") != 0) {
+        return 1;
+    }
+
+    cfg_free_ctx(*cfg);
+    *cfg = cfg_new();
+
+    return *cfg == NULL || cfg_load_ctx(*cfg, "bench_journal.cfg", CFG_FLAG_NONE) != 0;
+}
+
+static int flip(cfg_t* cfg, int i, bool synced) {
+    cfg_value_t value = { .type = CFG_STYPE_BOOL, .boolean = i % 2 == 0 };
+
+    return cfg_set_setting_ctx(cfg, "flag", &value) != 0 || (synced && cfg_journal_sync_ctx(cfg) != 0);
+}
+
+int main(void) {
+    double elapsed;
+    double compaction;
+    cfg_t* cfg = cfg_new();
+
+    remove("bench_journal.log");
+    if (cfg == NULL || generate("bench_journal.cfg") != 0 || cfg_load_ctx(cfg, "bench_journal.cfg", CFG_FLAG_NONE) != 0) {
+        return 1;
+    }
+
+    elapsed = now_ns();
+    for (int i = 0; i < REWRITES; i++) {
+        if (rewrite(&cfg, i % 2 == 0) != 0) {
+            cfg_perror_ctx(cfg, "rewrite");
+            return 1;
+        }
+    }
+    elapsed = now_ns() - elapsed;
+    printf("rewrite  changes=%d ns/change=%.0f\n", REWRITES, elapsed / REWRITES);
+
+    if (cfg_journal_open_ctx(cfg, "bench_journal.log", 0) != 0) {
+        cfg_perror_ctx(cfg, "journal");
+        return 1;
+    }
+
+    elapsed = now_ns();
+    for (int i = 0; i < FLIPS; i++) {
+        if (flip(cfg, i, false) != 0) {
+            cfg_perror_ctx(cfg, "journal");
+            return 1;
+        }
+    }
+    elapsed = now_ns() - elapsed;
+    printf("journal  changes=%d ns/change=%.0f\n", FLIPS, elapsed / FLIPS);
+
+    elapsed = now_ns();
+    for (int i = 0; i < SYNCED_FLIPS; i++) {
+        if (flip(cfg, i, true) != 0) {
+            cfg_perror_ctx(cfg, "synced");
+            return 1;
+        }
+    }
+    elapsed = now_ns() - elapsed;
+    printf("synced   changes=%d ns/change=%.0f\n", SYNCED_FLIPS, elapsed / SYNCED_FLIPS);
+
+    /* the start is what a change pays, the rest runs on the compaction thread */
+    compaction = now_ns();
+    if (cfg_journal_compact_ctx(cfg) != 0) {
+        cfg_perror_ctx(cfg, "compact");
+        return 1;
+    }
+    elapsed = now_ns() - compaction;
+    if (cfg_journal_sync_ctx(cfg) != 0) {
+        cfg_perror_ctx(cfg, "compact");
+        return 1;
+    }
+    compaction = now_ns() - compaction;
+    printf("compact  start_ms=%.2f total_ms=%.2f\n", elapsed / 1e6, compaction / 1e6);
+
+    cfg_journal_close_ctx(cfg);
+    cfg_free_ctx(cfg);
+    remove("bench_journal.cfg");
+    remove("bench_journal.log");
+
+    return 0;
+}
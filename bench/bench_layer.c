@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/*
+ * layer benchmark: hosts made of shared defaults, a cluster file and a host file, stacked as layers
+ * or parsed into a single configuration, host file first so that its settings win. reports the memory
+ * per host and the lookup time of identifiers spread over the three files.
+*/
+
+#define DEFAULTS 100000
+#define CLUSTER 1000
+#define HOST 100
+#define HOSTS 16
+#define LOOKUPS 2000000
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* settings key_0 to key_n - 1 of a file, the value tells the files apart */
+static size_t generate(char* buf, size_t cap, size_t n, int file) {
+    size_t len = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %d\n", i, file);
+    }
+
+    return len;
+}
+
+/* best lookup time of a few rounds over identifiers of every layer, in a scattered order */
+static double bench_lookups(cfg_t* cfg, const char* ids, long long* sum) {
+    long long value;
+    double best = 0;
+    double elapsed;
+
+    for (int round = 0; round < 3; round++) {
+        elapsed = now_ns();
+        for (size_t i = 0; i < LOOKUPS; i++) {
+            cfg_get_setting_ctx(cfg, &ids[(i * 7919 % DEFAULTS) * 16], &value);
+            *sum += value;
+        }
+        elapsed = (now_ns() - elapsed) / LOOKUPS;
+        best = round == 0 || elapsed < best ? elapsed : best;
+    }
+
+    return best;
+}
+
+int main(void) {
+    size_t cap = (DEFAULTS + CLUSTER + HOST) * 24;
+    char* buf = malloc(cap);
+    char* ids = malloc(DEFAULTS * 16);
+    size_t len;
+    size_t defaults_len;
+    long long sum = 0;
+    uint64_t flat_bytes = 0;
+    uint64_t layer_bytes = 0;
+    uint64_t defaults_bytes;
+    double flat_ns;
+    double layer_ns;
+    cfg_t* defaults = cfg_new();
+    cfg_t* cluster = cfg_new();
+    cfg_t* flat[HOSTS];
+    cfg_t* hosts[HOSTS];
+
+    if (buf == NULL || ids == NULL || defaults == NULL || cluster == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < DEFAULTS; i++) {
+        snprintf(&ids[i * 16], 16, "key_%zu", i);
+    }
+
+    defaults_len = generate(buf, cap, DEFAULTS, 0);
+    cfg_parse_ctx(defaults, buf, defaults_len, CFG_FLAG_NONE);
+    defaults_bytes = cfg_get_stats_ctx(defaults).heap_bytes;
+    cfg_set_base_ctx(cluster, defaults);
+    len = generate(buf, cap, CLUSTER, 1);
+    cfg_parse_ctx(cluster, buf, len, CFG_FLAG_NONE);
+    layer_bytes += cfg_get_stats_ctx(cluster).heap_bytes;
+
+    /* every host over the same cluster and defaults */
+    for (int h = 0; h < HOSTS; h++) {
+        hosts[h] = cfg_new();
+        cfg_set_base_ctx(hosts[h], cluster);
+        len = generate(buf, cap, HOST, 2);
+        cfg_parse_ctx(hosts[h], buf, len, CFG_FLAG_NONE);
+        layer_bytes += cfg_get_stats_ctx(hosts[h]).heap_bytes;
+    }
+
+    /* every host parsing the three files into one configuration */
+    for (int h = 0; h < HOSTS; h++) {
+        flat[h] = cfg_new();
+        len = generate(buf, cap, HOST, 2);
+        len += generate(&buf[len], cap - len, CLUSTER, 1);
+        len += generate(&buf[len], cap - len, DEFAULTS, 0);
+        cfg_parse_ctx(flat[h], buf, len, CFG_FLAG_NONE);
+        flat_bytes += cfg_get_stats_ctx(flat[h]).heap_bytes;
+    }
+
+    flat_ns = bench_lookups(flat[0], ids, &sum);
+    layer_ns = bench_lookups(hosts[0], ids, &sum);
+
+    printf("hosts=%d defaults=%d cluster=%d host=%d defaults_kb=%.0f (shared)\n", HOSTS, DEFAULTS, CLUSTER, HOST, (double)defaults_bytes / 1024);
+    printf("flat    kb/host=%.1f ns/lookup=%.1f\n", (double)flat_bytes / HOSTS / 1024, flat_ns);
+    printf("layered kb/host=%.1f ns/lookup=%.1f (cluster included once) sum=%lld\n", (double)layer_bytes / HOSTS / 1024, layer_ns, sum);
+
+    for (int h = 0; h < HOSTS; h++) {
+        cfg_free_ctx(flat[h]);
+        cfg_free_ctx(hosts[h]);
+    }
+    cfg_free_ctx(cluster);
+    cfg_free_ctx(defaults);
+    free(buf);
+    free(ids);
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/*
+ * layout benchmark: a million settings of every type, parsed copied and zero-copy. reports the heap
+ * memory per setting, the parse time, and the time of lookups spread over the whole table.
+*/
+
+#define KEYS 1000000
+#define LOOKUPS 2000000
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* a quarter of integers, floats, short strings and booleans */
+static size_t generate(char* buf, size_t cap) {
+    size_t len = 0;
+
+    for (size_t i = 0; i < KEYS; i++) {
+        switch (i % 4) {
+            case 0: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %zu\n", i, i * 7);
+                break;
+            }
+            case 1: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %zu.25\n", i, i);
+                break;
+            }
+            case 2: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = \"value %zu\"\n", i, i);
+                break;
+            }
+            default: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %s\n", i, i % 8 == 3 ? "true" : "false");
+                break;
+            }
+        }
+    }
+
+    return len;
+}
+
+static void bench(const char* name, const char* buf, size_t len, int flags, const char* ids) {
+    long long value;
+    long long sum = 0;
+    double start;
+    double parse_ms;
+    double lookup_ns;
+    cfg_stats_t stats;
+    cfg_t* cfg = cfg_new();
+
+    start = now_ns();
+    if (cfg == NULL || cfg_parse_ctx(cfg, buf, len, flags) != 0) {
+        cfg_perror_ctx(cfg, name);
+        exit(1);
+    }
+    parse_ms = (now_ns() - start) / 1e6;
+    stats = cfg_get_stats_ctx(cfg);
+
+    /* integers only, in a scattered order */
+    start = now_ns();
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        cfg_get_setting_ctx(cfg, &ids[(i * 7919 % (KEYS / 4)) * 16], &value);
+        sum += value;
+    }
+    lookup_ns = (now_ns() - start) / LOOKUPS;
+
+    printf("%-9s keys=%d bytes/setting=%.1f allocs=%llu parse_ms=%.1f ns/lookup=%.1f sum=%lld\n",
+        name, KEYS, (double)stats.heap_bytes / KEYS, (unsigned long long)stats.heap_allocs, parse_ms, lookup_ns, sum);
+
+    cfg_free_ctx(cfg);
+}
+
+int main(void) {
+    size_t cap = (size_t)KEYS * 40;
+    char* buf = malloc(cap);
+    char* ids = malloc(KEYS / 4 * 16);
+    size_t len;
+
+    if (buf == NULL || ids == NULL) {
+        return 1;
+    }
+
+    /* the integer settings are every fourth key */
+    for (size_t i = 0; i < KEYS / 4; i++) {
+        snprintf(&ids[i * 16], 16, "key_%zu", i * 4);
+    }
+
+    len = generate(buf, cap);
+    bench("copied", buf, len, CFG_FLAG_NONE, ids);
+    bench("zero-copy", buf, len, CFG_FLAG_ZEROCOPY, ids);
+
+    free(buf);
+    free(ids);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/*
+ * lazy benchmark: a config of a hundred thousand settings, mostly numbers, parsed with and without
+ * CFG_FLAG_LAZY, then two hundred of its settings read, the way a process reads a shared config.
+ * also reports the time of cfg_validate_ctx converting everything that wasn't read.
+*/
+
+#define KEYS 100000
+#define READS 200
+#define ROUNDS 5
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* four integers, four floats, a string and a boolean out of ten */
+static size_t generate(char* buf, size_t cap) {
+    size_t len = 0;
+
+    for (size_t i = 0; i < KEYS; i++) {
+        switch (i % 10) {
+            case 0:
+            case 1:
+            case 2:
+            case 3: {
+                len += (size_t)snprintf(&buf[len], cap - len, "service.key_%zu = %zu\n", i, i * 7919);
+                break;
+            }
+            case 8: {
+                len += (size_t)snprintf(&buf[len], cap - len, "service.key_%zu = \"value %zu\"\n", i, i);
+                break;
+            }
+            case 9: {
+                len += (size_t)snprintf(&buf[len], cap - len, "service.key_%zu = %s\n", i, i % 3 == 0 ? "true" : "false");
+                break;
+            }
+            default: {
+                len += (size_t)snprintf(&buf[len], cap - len, "service.key_%zu = %zu.%zu\n", i, i % 100000, i * 31 % 1000003);
+                break;
+            }
+        }
+    }
+
+    return len;
+}
+
+static int run(const char* name, const char* buf, size_t len, int flags) {
+    double best[3] = { 0 };
+    double elapsed;
+    char id[32];
+    long long integer;
+    cfg_float_t floating;
+    size_t key;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        cfg_t* cfg = cfg_new();
+
+        if (cfg == NULL) {
+            return 1;
+        }
+
+        elapsed = now_ns();
+        if (cfg_parse_ctx(cfg, buf, len, flags) != 0) {
+            cfg_perror_ctx(cfg, name);
+            return 1;
+        }
+        elapsed = now_ns() - elapsed;
+        best[0] = round == 0 || elapsed < best[0] ? elapsed : best[0];
+
+        /* numbers spread over the file, half integers and half floats */
+        elapsed = now_ns();
+        for (size_t i = 0; i < READS; i++) {
+            key = i * (KEYS / READS) + (i % 2 == 0 ? 0 : 4);
+            snprintf(id, sizeof(id), "service.key_%zu", key);
+            if (cfg_get_setting_ctx(cfg, id, i % 2 == 0 ? (void*)&integer : (void*)&floating) != 0) {
+                cfg_perror_ctx(cfg, name);
+                return 1;
+            }
+        }
+        elapsed = now_ns() - elapsed;
+        best[1] = round == 0 || elapsed < best[1] ? elapsed : best[1];
+
+        elapsed = now_ns();
+        if (cfg_validate_ctx(cfg, NULL, NULL) != 0) {
+            cfg_perror_ctx(cfg, name);
+            return 1;
+        }
+        elapsed = now_ns() - elapsed;
+        best[2] = round == 0 || elapsed < best[2] ? elapsed : best[2];
+
+        cfg_free_ctx(cfg);
+    }
+
+    printf("%-14s keys=%d parse_ms=%.2f reads=%d read_us=%.1f validate_ms=%.2f\n", name, KEYS, best[0] / 1e6,
+        READS, best[1] / 1e3, best[2] / 1e6);
+
+    return 0;
+}
+
+int main(void) {
+    size_t cap = (size_t)KEYS * 48;
+    char* buf = malloc(cap);
+    size_t len;
+
+    if (buf == NULL) {
+        return 1;
+    }
+
+    len = generate(buf, cap);
+    printf("bytes=%zu\n", len);
+
+    if (run("eager", buf, len, CFG_FLAG_NONE) != 0 || run("lazy", buf, len, CFG_FLAG_LAZY) != 0
+        || run("eager zerocopy", buf, len, CFG_FLAG_ZEROCOPY) != 0 || run("lazy zerocopy", buf, len, CFG_FLAG_LAZY | CFG_FLAG_ZEROCOPY) != 0) {
+        return 1;
+    }
+
+    free(buf);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/* lookup microbenchmark: parses configs of growing size and reads every key back */
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int bench_lookup(size_t keys, size_t rounds) {
+    size_t cap = keys * 40;
+    size_t len = 0;
+    char* buf = malloc(cap);
+    char** ids = malloc(keys * sizeof(char*));
+    long long value;
+    long long sum = 0;
+    double start;
+    double elapsed;
+
+    if (buf == NULL || ids == NULL) {
+        free(buf);
+        free(ids);
+        return 1;
+    }
+
+    for (size_t i = 0; i < keys; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, "section.key_%zu = %zu\n", i, i);
+    }
+
+    if (cfg_parse(buf, len) != 0) {
+        cfg_perror("cfg_parse");
+        free(buf);
+        free(ids);
+        return 1;
+    }
+
+    /* reuse the buffer to hold the identifiers looked up, so the timed loop only measures cfg_get_setting */
+    len = 0;
+    for (size_t i = 0; i < keys; i++) {
+        ids[i] = &buf[len];
+        len += (size_t)snprintf(&buf[len], cap - len, "section.key_%zu", i) + 1;
+    }
+
+    start = now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < keys; i++) {
+            if (cfg_get_setting(ids[i], &value) != 0) {
+                cfg_perror(ids[i]);
+                free(buf);
+                free(ids);
+                return 1;
+            }
+            sum += value;
+        }
+    }
+    elapsed = now_ns() - start;
+
+    printf("keys=%zu lookups=%zu ns/lookup=%.1f (checksum %lld)\n",
+        keys,
+        keys * rounds,
+        elapsed / (double)(keys * rounds),
+        sum
+    );
+
+    cfg_free();
+    free(buf);
+    free(ids);
+
+    return 0;
+}
+
+int main(void) {
+    static const size_t sizes[] = { 100, 1000, 10000, 50000, 100000 };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        /* keep the total amount of lookups roughly constant */
+        if (bench_lookup(sizes[i], 1000000 / sizes[i] + 1) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
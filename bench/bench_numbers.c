@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/* number parsing benchmark: parses generated configs made only of integers and floats */
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int bench_numbers(size_t keys) {
+    size_t cap = keys * 64 + 1;
+    size_t len = 0;
+    char* buf = malloc(cap);
+    unsigned long long x = 0x9e3779b97f4a7c15ULL;
+    double start;
+    double elapsed;
+
+    if (buf == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < keys; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        if (i % 2 == 0) {
+            len += (size_t)snprintf(&buf[len], cap - len, "n%zu = %lld\n", i, (long long)(x >> 20) - (1LL << 42));
+        } else {
+            len += (size_t)snprintf(&buf[len], cap - len, "n%zu = %.*f\n", i, (int)(x % 10), (double)(x >> 40) / 1000.0);
+        }
+    }
+
+    start = now_ns();
+    if (cfg_parse(buf, len) != 0) {
+        cfg_perror("cfg_parse");
+        free(buf);
+        return 1;
+    }
+    elapsed = now_ns() - start;
+
+    printf("keys=%zu bytes=%zu parse_ms=%.2f MB/s=%.1f ns/value=%.1f\n",
+        keys,
+        len,
+        elapsed / 1e6,
+        (double)len / (elapsed / 1e9) / 1e6,
+        elapsed / (double)keys
+    );
+
+    cfg_free();
+    free(buf);
+
+    return 0;
+}
+
+int main(void) {
+    static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (bench_numbers(sizes[i]) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
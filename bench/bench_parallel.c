@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* parallel load benchmark: loads the same generated file with 1 to N threads */
+
+#define KEYS 2000000
+#define ROUNDS 5
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* writes a config mixing integers, floats, strings and booleans */
+static int generate(const char* path) {
+    FILE* file = fopen(path, "w");
+
+    if (file == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < KEYS; i++) {
+        switch (i % 4) {
+            case 0: fprintf(file, "app.int_%zu = %zu\n", i, i * 7919); break;
+            case 1: fprintf(file, "app.float_%zu = %zu.%03zu\n", i, i, i % 1000); break;
+            case 2: fprintf(file, "app.string_%zu = \"value number %zu\" # comment\n", i, i); break;
+            default: fprintf(file, "app.bool_%zu = %s\n", i, i % 8 == 3 ? "true" : "false"); break;
+        }
+    }
+    fclose(file);
+
+    return 0;
+}
+
+static int bench_load(const char* path, size_t threads, int flags, size_t bytes, double* base_ns) {
+    double best_ns = 0;
+    double start;
+    double ns;
+    cfg_t* cfg;
+
+    for (size_t round = 0; round < ROUNDS; round++) {
+        cfg = cfg_new();
+        if (cfg == NULL) {
+            return 1;
+        }
+
+        start = now_ns();
+        if (cfg_load_parallel_ctx(cfg, path, threads, flags) != 0) {
+            cfg_perror_ctx(cfg, path);
+            cfg_free_ctx(cfg);
+            return 1;
+        }
+        ns = now_ns() - start;
+        cfg_free_ctx(cfg);
+
+        best_ns = round == 0 || ns < best_ns ? ns : best_ns;
+    }
+
+    if (threads == 1) {
+        *base_ns = best_ns;
+    }
+
+    printf("mode=%s threads=%zu keys=%d bytes=%zu load_ms=%.2f MB/s=%.1f speedup=%.2f\n",
+        (flags & CFG_FLAG_ZEROCOPY) != 0 ? "zerocopy" : "copy",
+        threads,
+        KEYS,
+        bytes,
+        best_ns / 1e6,
+        (double)bytes / (best_ns / 1e9) / 1e6,
+        *base_ns / best_ns
+    );
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    char path[] = "/tmp/libcfg_bench_parallel_XXXXXX";
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 1 ? (size_t)atol(argv[1]) : (size_t)(cores > 0 ? cores : 1);
+    double base_ns = 0;
+    size_t bytes;
+    int fd;
+    FILE* file;
+    int status = 0;
+
+    fd = mkstemp(path);
+    if (fd == -1 || generate(path) != 0) {
+        perror(path);
+        return 1;
+    }
+    close(fd);
+
+    file = fopen(path, "r");
+    fseek(file, 0, SEEK_END);
+    bytes = (size_t)ftell(file);
+    fclose(file);
+
+    for (int flags = CFG_FLAG_NONE; flags <= CFG_FLAG_ZEROCOPY && status == 0; flags++) {
+        for (size_t threads = 1; threads <= max_threads && status == 0; threads++) {
+            status = bench_load(path, threads, flags, bytes, &base_ns);
+        }
+    }
+
+    unlink(path);
+
+    return status;
+}
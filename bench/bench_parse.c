@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/* parse benchmark: parses generated configs of growing size and counts the heap allocations involved,
+ * into the default configuration or through a callback storing nothing */
+
+/* glibc lets the program interpose the allocator, count the calls and forward them to the real one */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static size_t allocs_g = 0;
+static size_t alloc_bytes_g = 0;
+static size_t frees_g = 0;
+
+void* malloc(size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += n * size;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += size;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr != NULL) {
+        frees_g += 1;
+    }
+    __libc_free(ptr);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* generates a config mixing integers, floats, strings and booleans */
+static char* generate(size_t keys, size_t* len) {
+    size_t cap = keys * 64 + 1;
+    char* buf = malloc(cap);
+
+    *len = 0;
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < keys; i++) {
+        switch (i % 4) {
+            case 0: {
+                *len += (size_t)snprintf(&buf[*len], cap - *len, "app.int_%zu = %zu\n", i, i * 7919);
+                break;
+            }
+            case 1: {
+                *len += (size_t)snprintf(&buf[*len], cap - *len, "app.float_%zu = %zu.%03zu\n", i, i, i % 1000);
+                break;
+            }
+            case 2: {
+                *len += (size_t)snprintf(&buf[*len], cap - *len, "app.string_%zu = \"value number %zu\"\n", i, i);
+                break;
+            }
+            default: {
+                *len += (size_t)snprintf(&buf[*len], cap - *len, "app.bool_%zu = %s\n", i, i % 8 == 3 ? "true" : "false");
+                break;
+            }
+        }
+    }
+
+    return buf;
+}
+
+/* consumes the settings handed by cfg_parse_cb */
+static int count_setting(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    (void)identifier;
+    *(size_t*)user += identifier_len + (size_t)value->type;
+
+    return 0;
+}
+
+static int bench_parse(size_t keys, int flags, bool callback) {
+    size_t len;
+    char* buf = generate(keys, &len);
+    size_t allocs;
+    size_t alloc_bytes;
+    size_t frees;
+    double start;
+    double parse_ns;
+    double free_ns;
+    size_t sum = 0;
+
+    if (buf == NULL) {
+        return 1;
+    }
+
+    allocs = allocs_g;
+    alloc_bytes = alloc_bytes_g;
+    frees = frees_g;
+
+    start = now_ns();
+    if ((callback ? cfg_parse_cb(buf, len, count_setting, &sum) : cfg_parse_ex(buf, len, flags)) != 0) {
+        cfg_perror("cfg_parse");
+        free(buf);
+        return 1;
+    }
+    parse_ns = now_ns() - start;
+
+    start = now_ns();
+    cfg_free();
+    free_ns = now_ns() - start;
+
+    printf("mode=%s keys=%zu bytes=%zu parse_ms=%.2f MB/s=%.1f free_ms=%.2f allocs=%zu alloc_bytes=%zu frees=%zu\n",
+        callback ? "callback" : (flags & CFG_FLAG_ZEROCOPY) != 0 ? "zerocopy" : "copy",
+        keys,
+        len,
+        parse_ns / 1e6,
+        (double)len / (parse_ns / 1e9) / 1e6,
+        free_ns / 1e6,
+        allocs_g - allocs,
+        alloc_bytes_g - alloc_bytes,
+        frees_g - frees
+    );
+
+    free(buf);
+
+    return 0;
+}
+
+int main(void) {
+    static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (bench_parse(sizes[i], CFG_FLAG_NONE, false) != 0 || bench_parse(sizes[i], CFG_FLAG_ZEROCOPY, false) != 0
+            || bench_parse(sizes[i], CFG_FLAG_NONE, true) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
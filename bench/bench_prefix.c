@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../src/cfg_private.h"
+
+/*
+ * prefix benchmark: a config with deep dotted namespaces, region.service.component.route.field,
+ * enumerated namespace by namespace with cfg_foreach_prefix and with a linear scan of the settings
+ * table, the only way to list a namespace before. also reports the memory of the prefix tree
+ * against the identifiers it indexes.
+*/
+
+#define REGIONS 8
+#define SERVICES 25
+#define COMPONENTS 5
+#define ROUTES 20
+#define FIELDS 5
+#define QUERIES 200
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int visit(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    (void)identifier;
+    (void)value;
+    *(size_t*)user += identifier_len;
+
+    return 0;
+}
+
+/* what listing a namespace took before the prefix tree */
+static size_t scan(const cfg_t* cfg, const char* prefix) {
+    size_t len = strlen(prefix);
+    size_t found = 0;
+
+    for (size_t i = 0; i < cfg->settings_len; i++) {
+        if (cfg->identifier_lens[i] >= len && memcmp(cfg->identifiers[i], prefix, len) == 0) {
+            found += cfg->identifier_lens[i];
+        }
+    }
+
+    return found;
+}
+
+int main(void) {
+    static const char* const fields[FIELDS] = { "timeout_ms", "retries", "weight", "path", "enabled" };
+    size_t keys = (size_t)REGIONS * SERVICES * COMPONENTS * ROUTES * FIELDS;
+    size_t cap = keys * 64;
+    size_t len = 0;
+    size_t identifiers_bytes = 0;
+    size_t tree_bytes;
+    size_t tree_sum = 0;
+    size_t scan_sum = 0;
+    size_t count;
+    char* buf = malloc(cap);
+    char prefix[64];
+    double start;
+    double build_ms;
+    double tree_ns[3] = { 0 };
+    double scan_ns[3] = { 0 };
+    uint64_t heap;
+    cfg_t* cfg = cfg_new();
+
+    if (buf == NULL || cfg == NULL) {
+        return 1;
+    }
+
+    for (int r = 0; r < REGIONS; r++) {
+        for (int s = 0; s < SERVICES; s++) {
+            for (int c = 0; c < COMPONENTS; c++) {
+                for (int t = 0; t < ROUTES; t++) {
+                    for (int f = 0; f < FIELDS; f++) {
+                        len += (size_t)snprintf(&buf[len], cap - len, "region_%d.service_%d.component_%d.route_%d.%s = %d\n", r, s, c, t, fields[f], t);
+                    }
+                }
+            }
+        }
+    }
+
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(cfg, "cfg_parse_ctx");
+        return 1;
+    }
+
+    for (size_t i = 0; i < cfg->settings_len; i++) {
+        identifiers_bytes += cfg->identifier_lens[i] + 1;
+    }
+
+    heap = cfg_get_stats_ctx(cfg).heap_bytes;
+    start = now_ns();
+    cfg_count_prefix_ctx(cfg, "", &count);
+    build_ms = (now_ns() - start) / 1e6;
+    tree_bytes = (size_t)(cfg_get_stats_ctx(cfg).heap_bytes - heap);
+
+    /* a region, a service, a component and a route, each level a few times */
+    for (int q = 0; q < QUERIES; q++) {
+        for (int level = 0; level < 3; level++) {
+            if (level == 0) {
+                snprintf(prefix, sizeof(prefix), "region_%d.service_%d.", q % REGIONS, q % SERVICES);
+            } else if (level == 1) {
+                snprintf(prefix, sizeof(prefix), "region_%d.service_%d.component_%d.", q % REGIONS, q % SERVICES, q % COMPONENTS);
+            } else {
+                snprintf(prefix, sizeof(prefix), "region_%d.service_%d.component_%d.route_%d.", q % REGIONS, q % SERVICES, q % COMPONENTS, q % ROUTES);
+            }
+
+            start = now_ns();
+            cfg_foreach_prefix_ctx(cfg, prefix, visit, &tree_sum);
+            tree_ns[level] += now_ns() - start;
+
+            start = now_ns();
+            scan_sum += scan(cfg, prefix);
+            scan_ns[level] += now_ns() - start;
+        }
+    }
+
+    if (tree_sum != scan_sum) {
+        fprintf(stderr, "the tree listed %zu identifier bytes, the scan %zu\n", tree_sum, scan_sum);
+        return 1;
+    }
+
+    printf("keys=%zu identifier_bytes/key=%.1f tree_bytes/key=%.1f tree_build_ms=%.1f\n",
+        keys, (double)identifiers_bytes / (double)keys, (double)tree_bytes / (double)keys, build_ms);
+    printf("service (%d settings)   tree_us=%.2f scan_us=%.1f\n", COMPONENTS * ROUTES * FIELDS, tree_ns[0] / QUERIES / 1e3, scan_ns[0] / QUERIES / 1e3);
+    printf("component (%d settings) tree_us=%.2f scan_us=%.1f\n", ROUTES * FIELDS, tree_ns[1] / QUERIES / 1e3, scan_ns[1] / QUERIES / 1e3);
+    printf("route (%d settings)       tree_us=%.2f scan_us=%.1f\n", FIELDS, tree_ns[2] / QUERIES / 1e3, scan_ns[2] / QUERIES / 1e3);
+
+    cfg_free_ctx(cfg);
+    free(buf);
+
+    return 0;
+}
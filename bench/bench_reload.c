@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/cfg.h"
+
+/* hot reload benchmark: cost of pinning a snapshot, and reload latency while readers keep reading */
+
+#define KEYS 1000
+#define RELOADS 200
+#define PINS 10000000
+
+typedef struct reader_s {
+    pthread_t thread;
+    cfg_live_t* live;
+    size_t pins;
+} reader_t;
+
+static atomic_bool done;
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/* request threads: pin, look a key up, release, then wait a bit for the next request */
+static void* run_reader(void* arg) {
+    reader_t* state = arg;
+    cfg_reader_t* reader = cfg_reader_new(state->live);
+    struct timespec pause = { 0, 50000 };
+    long long value;
+    cfg_t* cfg;
+
+    while (reader != NULL && !atomic_load_explicit(&done, memory_order_relaxed)) {
+        cfg = cfg_acquire(reader);
+        cfg_get_setting_ctx(cfg, "key_42", &value);
+        cfg_release(reader);
+        state->pins += 1;
+        nanosleep(&pause, NULL);
+    }
+
+    cfg_reader_free(reader);
+
+    return NULL;
+}
+
+static int bench_pin(cfg_live_t* live) {
+    cfg_reader_t* reader = cfg_reader_new(live);
+    size_t count = 0;
+    double start;
+    double elapsed;
+
+    if (reader == NULL) {
+        return 1;
+    }
+
+    start = now_ns();
+    for (size_t i = 0; i < PINS; i++) {
+        count += cfg_acquire(reader) != NULL;
+        cfg_release(reader);
+    }
+    elapsed = now_ns() - start;
+
+    printf("pins=%d ns/pin=%.1f (checksum %zu)\n", PINS, elapsed / PINS, count);
+    cfg_reader_free(reader);
+
+    return 0;
+}
+
+static int bench_reload(cfg_live_t* live, const char* path, size_t nreaders) {
+    reader_t* readers = calloc(nreaders, sizeof(reader_t));
+    double latencies[RELOADS];
+    double start;
+    size_t pins = 0;
+
+    if (readers == NULL) {
+        return 1;
+    }
+
+    atomic_store(&done, false);
+    for (size_t i = 0; i < nreaders; i++) {
+        readers[i].live = live;
+        pthread_create(&readers[i].thread, NULL, run_reader, &readers[i]);
+    }
+
+    for (size_t i = 0; i < RELOADS; i++) {
+        start = now_ns();
+        if (cfg_reload(live, path, CFG_FLAG_NONE) != 0) {
+            cfg_perror_live(live, path);
+        }
+        latencies[i] = now_ns() - start;
+    }
+
+    atomic_store(&done, true);
+    for (size_t i = 0; i < nreaders; i++) {
+        pthread_join(readers[i].thread, NULL);
+        pins += readers[i].pins;
+    }
+
+    qsort(latencies, RELOADS, sizeof(double), compare_double);
+    printf("readers=%zu reloads=%d keys=%d reload_us_p50=%.1f reload_us_p99=%.1f reader_pins=%zu\n",
+        nreaders,
+        RELOADS,
+        KEYS,
+        latencies[RELOADS / 2] / 1e3,
+        latencies[RELOADS * 99 / 100] / 1e3,
+        pins
+    );
+
+    free(readers);
+
+    return 0;
+}
+
+int main(void) {
+    static const size_t readers[] = { 0, 1, 4, 16, 64 };
+    char path[] = "/tmp/libcfg_bench_reload_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file;
+    cfg_live_t* live = cfg_live_new();
+    int status = 0;
+
+    if (fd == -1 || live == NULL || (file = fdopen(fd, "w")) == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    for (size_t i = 0; i < KEYS; i++) {
+        fprintf(file, "key_%zu = %zu\n", i, i);
+    }
+    fclose(file);
+
+    if (cfg_reload(live, path, CFG_FLAG_NONE) != 0) {
+        cfg_perror_live(live, path);
+        return 1;
+    }
+
+    status = bench_pin(live);
+    for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]) && status == 0; i++) {
+        status = bench_reload(live, path, readers[i]);
+    }
+
+    cfg_live_free(live);
+    unlink(path);
+
+    return status;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+#include "bench_schema_keys.h"
+
+/* schema benchmark: lookups by generated id against lookups by identifier, in random order */
+
+#define ROUNDS 200
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* best parse time of a few rounds, with or without the schema */
+static double bench_parse(const char* buf, size_t len, const cfg_schema_t* schema) {
+    double best = 0;
+    double elapsed;
+    cfg_t* cfg;
+
+    for (int round = 0; round < 5; round++) {
+        cfg = cfg_new();
+        cfg_use_schema_ctx(cfg, schema, true);
+        elapsed = now_ns();
+        cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE);
+        elapsed = now_ns() - elapsed;
+        best = round == 0 || elapsed < best ? elapsed : best;
+        cfg_free_ctx(cfg);
+    }
+
+    return best;
+}
+
+int main(void) {
+    size_t keys = BENCH_COUNT;
+    size_t cap = keys * 40;
+    size_t len = 0;
+    char* buf = malloc(cap);
+    size_t* order = malloc(keys * sizeof(size_t));
+    size_t tmp;
+    size_t j;
+    uint64_t seed = 42;
+    long long value;
+    long long sum_string = 0;
+    long long sum_id = 0;
+    double start;
+    double string_ns;
+    double id_ns;
+    cfg_t* cfg = cfg_new();
+
+    if (buf == NULL || order == NULL || cfg == NULL || cfg_use_schema_ctx(cfg, &bench_schema, true) != 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < keys; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, "%s = %zu\n", bench_identifiers[i], i);
+        order[i] = i;
+    }
+
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(cfg, "cfg_parse_ctx");
+        return 1;
+    }
+
+    /* the same random order for both, so neither gets the cache friendlier sequence */
+    for (size_t i = keys - 1; i > 0; i--) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        j = (size_t)(seed >> 33) % (i + 1);
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < keys; i++) {
+            cfg_get_setting_ctx(cfg, bench_identifiers[order[i]], &value);
+            sum_string += value;
+        }
+    }
+    string_ns = (now_ns() - start) / (double)(keys * ROUNDS);
+
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < keys; i++) {
+            cfg_get_by_id_ctx(cfg, order[i], &value);
+            sum_id += value;
+        }
+    }
+    id_ns = (now_ns() - start) / (double)(keys * ROUNDS);
+
+    if (sum_string != sum_id) {
+        fprintf(stderr, "checksums differ\n");
+        return 1;
+    }
+
+    printf("keys=%zu lookups=%zu string_ns/lookup=%.1f id_ns/lookup=%.1f speedup=%.1fx\n",
+        keys, keys * ROUNDS, string_ns, id_ns, string_ns / id_ns);
+    printf("parse without_schema_ms=%.2f with_schema_ms=%.2f\n",
+        bench_parse(buf, len, NULL) / 1e6, bench_parse(buf, len, &bench_schema) / 1e6);
+
+    cfg_free_ctx(cfg);
+    free(buf);
+    free(order);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* streaming benchmark: a config fed in pieces of various sizes, and loaded from a pipe, against a parse of the whole buffer */
+
+#define KEYS 1000000
+#define RUNS 5
+
+/* glibc lets the program interpose the allocator, count the calls and forward them to the real one */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static size_t allocs_g = 0;
+static size_t alloc_bytes_g = 0;
+
+void* malloc(size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += size;
+    return __libc_malloc(size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += size;
+    return __libc_realloc(ptr, size);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+typedef struct writer_s {
+    int fd;
+    const char* buf;
+    size_t len;
+} writer_t;
+
+static void* write_pipe(void* arg) {
+    writer_t* writer = arg;
+    ssize_t n;
+
+    for (size_t pos = 0; pos < writer->len; pos += (size_t)n) {
+        n = write(writer->fd, &writer->buf[pos], writer->len - pos);
+        if (n <= 0) {
+            break;
+        }
+    }
+    close(writer->fd);
+
+    return NULL;
+}
+
+static void report(const char* mode, size_t len, double ns, size_t allocs, size_t bytes) {
+    printf("mode=%s mb_per_s=%.1f allocs=%zu alloc_kb=%zu\n", mode, (double)len / (ns / 1e9) / 1e6, allocs, bytes / 1024);
+}
+
+int main(void) {
+    static const size_t pieces[] = { 64, 4096, 65536 };
+    size_t cap = (size_t)KEYS * 64;
+    char* buf = malloc(cap);
+    size_t len = 0;
+    size_t allocs;
+    size_t bytes;
+    size_t n;
+    double start;
+    double best;
+    double elapsed;
+    char mode[32];
+    char path[64];
+    int fds[2];
+    writer_t writer;
+    pthread_t thread;
+    cfg_t* cfg;
+
+    for (size_t i = 0; i < KEYS; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, i % 2 == 0 ? "app.key_%zu = %zu # counter\n" : "app.key_%zu = \"value %zu\"\n", i, i);
+    }
+    printf("keys=%d bytes=%zu\n", KEYS, len);
+
+    best = 1e300;
+    for (int run = 0; run < RUNS; run++) {
+        allocs = allocs_g;
+        bytes = alloc_bytes_g;
+        cfg = cfg_new();
+        start = now_ns();
+        cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE);
+        elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+        allocs = allocs_g - allocs;
+        bytes = alloc_bytes_g - bytes;
+        cfg_free_ctx(cfg);
+    }
+    report("buffer", len, best, allocs, bytes);
+
+    for (size_t p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++) {
+        best = 1e300;
+        for (int run = 0; run < RUNS; run++) {
+            allocs = allocs_g;
+            bytes = alloc_bytes_g;
+            cfg = cfg_new();
+            start = now_ns();
+            cfg_stream_begin_ctx(cfg);
+            for (size_t pos = 0; pos < len; pos += n) {
+                n = len - pos < pieces[p] ? len - pos : pieces[p];
+                cfg_stream_feed_ctx(cfg, &buf[pos], n);
+            }
+            if (cfg_stream_end_ctx(cfg) != 0) {
+                cfg_perror_ctx(cfg, "stream");
+                return 1;
+            }
+            elapsed = now_ns() - start;
+            best = elapsed < best ? elapsed : best;
+            allocs = allocs_g - allocs;
+            bytes = alloc_bytes_g - bytes;
+            cfg_free_ctx(cfg);
+        }
+        snprintf(mode, sizeof(mode), "feed_%zu", pieces[p]);
+        report(mode, len, best, allocs, bytes);
+    }
+
+    best = 1e300;
+    for (int run = 0; run < RUNS; run++) {
+        if (pipe(fds) != 0) {
+            return 1;
+        }
+        writer = (writer_t){ fds[1], buf, len };
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fds[0]);
+        allocs = allocs_g;
+        bytes = alloc_bytes_g;
+        cfg = cfg_new();
+        start = now_ns();
+        pthread_create(&thread, NULL, write_pipe, &writer);
+        if (cfg_load_ctx(cfg, path, CFG_FLAG_NONE) != 0) {
+            cfg_perror_ctx(cfg, "pipe");
+            return 1;
+        }
+        pthread_join(thread, NULL);
+        elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+        allocs = allocs_g - allocs;
+        bytes = alloc_bytes_g - bytes;
+        close(fds[0]);
+        cfg_free_ctx(cfg);
+    }
+    report("pipe", len, best, allocs, bytes);
+
+    free(buf);
+
+    return 0;
+}
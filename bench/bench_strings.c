@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/*
+ * strings benchmark: a fleet config where most string values come from small sets, hostnames,
+ * regions, teams, modes, and a few are unique, paths and names. reports the heap memory, the heap
+ * blocks and the parse time, copied and zero-copy.
+*/
+
+#define SERVICES 100000
+#define FIELDS 10
+#define ROUNDS 3
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t generate(char* buf, size_t cap) {
+    static const char* const regions[] = { "eu-west-1", "eu-central-1", "us-east-1", "us-west-2", "ap-south-1", "ap-northeast-1", "sa-east-1", "ca-central-1" };
+    static const char* const levels[] = { "debug", "info", "warn", "error" };
+    static const char* const protocols[] = { "http", "grpc", "tcp" };
+    size_t len = 0;
+
+    for (int s = 0; s < SERVICES; s++) {
+        len += (size_t)snprintf(&buf[len], cap - len,
+            "svc_%d.name = \"service-%d\"\n"
+            "svc_%d.host = \"db-%02d.internal.example.com\"\n"
+            "svc_%d.region = \"%s\"\n"
+            "svc_%d.owner = \"team-%d\"\n"
+            "svc_%d.mode = \"%s\"\n"
+            "svc_%d.log_level = \"%s\"\n"
+            "svc_%d.protocol = \"%s\"\n"
+            "svc_%d.path = \"/srv/service-%d/data\"\n"
+            "svc_%d.port = %d\n"
+            "svc_%d.timeout = %d.5\n",
+            s, s, s, s % 64, s, regions[s % 8], s, s % 200, s, s % 5 == 0 ? "disabled" : "enabled",
+            s, levels[s % 4], s, protocols[s % 3], s, s, s, 8000 + s % 1000, s, s % 30);
+    }
+
+    return len;
+}
+
+static void bench(const char* name, const char* buf, size_t len, int flags) {
+    double best = 0;
+    double elapsed;
+    cfg_stats_t stats = { 0 };
+    cfg_t* cfg;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        cfg = cfg_new();
+        elapsed = now_ns();
+        if (cfg == NULL || cfg_parse_ctx(cfg, buf, len, flags) != 0) {
+            cfg_perror_ctx(cfg, name);
+            exit(1);
+        }
+        elapsed = (now_ns() - elapsed) / 1e6;
+        best = round == 0 || elapsed < best ? elapsed : best;
+        stats = cfg_get_stats_ctx(cfg);
+        cfg_free_ctx(cfg);
+    }
+
+    printf("%-9s settings=%d strings=%llu shared=%llu heap_mb=%.1f bytes/setting=%.1f allocs=%llu parse_ms=%.1f\n",
+        name, SERVICES * FIELDS, (unsigned long long)stats.strings, (unsigned long long)stats.shared_strings,
+        (double)stats.heap_bytes / (1024 * 1024), (double)stats.heap_bytes / (SERVICES * FIELDS),
+        (unsigned long long)stats.heap_allocs, best);
+}
+
+int main(void) {
+    size_t cap = (size_t)SERVICES * FIELDS * 48;
+    char* buf = malloc(cap);
+    size_t len;
+
+    if (buf == NULL) {
+        return 1;
+    }
+
+    len = generate(buf, cap);
+    bench("copied", buf, len, CFG_FLAG_NONE);
+    bench("zero-copy", buf, len, CFG_FLAG_ZEROCOPY);
+
+    free(buf);
+
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "../include/cfg.h"
+
+/*
+ * benchmark suite, run by `make bench`: generates a config with a deterministic generator, then loads it,
+ * parses it, looks its settings up and frees it, and prints one line of key=value pairs per run so that
+ * runs of different commits can be compared. one run per process, so that the peak RSS, generated text
+ * included, is the one of the run. the timings are the best of a few repetitions.
+ *
+ *     bench_suite [-k keys] [-s seed] [-m ints:floats:strings:bools] [-c comments%] [-b blank%] [-t tag] [-w out.cfg]
+ *
+ * -w only writes the config and exits.
+*/
+
+#define LOOKUPS 1000000
+#define POOL 65536 /* identifiers looked up, in random order */
+#define ID_MAX 64
+#define RUNS 3
+
+/* glibc lets the program interpose the allocator, count the calls and forward them to the real one */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static size_t allocs_g = 0;
+static size_t alloc_bytes_g = 0;
+
+void* malloc(size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += n * size;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    allocs_g += 1;
+    alloc_bytes_g += size;
+    return __libc_realloc(ptr, size);
+}
+
+typedef struct synth_s {
+    size_t keys;
+    uint64_t seed;
+    unsigned mix[4]; /* weights of ints, floats, strings and bools */
+    unsigned comments; /* percentage of comment lines, on top of the settings */
+    unsigned blank; /* percentage of blank lines and of settings with odd spacing */
+} synth_t;
+
+static uint64_t state_g;
+
+/* xorshift64*, the same seed always gives the same config */
+static uint64_t next(void) {
+    state_g ^= state_g >> 12;
+    state_g ^= state_g << 25;
+    state_g ^= state_g >> 27;
+
+    return state_g * 0x2545f4914f6cdd1dULL;
+}
+
+static size_t identifier(char* buf, size_t cap, size_t i) {
+    return (size_t)snprintf(buf, cap, "section_%zu.key_%zu", i / 64, i);
+}
+
+/* usual spacing, or now and then odd spacing */
+static const char* spacing(const synth_t* synth, const char* usual) {
+    static const char* const odd[] = { "", "\t", "  ", " \t " };
+
+    return next() % 100 < synth->blank ? odd[next() % 4] : usual;
+}
+
+/* generates the config, about 48 bytes per setting */
+static char* generate(const synth_t* synth, size_t* len) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-./";
+    size_t cap = synth->keys * 96 + 256;
+    char* buf = malloc(cap);
+    unsigned total = synth->mix[0] + synth->mix[1] + synth->mix[2] + synth->mix[3];
+    unsigned pick;
+    size_t n;
+
+    if (buf == NULL || total == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    state_g = synth->seed * 0x9e3779b97f4a7c15ULL + 1;
+    *len = 0;
+
+    for (size_t i = 0; i < synth->keys; i++) {
+        if (next() % 100 < synth->comments) {
+            *len += (size_t)snprintf(&buf[*len], cap - *len, "# comment %" PRIu64 "\n", next() % 100000);
+        }
+        if (next() % 100 < synth->blank) {
+            *len += (size_t)snprintf(&buf[*len], cap - *len, next() % 2 == 0 ? "\n" : " \t\r\n");
+        }
+
+        *len += (size_t)snprintf(&buf[*len], cap - *len, "%s", spacing(synth, ""));
+        *len += identifier(&buf[*len], cap - *len, i);
+        *len += (size_t)snprintf(&buf[*len], cap - *len, "%s=%s", spacing(synth, " "), spacing(synth, " "));
+
+        pick = (unsigned)(next() % total);
+        if (pick < synth->mix[0]) {
+            *len += (size_t)snprintf(&buf[*len], cap - *len, "%lld", (long long)(next() >> (next() % 64)) * (next() % 2 == 0 ? 1 : -1));
+        } else if (pick < synth->mix[0] + synth->mix[1]) {
+            *len += (size_t)snprintf(&buf[*len], cap - *len, "%lld.%0*" PRIu64, (long long)(next() % 2000000) - 1000000,
+                (int)(next() % 6 + 1), next() % 100000);
+        } else if (pick < synth->mix[0] + synth->mix[1] + synth->mix[2]) {
+            n = (size_t)(next() % 40);
+            buf[(*len)++] = '"';
+            for (size_t c = 0; c < n; c++) {
+                buf[(*len)++] = alphabet[next() % (sizeof(alphabet) - 1)];
+            }
+            buf[(*len)++] = '"';
+        } else {
+            *len += (size_t)snprintf(&buf[*len], cap - *len, next() % 2 == 0 ? "true" : "false");
+        }
+
+        *len += (size_t)snprintf(&buf[*len], cap - *len, "%s\n", next() % 100 < synth->blank ? " \r" : "");
+    }
+
+    return buf;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static long peak_rss_kb(void) {
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* the least disturbed by the rest of the machine */
+static double best(double a, double b) {
+    return a < b ? a : b;
+}
+
+static int usage(const char* name) {
+    fprintf(stderr, "usage: %s [-k keys] [-s seed] [-m ints:floats:strings:bools] [-c comments%%] [-b blank%%] [-t tag] [-w out.cfg]\n", name);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    synth_t synth = { .keys = 100000, .seed = 1, .mix = { 40, 20, 30, 10 }, .comments = 10, .blank = 10 };
+    const char* tag = "none";
+    const char* output = NULL;
+    char path[] = "/tmp/bench_suite_XXXXXX";
+    char* hits = malloc(POOL * ID_MAX);
+    char* misses = malloc(POOL * ID_MAX);
+    char* buf;
+    size_t len;
+    size_t parse_allocs = 0;
+    size_t parse_alloc_bytes = 0;
+    size_t found = 0;
+    double start;
+    double load_ns = 1e300;
+    double parse_ns = 1e300;
+    double hit_ns = 1e300;
+    double miss_ns = 1e300;
+    double free_ns = 1e300;
+    long double value; /* large enough for every type */
+    FILE* file;
+    int fd;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        } else if (strcmp(argv[i], "-k") == 0) {
+            synth.keys = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            synth.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-m") == 0) {
+            if (sscanf(argv[++i], "%u:%u:%u:%u", &synth.mix[0], &synth.mix[1], &synth.mix[2], &synth.mix[3]) != 4) {
+                return usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "-c") == 0) {
+            synth.comments = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-b") == 0) {
+            synth.blank = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            tag = argv[++i];
+        } else if (strcmp(argv[i], "-w") == 0) {
+            output = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    buf = synth.keys == 0 ? NULL : generate(&synth, &len);
+    if (buf == NULL || hits == NULL || misses == NULL) {
+        return usage(argv[0]);
+    }
+
+    if (output != NULL) {
+        file = fopen(output, "w");
+        if (file == NULL || fwrite(buf, 1, len, file) != len || fclose(file) != 0) {
+            perror(output);
+            return 1;
+        }
+        return 0;
+    }
+
+    fd = mkstemp(path);
+    if (fd == -1 || write(fd, buf, len) != (ssize_t)len) {
+        perror(path);
+        return 1;
+    }
+    close(fd);
+
+    for (size_t i = 0; i < POOL; i++) {
+        identifier(&hits[i * ID_MAX], ID_MAX, (size_t)(next() % synth.keys));
+        snprintf(&misses[i * ID_MAX], ID_MAX, "section_%zu.missing_%zu", (size_t)(next() % synth.keys) / 64, i);
+    }
+
+    for (int run = 0; run < RUNS; run++) {
+        start = now_ns();
+        if (cfg_load(path) != 0) {
+            cfg_perror(path);
+            return 1;
+        }
+        load_ns = best(load_ns, now_ns() - start);
+        cfg_free();
+
+        parse_allocs = allocs_g;
+        parse_alloc_bytes = alloc_bytes_g;
+        start = now_ns();
+        if (cfg_parse(buf, len) != 0) {
+            cfg_perror("cfg_parse");
+            return 1;
+        }
+        parse_ns = best(parse_ns, now_ns() - start);
+        parse_allocs = allocs_g - parse_allocs;
+        parse_alloc_bytes = alloc_bytes_g - parse_alloc_bytes;
+
+        start = now_ns();
+        for (size_t i = 0; i < LOOKUPS; i++) {
+            found += cfg_get_setting(&hits[(i % POOL) * ID_MAX], &value) == 0 || cfg_errno != CFG_ENEXIST;
+        }
+        hit_ns = best(hit_ns, (now_ns() - start) / LOOKUPS);
+
+        start = now_ns();
+        for (size_t i = 0; i < LOOKUPS; i++) {
+            found += cfg_get_setting(&misses[(i % POOL) * ID_MAX], &value) == 0;
+        }
+        miss_ns = best(miss_ns, (now_ns() - start) / LOOKUPS);
+
+        start = now_ns();
+        cfg_free();
+        free_ns = best(free_ns, now_ns() - start);
+    }
+
+    unlink(path);
+
+    /* every hit is found and no miss is */
+    if (found != (size_t)RUNS * LOOKUPS) {
+        fprintf(stderr, "%zu lookups succeeded, expected %zu\n", found, (size_t)RUNS * LOOKUPS);
+        return 1;
+    }
+
+    printf("tag=%s keys=%zu seed=%" PRIu64 " bytes=%zu load_mb_s=%.1f parse_mb_s=%.1f lookup_ns=%.1f miss_ns=%.1f "
+        "free_ms=%.2f allocs=%zu alloc_bytes=%zu peak_rss_kb=%ld\n",
+        tag, synth.keys, synth.seed, len, (double)len / (load_ns / 1e9) / 1e6, (double)len / (parse_ns / 1e9) / 1e6,
+        hit_ns, miss_ns, free_ns / 1e6, parse_allocs, parse_alloc_bytes, peak_rss_kb());
+
+    free(hits);
+    free(misses);
+    free(buf);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../include/cfg.h"
+
+/*
+ * tokenizer throughput benchmark: parses large generated configs with short lines, long
+ * comments and long strings. build with -DCFG_NO_SIMD to measure the scalar scanner.
+*/
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static char* generate(const char* shape, size_t target, size_t* len) {
+    char* buf = malloc(target + 512);
+    size_t n = 0;
+
+    *len = 0;
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    while (*len < target) {
+        if (strcmp(shape, "short") == 0) {
+            *len += (size_t)sprintf(&buf[*len], "k%zu = %zu\n", n, n);
+        } else if (strcmp(shape, "comments") == 0) {
+            *len += (size_t)sprintf(&buf[*len], "# %0160zu\nk%zu = %zu # %060zu\n", n, n, n, n);
+        } else {
+            *len += (size_t)sprintf(&buf[*len], "section.subsection.key_%zu    =    \"%0200zu\"    \n", n, n);
+        }
+        n += 1;
+    }
+
+    return buf;
+}
+
+static int bench_tokenizer(const char* shape, size_t target) {
+    size_t len;
+    char* buf = generate(shape, target, &len);
+    double best = 0;
+    double start;
+    double elapsed;
+
+    if (buf == NULL) {
+        return 1;
+    }
+
+    /* zero-copy keeps the arena out of the measurement as much as possible */
+    for (int round = 0; round < 5; round++) {
+        start = now_ns();
+        if (cfg_parse_ex(buf, len, CFG_FLAG_ZEROCOPY) != 0) {
+            cfg_perror("cfg_parse_ex");
+            free(buf);
+            return 1;
+        }
+        elapsed = now_ns() - start;
+        cfg_free();
+
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    printf("shape=%s bytes=%zu parse_ms=%.2f MB/s=%.1f\n", shape, len, best / 1e6, (double)len / (best / 1e9) / 1e6);
+    free(buf);
+
+    return 0;
+}
+
+int main(void) {
+    static const char* shapes[] = { "short", "comments", "strings" };
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        if (bench_tokenizer(shapes[i], 64 * 1024 * 1024) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
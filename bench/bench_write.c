@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/*
+ * write benchmark: half a million settings of every type written to /dev/null with cfg_dump and
+ * cfg_write, and into memory with cfg_write_buffer. reports the time and the output rate.
+*/
+
+#define KEYS 500000
+#define ROUNDS 5
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* a quarter of integers, floats, short strings and booleans */
+static size_t generate(char* buf, size_t cap) {
+    size_t len = 0;
+
+    for (size_t i = 0; i < KEYS; i++) {
+        switch (i % 4) {
+            case 0: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %zu\n", i, i * 7919);
+                break;
+            }
+            case 1: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %zu.%zu\n", i, i % 1000, i % 97);
+                break;
+            }
+            case 2: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = \"value %zu\"\n", i, i);
+                break;
+            }
+            default: {
+                len += (size_t)snprintf(&buf[len], cap - len, "key_%zu = %s\n", i, i % 8 == 3 ? "true" : "false");
+                break;
+            }
+        }
+    }
+
+    return len;
+}
+
+static void report(const char* name, double best, size_t bytes) {
+    printf("%-7s keys=%d bytes=%zu ms=%.1f mb/s=%.0f\n", name, KEYS, bytes, best / 1e6, (double)bytes / (best / 1e9) / (1024 * 1024));
+}
+
+int main(void) {
+    size_t cap = (size_t)KEYS * 40;
+    char* buf = malloc(cap);
+    char* out = NULL;
+    size_t out_len = 0;
+    double best[3] = { 0 };
+    double elapsed;
+    size_t len;
+    int fd = open("/dev/null", O_WRONLY);
+    int console = dup(STDOUT_FILENO);
+    cfg_t* cfg = cfg_new();
+
+    /* cfg_dump writes to stdout, which points to /dev/null until the results */
+    if (buf == NULL || cfg == NULL || fd == -1 || console == -1 || dup2(fd, STDOUT_FILENO) == -1) {
+        return 1;
+    }
+
+    len = generate(buf, cap);
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(cfg, "parse");
+        return 1;
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        elapsed = now_ns();
+        cfg_dump_ctx(cfg);
+        fflush(stdout);
+        elapsed = now_ns() - elapsed;
+        best[0] = round == 0 || elapsed < best[0] ? elapsed : best[0];
+
+        elapsed = now_ns();
+        if (cfg_write_ctx(cfg, fd) != 0) {
+            return 1;
+        }
+        elapsed = now_ns() - elapsed;
+        best[1] = round == 0 || elapsed < best[1] ? elapsed : best[1];
+
+        free(out);
+        elapsed = now_ns();
+        if (cfg_write_buffer_ctx(cfg, &out, &out_len) != 0) {
+            return 1;
+        }
+        elapsed = now_ns() - elapsed;
+        best[2] = round == 0 || elapsed < best[2] ? elapsed : best[2];
+    }
+
+    fflush(stdout);
+    if (dup2(console, STDOUT_FILENO) == -1) {
+        return 1;
+    }
+    report("dump", best[0], out_len);
+    report("write", best[1], out_len);
+    report("buffer", best[2], out_len);
+
+    free(out);
+    free(buf);
+    close(fd);
+    close(console);
+    cfg_free_ctx(cfg);
+
+    return 0;
+}
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_array.c ../src/*.c -pthread -o bench_array.out && ./bench_array.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_bind.c ../src/*.c -pthread -o bench_bind.out && ./bench_bind.out
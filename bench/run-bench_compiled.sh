@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_compiled.c ../src/*.c -pthread -o bench_compiled.out && ./bench_compiled.out
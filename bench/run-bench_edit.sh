@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_edit.c ../src/*.c -pthread -o bench_edit.out && ./bench_edit.out
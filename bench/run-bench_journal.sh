@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_journal.c ../src/*.c -pthread -o bench_journal.out && ./bench_journal.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_layer.c ../src/*.c -pthread -o bench_layer.out && ./bench_layer.out
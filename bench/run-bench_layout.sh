@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_layout.c ../src/*.c -pthread -o bench_layout.out && ./bench_layout.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_lazy.c ../src/*.c -pthread -o bench_lazy.out && ./bench_lazy.out
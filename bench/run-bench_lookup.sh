@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_lookup.c ../src/*.c -pthread -o bench_lookup.out && ./bench_lookup.out
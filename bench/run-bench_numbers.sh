@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_numbers.c ../src/*.c -pthread -o bench_numbers.out && ./bench_numbers.out
@@ -0,0 +1,4 @@
+#!/bin/bash
+
+# the maximum number of threads defaults to the number of online cores
+clang -std=gnu2x -Wall -Wextra -O2 bench_parallel.c ../src/*.c -pthread -o bench_parallel.out && ./bench_parallel.out ${1}
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_parse.c ../src/*.c -pthread -o bench_parse.out && ./bench_parse.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_prefix.c ../src/*.c -pthread -o bench_prefix.out && ./bench_prefix.out
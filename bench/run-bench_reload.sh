@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_reload.c ../src/*.c -pthread -o bench_reload.out && ./bench_reload.out
@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# the schema header is generated first, as a build would do
+clang -std=gnu2x -Wall -Wextra -O2 ../tools/cfg_gen.c ../src/*.c -pthread -o cfg_gen.out || exit 1
+seq -f "section.key_%g" 0 9999 > bench_schema.keys
+./cfg_gen.out -p bench -o bench_schema_keys.h bench_schema.keys && \
+clang -std=gnu2x -Wall -Wextra -O2 -I../include bench_schema.c ../src/*.c -pthread -o bench_schema.out && ./bench_schema.out
+status=$?
+rm -f cfg_gen.out bench_schema.keys bench_schema_keys.h
+exit ${status}
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_stream.c ../src/*.c -pthread -o bench_stream.out && ./bench_stream.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_strings.c ../src/*.c -pthread -o bench_strings.out && ./bench_strings.out
@@ -0,0 +1,6 @@
+#!/bin/bash
+
+for variant in "" "-DCFG_NO_AVX2" "-DCFG_NO_SIMD"; do
+    echo "scanner build flags: ${variant:-default}"
+    clang -std=gnu2x -Wall -Wextra -O2 ${variant} bench_tokenizer.c ../src/*.c -pthread -o bench_tokenizer.out && ./bench_tokenizer.out
+done
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -O2 bench_write.c ../src/*.c -pthread -o bench_write.out && ./bench_write.out
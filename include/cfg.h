@@ -23,6 +23,18 @@ enum cfg_error_e {
     CFG_ESEEK,
     CFG_EMAP,
     CFG_ENEXIST,
+    CFG_EVIEW,
+    CFG_EWATCH,
+    CFG_EEDIT,
+    CFG_EWRITE,
+    CFG_ESCHEMA,
+    CFG_EUNKNOWN,
+    CFG_ESTREAM,
+    CFG_EREAD,
+    CFG_ELAYER,
+    CFG_EREADONLY,
+    CFG_EJOURNAL,
+    CFG_EARRAY,
     CFG_EHUH,
 };
 
@@ -35,47 +47,272 @@ enum cfg_setting_type_e {
     CFG_STYPE_FLOAT,
     CFG_STYPE_STRING,
     CFG_STYPE_BOOL,
+    CFG_STYPE_ARRAY,
 };
 
 /**
- * @brief setting object, containing the setting value
+ * @brief floating point storage type, build with CFG_FLOAT_DOUBLE to store doubles instead of long doubles
 */
-typedef struct cfg_setting_s {
-    enum cfg_setting_type_e type;
-    char* identifier;
+#ifdef CFG_FLOAT_DOUBLE
+typedef double cfg_float_t;
+#else
+typedef long double cfg_float_t;
+#endif
+
+/**
+ * @brief parsing flags
+*/
+enum cfg_flag_e {
+    CFG_FLAG_NONE = 0,
+    CFG_FLAG_ZEROCOPY = 1 << 0, /* identifiers and strings reference the parsed buffer instead of being copied */
+    CFG_FLAG_INCREMENTAL = 1 << 1, /* keeps a line index so the buffer can be edited with cfg_edit, not with zero-copy */
+    CFG_FLAG_LAZY = 1 << 2, /* numbers are kept as text and converted by the first getter reading them, see cfg_validate */
+};
+
+/**
+ * @brief identifiers known at build time, generated by cfg_gen. the settings of those identifiers
+ * are stored by id and found with a perfect hash: identifier, displacement of its bucket, position
+*/
+typedef struct cfg_schema_s {
+    const char* const* identifiers; /* identifier of every id */
+    const uint32_t* identifier_lens;
+    size_t len; /* number of ids */
+    const uint32_t* displacements; /* displacement of every bucket */
+    size_t buckets_len;
+    const uint32_t* positions; /* id + 1 at every position of the perfect hash, 0 if free */
+    size_t positions_len;
+} cfg_schema_t;
 
+/**
+ * @brief binding of a setting to a struct field, for cfg_bind. the field has the type the getters
+ * write: long long, cfg_float_t, char* or bool. an optional binding gets its default when the
+ * setting is missing
+*/
+typedef struct cfg_binding_s {
+    const char* identifier;
+    enum cfg_setting_type_e type; /* expected type */
+    size_t offset; /* offsetof the field */
+    bool optional;
+    union { /* default value */
+        long long integer;
+        cfg_float_t floating;
+        const char* string;
+        bool boolean;
+    };
+} cfg_binding_t;
+
+/**
+ * @brief string item of an array, see cfg_get_array_ctx
+*/
+typedef struct cfg_string_span_s {
+    const char* ptr;
+    size_t len;
+} cfg_string_span_t;
+
+/**
+ * @brief decoded value of a setting, handed to the callback of cfg_parse_cb and taken by cfg_set_setting.
+ * strings point into the parsed buffer and are not NUL terminated. the items of an array are contiguous
+ * long long, cfg_float_t or cfg_string_span_t, the ones handed to a callback only stay valid during the call
+*/
+typedef struct cfg_value_s {
+    enum cfg_setting_type_e type;
     union {
         long long integer;
-        long double floating;
-        char* string;
+        cfg_float_t floating;
+        struct {
+            const char* string;
+            size_t string_len;
+        };
         bool boolean;
+        struct {
+            const void* array;
+            size_t array_len;
+            enum cfg_setting_type_e array_type; /* type of the items, CFG_STYPE_UNKNOWN for an empty array */
+        };
     };
-} cfg_setting_t;
+} cfg_value_t;
+
+/**
+ * @brief called by cfg_parse_cb for every setting in file order, the identifier points into the parsed buffer
+ * and isn't NUL terminated. returning non-zero stops the parse
+*/
+typedef int (*cfg_setting_cb_t)(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user);
 
 /**
- * @brief cfg object
+ * @brief statistics of a configuration, see cfg_get_stats_ctx. build with CFG_NO_STATS to leave the counters out
 */
-typedef struct cfg_s {
-    char* path;
-    cfg_setting_t** settings;
-    size_t settings_len;
-    size_t line;
-    size_t col;
-} cfg_t;
+typedef struct cfg_stats_s {
+    uint64_t parse_ns; /* wall time spent parsing */
+    uint64_t parse_bytes; /* bytes scanned by the parser */
+    uint64_t lines; /* newlines scanned by the parser */
+    uint64_t integers; /* settings parsed, per type */
+    uint64_t floats;
+    uint64_t strings;
+    uint64_t booleans;
+    uint64_t arrays;
+    uint64_t shared_strings; /* copied strings sharing the copy of an earlier setting with the same value */
+    uint64_t heap_bytes; /* heap memory held by the configuration */
+    uint64_t heap_allocs; /* heap blocks held by the configuration */
+    uint64_t lookups; /* settings looked up by the getters */
+    uint64_t misses; /* lookups that failed with CFG_ENEXIST */
+} cfg_stats_t;
+
+/**
+ * @brief operations reported to a slow hook
+*/
+enum cfg_slow_e {
+    CFG_SLOW_PARSE,
+    CFG_SLOW_LOOKUP,
+};
+
+/**
+ * @brief called when a parse or a lookup takes longer than the threshold given to cfg_set_slow_hook_ctx.
+ * what is the path of the loaded file for a parse, NULL for a buffer, and the identifier for a lookup,
+ * neither is NUL terminated
+*/
+typedef void (*cfg_slow_cb_t)(enum cfg_slow_e kind, const char* what, size_t what_len, uint64_t ns, void* user);
+
+/**
+ * @brief cfg object, holds a parsed configuration and its error state
+*/
+typedef struct cfg_s cfg_t;
+
+/**
+ * @brief live configuration, publishes immutable snapshots that can be reloaded while being read
+*/
+typedef struct cfg_live_s cfg_live_t;
+
+/**
+ * @brief reader of a live configuration, pins one snapshot at a time, one per thread
+*/
+typedef struct cfg_reader_s cfg_reader_t;
+
+/**
+ * @brief watcher reloading a live configuration when its file changes
+*/
+typedef struct cfg_watch_s cfg_watch_t;
+
+/**
+ * @brief kinds of setting changes reported by a watcher
+*/
+enum cfg_change_e {
+    CFG_CHANGE_ADDED,
+    CFG_CHANGE_REMOVED,
+    CFG_CHANGE_CHANGED,
+};
+
+/**
+ * @brief called by a watcher for every setting that changed in a reload, old_cfg is NULL on the first load.
+ * both snapshots stay valid until the callback returns, the identifier isn't NUL terminated in zero-copy mode
+*/
+typedef void (*cfg_change_cb_t)(enum cfg_change_e change, const char* identifier, size_t identifier_len,
+    cfg_t* old_cfg, cfg_t* new_cfg, void* user);
 
 extern int cfg_errno;
 
 const char *cfg_strerror(int errnum);
 void cfg_perror(const char *error_string);
 
+cfg_t* cfg_new(void);
+int cfg_parse_ctx(cfg_t* cfg, const char* str, size_t len, int flags);
+int cfg_parse_cb_ctx(cfg_t* cfg, const char* str, size_t len, cfg_setting_cb_t callback, void* user);
+int cfg_load_ctx(cfg_t* cfg, const char* path, int flags);
+int cfg_load_parallel_ctx(cfg_t* cfg, const char* path, size_t nthreads, int flags);
+int cfg_edit_ctx(cfg_t* cfg, const char* str, size_t len, size_t edit_pos, size_t old_len, size_t new_len);
+int cfg_load_compiled_ctx(cfg_t* cfg, const char* text_path, const char* bin_path);
+int cfg_stream_begin_ctx(cfg_t* cfg);
+int cfg_stream_feed_ctx(cfg_t* cfg, const char* buf, size_t len);
+int cfg_stream_end_ctx(cfg_t* cfg);
+int cfg_use_schema_ctx(cfg_t* cfg, const cfg_schema_t* schema, bool overflow);
+int cfg_set_base_ctx(cfg_t* cfg, const cfg_t* base);
+const cfg_t* cfg_get_base_ctx(const cfg_t* cfg);
+void cfg_free_ctx(cfg_t* cfg);
+
+int cfg_set_setting_ctx(cfg_t* cfg, const char* identifier, const cfg_value_t* value);
+int cfg_remove_setting_ctx(cfg_t* cfg, const char* identifier);
+int cfg_journal_open_ctx(cfg_t* cfg, const char* path, size_t compact_bytes);
+int cfg_journal_compact_ctx(cfg_t* cfg);
+int cfg_journal_sync_ctx(cfg_t* cfg);
+int cfg_journal_close_ctx(cfg_t* cfg);
+int cfg_validate_ctx(cfg_t* cfg, const char** identifier, size_t* identifier_len);
+
+int cfg_get_setting_ctx(cfg_t* cfg, const char* identifier, void* value);
+int cfg_get_by_id_ctx(cfg_t* cfg, size_t id, void* value);
+int cfg_bind_ctx(cfg_t* cfg, const cfg_binding_t* table, size_t n, void* out_struct, int* errors);
+int cfg_get_string_view_ctx(cfg_t* cfg, const char* identifier, const char** str, size_t* len);
+int cfg_get_array_ctx(cfg_t* cfg, const char* identifier, enum cfg_setting_type_e type, const void** items, size_t* len);
+enum cfg_setting_type_e cfg_get_setting_type_ctx(const cfg_t* cfg, const char* identifier);
+int cfg_foreach_prefix_ctx(cfg_t* cfg, const char* prefix, cfg_setting_cb_t callback, void* user);
+int cfg_count_prefix_ctx(cfg_t* cfg, const char* prefix, size_t* count);
+cfg_stats_t cfg_get_stats_ctx(const cfg_t* cfg);
+void cfg_set_slow_hook_ctx(cfg_t* cfg, uint64_t threshold_ns, cfg_slow_cb_t hook, void* user);
+
+void cfg_dump_ctx(const cfg_t* cfg);
+int cfg_write_ctx(cfg_t* cfg, int fd);
+int cfg_write_buffer_ctx(cfg_t* cfg, char** str, size_t* len);
+int cfg_get_errno_ctx(const cfg_t* cfg);
+void cfg_perror_ctx(const cfg_t* cfg, const char* error_string);
+size_t cfg_get_error_line_ctx(const cfg_t* cfg);
+size_t cfg_get_error_col_ctx(const cfg_t* cfg);
+const char* cfg_get_path_ctx(const cfg_t* cfg);
+
+cfg_live_t* cfg_live_new(void);
+int cfg_reload(cfg_live_t* live, const char* path, int flags);
+void cfg_live_free(cfg_live_t* live);
+int cfg_get_errno_live(cfg_live_t* live);
+void cfg_perror_live(cfg_live_t* live, const char* error_string);
+size_t cfg_get_error_line_live(cfg_live_t* live);
+size_t cfg_get_error_col_live(cfg_live_t* live);
+
+cfg_reader_t* cfg_reader_new(cfg_live_t* live);
+cfg_t* cfg_acquire(cfg_reader_t* reader);
+void cfg_release(cfg_reader_t* reader);
+void cfg_reader_free(cfg_reader_t* reader);
+
+cfg_watch_t* cfg_watch_new(cfg_live_t* live, const char* path, int flags, int debounce_ms, cfg_change_cb_t callback, void* user);
+int cfg_watch_process(cfg_watch_t* watch, int timeout_ms);
+int cfg_watch_fd(const cfg_watch_t* watch);
+int cfg_get_errno_watch(const cfg_watch_t* watch);
+void cfg_watch_free(cfg_watch_t* watch);
+
 int cfg_parse(const char* str, size_t len);
+int cfg_parse_ex(const char* str, size_t len, int flags);
+int cfg_parse_cb(const char* str, size_t len, cfg_setting_cb_t callback, void* user);
 int cfg_load(const char* path);
+int cfg_load_ex(const char* path, int flags);
+int cfg_load_parallel(const char* path, size_t nthreads);
+int cfg_edit(const char* str, size_t len, size_t edit_pos, size_t old_len, size_t new_len);
+int cfg_compile(const char* text_path, const char* bin_path);
+int cfg_load_compiled(const char* text_path, const char* bin_path);
+int cfg_stream_begin(void);
+int cfg_stream_feed(const char* buf, size_t len);
+int cfg_stream_end(void);
+int cfg_use_schema(const cfg_schema_t* schema, bool overflow);
+int cfg_set_base(const cfg_t* base);
 void cfg_free(void);
 
+int cfg_set_setting(const char* identifier, const cfg_value_t* value);
+int cfg_remove_setting(const char* identifier);
+int cfg_journal_open(const char* path, size_t compact_bytes);
+int cfg_journal_compact(void);
+int cfg_journal_sync(void);
+int cfg_journal_close(void);
+int cfg_validate(const char** identifier, size_t* identifier_len);
+
 int cfg_get_setting(const char* identifier, void* value);
+int cfg_get_by_id(size_t id, void* value);
+int cfg_bind(const cfg_binding_t* table, size_t n, void* out_struct, int* errors);
+int cfg_get_string_view(const char* identifier, const char** str, size_t* len);
+int cfg_get_array(const char* identifier, enum cfg_setting_type_e type, const void** items, size_t* len);
 enum cfg_setting_type_e cfg_get_setting_type(const char* identifier);
+int cfg_foreach_prefix(const char* prefix, cfg_setting_cb_t callback, void* user);
+int cfg_count_prefix(const char* prefix, size_t* count);
+cfg_stats_t cfg_get_stats(void);
+void cfg_set_slow_hook(uint64_t threshold_ns, cfg_slow_cb_t hook, void* user);
 
 void cfg_dump(void);
+int cfg_write(int fd);
+int cfg_write_buffer(char** str, size_t* len);
 size_t cfg_get_error_line(void);
 size_t cfg_get_error_col(void);
 const char* cfg_get_path(void);
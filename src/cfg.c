@@ -4,19 +4,36 @@
 #include <string.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdalign.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
 #include <time.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
-#include "../include/cfg.h"
+#include "cfg_private.h"
+#include "cfg_scan.h"
 
-int cfg_errno = 0; /* config error */
+int cfg_errno = 0; /* config error of the default configuration */
 
-static cfg_t cfg_g = { /* cfg object */
+static cfg_t cfg_g = { /* default cfg object, used by the functions without a cfg object parameter */
     .col = 1,
     .line = 1,
     .path = NULL,
-    .settings = NULL,
-    .settings_len = 0
+    .arena = NULL,
+    .mappings = NULL,
+    .values = NULL,
+    .identifiers = NULL,
+    .hashes = NULL,
+    .identifier_lens = NULL,
+    .types = NULL,
+    .settings_len = 0,
+    .settings_cap = 0,
+    .index = NULL,
+    .index_cap = 0,
+    .index_len = 0,
+    .errnum = CFG_SUCCESS
 };
 
 static const char* cfg_error_string_list[] = { /* error strings */
@@ -35,6 +52,18 @@ static const char* cfg_error_string_list[] = { /* error strings */
     [CFG_ESEEK] = "failed to seek end of file",
     [CFG_EMAP] = "failed to map file content to memory",
     [CFG_ENEXIST] = "setting doesn't exist",
+    [CFG_EVIEW] = "string is a zero-copy view, use cfg_get_string_view",
+    [CFG_EWATCH] = "failed to watch file",
+    [CFG_EEDIT] = "invalid edit, parse with CFG_FLAG_INCREMENTAL and without CFG_FLAG_ZEROCOPY",
+    [CFG_EWRITE] = "failed to write file",
+    [CFG_ESCHEMA] = "schema doesn't match this library, or the configuration isn't empty",
+    [CFG_EUNKNOWN] = "identifier isn't in the schema",
+    [CFG_ESTREAM] = "no stream, call cfg_stream_begin first",
+    [CFG_EREAD] = "failed to read file",
+    [CFG_ELAYER] = "configuration would be stacked over itself",
+    [CFG_EREADONLY] = "compiled configs can't be changed",
+    [CFG_EJOURNAL] = "no journal, or the configuration wasn't loaded from a file",
+    [CFG_EARRAY] = "invalid array, or an array where a single value is expected",
     [CFG_EHUH] = "huh?",
 };
 
@@ -55,6 +84,37 @@ void cfg_perror(const char *error_string) {
     fprintf(stderr, "%s: %s\n", error_string ? error_string : "", cfg_strerror(cfg_errno));
 }
 
+/**
+ * @brief prints the provided error string to stderr, followed by the latest error string of the configuration
+ * @param cfg configuration object
+ * @param error_string error string
+*/
+void cfg_perror_ctx(const cfg_t* cfg, const char* error_string) {
+    fprintf(stderr, "%s: %s\n", error_string ? error_string : "", cfg_strerror(__atomic_load_n(&cfg->errnum, __ATOMIC_RELAXED)));
+}
+
+/**
+ * @brief gets the latest error number of the configuration
+ * @param cfg configuration object
+ * @returns error number
+*/
+int cfg_get_errno_ctx(const cfg_t* cfg) {
+    return __atomic_load_n(&cfg->errnum, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief publishes the error of the default configuration to cfg_errno
+ * @param status status returned by a function called on the default configuration
+ * @returns the status
+*/
+static int cfg_default_status(int status) {
+    if (status != 0) {
+        cfg_errno = cfg_g.errnum;
+    }
+
+    return status;
+}
+
 /**
  * @brief checks wether the provided character is a whitespace
  * @param c character to check
@@ -64,515 +124,1943 @@ static bool cfg_is_whitespace(char c) {
     return c == '\r' || c == ' ' || c == '\t';
 }
 
+#define CFG_ARENA_CHUNK_MIN 4096 /* size of the first arena chunk */
+#define CFG_ARENA_CHUNK_MAX (64 * 1024 * 1024) /* arena chunks stop doubling past this size */
+
+struct cfg_arena_chunk_s {
+    cfg_arena_chunk_t* next;
+    size_t used;
+    size_t cap;
+    alignas(max_align_t) unsigned char data[];
+};
+
+struct cfg_mapping_s {
+    cfg_mapping_t* next;
+    void* ptr;
+    size_t len;
+};
+
 /**
- * @brief frees the loaded configuration
+ * @brief allocates memory from the configuration arena, freed all at once by cfg_free
+ * @param cfg configuration object
+ * @param size size of the allocation
+ * @param align alignment of the allocation, power of two
+ * @returns pointer to the allocated memory, NULL if out of memory with the configuration error set
 */
-void cfg_free(void) {
-    cfg_setting_t* current;
+static void* cfg_arena_alloc(cfg_t* cfg, size_t size, size_t align) {
+    cfg_arena_chunk_t* chunk = cfg->arena;
+    size_t offset;
+    size_t cap;
+
+    if (chunk != NULL) {
+        offset = (chunk->used + align - 1) & ~(align - 1);
+        if (offset + size <= chunk->cap) {
+            chunk->used = offset + size;
+            return &chunk->data[offset];
+        }
+    }
 
-    for (size_t i = 0; i < cfg_g.settings_len; ++i) {
-        current = cfg_g.settings[i];
+    /* chunks grow geometrically so that large configs only need a handful of them */
+    cap = chunk == NULL ? CFG_ARENA_CHUNK_MIN : chunk->cap * 2;
+    if (cap > CFG_ARENA_CHUNK_MAX) {
+        cap = CFG_ARENA_CHUNK_MAX;
+    }
+    if (cap < size) {
+        cap = size;
+    }
 
-        if (current->type == CFG_STYPE_STRING) {
-            free(current->string);
-        }
+    chunk = malloc(sizeof(cfg_arena_chunk_t) + cap);
+    if (chunk == NULL) {
+        cfg->errnum = CFG_EMEM;
+        return NULL;
+    }
+
+    chunk->next = cfg->arena;
+    chunk->used = size;
+    chunk->cap = cap;
+    cfg->arena = chunk;
+
+    return chunk->data;
+}
 
-        free(current->identifier);
-        free(current);
+/**
+ * @brief measures the heap memory held by a configuration
+ * @param cfg configuration object
+ * @param bytes (out) bytes held
+ * @param allocs (out) blocks held
+*/
+void cfg_arena_usage(const cfg_t* cfg, uint64_t* bytes, uint64_t* allocs) {
+    *bytes = 0;
+    *allocs = 0;
+
+    for (const cfg_arena_chunk_t* chunk = cfg->arena; chunk != NULL; chunk = chunk->next) {
+        *bytes += sizeof(cfg_arena_chunk_t) + chunk->cap;
+        *allocs += 1;
     }
+}
 
-    if (cfg_g.settings_len != 0) {
-        free(cfg_g.settings);
+/**
+ * @brief copies a string into the configuration arena
+ * @param cfg configuration object
+ * @param str pointer to the string
+ * @param len length of the string
+ * @returns pointer to the NUL terminated copy, NULL if out of memory with the configuration error set
+*/
+static char* cfg_arena_strndup(cfg_t* cfg, const char* str, size_t len) {
+    char* copy = cfg_arena_alloc(cfg, len + 1, 1);
+
+    if (copy == NULL) {
+        return NULL;
     }
 
-    if (cfg_g.path != NULL) {
-        free(cfg_g.path);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    return copy;
+}
+
+/**
+ * @brief hashes an identifier (64 bit FNV-1a folded to 32 bit)
+ * @param str pointer to the identifier
+ * @param len length of the identifier
+ * @returns hash of the identifier
+*/
+uint32_t cfg_hash(const char* str, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 0x100000001b3ULL;
     }
+
+    return (uint32_t)(h ^ (h >> 32));
 }
 
 /**
- * @brief outputs the current loaded configuration to the console
+ * @brief finds a setting through the hash index
+ * @param cfg configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param hash hash of the identifier
+ * @returns position of the first indexed setting with this identifier, CFG_SETTING_NONE if it doesn't exist
 */
-void cfg_dump(void) {
-    cfg_setting_t* current;
+static size_t cfg_find_indexed(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash) {
+    size_t mask = cfg->index_cap - 1;
+    cfg_index_slot_t* slot;
+    size_t pos;
 
-    for (size_t i = 0; i < cfg_g.settings_len; ++i) {
-        current = cfg_g.settings[i];
+    if (cfg->index_cap == 0) {
+        return CFG_SETTING_NONE;
+    }
 
-        switch (current->type) {
-            case CFG_STYPE_STRING: {
-                printf("%s=\"%s\"\n", current->identifier, current->string);
-                break;
-            }
-            case CFG_STYPE_INT: {
-                printf("%s=%lld\n", current->identifier, current->integer);
-                break;
-            }
-            case CFG_STYPE_BOOL: {
-                printf("%s=%s\n", current->identifier, current->boolean ? "true" : "false");
-                break;
-            }
-            case CFG_STYPE_FLOAT: {
-                printf("%s=%Lf\n", current->identifier, current->floating);
-                break;
-            }
-            case CFG_STYPE_UNKNOWN: {
-                break;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        slot = &cfg->index[i];
+
+        if (slot->setting == 0) {
+            return CFG_SETTING_NONE;
+        }
+
+        if (slot->hash == hash) {
+            pos = slot->setting - 1;
+            if (cfg->identifier_lens[pos] == len && memcmp(cfg->identifiers[pos], identifier, len) == 0) {
+                return pos;
             }
         }
     }
 }
 
 /**
- * @brief adds a setting to the configuration
- * @param setting pointer to the setting object
- * @returns 0 on success, 1 otherwise
+ * @brief finds a setting in the schema slots if the identifier is part of the schema, through the hash index otherwise
+ * @param cfg configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param hash hash of the identifier
+ * @returns position of the first setting with this identifier, CFG_SETTING_NONE if it doesn't exist
 */
-static int cfg_add_setting(cfg_setting_t* setting) {
-    void* tmp;
+size_t cfg_find_setting(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash) {
+    size_t id;
+
+    if (cfg->slots != NULL) {
+        id = cfg_schema_find(cfg->schema, identifier, len, hash);
+        if (id != CFG_SCHEMA_NONE) {
+            return cfg->slots[id] == 0 ? CFG_SETTING_NONE : cfg->slots[id] - 1;
+        }
+    }
 
-    tmp = realloc(cfg_g.settings_len == 0 ? NULL : cfg_g.settings, sizeof(cfg_setting_t*) * (cfg_g.settings_len + 1));
+    return cfg_find_indexed(cfg, identifier, len, hash);
+}
 
-    if (tmp == NULL) {
-        cfg_errno = CFG_EMEM;
-        return 1;
+/**
+ * @brief indexes a setting of the settings table, in its schema slot or in the hash index.
+ * the first setting with a given identifier wins, duplicates are not indexed. the index must have a free slot
+ * @param cfg configuration object
+ * @param pos position of the setting
+*/
+void cfg_index_setting(cfg_t* cfg, size_t pos) {
+    const char* identifier = cfg->identifiers[pos];
+    size_t len = cfg->identifier_lens[pos];
+    uint32_t hash = cfg->hashes[pos];
+    size_t id;
+
+    if (cfg->slots != NULL) {
+        id = cfg_schema_find(cfg->schema, identifier, len, hash);
+        if (id != CFG_SCHEMA_NONE) {
+            if (cfg->slots[id] == 0) {
+                cfg->slots[id] = (uint32_t)(pos + 1);
+            } else {
+                cfg->duplicates += 1;
+            }
+            return;
+        }
     }
-    
-    cfg_g.settings = tmp;
-    cfg_g.settings_len += 1;
-    cfg_g.settings[cfg_g.settings_len - 1] = setting;
 
-    return 0;
+    if (cfg_find_indexed(cfg, identifier, len, hash) == CFG_SETTING_NONE) {
+        cfg_index_insert(cfg->index, cfg->index_cap, hash, (uint32_t)(pos + 1));
+        cfg->index_len += 1;
+    } else {
+        cfg->duplicates += 1;
+    }
 }
 
 /**
- * @brief adds an string setting to the configuration object
- * @param str pointer to the string value
- * @param str_len length of string value
- * @param id pointer to the identifier token
- * @param id_len length of the identifier token
- * @returns 0 on success, 1 otherwise
+ * @brief finds a setting for the getters, in the compiled config first, then in the parsed settings,
+ * then in the base layers
+ * @param cfg configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param tmp (out) decoded setting
+ * @returns tmp, NULL if the setting doesn't exist
 */
-static int cfg_add_string_setting(const char* str, size_t str_len, const char* id, size_t id_len) {
-    cfg_setting_t* setting = malloc(sizeof(cfg_setting_t));
+cfg_setting_t* cfg_lookup(const cfg_t* cfg, const char* identifier, size_t len, cfg_setting_t* tmp) {
+    uint64_t start = cfg->slow_hook != NULL ? cfg_now_ns() : 0;
+    cfg_setting_t* setting = cfg_layer_find(cfg, identifier, len, cfg_hash(identifier, len), tmp);
+
+    cfg_stats_lookup(cfg, setting);
+    if (cfg->slow_hook != NULL) {
+        cfg_stats_slow(cfg, CFG_SLOW_LOOKUP, identifier, len, start);
+    }
 
-    setting->type = CFG_STYPE_STRING;
-    setting->identifier = strndup(id, id_len);
-    setting->string = strndup(str, str_len);
+    return setting;
+}
 
-    if (cfg_add_setting(setting) != 0) {
-        free(setting->string);
-        free(setting->identifier);
-        free(setting);
-        return 1;
+/**
+ * @brief inserts a slot in the hash index, the index must have a free slot
+ * @param index pointer to the index slots
+ * @param cap capacity of the index, power of two
+ * @param hash hash of the identifier
+ * @param setting position of the setting + 1
+*/
+void cfg_index_insert(cfg_index_slot_t* index, size_t cap, uint32_t hash, uint32_t setting) {
+    size_t mask = cap - 1;
+    size_t i = hash & mask;
+
+    while (index[i].setting != 0) {
+        i = (i + 1) & mask;
     }
 
-    return 0;
+    index[i].hash = hash;
+    index[i].setting = setting;
 }
 
 /**
- * @brief adds an boolean value setting to the configuration object
- * @param b value to add
- * @param id pointer to the identifier token
- * @param id_len length of the identifier token
+ * @brief doubles the capacity of the hash index, keeping the load factor under 1/2
+ * @param cfg configuration object
  * @returns 0 on success, 1 otherwise
 */
-static int cfg_add_boolean_setting(bool b, const char* id, size_t id_len) {
-    cfg_setting_t* setting = malloc(sizeof(cfg_setting_t));
-
-    setting->type = CFG_STYPE_BOOL;
-    setting->identifier = strndup(id, id_len);
-    setting->boolean = b;
+int cfg_index_grow(cfg_t* cfg) {
+    size_t cap = cfg->index_cap == 0 ? 16 : cfg->index_cap * 2;
+    cfg_index_slot_t* index = calloc(cap, sizeof(cfg_index_slot_t));
 
-    if (cfg_add_setting(setting) != 0) {
-        free(setting->identifier);
-        free(setting);
+    if (index == NULL) {
+        cfg->errnum = CFG_EMEM;
         return 1;
     }
 
+    /* the hashes are stored next to the positions, no need to rehash the identifiers */
+    for (size_t i = 0; i < cfg->index_cap; i++) {
+        if (cfg->index[i].setting != 0) {
+            cfg_index_insert(index, cap, cfg->index[i].hash, cfg->index[i].setting);
+        }
+    }
+
+    free(cfg->index);
+    cfg->index = index;
+    cfg->index_cap = cap;
+
     return 0;
 }
 
 /**
- * @brief adds an floating point number setting to the configuration object
- * @param value value to add
- * @param id pointer to the identifier token
- * @param id_len length of the identifier token
- * @returns 0 on success, 1 otherwise
+ * @brief releases everything held by the configuration and resets it
+ * @param cfg configuration object
 */
-static int cfg_add_floating_setting(long double value, const char* id, size_t id_len) {
-    cfg_setting_t* setting = malloc(sizeof(cfg_setting_t));
+void cfg_clear(cfg_t* cfg) {
+    cfg_arena_chunk_t* next;
 
-    setting->type = CFG_STYPE_FLOAT;
-    setting->identifier = strndup(id, id_len);
-    setting->floating = value;
+    /* the mappings list lives in the arena, unmap before releasing it */
+    for (cfg_mapping_t* map = cfg->mappings; map != NULL; map = map->next) {
+        munmap(map->ptr, map->len);
+    }
 
-    if (cfg_add_setting(setting) != 0) {
-        free(setting->identifier);
-        free(setting);
-        return 1;
+    while (cfg->arena != NULL) {
+        next = cfg->arena->next;
+        free(cfg->arena);
+        cfg->arena = next;
     }
 
-    return 0;
+    free(cfg->values);
+    free(cfg->index);
+    free(cfg->strings);
+    free(cfg->lines);
+    free(cfg->stream);
+    free(cfg->path);
+    cfg_tree_drop(cfg);
+    cfg_journal_drop(cfg);
+
+    /* the schema, the base layer and the slow hook stay, ready for the next parse */
+    memset(&cfg->stats, 0, sizeof(cfg_stats_t));
+    memset(cfg->shards, 0, sizeof(cfg->shards));
+    if (cfg->slots != NULL) {
+        memset(cfg->slots, 0, sizeof(uint32_t) * cfg->schema->len);
+    }
+
+    cfg->path = NULL;
+    cfg->mappings = NULL;
+    cfg->values = NULL;
+    cfg->identifiers = NULL;
+    cfg->hashes = NULL;
+    cfg->identifier_lens = NULL;
+    cfg->types = NULL;
+    cfg->settings_len = 0;
+    cfg->settings_cap = 0;
+    cfg->index = NULL;
+    cfg->index_cap = 0;
+    cfg->index_len = 0;
+    cfg->duplicates = 0;
+    cfg->lazy = false;
+    cfg->strings = NULL;
+    cfg->strings_cap = 0;
+    cfg->strings_len = 0;
+    cfg->lines = NULL;
+    cfg->lines_len = 0;
+    cfg->lines_cap = 0;
+    cfg->text_len = 0;
+    cfg->stream = NULL;
+    cfg->image = NULL;
+    cfg->line = 1;
+    cfg->col = 1;
+    cfg->errnum = CFG_SUCCESS;
 }
 
 /**
- * @brief adds an integer number setting to the configuration object
- * @param value value to add
- * @param id pointer to the identifier token
- * @param id_len length of the identifier token
- * @returns 0 on success, 1 otherwise
+ * @brief creates an empty configuration, configurations are independent and each can be used from its own thread
+ * @returns pointer to the configuration, NULL if out of memory
 */
-static int cfg_add_integer_setting(long long value, const char* id, size_t id_len) {
-    cfg_setting_t* setting = malloc(sizeof(cfg_setting_t));
-
-    setting->type = CFG_STYPE_INT;
-    setting->identifier = strndup(id, id_len);
-    setting->integer = value;
+cfg_t* cfg_new(void) {
+    cfg_t* cfg = malloc(sizeof(cfg_t));
 
-    if (cfg_add_setting(setting) != 0) {
-        free(setting->identifier);
-        free(setting);
-        return 1;
+    if (cfg == NULL) {
+        return NULL;
     }
 
-    return 0;
+    cfg_init(cfg);
+
+    return cfg;
 }
 
 /**
- * @brief checks if the given token is a valid identifier
- * @param str pointer to the serialized token
- * @param len length of the token
- * @returns true if the given token is a valid identifier, false otherwise
+ * @brief initializes an empty configuration
+ * @param cfg configuration object
 */
-static bool cfg_is_identifier_valid(const char* str, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        if ((str[i] < 'a' || str[i] > 'z')
-            && (str[i] < 'A' || str[i] > 'Z')
-            && (str[i] < '0' || str[i] > '9')
-            && str[i] != '.' && str[i] != '_' && str[i] != '-') {
-            return 0;
-        }
+void cfg_init(cfg_t* cfg) {
+    memset(cfg, 0, sizeof(cfg_t));
+    cfg->line = 1;
+    cfg->col = 1;
+}
+
+/**
+ * @brief frees a configuration created by cfg_new
+ * @param cfg configuration object, may be NULL
+*/
+void cfg_free_ctx(cfg_t* cfg) {
+    if (cfg == NULL) {
+        return;
     }
 
-    return 1;
+    cfg_clear(cfg);
+    free(cfg->slots);
+    free(cfg);
 }
 
 /**
- * @brief checks if the given token is a valid number
- * @param str pointer to the serialized token
- * @param len length of the token
- * @returns true if the given token is a valid number, false otherwise
+ * @brief frees the loaded configuration
 */
-static bool cfg_is_number_syntax_valid(const char* str, size_t len) {
-    size_t dot_count = 0;
+void cfg_free(void) {
+    cfg_clear(&cfg_g);
+}
 
-    for (size_t i = 0; i < len; i++) {
-        switch (str[i]) {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9': {
-                break;
-            }
-            case '.': {
-                dot_count += 1;
-                if (dot_count > 1) {
-                    return 0;
-                }
-                break;
-            }
-            case '-': {
-                if (i != 0) {
-                    return 0;
-                }
-                break;
-            }
-            default: {
-                return 0;
-            }
-        }
+/**
+ * @brief outputs the current loaded configuration to the console
+*/
+void cfg_dump(void) {
+    cfg_dump_ctx(&cfg_g);
+}
+
+/**
+ * @brief outputs a configuration to the console, then the settings of its base layers that it doesn't shadow
+ * @param cfg configuration object
+*/
+void cfg_dump_ctx(const cfg_t* cfg) {
+    /* whatever the program printed comes first */
+    fflush(stdout);
+    cfg_write_all(cfg, true, STDOUT_FILENO, NULL, NULL);
+}
+
+/**
+ * @brief points the arrays of the settings table into a single block
+ * @param cfg configuration object
+ * @param block block of CFG_SETTING_BYTES * cap bytes
+ * @param cap number of settings the block holds
+*/
+static void cfg_carve_settings(cfg_t* cfg, unsigned char* block, size_t cap) {
+    /* largest alignment first, so that every array is aligned */
+    cfg->values = (cfg_value_slot_t*)block;
+    cfg->identifiers = (char**)&cfg->values[cap];
+    cfg->hashes = (uint32_t*)&cfg->identifiers[cap];
+    cfg->identifier_lens = &cfg->hashes[cap];
+    cfg->types = (uint8_t*)&cfg->identifier_lens[cap];
+}
+
+/**
+ * @brief copies settings between two settings tables, or within one, row by row
+ * @param cfg configuration object receiving the settings, room must have been reserved
+ * @param pos position of the first setting written
+ * @param from configuration object holding the settings, may be cfg
+ * @param from_pos position of the first setting read
+ * @param n number of settings
+*/
+void cfg_move_settings(cfg_t* cfg, size_t pos, const cfg_t* from, size_t from_pos, size_t n) {
+    if (n == 0) {
+        return;
     }
 
-    return 1;
+    memmove(&cfg->values[pos], &from->values[from_pos], sizeof(cfg_value_slot_t) * n);
+    memmove(&cfg->identifiers[pos], &from->identifiers[from_pos], sizeof(char*) * n);
+    memmove(&cfg->hashes[pos], &from->hashes[from_pos], sizeof(uint32_t) * n);
+    memmove(&cfg->identifier_lens[pos], &from->identifier_lens[from_pos], sizeof(uint32_t) * n);
+    memmove(&cfg->types[pos], &from->types[from_pos], sizeof(uint8_t) * n);
 }
 
 /**
- * @brief parses an integer number from the buffer
- * @param str pointer to the serialized value token
- * @param len length of the serialized value token
- * @param id pointer to the identifier token
- * @param id_len length of the identifier token
+ * @brief makes room for more settings, the settings table grows geometrically
+ * @param cfg configuration object
+ * @param n number of settings about to be added
  * @returns 0 on success, 1 otherwise
 */
-static int cfg_parse_integer(const char* str, size_t len, const char* id, size_t id_len) {
-    int status = 0;
-    char *endptr;
-    long long result;
-    char* copy;
+int cfg_reserve_settings(cfg_t* cfg, size_t n) {
+    size_t cap = cfg->settings_cap == 0 ? 16 : cfg->settings_cap;
+    cfg_t old;
+    unsigned char* block;
 
-    errno = 0;
-    copy = strndup(str, len); /* handle case where the value is the last thing in the file */
-    if (copy == NULL && errno == ENOMEM) {
-        cfg_errno = CFG_EMEM;
+    if (cfg->settings_len + n > UINT32_MAX) {
+        cfg->errnum = CFG_EMEM;
         return 1;
     }
 
-    errno = 0;
-    result = strtoll(copy, &endptr, 10);
-    if (endptr == copy) {
-        cfg_errno = CFG_EINVINT;
-        status = 1;
-        goto cfg_parse_integer_free;
+    if (cfg->settings_len + n <= cfg->settings_cap) {
+        return 0;
     }
 
-    if (errno == ERANGE || errno == EINVAL) {
-        cfg_errno = CFG_ERANGE;
-        status = 1;
-        goto cfg_parse_integer_free;
+    while (cap < cfg->settings_len + n) {
+        cap *= 2;
     }
 
-    if (cfg_add_integer_setting(result, id, id_len) != 0) {
-        /* report another error here? */
-        status = 1;
+    /* the arrays move within the block as it grows, they are copied one by one rather than reallocated */
+    block = malloc(CFG_SETTING_BYTES * cap);
+    if (block == NULL) {
+        cfg->errnum = CFG_EMEM;
+        return 1;
     }
 
-cfg_parse_integer_free:
-    free(copy);
+    old.values = cfg->values;
+    old.identifiers = cfg->identifiers;
+    old.hashes = cfg->hashes;
+    old.identifier_lens = cfg->identifier_lens;
+    old.types = cfg->types;
 
-    return status;
+    cfg_carve_settings(cfg, block, cap);
+    cfg_move_settings(cfg, 0, &old, 0, cfg->settings_len);
+    free(old.values);
+
+    cfg->settings_cap = cap;
+
+    return 0;
 }
 
 /**
- * @brief parses a floating point number from the buffer
- * @param str pointer to the serialized value token
- * @param len length of the serialized value token
- * @param id pointer to the identifier token
- * @param id_len length of the identifier token
+ * @brief adds the setting written right after the last one of the settings table and indexes it
+ * @param cfg configuration object
  * @returns 0 on success, 1 otherwise
 */
-static int cfg_parse_floating(const char* str, size_t len, const char* id, size_t id_len) {
-    int status = 0;
-    char *endptr;
-    long double result;
-    char* copy;
+static int cfg_append_setting(cfg_t* cfg) {
+    size_t pos = cfg->settings_len;
 
-    errno = 0;
-    copy = strndup(str, len); /* handle case where the value is the last thing in the file */
-    if (copy == NULL && errno == ENOMEM) {
-        cfg_errno = CFG_EMEM;
+    if (cfg->schema != NULL && !cfg->overflow
+        && cfg_schema_find(cfg->schema, cfg->identifiers[pos], cfg->identifier_lens[pos], cfg->hashes[pos]) == CFG_SCHEMA_NONE) {
+        cfg->errnum = CFG_EUNKNOWN;
         return 1;
     }
 
-    errno = 0;
-    result = strtold(copy, &endptr);
-    if (endptr == copy) {
-        cfg_errno = CFG_EINVFLOAT;
-        status = 1;
-        goto cfg_parse_floating_free;
+    if ((cfg->index_len + 1) * 2 > cfg->index_cap && cfg_index_grow(cfg) != 0) {
+        return 1;
     }
 
-    if (errno == ERANGE || errno == EINVAL) {
-        cfg_errno = CFG_ERANGE;
-        status = 1;
-        goto cfg_parse_floating_free;
+    if (cfg->tree != NULL) {
+        cfg_tree_drop(cfg);
     }
 
-    if (cfg_add_floating_setting(result, id, id_len) != 0) {
-        /* report another error here? */
-        status = 1;
+    cfg->settings_len += 1;
+    cfg_index_setting(cfg, pos);
+
+    return 0;
+}
+
+/**
+ * @brief adds a row to the settings table
+ * @param cfg configuration object
+ * @param tag type tag of the setting, with its flags
+ * @param value value of the setting
+ * @param identifier identifier, in the arena or in the parsed buffer
+ * @param id_len length of the identifier, fits 32 bits
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_row(cfg_t* cfg, uint8_t tag, cfg_value_slot_t value, char* identifier, size_t id_len) {
+    size_t pos = cfg->settings_len;
+
+    if (cfg_reserve_settings(cfg, 1) != 0) {
+        return 1;
     }
 
-cfg_parse_floating_free:
-    free(copy);
+    cfg->values[pos] = value;
+    cfg->identifiers[pos] = identifier;
+    cfg->hashes[pos] = cfg_hash(identifier, id_len);
+    cfg->identifier_lens[pos] = (uint32_t)id_len;
+    cfg->types[pos] = tag;
 
-    return status;
+    return cfg_append_setting(cfg);
 }
 
 /**
- * @brief parses a string from the buffer
- * @param str pointer to the serialized value token
- * @param len length of the serialized value token
+ * @brief adds a setting to the configuration, copying its identifier unless in zero-copy mode
+ * @param cfg configuration object
+ * @param type type of the setting
+ * @param value value of the setting, strings and long doubles already in the arena
  * @param id pointer to the identifier token
  * @param id_len length of the identifier token
+ * @param flags parsing flags
  * @returns 0 on success, 1 otherwise
 */
-static int cfg_parse_string(const char* str, size_t len, const char* id, size_t id_len) {
-    if (len < 2 || str[0] != '\"' || str[len - 1] != '\"') {
-        cfg_errno = CFG_EINVSTRING;
+static int cfg_add_setting(cfg_t* cfg, enum cfg_setting_type_e type, cfg_value_slot_t value, const char* id, size_t id_len, int flags) {
+    bool view = (flags & CFG_FLAG_ZEROCOPY) != 0;
+    char* identifier;
+
+    if (id_len > UINT32_MAX) {
+        cfg->errnum = CFG_EINVID;
         return 1;
     }
 
-    if (cfg_add_string_setting(&str[1], len - 2, id, id_len) != 0) {
-        /* report another error here? */
+    identifier = view ? (char*)id : cfg_arena_strndup(cfg, id, id_len);
+    if (identifier == NULL) {
         return 1;
     }
 
-    return 0;
+    return cfg_add_row(cfg, (uint8_t)(type | (view ? CFG_SETTING_VIEW : 0)), value, identifier, id_len);
 }
 
 /**
- * @brief parses the serialized configuration buffer
- * @param str pointer to the buffer containing the serialized configuration
- * @param len length of the buffer
- * @returns 0 on success, 1 otherwise with cfg_errno set
+ * @brief adds a number to the configuration without converting it, its text is kept after the identifier:
+ * in the parsed buffer in zero-copy mode, copied along with the identifier otherwise
+ * @param cfg configuration object
+ * @param str pointer to the serialized value token
+ * @param len length of the serialized value token, fits 32 bits
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
 */
-int cfg_parse(const char* str, size_t len) {
-    size_t c1 = 0;
-    size_t c2 = 0;
-    size_t id_pos = 0;
-    size_t id_len = 0;
-    size_t value_pos = 0;
-    size_t value_len = 0;
+static int cfg_add_lazy_setting(cfg_t* cfg, const char* str, size_t len, const char* id, size_t id_len, int flags) {
+    bool view = (flags & CFG_FLAG_ZEROCOPY) != 0;
+    enum cfg_setting_type_e type = memchr(str, '.', len) != NULL ? CFG_STYPE_FLOAT : CFG_STYPE_INT;
+    char* identifier = (char*)id;
+    size_t offset = (size_t)(str - id);
+
+    if (id_len > UINT32_MAX) {
+        cfg->errnum = CFG_EINVID;
+        return 1;
+    }
 
-    while (c2 < len) {
-        switch (str[c2]) {
-            /* forward the cursor until something meaningful */
-            case '\r':
-            case '\t':
-            case ' ': {
-                c2 += 1;
-                cfg_g.col += 1;
-                break;
-            }
-            /* end of line expect an identifier */
-            case '\n': {
+    if (!view) {
+        identifier = cfg_arena_alloc(cfg, id_len + len + 2, 1);
+        if (identifier == NULL) {
+            return 1;
+        }
+        offset = id_len + 1;
+        memcpy(identifier, id, id_len);
+        identifier[id_len] = '\0';
+        memcpy(&identifier[offset], str, len);
+        identifier[offset + len] = '\0';
+    }
+
+    cfg->lazy = true;
+    cfg_stats_add(type == CFG_STYPE_INT ? &cfg->stats.integers : &cfg->stats.floats, 1);
+
+    return cfg_add_row(cfg, (uint8_t)(type | CFG_SETTING_LAZY | (view ? CFG_SETTING_VIEW : 0)),
+        (cfg_value_slot_t){ .text = { (uint32_t)offset, (uint32_t)len } }, identifier, id_len);
+}
+
+/**
+ * @brief moves the memory of a configuration into another one, the settings allocated there stay valid
+ * @param cfg configuration object receiving the memory
+ * @param part configuration object giving its memory
+*/
+void cfg_take_arena(cfg_t* cfg, cfg_t* part) {
+    cfg_arena_chunk_t* tail;
+
+    if (part->arena == NULL) {
+        return;
+    }
+
+    /* the chunks of the part go after the current chunk, which keeps serving allocations */
+    for (tail = part->arena; tail->next != NULL; tail = tail->next);
+
+    if (cfg->arena == NULL) {
+        cfg->arena = part->arena;
+    } else {
+        tail->next = cfg->arena->next;
+        cfg->arena->next = part->arena;
+    }
+    part->arena = NULL;
+}
+
+/**
+ * @brief moves the settings of a configuration at the end of another one, in order, along with
+ * the memory holding them. used to gather configurations parsed separately
+ * @param cfg configuration object receiving the settings
+ * @param part configuration object giving its settings, left without settings
+ * @returns 0 on success, 1 otherwise
+*/
+int cfg_merge(cfg_t* cfg, cfg_t* part) {
+    cfg_take_arena(cfg, part);
+    cfg->lazy = cfg->lazy || part->lazy;
+
+    if (cfg_reserve_settings(cfg, part->settings_len) != 0) {
+        return 1;
+    }
+
+    /* the rows are copied past the end of the table, then added one by one */
+    cfg_move_settings(cfg, cfg->settings_len, part, 0, part->settings_len);
+    for (size_t i = 0; i < part->settings_len; i++) {
+        if (cfg_append_setting(cfg) != 0) {
+            return 1;
+        }
+    }
+
+    part->settings_len = 0;
+
+    return 0;
+}
+
+#define CFG_STRING_SHARED_MAX 128 /* longer strings are hardly ever repeated, they are neither hashed nor shared */
+
+/**
+ * @brief finds a copied string value of the configuration
+ * @param cfg configuration object
+ * @param str pointer to the string
+ * @param len length of the string
+ * @param hash hash of the string
+ * @returns string record, NULL if no setting holds this value
+*/
+static const cfg_string_t* cfg_strings_find(const cfg_t* cfg, const char* str, size_t len, uint32_t hash) {
+    size_t mask = cfg->strings_cap - 1;
+    const cfg_string_t* string;
+
+    if (cfg->strings_cap == 0) {
+        return NULL;
+    }
+
+    for (size_t i = hash & mask; cfg->strings[i].setting != 0; i = (i + 1) & mask) {
+        if (cfg->strings[i].hash == hash) {
+            string = cfg->values[cfg->strings[i].setting - 1].string;
+            if (string->len == len && memcmp(string->bytes, str, len) == 0) {
+                return string;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief records the copied string value of a setting, so that the next settings with this value share it.
+ * nothing is recorded if the table can't grow, the value is then copied again
+ * @param cfg configuration object
+ * @param hash hash of the string
+ * @param pos position of the setting
+*/
+static void cfg_strings_insert(cfg_t* cfg, uint32_t hash, size_t pos) {
+    size_t cap = cfg->strings_cap == 0 ? 16 : cfg->strings_cap * 2;
+    cfg_index_slot_t* strings;
+
+    if ((cfg->strings_len + 1) * 2 > cfg->strings_cap) {
+        strings = calloc(cap, sizeof(cfg_index_slot_t));
+        if (strings == NULL) {
+            return;
+        }
+
+        for (size_t i = 0; i < cfg->strings_cap; i++) {
+            if (cfg->strings[i].setting != 0) {
+                cfg_index_insert(strings, cap, cfg->strings[i].hash, cfg->strings[i].setting);
+            }
+        }
+
+        free(cfg->strings);
+        cfg->strings = strings;
+        cfg->strings_cap = cap;
+    }
+
+    cfg_index_insert(cfg->strings, cfg->strings_cap, hash, (uint32_t)(pos + 1));
+    cfg->strings_len += 1;
+}
+
+/**
+ * @brief forgets the string values recorded for sharing, the settings moved. the strings stay in the arena
+ * @param cfg configuration object
+*/
+void cfg_strings_drop(cfg_t* cfg) {
+    free(cfg->strings);
+    cfg->strings = NULL;
+    cfg->strings_cap = 0;
+    cfg->strings_len = 0;
+}
+
+/**
+ * @brief forgets the copied string value of a setting about to change or be removed, the next settings
+ * with this value copy it again. the string stays in the arena, the settings sharing it keep it
+ * @param cfg configuration object
+ * @param pos position of the setting
+*/
+static void cfg_strings_forget(cfg_t* cfg, size_t pos) {
+    size_t mask = cfg->strings_cap - 1;
+    const cfg_string_t* string = cfg->values[pos].string;
+    size_t i;
+    size_t j;
+    size_t home;
+
+    if (cfg->strings_cap == 0 || cfg->types[pos] != CFG_STYPE_STRING || string->len > CFG_STRING_SHARED_MAX) {
+        return;
+    }
+
+    for (i = cfg_hash(string->bytes, string->len) & mask; cfg->strings[i].setting != pos + 1; i = (i + 1) & mask) {
+        /* the setting shares the copy of another one */
+        if (cfg->strings[i].setting == 0) {
+            return;
+        }
+    }
+
+    /* the slots after it that it pushed away from their home move back, no tombstones */
+    for (j = (i + 1) & mask; cfg->strings[j].setting != 0; j = (j + 1) & mask) {
+        home = cfg->strings[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            cfg->strings[i] = cfg->strings[j];
+            i = j;
+        }
+    }
+
+    cfg->strings[i].setting = 0;
+    cfg->strings_len -= 1;
+}
+
+/**
+ * @brief copies a string value into the arena, unless a setting already holds a copy of it
+ * @param cfg configuration object
+ * @param str pointer to the string value
+ * @param str_len length of string value
+ * @param hash (out) hash of the string if it can be shared
+ * @param shared (out) true if the copy of another setting is returned
+ * @returns string record, NULL if out of memory with the configuration error set
+*/
+static const cfg_string_t* cfg_copy_string(cfg_t* cfg, const char* str, size_t str_len, uint32_t* hash, bool* shared) {
+    const cfg_string_t* string = NULL;
+    cfg_string_t* copy;
+
+    if (str_len <= CFG_STRING_SHARED_MAX) {
+        *hash = cfg_hash(str, str_len);
+        string = cfg_strings_find(cfg, str, str_len, *hash);
+    }
+
+    *shared = string != NULL;
+    if (string != NULL) {
+        cfg_stats_add(&cfg->stats.shared_strings, 1);
+        return string;
+    }
+
+    copy = cfg_arena_alloc(cfg, sizeof(cfg_string_t) + str_len + 1, alignof(cfg_string_t));
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->len = str_len;
+    memcpy(copy->bytes, str, str_len);
+    copy->bytes[str_len] = '\0';
+
+    return copy;
+}
+
+/**
+ * @brief adds an string setting to the configuration object. a copied string shares the copy of an earlier
+ * setting with the same value, a zero-copy one points into the parsed buffer
+ * @param cfg configuration object
+ * @param str pointer to the string value
+ * @param str_len length of string value
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_string_setting(cfg_t* cfg, const char* str, size_t str_len, const char* id, size_t id_len, int flags) {
+    cfg_string_view_t* view;
+    const cfg_string_t* string;
+    uint32_t hash = 0;
+    bool shared;
+
+    if ((flags & CFG_FLAG_ZEROCOPY) != 0) {
+        view = cfg_arena_alloc(cfg, sizeof(cfg_string_view_t), alignof(cfg_string_view_t));
+        if (view == NULL) {
+            return 1;
+        }
+        view->len = str_len;
+        view->ptr = (char*)str;
+        return cfg_add_setting(cfg, CFG_STYPE_STRING, (cfg_value_slot_t){ .string_view = view }, id, id_len, flags);
+    }
+
+    string = cfg_copy_string(cfg, str, str_len, &hash, &shared);
+    if (string == NULL || cfg_add_setting(cfg, CFG_STYPE_STRING, (cfg_value_slot_t){ .string = string }, id, id_len, flags) != 0) {
+        return 1;
+    }
+
+    if (!shared && str_len <= CFG_STRING_SHARED_MAX) {
+        cfg_strings_insert(cfg, hash, cfg->settings_len - 1);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief adds an boolean value setting to the configuration object
+ * @param cfg configuration object
+ * @param b value to add
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_boolean_setting(cfg_t* cfg, bool b, const char* id, size_t id_len, int flags) {
+    return cfg_add_setting(cfg, CFG_STYPE_BOOL, (cfg_value_slot_t){ .boolean = b }, id, id_len, flags);
+}
+
+/**
+ * @brief adds an floating point number setting to the configuration object
+ * @param cfg configuration object
+ * @param value value to add
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_floating_setting(cfg_t* cfg, cfg_float_t value, const char* id, size_t id_len, int flags) {
+#ifdef CFG_FLOAT_DOUBLE
+    return cfg_add_setting(cfg, CFG_STYPE_FLOAT, (cfg_value_slot_t){ .floating = value }, id, id_len, flags);
+#else
+    cfg_float_t* floating = cfg_arena_alloc(cfg, sizeof(cfg_float_t), alignof(cfg_float_t));
+
+    if (floating == NULL) {
+        return 1;
+    }
+
+    *floating = value;
+
+    return cfg_add_setting(cfg, CFG_STYPE_FLOAT, (cfg_value_slot_t){ .floating = floating }, id, id_len, flags);
+#endif
+}
+
+/**
+ * @brief adds an integer number setting to the configuration object
+ * @param cfg configuration object
+ * @param value value to add
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_integer_setting(cfg_t* cfg, long long value, const char* id, size_t id_len, int flags) {
+    return cfg_add_setting(cfg, CFG_STYPE_INT, (cfg_value_slot_t){ .integer = value }, id, id_len, flags);
+}
+
+/**
+ * @brief adds an array setting to the configuration object
+ * @param cfg configuration object
+ * @param array array, in the arena
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_array_setting(cfg_t* cfg, const cfg_array_t* array, const char* id, size_t id_len, int flags) {
+    cfg_stats_add(&cfg->stats.arrays, 1);
+
+    return cfg_add_setting(cfg, CFG_STYPE_ARRAY, (cfg_value_slot_t){ .array = array }, id, id_len, flags);
+}
+
+/**
+ * @brief copies an array value into the arena, strings included
+ * @param cfg configuration object
+ * @param value array value, checked by cfg_array_check
+ * @returns copy, NULL if out of memory with the configuration error set
+*/
+static cfg_array_t* cfg_copy_array(cfg_t* cfg, const cfg_value_t* value) {
+    cfg_array_t* array = cfg_arena_alloc(cfg, cfg_array_copy_size(value), alignof(cfg_array_t));
+
+    if (array != NULL) {
+        cfg_array_copy(array, value);
+    }
+
+    return array;
+}
+
+/**
+ * @brief decodes an array token into the arena, or into a scratch buffer
+ * @param cfg configuration object
+ * @param str pointer to the serialized value token, starting with '['
+ * @param len length of the serialized value token
+ * @param flags parsing flags, strings are copied after the items unless in zero-copy mode
+ * @param scratch true to decode into a buffer allocated with malloc, whose strings point into the token
+ * @returns array, NULL otherwise with the configuration error set
+*/
+static cfg_array_t* cfg_parse_array(cfg_t* cfg, const char* str, size_t len, int flags, bool scratch) {
+    bool copy = !scratch && (flags & CFG_FLAG_ZEROCOPY) == 0;
+    cfg_array_t shape;
+    cfg_array_t* array;
+    size_t size;
+    int errnum = cfg_array_measure(str, len, copy, &shape, &size);
+
+    if (errnum != CFG_SUCCESS) {
+        cfg->errnum = errnum;
+        return NULL;
+    }
+
+    array = scratch ? malloc(size) : cfg_arena_alloc(cfg, size, alignof(cfg_array_t));
+    if (array == NULL) {
+        cfg->errnum = CFG_EMEM;
+        return NULL;
+    }
+
+    array->len = shape.len;
+    array->type = shape.type;
+    errnum = cfg_array_decode(str, len, copy, array);
+    if (errnum != CFG_SUCCESS) {
+        if (scratch) {
+            free(array);
+        }
+        cfg->errnum = errnum;
+        return NULL;
+    }
+
+    return array;
+}
+
+/**
+ * @brief checks if the given token is a valid identifier
+ * @param str pointer to the serialized token
+ * @param len length of the token
+ * @returns true if the given token is a valid identifier, false otherwise
+*/
+static bool cfg_is_identifier_valid(const char* str, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if ((str[i] < 'a' || str[i] > 'z')
+            && (str[i] < 'A' || str[i] > 'Z')
+            && (str[i] < '0' || str[i] > '9')
+            && str[i] != '.' && str[i] != '_' && str[i] != '-') {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief checks if a value token is a number, from its first character like cfg_parse_value does
+ * @param c first character of the token
+ * @returns true if the token should be a number
+*/
+static bool cfg_is_number_start(char c) {
+    return c == '-' || (c >= '0' && c <= '9');
+}
+
+/**
+ * @brief checks if the given token is a valid number
+ * @param str pointer to the serialized token
+ * @param len length of the token
+ * @returns true if the given token is a valid number, false otherwise
+*/
+bool cfg_is_number_syntax_valid(const char* str, size_t len) {
+    size_t dot_count = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        switch (str[i]) {
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9': {
+                break;
+            }
+            case '.': {
+                dot_count += 1;
+                if (dot_count > 1) {
+                    return 0;
+                }
+                break;
+            }
+            case '-': {
+                if (i != 0) {
+                    return 0;
+                }
+                break;
+            }
+            default: {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+#define CFG_NUMBER_COPY_MAX 64 /* numbers shorter than this are copied on the stack for the libc fallback */
+
+const cfg_float_t cfg_pow10_list[CFG_FLOAT_POW10_MAX + 1] = { /* exact powers of ten */
+    1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L,
+    1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+    1e20L, 1e21L, 1e22L,
+#if CFG_FLOAT_POW10_MAX > 22
+    1e23L, 1e24L, 1e25L, 1e26L, 1e27L,
+#endif
+};
+
+/**
+ * @brief appends decimal digits to a value, eight at a time with SWAR arithmetic on little endian targets
+ * @param result value the digits are appended to
+ * @param str pointer to the digits
+ * @param len number of digits, the value must hold in 19 digits overall
+ * @returns value followed by the digits
+*/
+static uint64_t cfg_parse_digits(uint64_t result, const char* str, size_t len) {
+    size_t i = 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t chunk;
+
+    for (; i + 8 <= len; i += 8) {
+        memcpy(&chunk, &str[i], 8);
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10 + (chunk >> 8)) & 0x00ff00ff00ff00ffULL;
+        chunk = (chunk * 100 + (chunk >> 16)) & 0x0000ffff0000ffffULL;
+        chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000ffffffffULL;
+        result = result * 100000000 + chunk;
+    }
+#endif
+
+    for (; i < len; i++) {
+        result = result * 10 + (uint64_t)(str[i] - '0');
+    }
+
+    return result;
+}
+
+/**
+ * @brief parses an integer number in place, the token must have passed cfg_is_number_syntax_valid
+ * @param str pointer to the serialized value token
+ * @param len length of the serialized value token
+ * @param result (out) parsed value
+ * @returns CFG_SUCCESS, or an error number
+*/
+int cfg_parse_integer_value(const char* str, size_t len, long long* result) {
+    bool negative = len > 0 && str[0] == '-';
+    size_t i = negative;
+    uint64_t magnitude;
+
+    if (i == len) {
+        return CFG_EINVINT;
+    }
+
+    /* leading zeros don't count towards the 19 digits that fit in 64 bits */
+    while (i + 1 < len && str[i] == '0') {
+        i += 1;
+    }
+
+    if (len - i > 19) {
+        return CFG_ERANGE;
+    }
+
+    magnitude = cfg_parse_digits(0, &str[i], len - i);
+    if (magnitude > (uint64_t)LLONG_MAX + negative) {
+        return CFG_ERANGE;
+    }
+
+    *result = negative ? -(long long)(magnitude - 1) - 1 : (long long)magnitude;
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief parses a floating point number with the libc, used when the fast path can't be exact
+ * @param str pointer to the serialized value token
+ * @param len length of the serialized value token
+ * @param result (out) parsed value
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_parse_floating_slow(const char* str, size_t len, cfg_float_t* result) {
+    int errnum = CFG_SUCCESS;
+    char buf[CFG_NUMBER_COPY_MAX];
+    char* copy = buf;
+    char* endptr;
+
+    /* the token isn't NUL terminated, only very long numbers need a heap copy */
+    if (len >= CFG_NUMBER_COPY_MAX) {
+        copy = malloc(len + 1);
+        if (copy == NULL) {
+            return CFG_EMEM;
+        }
+    }
+
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    errno = 0;
+    *result = cfg_strtof(copy, &endptr);
+    if (endptr == copy) {
+        errnum = CFG_EINVFLOAT;
+    } else if (errno == ERANGE || errno == EINVAL) {
+        errnum = CFG_ERANGE;
+    }
+
+    if (copy != buf) {
+        free(copy);
+    }
+
+    return errnum;
+}
+
+/**
+ * @brief parses a floating point number in place, the token must have passed cfg_is_number_syntax_valid
+ * @param str pointer to the serialized value token
+ * @param len length of the serialized value token
+ * @param result (out) parsed value
+ * @returns CFG_SUCCESS, or an error number
+*/
+int cfg_parse_floating_value(const char* str, size_t len, cfg_float_t* result) {
+    bool negative = len > 0 && str[0] == '-';
+    size_t start = negative;
+    size_t end = len;
+    size_t dot;
+    size_t fraction_len;
+    uint64_t mantissa;
+    cfg_float_t value;
+
+    dot = start;
+    while (dot < end && str[dot] != '.') {
+        dot += 1;
+    }
+
+    /* "-", "." and "-." have no digit at all */
+    if (end - start <= (dot < end)) {
+        return CFG_EINVFLOAT;
+    }
+
+    /* trailing zeros of the fraction and leading zeros of the integer part don't change the value */
+    while (end > dot + 1 && str[end - 1] == '0') {
+        end -= 1;
+    }
+    while (start < dot && str[start] == '0') {
+        start += 1;
+    }
+
+    fraction_len = end > dot ? end - dot - 1 : 0;
+
+    /*
+     * Clinger's fast path: when the digits fit in the mantissa and the power of ten is exact,
+     * a single correctly rounded division gives the correctly rounded result. the grammar has
+     * no exponent, so this covers the numbers found in configuration files.
+    */
+    if (dot - start + fraction_len <= 19 && fraction_len <= CFG_FLOAT_POW10_MAX) {
+        mantissa = cfg_parse_digits(0, &str[start], dot - start);
+        if (fraction_len > 0) {
+            mantissa = cfg_parse_digits(mantissa, &str[dot + 1], fraction_len);
+        }
+
+        if (mantissa <= CFG_FLOAT_MANTISSA_MAX) {
+            value = (cfg_float_t)mantissa / cfg_pow10_list[fraction_len];
+            *result = negative ? -value : value;
+            return CFG_SUCCESS;
+        }
+    }
+
+    return cfg_parse_floating_slow(str, len, result);
+}
+
+/**
+ * @brief parses a number, the type is told by the decimal point
+ * @param str pointer to the serialized value token
+ * @param len length of the serialized value token
+ * @param value (out) parsed value
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_parse_number(const char* str, size_t len, cfg_value_t* value) {
+    if (!cfg_is_number_syntax_valid(str, len)) {
+        return CFG_ENEXIST;
+    }
+
+    if (memchr(str, '.', len) != NULL) {
+        value->type = CFG_STYPE_FLOAT;
+        return cfg_parse_floating_value(str, len, &value->floating);
+    }
+
+    value->type = CFG_STYPE_INT;
+    return cfg_parse_integer_value(str, len, &value->integer);
+}
+
+/**
+ * @brief converts the text of a lazy number of the settings table, the table is left as it is
+ * @param cfg configuration object
+ * @param pos position of the setting, a lazy number
+ * @param tmp (out) setting decoded by cfg_setting_at, receives the value, or the error and the text
+*/
+void cfg_setting_convert(const cfg_t* cfg, size_t pos, cfg_setting_t* tmp) {
+    const char* str = &cfg->identifiers[pos][cfg->values[pos].text.offset];
+    size_t len = cfg->values[pos].text.len;
+    cfg_value_t value;
+
+    tmp->errnum = cfg_parse_number(str, len, &value);
+    if (tmp->errnum != CFG_SUCCESS) {
+        tmp->string = (char*)str;
+        tmp->string_len = len;
+        return;
+    }
+
+    if (value.type == CFG_STYPE_INT) {
+        tmp->integer = value.integer;
+    } else {
+        tmp->floating = value.floating;
+    }
+}
+
+/**
+ * @brief stores the converted value of a lazy number in the settings table, so that it is converted once
+ * @param cfg configuration object
+ * @param pos position of the setting, a lazy number
+ * @param setting setting converted by cfg_setting_at
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_settle_setting(cfg_t* cfg, size_t pos, const cfg_setting_t* setting) {
+    if (setting->type == CFG_STYPE_INT) {
+        cfg->values[pos].integer = setting->integer;
+    } else {
+#ifdef CFG_FLOAT_DOUBLE
+        cfg->values[pos].floating = setting->floating;
+#else
+        cfg_float_t* floating = cfg_arena_alloc(cfg, sizeof(cfg_float_t), alignof(cfg_float_t));
+
+        if (floating == NULL) {
+            return 1;
+        }
+        *floating = setting->floating;
+        cfg->values[pos].floating = floating;
+#endif
+    }
+
+    cfg->types[pos] &= (uint8_t)~CFG_SETTING_LAZY;
+
+    return 0;
+}
+
+/**
+ * @brief adds a decoded setting to the configuration object
+ * @param cfg configuration object
+ * @param value decoded value, strings point into the parsed buffer, arrays are copied
+ * @param id pointer to the identifier token
+ * @param id_len length of the identifier token
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_add_value_setting(cfg_t* cfg, const cfg_value_t* value, const char* id, size_t id_len, int flags) {
+    const cfg_array_t* array;
+
+    switch (value->type) {
+        case CFG_STYPE_INT: {
+            cfg_stats_add(&cfg->stats.integers, 1);
+            return cfg_add_integer_setting(cfg, value->integer, id, id_len, flags);
+        }
+        case CFG_STYPE_FLOAT: {
+            cfg_stats_add(&cfg->stats.floats, 1);
+            return cfg_add_floating_setting(cfg, value->floating, id, id_len, flags);
+        }
+        case CFG_STYPE_STRING: {
+            cfg_stats_add(&cfg->stats.strings, 1);
+            return cfg_add_string_setting(cfg, value->string, value->string_len, id, id_len, flags);
+        }
+        case CFG_STYPE_BOOL: {
+            cfg_stats_add(&cfg->stats.booleans, 1);
+            return cfg_add_boolean_setting(cfg, value->boolean, id, id_len, flags);
+        }
+        case CFG_STYPE_ARRAY: {
+            array = cfg_copy_array(cfg, value);
+            return array == NULL || cfg_add_array_setting(cfg, array, id, id_len, flags);
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    cfg->errnum = CFG_EHUH;
+    return 1;
+}
+
+/**
+ * @brief checks that a value can be stored and written back in the config syntax
+ * @param value value
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_check_value(const cfg_value_t* value) {
+    switch (value->type) {
+        case CFG_STYPE_INT:
+        case CFG_STYPE_BOOL: {
+            return CFG_SUCCESS;
+        }
+        case CFG_STYPE_FLOAT: {
+            /* the syntax has no infinities nor NaNs */
+            return isfinite(value->floating) ? CFG_SUCCESS : CFG_EINVFLOAT;
+        }
+        case CFG_STYPE_STRING: {
+            /* a string value ends at the end of the line or at a comment */
+            return memchr(value->string, '\n', value->string_len) == NULL && memchr(value->string, '#', value->string_len) == NULL
+                ? CFG_SUCCESS : CFG_EINVSTRING;
+        }
+        case CFG_STYPE_ARRAY: {
+            return cfg_array_check(value);
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return CFG_EINVNULL;
+}
+
+/**
+ * @brief replaces the value of a setting of the settings table in place, a zero-copy setting gets
+ * a view of a copy of the string, an array is copied with its strings
+ * @param cfg configuration object
+ * @param pos position of the setting
+ * @param value value
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_store_value(cfg_t* cfg, size_t pos, const cfg_value_t* value) {
+    bool view = (cfg->types[pos] & CFG_SETTING_VIEW) != 0;
+    cfg_value_slot_t slot = { .integer = 0 };
+    cfg_string_view_t* string_view;
+    uint32_t hash = 0;
+    bool shared = true;
+
+    switch (value->type) {
+        case CFG_STYPE_INT: {
+            slot.integer = value->integer;
+            break;
+        }
+        case CFG_STYPE_BOOL: {
+            slot.boolean = value->boolean;
+            break;
+        }
+        case CFG_STYPE_FLOAT: {
+#ifdef CFG_FLOAT_DOUBLE
+            slot.floating = value->floating;
+#else
+            /* a float changed again and again keeps its place in the arena */
+            slot.floating = cfg->types[pos] == CFG_STYPE_FLOAT ? cfg->values[pos].floating : cfg_arena_alloc(cfg, sizeof(cfg_float_t), alignof(cfg_float_t));
+            if (slot.floating == NULL) {
+                return 1;
+            }
+            *(cfg_float_t*)slot.floating = value->floating;
+#endif
+            break;
+        }
+        case CFG_STYPE_STRING: {
+            if (view) {
+                string_view = cfg_arena_alloc(cfg, sizeof(cfg_string_view_t), alignof(cfg_string_view_t));
+                if (string_view == NULL || (string_view->ptr = cfg_arena_strndup(cfg, value->string, value->string_len)) == NULL) {
+                    return 1;
+                }
+                string_view->len = value->string_len;
+                slot.string_view = string_view;
+            } else if ((slot.string = cfg_copy_string(cfg, value->string, value->string_len, &hash, &shared)) == NULL) {
+                return 1;
+            }
+            break;
+        }
+        case CFG_STYPE_ARRAY: {
+            slot.array = cfg_copy_array(cfg, value);
+            if (slot.array == NULL) {
+                return 1;
+            }
+            break;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    cfg_strings_forget(cfg, pos);
+    cfg->values[pos] = slot;
+    cfg->types[pos] = (uint8_t)(value->type | (view ? CFG_SETTING_VIEW : 0));
+
+    if (!shared && value->string_len <= CFG_STRING_SHARED_MAX) {
+        cfg_strings_insert(cfg, hash, pos);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief empties a setting of the settings table, it keeps its identifier and its place in the index
+ * @param cfg configuration object
+ * @param pos position of the setting
+*/
+static void cfg_empty_setting(cfg_t* cfg, size_t pos) {
+    cfg_strings_forget(cfg, pos);
+    cfg->values[pos].integer = 0;
+    cfg->types[pos] &= CFG_SETTING_VIEW;
+}
+
+/**
+ * @brief forgets the line index, the settings no longer match the parsed buffer and cfg_edit_ctx fails
+ * @param cfg configuration object
+*/
+static void cfg_drop_lines(cfg_t* cfg) {
+    free(cfg->lines);
+    cfg->lines = NULL;
+    cfg->lines_len = 0;
+    cfg->lines_cap = 0;
+}
+
+/**
+ * @brief sets a setting of the default configuration, see cfg_set_setting_ctx
+ * @param identifier identifier string
+ * @param value value, a string is copied
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_set_setting(const char* identifier, const cfg_value_t* value) {
+    return cfg_default_status(cfg_set_setting_ctx(&cfg_g, identifier, value));
+}
+
+/**
+ * @brief sets a setting of a configuration, adding it if it doesn't exist. the setting is found through the
+ * index and its value replaced in place, a new one is added at the end, in O(1) either way. the strings
+ * handed out by the getters stay valid. with a journal, the change is appended to it
+ * @param cfg configuration object, not a compiled config nor a snapshot shared with readers
+ * @param identifier identifier string
+ * @param value value, a string is copied and can't hold a newline nor a '#', a float must be finite. an array
+ * is copied, its strings can't hold a quote either
+ * @returns 0 on success, 1 otherwise with the configuration error set. CFG_EWRITE means that the
+ * setting is changed but the journal failed to record it
+*/
+int cfg_set_setting_ctx(cfg_t* cfg, const char* identifier, const cfg_value_t* value) {
+    return cfg_set_setting_len(cfg, identifier, strlen(identifier), value);
+}
+
+/**
+ * @brief sets a setting of a configuration, see cfg_set_setting_ctx
+ * @param cfg configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param value value
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_set_setting_len(cfg_t* cfg, const char* identifier, size_t len, const cfg_value_t* value) {
+    size_t pos;
+    int errnum = cfg_check_value(value);
+
+    if (errnum == CFG_SUCCESS && (len == 0 || len > UINT32_MAX || !cfg_is_identifier_valid(identifier, len))) {
+        errnum = CFG_EINVID;
+    }
+    if (errnum == CFG_SUCCESS && cfg->image != NULL) {
+        errnum = CFG_EREADONLY;
+    }
+    if (errnum != CFG_SUCCESS) {
+        cfg->errnum = errnum;
+        return 1;
+    }
+
+    pos = cfg_find_setting(cfg, identifier, len, cfg_hash(identifier, len));
+    if (pos == CFG_SETTING_NONE) {
+        if (cfg_add_value_setting(cfg, value, identifier, len, CFG_FLAG_NONE) != 0) {
+            return 1;
+        }
+        pos = cfg->settings_len - 1;
+    } else {
+        /* a removed setting comes back, the prefix tree left it out */
+        if ((cfg->types[pos] & CFG_SETTING_TYPE) == CFG_STYPE_UNKNOWN && cfg->tree != NULL) {
+            cfg_tree_drop(cfg);
+        }
+        if (cfg_store_value(cfg, pos, value) != 0) {
+            return 1;
+        }
+    }
+
+    cfg_drop_lines(cfg);
+
+    return cfg->journal == NULL ? 0 : cfg_journal_set(cfg, pos);
+}
+
+/**
+ * @brief removes a setting of the default configuration, see cfg_remove_setting_ctx
+ * @param identifier identifier string
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_remove_setting(const char* identifier) {
+    return cfg_default_status(cfg_remove_setting_ctx(&cfg_g, identifier));
+}
+
+/**
+ * @brief removes a setting of a configuration. the setting stays in the table and in the index with no type,
+ * in O(1), the getters no longer find it and setting it again reuses its place. a setting of a base layer is
+ * hidden from the configuration, the base isn't modified. with a journal, the removal is appended to it
+ * @param cfg configuration object, not a compiled config nor a snapshot shared with readers
+ * @param identifier identifier string
+ * @returns 0 on success, 1 otherwise with the configuration error set, CFG_ENEXIST if the setting doesn't
+ * exist. CFG_EWRITE means that the setting is removed but the journal failed to record it
+*/
+int cfg_remove_setting_ctx(cfg_t* cfg, const char* identifier) {
+    return cfg_remove_setting_len(cfg, identifier, strlen(identifier));
+}
+
+/**
+ * @brief removes a setting of a configuration, see cfg_remove_setting_ctx
+ * @param cfg configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_remove_setting_len(cfg_t* cfg, const char* identifier, size_t len) {
+    uint32_t hash = cfg_hash(identifier, len);
+    size_t pos;
+    cfg_setting_t tmp;
+
+    if (cfg->image != NULL) {
+        cfg->errnum = CFG_EREADONLY;
+        return 1;
+    }
+
+    pos = cfg_find_setting(cfg, identifier, len, hash);
+    if (pos == CFG_SETTING_NONE) {
+        /* a setting of a base layer is shadowed by an empty one */
+        if (cfg->base == NULL || cfg_layer_find(cfg->base, identifier, len, hash, &tmp) == NULL) {
+            cfg->errnum = CFG_ENEXIST;
+            return 1;
+        }
+        if (cfg_add_setting(cfg, CFG_STYPE_UNKNOWN, (cfg_value_slot_t){ .integer = 0 }, identifier, len, CFG_FLAG_NONE) != 0) {
+            return 1;
+        }
+    } else if ((cfg->types[pos] & CFG_SETTING_TYPE) == CFG_STYPE_UNKNOWN) {
+        cfg->errnum = CFG_ENEXIST;
+        return 1;
+    } else {
+        cfg_empty_setting(cfg, pos);
+
+        /* the duplicates would come back once written out and parsed again */
+        for (size_t i = pos + 1; cfg->duplicates != 0 && i < cfg->settings_len; i++) {
+            if (cfg->hashes[i] == hash && cfg->identifier_lens[i] == len && memcmp(cfg->identifiers[i], identifier, len) == 0) {
+                cfg_empty_setting(cfg, i);
+            }
+        }
+    }
+
+    cfg_tree_drop(cfg);
+    cfg_drop_lines(cfg);
+
+    return cfg->journal == NULL ? 0 : cfg_journal_remove(cfg, identifier, len);
+}
+
+/**
+ * @brief decodes a value token, the type is guessed from its first character
+ * @param cfg configuration object
+ * @param str pointer to the serialized value token, not empty
+ * @param len length of the serialized value token
+ * @param value (out) decoded value, strings point into the token
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_parse_value(cfg_t* cfg, const char* str, size_t len, cfg_value_t* value) {
+    int errnum;
+
+    switch (str[0]) {
+        /* the value should be a number */
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9': {
+            errnum = cfg_parse_number(str, len, value);
+            if (errnum != CFG_SUCCESS) {
+                cfg->errnum = errnum;
+                return 1;
+            }
+            return 0;
+        }
+        /* the value should be a string */
+        case '\"': {
+            if (len < 2 || str[len - 1] != '\"') {
+                cfg->errnum = CFG_EINVSTRING;
+                return 1;
+            }
+            value->type = CFG_STYPE_STRING;
+            value->string = &str[1];
+            value->string_len = len - 2;
+            return 0;
+        }
+        /* the value should be a bool */
+        case 'f':
+        case 't': {
+            if (len == 4 && memcmp(str, "true", 4) == 0) {
+                value->type = CFG_STYPE_BOOL;
+                value->boolean = true;
+                return 0;
+            }
+            if (len == 5 && memcmp(str, "false", 5) == 0) {
+                value->type = CFG_STYPE_BOOL;
+                value->boolean = false;
+                return 0;
+            }
+            cfg->errnum = CFG_EINVBOOL;
+            return 1;
+        }
+        default: {
+            cfg->errnum = CFG_EINVNULL;
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief moves the line and column of the configuration to where the parser stopped, the parser
+ * doesn't track them itself and they are counted from the newlines of the buffer here
+ * @param cfg configuration object
+ * @param str pointer to the parsed buffer
+ * @param pos position of the cursor in the buffer
+*/
+static void cfg_set_position(cfg_t* cfg, const char* str, size_t pos) {
+    size_t newlines = cfg_scan_count(str, pos, '\n');
+    size_t line_start = pos;
+
+    if (newlines == 0) {
+        cfg->col += pos;
+        return;
+    }
+
+    while (str[line_start - 1] != '\n') {
+        line_start -= 1;
+    }
+
+    cfg->line += newlines;
+    cfg->col = pos - line_start + 1;
+}
+
+/**
+ * @brief parses the serialized configuration buffer, adding its settings to the configuration
+ * or handing them to a callback
+ * @param cfg configuration object
+ * @param str pointer to the buffer containing the serialized configuration
+ * @param len length of the buffer
+ * @param flags parsing flags
+ * @param callback called for every setting instead of adding it, NULL to add the settings
+ * @param user passed to the callback
+ * @returns 0 on success or when stopped by the callback, 1 otherwise with the configuration error set
+*/
+static int cfg_parse_buffer(cfg_t* cfg, const char* str, size_t len, int flags, cfg_setting_cb_t callback, void* user) {
+    int status = 1;
+    size_t c1 = 0;
+    size_t c2 = 0;
+    size_t id_pos = 0;
+    size_t id_len = 0;
+    size_t value_pos = 0;
+    size_t value_len = 0;
+    size_t line = cfg->line;
+    uint64_t start = cfg_now_ns();
+    cfg_array_t* array = NULL;
+    cfg_value_t value;
+    bool stop;
+
+    while (c2 < len) {
+        switch (str[c2]) {
+            /* forward the cursor until something meaningful */
+            case '\r':
+            case '\t':
+            case ' ':
+            case '\n': {
                 c2 += 1;
-                
-                cfg_g.line += 1;
-                cfg_g.col = 1;
                 break;
             }
             /* forward the cursor to the end of the line */
             case '#': {
-                while (c2 < len && str[c2] != '\n') {
-                    c2 += 1;
-                    cfg_g.col += 1;
-                }
+                c2 = cfg_scan_find(str, c2, len, '\n', '\n');
                 break;
             }
             /* we have an identifier */
             default: {
                 c1 = c2;
-                /* get the position and length of the identifier */
-                while (c2 < len && str[c2] != '=') {
-                    c2 += 1;
-                    cfg_g.col += 1;
-                }
+                /* get the position and length of the identifier, it ends at the assignment operator */
+                c2 = cfg_scan_find(str, c2, len, '=', '\n');
                 id_pos = c1;
                 id_len = c2 - c1;
 
-
-                if (id_len == 0) {
-                    cfg_errno = CFG_EINVID;
-                    return 1;
+                if (id_len == 0 || c2 == len || str[c2] != '=') {
+                    cfg->errnum = CFG_EINVID;
+                    goto cfg_parse_buffer_end;
                 }
 
                 /* trim whitespaces at the end of the identifier */
-                for (size_t i = 1; cfg_is_whitespace(str[c2 - i]); i++) {
+                while (cfg_is_whitespace(str[id_pos + id_len - 1])) {
                     id_len -= 1;
                 }
 
                 /* check for key validity */
                 if (!cfg_is_identifier_valid(&str[id_pos], id_len)) {
-                    cfg_errno = CFG_EINVID;
-                    return 1;
+                    cfg->errnum = CFG_EINVID;
+                    goto cfg_parse_buffer_end;
                 }
 
                 /* skip the assignment operator */
-                if (c2 + 1 < len && str[c2] == '=') {
-                    c2 += 1;
-                    cfg_g.col += 1;
-                }
+                c2 += 1;
 
                 /* forward to the value */
                 while (c2 < len && cfg_is_whitespace(str[c2])) {
                     c2 += 1;
-                    cfg_g.col += 1;
                 }
                 c1 = c2;
 
                 /* get the position and length of the value until end of line */
-                while (c2 < len && str[c2] != '\n' && str[c2] != '#') {
-                    c2 += 1;
-                    cfg_g.col += 1;
-                }
+                c2 = cfg_scan_find(str, c2, len, '\n', '#');
                 value_pos = c1;
                 value_len = c2 - c1;
 
                 /* trim whitespaces at the end of the value */
-                for (size_t i = 1; cfg_is_whitespace(str[c2 - i]); i++) {
+                while (value_len > 0 && cfg_is_whitespace(str[value_pos + value_len - 1])) {
                     value_len -= 1;
                 }
 
-                switch (str[value_pos]) {
-                    /* the value should be a number */
-                    case '-':
-                    case '0':
-                    case '1':
-                    case '2':
-                    case '3':
-                    case '4':
-                    case '5':
-                    case '6':
-                    case '7':
-                    case '8':
-                    case '9': {
-                        if (!cfg_is_number_syntax_valid(&str[value_pos], value_len)) {
-                            cfg_errno = CFG_ENEXIST;
-                            return 1;
-                        }
-                        if (memchr(&str[value_pos], '.', value_len) != NULL) {
-                            if (cfg_parse_floating(&str[value_pos], value_len, &str[id_pos], id_len) != 0) {
-                                return 1;
-                            }
-                        } else {
-                            if (cfg_parse_integer(&str[value_pos], value_len, &str[id_pos], id_len) != 0) {
-                                return 1;
-                            }
-                        }              
-                        break;
+                if (value_len == 0) {
+                    cfg->errnum = CFG_EINVNULL;
+                    goto cfg_parse_buffer_end;
+                }
+
+                /* with CFG_FLAG_LAZY a number is only recorded, the first getter reading it converts it */
+                if (callback == NULL && (flags & CFG_FLAG_LAZY) != 0 && cfg_is_number_start(str[value_pos])
+                    && value_pos - id_pos <= UINT32_MAX && value_len <= UINT32_MAX) {
+                    if (cfg_add_lazy_setting(cfg, &str[value_pos], value_len, &str[id_pos], id_len, flags) != 0) {
+                        goto cfg_parse_buffer_end;
                     }
-                    /* the value should be a string */
-                    case '\"': {
-                        if (cfg_parse_string(&str[value_pos], value_len, &str[id_pos], id_len) != 0) {
-                            return 1;
-                        }                        
-                        break;
+                    break;
+                }
+
+                /* an array is decoded in the arena, or in a scratch buffer released once handed to the callback */
+                if (str[value_pos] == '[') {
+                    array = cfg_parse_array(cfg, &str[value_pos], value_len, flags, callback != NULL);
+                    if (array == NULL) {
+                        goto cfg_parse_buffer_end;
                     }
-                    /* the value should be a bool */
-                    case 'f':
-                    case 't': {
-                        if (strncmp(&str[value_pos], "true", value_len) == 0) {
-                            if (cfg_add_boolean_setting(1, &str[id_pos], id_len) != 0) {
-                                return 1;
-                            }
-                        } else if (strncmp(&str[value_pos], "false", value_len) == 0) {
-                            if (cfg_add_boolean_setting(0, &str[id_pos], id_len) != 0) {
-                                return 1;
-                            }
-                        } else {
-                            cfg_errno = CFG_EINVBOOL;
-                            return 1;
+                    if (callback == NULL) {
+                        if (cfg_add_array_setting(cfg, array, &str[id_pos], id_len, flags) != 0) {
+                            goto cfg_parse_buffer_end;
                         }
                         break;
                     }
-                    default: {
-                        cfg_errno = CFG_EINVNULL;
-                        return 1;
+                    cfg_array_value(array, &value);
+                } else if (cfg_parse_value(cfg, &str[value_pos], value_len, &value) != 0) {
+                    goto cfg_parse_buffer_end;
+                }
+
+                if (callback == NULL) {
+                    if (cfg_add_value_setting(cfg, &value, &str[id_pos], id_len, flags) != 0) {
+                        goto cfg_parse_buffer_end;
                     }
+                    break;
+                }
+
+                stop = callback(&str[id_pos], id_len, &value, user) != 0;
+                free(array);
+                array = NULL;
+                if (stop) {
+                    /* stopped by the callback, after the value */
+                    status = 0;
+                    goto cfg_parse_buffer_end;
                 }
                 break;
             }
         }
     }
 
+    status = 0;
+
+cfg_parse_buffer_end:
+    cfg_set_position(cfg, str, c2);
+
+    cfg_stats_add(&cfg->stats.parse_ns, cfg_now_ns() - start);
+    cfg_stats_add(&cfg->stats.parse_bytes, c2);
+    cfg_stats_add(&cfg->stats.lines, cfg->line - line);
+    if (cfg->slow_hook != NULL) {
+        cfg_stats_slow(cfg, CFG_SLOW_PARSE, cfg->path, cfg->path == NULL ? 0 : strlen(cfg->path), start);
+    }
+
+    return status;
+}
+
+/**
+ * @brief parses the serialized configuration buffer
+ * @param str pointer to the buffer containing the serialized configuration
+ * @param len length of the buffer
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_parse(const char* str, size_t len) {
+    return cfg_parse_ex(str, len, CFG_FLAG_NONE);
+}
+
+/**
+ * @brief parses the serialized configuration buffer
+ * @param str pointer to the buffer containing the serialized configuration, with CFG_FLAG_ZEROCOPY it must outlive the configuration
+ * @param len length of the buffer
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_parse_ex(const char* str, size_t len, int flags) {
+    return cfg_default_status(cfg_parse_ctx(&cfg_g, str, len, flags));
+}
+
+/**
+ * @brief parses the serialized configuration buffer into a configuration
+ * @param cfg configuration object
+ * @param str pointer to the buffer containing the serialized configuration, with CFG_FLAG_ZEROCOPY it must outlive the configuration
+ * @param len length of the buffer
+ * @param flags parsing flags
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_parse_ctx(cfg_t* cfg, const char* str, size_t len, int flags) {
+    size_t base = cfg->settings_len;
+
+    /* the line index describes the latest buffer only */
+    cfg_drop_lines(cfg);
+
+    if (cfg_parse_buffer(cfg, str, len, flags, NULL, NULL) != 0) {
+        return 1;
+    }
+
+    if ((flags & CFG_FLAG_INCREMENTAL) != 0 && (flags & CFG_FLAG_ZEROCOPY) == 0 && cfg_index_lines(cfg, str, len, base) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief parses the serialized configuration buffer, handing every setting to a callback instead of storing it
+ * @param str pointer to the buffer containing the serialized configuration
+ * @param len length of the buffer
+ * @param callback called for every setting, in file order, returns non-zero to stop parsing
+ * @param user passed to the callback
+ * @returns 0 on success or when stopped by the callback, 1 otherwise with cfg_errno set
+*/
+int cfg_parse_cb(const char* str, size_t len, cfg_setting_cb_t callback, void* user) {
+    return cfg_default_status(cfg_parse_cb_ctx(&cfg_g, str, len, callback, user));
+}
+
+/**
+ * @brief parses the serialized configuration buffer, handing every setting to a callback instead of storing it.
+ * nothing is added to the configuration, only its error and position are updated, and nothing is allocated
+ * but the copy of numbers too long for the stack handed to the libc and the items of the arrays, released
+ * after the callback
+ * @param cfg configuration object, receives the error and the position where the parser stopped
+ * @param str pointer to the buffer containing the serialized configuration
+ * @param len length of the buffer
+ * @param callback called for every setting, in file order, returns non-zero to stop parsing
+ * @param user passed to the callback
+ * @returns 0 on success or when stopped by the callback, 1 otherwise with the configuration error set
+*/
+int cfg_parse_cb_ctx(cfg_t* cfg, const char* str, size_t len, cfg_setting_cb_t callback, void* user) {
+    return cfg_parse_buffer(cfg, str, len, CFG_FLAG_NONE, callback, user);
+}
+
+/**
+ * @brief converts the numbers of the configuration parsed with CFG_FLAG_LAZY
+ * @param identifier (out) identifier of the first setting that doesn't convert, NULL to ignore
+ * @param identifier_len (out) length of the identifier, NULL to ignore
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_validate(const char** identifier, size_t* identifier_len) {
+    return cfg_default_status(cfg_validate_ctx(&cfg_g, identifier, identifier_len));
+}
+
+/**
+ * @brief converts every number of a configuration parsed with CFG_FLAG_LAZY, stopping at the first one
+ * that doesn't convert with the error the parse would have failed with. the configuration then reads
+ * like one parsed without the flag, the getters don't write it anymore and it can be shared between threads
+ * @param cfg configuration object
+ * @param identifier (out) identifier of the first setting that doesn't convert, not NUL terminated in zero-copy mode, NULL to ignore
+ * @param identifier_len (out) length of the identifier, NULL to ignore
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_validate_ctx(cfg_t* cfg, const char** identifier, size_t* identifier_len) {
+    cfg_setting_t tmp;
+
+    for (size_t i = 0; cfg->lazy && i < cfg->settings_len; i++) {
+        if ((cfg->types[i] & CFG_SETTING_LAZY) == 0) {
+            continue;
+        }
+
+        cfg_setting_at(cfg, i, &tmp);
+        if (tmp.errnum != CFG_SUCCESS) {
+            cfg->errnum = tmp.errnum;
+            if (identifier != NULL) {
+                *identifier = tmp.identifier;
+            }
+            if (identifier_len != NULL) {
+                *identifier_len = tmp.identifier_len;
+            }
+            return 1;
+        }
+
+        if (cfg_settle_setting(cfg, i, &tmp) != 0) {
+            return 1;
+        }
+    }
+
+    cfg->lazy = false;
+
     return 0;
 }
 
@@ -589,56 +2077,278 @@ static size_t cfg_get_file_size(int fd) {
 }
 
 /**
- * @brief loads a supported config file into the program
+ * @brief maps a config file to memory and records its path in the configuration
+ * @param cfg configuration object
  * @param path path to the config file
- * @returns 0 on success, 1 otherwise with cfg_errno set
+ * @param ptr (out) pointer to the mapping
+ * @param len (out) length of the mapping
+ * @returns 0 on success, 1 otherwise with the configuration error set
 */
-int cfg_load(const char* path) {
+int cfg_map_file(cfg_t* cfg, const char* path, char** ptr, size_t* len) {
     int status = 0;
     int fd;
     off_t raw_len;
     char *raw_ptr;
 
-    cfg_g.path = strdup(path);
+    free(cfg->path);
+    cfg->path = strdup(path);
 
     fd = open(path, O_RDONLY, 0600);
     if (fd == -1) {
-        cfg_errno = CFG_EOPEN;
+        cfg->errnum = CFG_EOPEN;
         return 1;
     }
 
     if (cfg_get_file_size(fd) == 0) {
-        cfg_errno = CFG_ESIZE;
+        cfg->errnum = CFG_ESIZE;
         status = 1;
-        goto cfg_load_close_fd;
+        goto cfg_map_file_close_fd;
     }
 
     raw_len = lseek(fd, 0, SEEK_END);
     if (raw_len == -1) {
-        cfg_errno = CFG_ESEEK;
+        cfg->errnum = CFG_ESEEK;
         status = 1;
-        goto cfg_load_close_fd;
+        goto cfg_map_file_close_fd;
     }
 
     raw_ptr = mmap(0, (size_t)raw_len, PROT_READ, MAP_PRIVATE, fd, 0);
     if (raw_ptr == MAP_FAILED) {
-        cfg_errno = CFG_EMAP;
+        cfg->errnum = CFG_EMAP;
         status = 1;
-        goto cfg_load_close_fd;
+        goto cfg_map_file_close_fd;
     }
 
-    if (cfg_parse(raw_ptr, (size_t)raw_len) != 0) {
-        status = 1;
+    *ptr = raw_ptr;
+    *len = (size_t)raw_len;
+
+cfg_map_file_close_fd:
+    close(fd);
+
+    return status;
+}
+
+/**
+ * @brief hands a file mapping over to the configuration, it is unmapped when the configuration is freed
+ * @param cfg configuration object
+ * @param ptr pointer to the mapping
+ * @param len length of the mapping
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_keep_mapping(cfg_t* cfg, char* ptr, size_t len) {
+    cfg_mapping_t* map = cfg_arena_alloc(cfg, sizeof(cfg_mapping_t), alignof(cfg_mapping_t));
+
+    if (map == NULL) {
+        return 1;
     }
 
-    munmap(raw_ptr, (size_t)raw_len);
+    map->ptr = ptr;
+    map->len = len;
+    map->next = cfg->mappings;
+    cfg->mappings = map;
 
-cfg_load_close_fd:
-    close(fd);
+    return 0;
+}
+
+/**
+ * @brief loads a supported config file into the program
+ * @param path path to the config file
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_load(const char* path) {
+    return cfg_load_ex(path, CFG_FLAG_NONE);
+}
+
+/**
+ * @brief loads a supported config file into the program
+ * @param path path to the config file
+ * @param flags parsing flags, with CFG_FLAG_ZEROCOPY the file stays mapped until cfg_free
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_load_ex(const char* path, int flags) {
+    return cfg_default_status(cfg_load_ctx(&cfg_g, path, flags));
+}
+
+/**
+ * @brief loads a supported config file into a configuration. pipes, sockets and files that don't report
+ * their size, like the ones of /proc, are read in pieces and parsed as a stream, without the flags
+ * @param cfg configuration object
+ * @param path path to the config file
+ * @param flags parsing flags, with CFG_FLAG_ZEROCOPY the file stays mapped until the configuration is freed
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_load_ctx(cfg_t* cfg, const char* path, int flags) {
+    int status;
+    char* raw_ptr;
+    size_t raw_len;
+    struct stat s;
+
+    if (stat(path, &s) == 0 && (!S_ISREG(s.st_mode) || s.st_size == 0)) {
+        return cfg_load_stream(cfg, path);
+    }
+
+    if (cfg_map_file(cfg, path, &raw_ptr, &raw_len) != 0) {
+        return 1;
+    }
+
+    /* in zero-copy mode the settings reference the mapping, it is released by cfg_free */
+    if ((flags & CFG_FLAG_ZEROCOPY) != 0 && cfg_keep_mapping(cfg, raw_ptr, raw_len) != 0) {
+        munmap(raw_ptr, raw_len);
+        return 1;
+    }
+
+    status = cfg_parse_ctx(cfg, raw_ptr, raw_len, flags);
+
+    if ((flags & CFG_FLAG_ZEROCOPY) == 0) {
+        munmap(raw_ptr, raw_len);
+    }
 
     return status;
 }
 
+/**
+ * @brief loads a supported config file into the program, parsing it on several threads
+ * @param path path to the config file
+ * @param nthreads maximum number of threads
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_load_parallel(const char* path, size_t nthreads) {
+    return cfg_default_status(cfg_load_parallel_ctx(&cfg_g, path, nthreads, CFG_FLAG_NONE));
+}
+
+/**
+ * @brief loads a compiled config into the program, with the text parser if it is missing, invalid or out of date
+ * @param text_path path to the config file
+ * @param bin_path path to the compiled config
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_load_compiled(const char* text_path, const char* bin_path) {
+    return cfg_default_status(cfg_load_compiled_ctx(&cfg_g, text_path, bin_path));
+}
+
+/**
+ * @brief starts parsing a config fed in pieces with cfg_stream_feed into the program
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_stream_begin(void) {
+    return cfg_default_status(cfg_stream_begin_ctx(&cfg_g));
+}
+
+/**
+ * @brief parses the next piece of a config, see cfg_stream_feed_ctx
+ * @param buf pointer to the piece, only used during the call
+ * @param len length of the piece
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_stream_feed(const char* buf, size_t len) {
+    return cfg_default_status(cfg_stream_feed_ctx(&cfg_g, buf, len));
+}
+
+/**
+ * @brief parses the last line of a config fed with cfg_stream_feed
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_stream_end(void) {
+    return cfg_default_status(cfg_stream_end_ctx(&cfg_g));
+}
+
+/**
+ * @brief fills a struct with the settings of the loaded configuration, see cfg_bind_ctx
+ * @param table bindings of the settings to the struct fields
+ * @param n number of bindings
+ * @param out_struct (out) struct to fill
+ * @param errors (out) error number of every binding, may be NULL
+ * @returns 0 on success, 1 otherwise with cfg_errno set to the error of the first failed binding
+*/
+int cfg_bind(const cfg_binding_t* table, size_t n, void* out_struct, int* errors) {
+    return cfg_default_status(cfg_bind_ctx(&cfg_g, table, n, out_struct, errors));
+}
+
+/**
+ * @brief sets the schema the next config files are parsed with
+ * @param schema schema generated by cfg_gen, NULL to stop using one
+ * @param overflow true to allow identifiers missing from the schema, false to reject them
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_use_schema(const cfg_schema_t* schema, bool overflow) {
+    return cfg_default_status(cfg_use_schema_ctx(&cfg_g, schema, overflow));
+}
+
+/**
+ * @brief stacks the loaded configuration over a base layer, see cfg_set_base_ctx
+ * @param base lower layer, NULL to remove it
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_set_base(const cfg_t* base) {
+    return cfg_default_status(cfg_set_base_ctx(&cfg_g, base));
+}
+
+/**
+ * @brief applies an edit to the buffer last parsed with CFG_FLAG_INCREMENTAL, only the lines it touches are parsed again
+ * @param str pointer to the edited buffer
+ * @param len length of the edited buffer
+ * @param edit_pos offset of the edit
+ * @param old_len number of bytes replaced at edit_pos
+ * @param new_len number of bytes replacing them
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_edit(const char* str, size_t len, size_t edit_pos, size_t old_len, size_t new_len) {
+    return cfg_default_status(cfg_edit_ctx(&cfg_g, str, len, edit_pos, old_len, new_len));
+}
+
+/**
+ * @brief writes the loaded configuration to a file descriptor, see cfg_write_ctx
+ * @param fd file descriptor
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_write(int fd) {
+    return cfg_default_status(cfg_write_ctx(&cfg_g, fd));
+}
+
+/**
+ * @brief writes the loaded configuration to memory, see cfg_write_buffer_ctx
+ * @param str (out) output, NUL terminated, to release with free
+ * @param len (out) length of the output
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_write_buffer(char** str, size_t* len) {
+    return cfg_default_status(cfg_write_buffer_ctx(&cfg_g, str, len));
+}
+
+/**
+ * @brief opens the journal of the loaded configuration and replays it, see cfg_journal_open_ctx
+ * @param path path of the journal
+ * @param compact_bytes size of the journal that starts a compaction, 0 to compact only with cfg_journal_compact
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_journal_open(const char* path, size_t compact_bytes) {
+    return cfg_default_status(cfg_journal_open_ctx(&cfg_g, path, compact_bytes));
+}
+
+/**
+ * @brief starts a compaction of the journal of the loaded configuration, see cfg_journal_compact_ctx
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_journal_compact(void) {
+    return cfg_default_status(cfg_journal_compact_ctx(&cfg_g));
+}
+
+/**
+ * @brief waits for the compaction and syncs the journal of the loaded configuration, see cfg_journal_sync_ctx
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_journal_sync(void) {
+    return cfg_default_status(cfg_journal_sync_ctx(&cfg_g));
+}
+
+/**
+ * @brief syncs and closes the journal of the loaded configuration, see cfg_journal_close_ctx
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_journal_close(void) {
+    return cfg_default_status(cfg_journal_close_ctx(&cfg_g));
+}
+
 /**
  * @brief get a setting value
  * @param identifier identifier string
@@ -646,43 +2356,199 @@ cfg_load_close_fd:
  * @returns 0 on success, 1 otherwise
 */
 int cfg_get_setting(const char* identifier, void* value) {
-    for (size_t i = 0; i < cfg_g.settings_len; i++) {
-        if (strcmp(identifier, cfg_g.settings[i]->identifier) == 0) {
-            switch (cfg_g.settings[i]->type) {
-                case CFG_STYPE_BOOL: {
-                    *(bool*)value = cfg_g.settings[i]->boolean;
-                    return 0;
-                }
-                case CFG_STYPE_STRING: {
-                    *(char**)value = cfg_g.settings[i]->string;
-                    return 0;
-                }
-                case CFG_STYPE_INT: {
-                    *(long long*)value = cfg_g.settings[i]->integer;
-                    return 0;
-                }
-                case CFG_STYPE_FLOAT: {
-                    *(long double*)value = cfg_g.settings[i]->floating;
-                    return 0;
-                }
-                case CFG_STYPE_UNKNOWN: {
-                    cfg_errno = CFG_EHUH;
-                    return 1;
-                }
+    return cfg_default_status(cfg_get_setting_ctx(&cfg_g, identifier, value));
+}
+
+/**
+ * @brief copies the value of a setting
+ * @param cfg configuration object
+ * @param setting setting, NULL if it doesn't exist
+ * @param value (out) address of the variable to write value data to
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_get_value(cfg_t* cfg, const cfg_setting_t* setting, void* value) {
+    if (setting == NULL) {
+        cfg_set_errnum(cfg, CFG_ENEXIST);
+        return 1;
+    }
+
+    if (setting->errnum != CFG_SUCCESS) {
+        cfg_set_errnum(cfg, setting->errnum);
+        return 1;
+    }
+
+    switch (setting->type) {
+        case CFG_STYPE_BOOL: {
+            *(bool*)value = setting->boolean;
+            return 0;
+        }
+        case CFG_STYPE_STRING: {
+            if (setting->view) {
+                cfg_set_errnum(cfg, CFG_EVIEW);
+                return 1;
             }
+            *(char**)value = setting->string;
+            return 0;
+        }
+        case CFG_STYPE_INT: {
+            *(long long*)value = setting->integer;
+            return 0;
+        }
+        case CFG_STYPE_FLOAT: {
+            *(cfg_float_t*)value = setting->floating;
+            return 0;
+        }
+        case CFG_STYPE_ARRAY: {
+            cfg_set_errnum(cfg, CFG_EARRAY);
+            return 1;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
         }
     }
-    
-    cfg_errno = CFG_ENEXIST;
+
+    cfg_set_errnum(cfg, CFG_EHUH);
     return 1;
 }
 
+/**
+ * @brief get a setting value from a configuration
+ * @param cfg configuration object
+ * @param identifier identifier string
+ * @param value (out) address of the variable to write value data to
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_get_setting_ctx(cfg_t* cfg, const char* identifier, void* value) {
+    cfg_setting_t tmp;
+    cfg_setting_t* setting = cfg_lookup(cfg, identifier, strlen(identifier), &tmp);
+    size_t pos;
+
+    /* a lazy number of the configuration is stored once converted, the ones of the base layers are left as they are */
+    if (setting != NULL && setting->lazy && setting->errnum == CFG_SUCCESS && cfg->lazy) {
+        pos = cfg_find_setting(cfg, setting->identifier, setting->identifier_len, setting->hash);
+        if (pos != CFG_SETTING_NONE && cfg->identifiers[pos] == setting->identifier) {
+            cfg_settle_setting(cfg, pos, setting);
+        }
+    }
+
+    return cfg_get_value(cfg, setting, value);
+}
+
+/**
+ * @brief get a setting value by the id cfg_gen generated for its identifier
+ * @param id id of the identifier in the schema
+ * @param value (out) address of the variable to write value data to
+ * @returns 0 on success, 1 otherwise
+*/
+int cfg_get_by_id(size_t id, void* value) {
+    return cfg_default_status(cfg_get_by_id_ctx(&cfg_g, id, value));
+}
+
+/**
+ * @brief get a setting value from a configuration using a schema, by the id cfg_gen generated
+ * for its identifier. the setting is read from its slot, nothing is hashed nor compared, unless
+ * the configuration doesn't hold it and it is looked up in the base layers
+ * @param cfg configuration object
+ * @param id id of the identifier in the schema
+ * @param value (out) address of the variable to write value data to
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_get_by_id_ctx(cfg_t* cfg, size_t id, void* value) {
+    const char* identifier;
+    size_t len;
+    cfg_setting_t tmp;
+    cfg_setting_t* setting = NULL;
+
+    if (cfg->slots == NULL || id >= cfg->schema->len) {
+        cfg_stats_lookup(cfg, NULL);
+        cfg_set_errnum(cfg, CFG_ENEXIST);
+        return 1;
+    }
+
+    if (cfg->slots[id] != 0) {
+        setting = cfg_setting_at(cfg, cfg->slots[id] - 1, &tmp);
+        setting = setting->type == CFG_STYPE_UNKNOWN ? NULL : setting;
+        if (setting != NULL && setting->lazy && setting->errnum == CFG_SUCCESS) {
+            cfg_settle_setting(cfg, cfg->slots[id] - 1, setting);
+        }
+    } else if (cfg->base != NULL) {
+        identifier = cfg->schema->identifiers[id];
+        len = cfg->schema->identifier_lens[id];
+        setting = cfg_layer_find(cfg->base, identifier, len, cfg_hash(identifier, len), &tmp);
+    }
+
+    cfg_stats_lookup(cfg, setting);
+
+    return cfg_get_value(cfg, setting, value);
+}
+
+/**
+ * @brief get a string setting value as a pointer and a length, works in zero-copy mode
+ * @param identifier identifier string
+ * @param str (out) pointer to the string, not NUL terminated in zero-copy mode
+ * @param len (out) length of the string
+ * @returns 0 on success, 1 otherwise
+*/
+int cfg_get_string_view(const char* identifier, const char** str, size_t* len) {
+    return cfg_default_status(cfg_get_string_view_ctx(&cfg_g, identifier, str, len));
+}
+
+/**
+ * @brief get a string setting value of a configuration as a pointer and a length, works in zero-copy mode
+ * @param cfg configuration object
+ * @param identifier identifier string
+ * @param str (out) pointer to the string, not NUL terminated in zero-copy mode
+ * @param len (out) length of the string
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_get_string_view_ctx(cfg_t* cfg, const char* identifier, const char** str, size_t* len) {
+    size_t id_len = strlen(identifier);
+    cfg_setting_t tmp;
+    cfg_setting_t* setting = cfg_lookup(cfg, identifier, id_len, &tmp);
+
+    if (setting == NULL) {
+        cfg_set_errnum(cfg, CFG_ENEXIST);
+        return 1;
+    }
+
+    if (setting->type != CFG_STYPE_STRING) {
+        cfg_set_errnum(cfg, CFG_EINVSTRING);
+        return 1;
+    }
+
+    *str = setting->string;
+    *len = setting->string_len;
+
+    return 0;
+}
+
+/**
+ * @brief get an array setting value as a pointer to its items and their number, see cfg_get_array_ctx
+ * @param identifier identifier string
+ * @param type type of the items: CFG_STYPE_INT, CFG_STYPE_FLOAT or CFG_STYPE_STRING
+ * @param items (out) pointer to the first item: long long, cfg_float_t or cfg_string_span_t
+ * @param len (out) number of items
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_get_array(const char* identifier, enum cfg_setting_type_e type, const void** items, size_t* len) {
+    return cfg_default_status(cfg_get_array_ctx(&cfg_g, identifier, type, items, len));
+}
+
 /**
  * @brief get the line at wich the parser stopped
  * @returns the line number
 */
 size_t cfg_get_error_line(void) {
-    return cfg_g.line;
+    return cfg_get_error_line_ctx(&cfg_g);
+}
+
+/**
+ * @brief get the line at wich the parser of a configuration stopped
+ * @param cfg configuration object
+ * @returns the line number
+*/
+size_t cfg_get_error_line_ctx(const cfg_t* cfg) {
+    return cfg->line;
 }
 
 /**
@@ -690,7 +2556,16 @@ size_t cfg_get_error_line(void) {
  * @returns the column number
 */
 size_t cfg_get_error_col(void) {
-    return cfg_g.col;
+    return cfg_get_error_col_ctx(&cfg_g);
+}
+
+/**
+ * @brief get the column at wich the parser of a configuration stopped
+ * @param cfg configuration object
+ * @returns the column number
+*/
+size_t cfg_get_error_col_ctx(const cfg_t* cfg) {
+    return cfg->col;
 }
 
 /**
@@ -698,7 +2573,16 @@ size_t cfg_get_error_col(void) {
  * @returns pointer to the path string or NULL if parsed from a buffer
 */
 const char* cfg_get_path(void) {
-    return cfg_g.path;
+    return cfg_get_path_ctx(&cfg_g);
+}
+
+/**
+ * @brief returns the path of the file loaded into a configuration
+ * @param cfg configuration object
+ * @returns pointer to the path string or NULL if parsed from a buffer
+*/
+const char* cfg_get_path_ctx(const cfg_t* cfg) {
+    return cfg->path;
 }
 
 /**
@@ -707,11 +2591,62 @@ const char* cfg_get_path(void) {
  * @returns type of the corresponding setting
 */
 enum cfg_setting_type_e cfg_get_setting_type(const char* identifier) {
-    for (size_t i = 0; i < cfg_g.settings_len; i++) {
-        if (strcmp(identifier, cfg_g.settings[i]->identifier) == 0) {
-            return cfg_g.settings[i]->type;
-        }
+    return cfg_get_setting_type_ctx(&cfg_g, identifier);
+}
+
+/**
+ * @brief get the type of a setting of a configuration
+ * @param cfg configuration object
+ * @param identifier setting identifier
+ * @returns type of the corresponding setting
+*/
+enum cfg_setting_type_e cfg_get_setting_type_ctx(const cfg_t* cfg, const char* identifier) {
+    size_t len = strlen(identifier);
+    cfg_setting_t tmp;
+    cfg_setting_t* setting = cfg_lookup(cfg, identifier, len, &tmp);
+
+    if (setting == NULL) {
+        return CFG_STYPE_UNKNOWN;
     }
 
-    return CFG_STYPE_UNKNOWN;
+    return setting->type;
+}
+
+/**
+ * @brief hands every setting of the loaded configuration whose identifier starts with a prefix to a callback
+ * @param prefix prefix of the identifiers, "" for every setting
+ * @param callback called for every setting in identifier order, returns non-zero to stop
+ * @param user passed to the callback
+ * @returns 0 on success or when stopped by the callback, 1 otherwise with cfg_errno set
+*/
+int cfg_foreach_prefix(const char* prefix, cfg_setting_cb_t callback, void* user) {
+    return cfg_default_status(cfg_foreach_prefix_ctx(&cfg_g, prefix, callback, user));
+}
+
+/**
+ * @brief counts the settings of the loaded configuration whose identifier starts with a prefix
+ * @param prefix prefix of the identifiers, "" for every setting
+ * @param count (out) number of settings
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_count_prefix(const char* prefix, size_t* count) {
+    return cfg_default_status(cfg_count_prefix_ctx(&cfg_g, prefix, count));
+}
+
+/**
+ * @brief gets the statistics of the loaded configuration
+ * @returns statistics, see cfg_get_stats_ctx
+*/
+cfg_stats_t cfg_get_stats(void) {
+    return cfg_get_stats_ctx(&cfg_g);
+}
+
+/**
+ * @brief calls a hook when a parse or a lookup of the loaded configuration is slow
+ * @param threshold_ns duration from which the hook is called
+ * @param hook called with the operation and its duration, NULL to remove the hook
+ * @param user passed to the hook
+*/
+void cfg_set_slow_hook(uint64_t threshold_ns, cfg_slow_cb_t hook, void* user) {
+    cfg_set_slow_hook_ctx(&cfg_g, threshold_ns, hook, user);
 }
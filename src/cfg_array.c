@@ -0,0 +1,456 @@
+#include <math.h>
+#include <string.h>
+
+#include "cfg_private.h"
+#include "cfg_scan.h"
+
+/*
+ * array values, "ids = [1, 2, 3]", stored as a single block of contiguous items. the items of an array
+ * all have the type of the first one, an array holding a decimal point anywhere is an array of floats.
+ * numeric arrays can't hold a comma but as a separator, so the commas counted 16 or 32 bytes at a time
+ * give the exact number of items and the block is allocated once, then every item is found with the
+ * same scanner and converted by the number parsers, eight digits at a time. a string array may hold
+ * commas in its strings, the count is then an upper bound.
+*/
+
+/**
+ * @brief checks wether the provided character is a whitespace, like the parser does
+ * @param c character to check
+ * @returns true if the character is a whitespace, false otherwise
+*/
+static bool cfg_array_is_whitespace(char c) {
+    return c == '\r' || c == ' ' || c == '\t';
+}
+
+/**
+ * @brief gets the size of an item
+ * @param type type of the items
+ * @returns size of an item, 0 for an empty array
+*/
+static size_t cfg_array_item_size(enum cfg_setting_type_e type) {
+    switch (type) {
+        case CFG_STYPE_INT: {
+            return sizeof(long long);
+        }
+        case CFG_STYPE_FLOAT: {
+            return sizeof(cfg_float_t);
+        }
+        case CFG_STYPE_STRING: {
+            return sizeof(cfg_string_span_t);
+        }
+        case CFG_STYPE_BOOL:
+        case CFG_STYPE_ARRAY:
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief gets the items between the brackets of an array token, without the whitespaces before the first one
+ * @param str pointer to the serialized value token
+ * @param len length of the token
+ * @param body (out) first character of the first item
+ * @param body_len (out) length from there to the closing bracket
+ * @returns CFG_SUCCESS, or CFG_EARRAY if the token isn't an array
+*/
+static int cfg_array_body(const char* str, size_t len, const char** body, size_t* body_len) {
+    size_t start = 1;
+
+    if (len < 2 || str[0] != '[' || str[len - 1] != ']') {
+        return CFG_EARRAY;
+    }
+
+    while (start < len - 1 && cfg_array_is_whitespace(str[start])) {
+        start += 1;
+    }
+
+    *body = &str[start];
+    *body_len = len - 1 - start;
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief gets a number item, trimmed of its whitespaces
+ * @param str pointer to the item
+ * @param len length of the item
+ * @param start (out) position of the number
+ * @returns length of the number, 0 if the item is empty
+*/
+static size_t cfg_array_trim(const char* str, size_t len, size_t* start) {
+    size_t i = 0;
+
+    while (i < len && cfg_array_is_whitespace(str[i])) {
+        i += 1;
+    }
+    while (len > i && cfg_array_is_whitespace(str[len - 1])) {
+        len -= 1;
+    }
+
+    *start = i;
+
+    return len - i;
+}
+
+/**
+ * @brief checks an array token and measures the block it is decoded into, see cfg_array_decode
+ * @param str pointer to the serialized value token, from its opening to its closing bracket
+ * @param len length of the token
+ * @param copy true if the strings are copied into the block, false if they point into the token
+ * @param shape (out) type of the items and number of items the block holds
+ * @param size (out) size of the block
+ * @returns CFG_SUCCESS, or CFG_EARRAY if the token isn't an array of numbers or strings
+*/
+int cfg_array_measure(const char* str, size_t len, bool copy, cfg_array_t* shape, size_t* size) {
+    const char* body;
+    size_t body_len;
+    int errnum = cfg_array_body(str, len, &body, &body_len);
+
+    if (errnum != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    shape->len = 0;
+    shape->type = CFG_STYPE_UNKNOWN;
+    *size = sizeof(cfg_array_t);
+
+    if (body_len == 0) {
+        return CFG_SUCCESS;
+    }
+
+    if (body[0] == '"') {
+        shape->type = CFG_STYPE_STRING;
+    } else if (body[0] == '-' || (body[0] >= '0' && body[0] <= '9')) {
+        shape->type = memchr(body, '.', body_len) != NULL ? CFG_STYPE_FLOAT : CFG_STYPE_INT;
+    } else {
+        return CFG_EARRAY;
+    }
+
+    shape->len = cfg_scan_count(body, body_len, ',') + 1;
+    *size += shape->len * cfg_array_item_size(shape->type);
+
+    /* a string takes its quotes in the token and its NUL in the copy */
+    if (shape->type == CFG_STYPE_STRING && copy) {
+        *size += body_len;
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief decodes the numbers of an array, the items are separated by the only commas of the token
+ * @param body first item
+ * @param body_len length from there to the closing bracket
+ * @param array (in, out) block measured by cfg_array_measure, receives the items
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_array_decode_numbers(const char* body, size_t body_len, cfg_array_t* array) {
+    long long* integers = (long long*)(void*)array->items;
+    cfg_float_t* floats = (cfg_float_t*)(void*)array->items;
+    size_t pos = 0;
+    size_t end;
+    size_t start;
+    size_t len;
+    int errnum;
+
+    for (size_t i = 0; i < array->len; i++) {
+        end = cfg_scan_find(body, pos, body_len, ',', ',');
+        len = cfg_array_trim(&body[pos], end - pos, &start);
+        start += pos;
+
+        if (len == 0 || !cfg_is_number_syntax_valid(&body[start], len)) {
+            return CFG_EARRAY;
+        }
+
+        if (array->type == CFG_STYPE_INT) {
+            errnum = cfg_parse_integer_value(&body[start], len, &integers[i]);
+        } else {
+            errnum = cfg_parse_floating_value(&body[start], len, &floats[i]);
+        }
+
+        /* "-" passes the syntax check, it isn't a number either */
+        if (errnum != CFG_SUCCESS) {
+            return errnum == CFG_ERANGE || errnum == CFG_EMEM ? errnum : CFG_EARRAY;
+        }
+
+        pos = end + 1;
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief decodes the strings of an array, quoted and separated by commas, without escapes
+ * @param body first item, an opening quote
+ * @param body_len length from there to the closing bracket
+ * @param copy true if the strings are copied after the items
+ * @param array (in, out) block measured by cfg_array_measure, receives the items and their number
+ * @returns CFG_SUCCESS, or CFG_EARRAY if an item isn't a string
+*/
+static int cfg_array_decode_strings(const char* body, size_t body_len, bool copy, cfg_array_t* array) {
+    cfg_string_span_t* spans = (cfg_string_span_t*)(void*)array->items;
+    char* copies = (char*)&spans[array->len];
+    size_t pos = 0;
+    size_t end;
+    size_t n = 0;
+
+    while (true) {
+        if (pos == body_len || body[pos] != '"') {
+            return CFG_EARRAY;
+        }
+
+        end = cfg_scan_find(body, pos + 1, body_len, '"', '"');
+        if (end == body_len) {
+            return CFG_EARRAY;
+        }
+
+        spans[n].len = end - pos - 1;
+        spans[n].ptr = &body[pos + 1];
+        if (copy) {
+            memcpy(copies, spans[n].ptr, spans[n].len);
+            copies[spans[n].len] = '\0';
+            spans[n].ptr = copies;
+            copies += spans[n].len + 1;
+        }
+        n += 1;
+
+        for (pos = end + 1; pos < body_len && cfg_array_is_whitespace(body[pos]); pos++);
+        if (pos == body_len) {
+            break;
+        }
+        if (body[pos] != ',') {
+            return CFG_EARRAY;
+        }
+        for (pos += 1; pos < body_len && cfg_array_is_whitespace(body[pos]); pos++);
+    }
+
+    array->len = n;
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief decodes an array token into a block measured by cfg_array_measure
+ * @param str pointer to the serialized value token, checked by cfg_array_measure
+ * @param len length of the token
+ * @param copy true to copy the strings into the block, false to point into the token
+ * @param array (in, out) block of the measured size, with the shape given by cfg_array_measure. receives
+ * the items, and their number
+ * @returns CFG_SUCCESS, or an error number: CFG_EARRAY for an item that isn't of the type of the first one,
+ * CFG_ERANGE for a number out of range
+*/
+int cfg_array_decode(const char* str, size_t len, bool copy, cfg_array_t* array) {
+    const char* body;
+    size_t body_len;
+
+    cfg_array_body(str, len, &body, &body_len);
+
+    switch (array->type) {
+        case CFG_STYPE_INT:
+        case CFG_STYPE_FLOAT: {
+            return cfg_array_decode_numbers(body, body_len, array);
+        }
+        case CFG_STYPE_STRING: {
+            return cfg_array_decode_strings(body, body_len, copy, array);
+        }
+        case CFG_STYPE_BOOL:
+        case CFG_STYPE_ARRAY:
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief checks that an array value can be stored and written back in the config syntax
+ * @param value array value
+ * @returns CFG_SUCCESS, or an error number
+*/
+int cfg_array_check(const cfg_value_t* value) {
+    const cfg_float_t* floats = value->array;
+    const cfg_string_span_t* spans = value->array;
+
+    if (value->array_len == 0) {
+        return CFG_SUCCESS;
+    }
+
+    if (value->array == NULL) {
+        return CFG_EARRAY;
+    }
+
+    switch (value->array_type) {
+        case CFG_STYPE_INT: {
+            return CFG_SUCCESS;
+        }
+        case CFG_STYPE_FLOAT: {
+            for (size_t i = 0; i < value->array_len; i++) {
+                if (!isfinite(floats[i])) {
+                    return CFG_EINVFLOAT;
+                }
+            }
+            return CFG_SUCCESS;
+        }
+        case CFG_STYPE_STRING: {
+            /* a string item ends at its closing quote, the array at the end of the line or at a comment */
+            for (size_t i = 0; i < value->array_len; i++) {
+                if (memchr(spans[i].ptr, '\n', spans[i].len) != NULL || memchr(spans[i].ptr, '#', spans[i].len) != NULL
+                    || memchr(spans[i].ptr, '"', spans[i].len) != NULL) {
+                    return CFG_EINVSTRING;
+                }
+            }
+            return CFG_SUCCESS;
+        }
+        case CFG_STYPE_BOOL:
+        case CFG_STYPE_ARRAY:
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return CFG_EARRAY;
+}
+
+/**
+ * @brief measures the block holding a copy of an array value, checked by cfg_array_check
+ * @param value array value
+ * @returns size of the block
+*/
+size_t cfg_array_copy_size(const cfg_value_t* value) {
+    const cfg_string_span_t* spans = value->array;
+    size_t size = sizeof(cfg_array_t) + value->array_len * cfg_array_item_size(value->array_type);
+
+    for (size_t i = 0; value->array_type == CFG_STYPE_STRING && i < value->array_len; i++) {
+        size += spans[i].len + 1;
+    }
+
+    return size;
+}
+
+/**
+ * @brief copies an array value into a block, strings included
+ * @param array (out) block of cfg_array_copy_size bytes
+ * @param value array value
+*/
+void cfg_array_copy(cfg_array_t* array, const cfg_value_t* value) {
+    const cfg_string_span_t* spans = value->array;
+    cfg_string_span_t* copy_spans = (cfg_string_span_t*)(void*)array->items;
+    char* copies = (char*)&copy_spans[value->array_len];
+
+    array->len = value->array_len;
+    array->type = value->array_len == 0 ? CFG_STYPE_UNKNOWN : value->array_type;
+
+    if (array->type != CFG_STYPE_STRING) {
+        memcpy(array->items, value->array, array->len * cfg_array_item_size(array->type));
+        return;
+    }
+
+    for (size_t i = 0; i < array->len; i++) {
+        memcpy(copies, spans[i].ptr, spans[i].len);
+        copies[spans[i].len] = '\0';
+        copy_spans[i].ptr = copies;
+        copy_spans[i].len = spans[i].len;
+        copies += spans[i].len + 1;
+    }
+}
+
+/**
+ * @brief describes an array as a value, the items stay in the array
+ * @param array array
+ * @param value (out) array value
+*/
+void cfg_array_value(const cfg_array_t* array, cfg_value_t* value) {
+    value->type = CFG_STYPE_ARRAY;
+    value->array = array->items;
+    value->array_len = array->len;
+    value->array_type = array->type;
+}
+
+/**
+ * @brief compares two arrays
+ * @param a array
+ * @param b array
+ * @returns true if both have the same items
+*/
+bool cfg_array_equal(const cfg_array_t* a, const cfg_array_t* b) {
+    const cfg_float_t* a_floats = (const cfg_float_t*)(const void*)a->items;
+    const cfg_float_t* b_floats = (const cfg_float_t*)(const void*)b->items;
+    const cfg_string_span_t* a_spans = (const cfg_string_span_t*)(const void*)a->items;
+    const cfg_string_span_t* b_spans = (const cfg_string_span_t*)(const void*)b->items;
+
+    if (a->type != b->type || a->len != b->len) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a->len; i++) {
+        switch (a->type) {
+            case CFG_STYPE_INT: {
+                if (((const long long*)(const void*)a->items)[i] != ((const long long*)(const void*)b->items)[i]) {
+                    return false;
+                }
+                break;
+            }
+            case CFG_STYPE_FLOAT: {
+                /* long doubles have padding bytes, the items are compared as numbers */
+                if (a_floats[i] < b_floats[i] || a_floats[i] > b_floats[i]) {
+                    return false;
+                }
+                break;
+            }
+            case CFG_STYPE_STRING: {
+                if (a_spans[i].len != b_spans[i].len || memcmp(a_spans[i].ptr, b_spans[i].ptr, a_spans[i].len) != 0) {
+                    return false;
+                }
+                break;
+            }
+            case CFG_STYPE_BOOL:
+            case CFG_STYPE_ARRAY:
+            case CFG_STYPE_UNKNOWN: {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief get an array setting value of a configuration as a pointer to its items and their number. the
+ * items are contiguous, of the type asked for: long long, cfg_float_t or cfg_string_span_t. the strings
+ * are NUL terminated unless in zero-copy mode. an empty array reads as an array of any type
+ * @param cfg configuration object
+ * @param identifier identifier string
+ * @param type type of the items
+ * @param items (out) pointer to the first item, valid until the configuration is freed
+ * @param len (out) number of items
+ * @returns 0 on success, 1 otherwise with the configuration error set: CFG_EARRAY if the setting isn't
+ * an array, CFG_EINVINT, CFG_EINVFLOAT or CFG_EINVSTRING if its items have another type
+*/
+int cfg_get_array_ctx(cfg_t* cfg, const char* identifier, enum cfg_setting_type_e type, const void** items, size_t* len) {
+    cfg_setting_t tmp;
+    cfg_setting_t* setting = cfg_lookup(cfg, identifier, strlen(identifier), &tmp);
+
+    if (setting == NULL) {
+        cfg_set_errnum(cfg, CFG_ENEXIST);
+        return 1;
+    }
+
+    if (setting->type != CFG_STYPE_ARRAY) {
+        cfg_set_errnum(cfg, CFG_EARRAY);
+        return 1;
+    }
+
+    if (setting->array->len != 0 && setting->array->type != type) {
+        cfg_set_errnum(cfg, cfg_bind_type_error(type));
+        return 1;
+    }
+
+    *items = setting->array->items;
+    *len = setting->array->len;
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <string.h>
+
+#include "cfg_private.h"
+
+/*
+ * structs and config files tend to list their fields in the same order, so the bindings are matched
+ * against the settings with a cursor walking the settings table: a binding whose identifier is
+ * the one of the setting under the cursor, or of one of the next few, is filled without hashing
+ * its identifier. the others are looked up like the getters do, and the cursor jumps after the
+ * setting found if it is close enough. it is given up after a run of misses, when the orders
+ * don't match. it is only used when no identifier is duplicated, so the setting it finds is
+ * always the one a lookup would find.
+*/
+
+/* settings the cursor may skip to find the identifier of a binding */
+#define CFG_BIND_WINDOW 4
+
+/* settings the cursor may skip to catch up with a setting that was looked up */
+#define CFG_BIND_RESYNC 32
+
+/* misses in a row after which the cursor is given up */
+#define CFG_BIND_MAX_MISSES 8
+
+/**
+ * @brief gets the error of a setting of the wrong type for a binding, or for cfg_get_array_ctx
+ * @param type type expected
+ * @returns error number
+*/
+int cfg_bind_type_error(enum cfg_setting_type_e type) {
+    switch (type) {
+        case CFG_STYPE_INT: {
+            return CFG_EINVINT;
+        }
+        case CFG_STYPE_FLOAT: {
+            return CFG_EINVFLOAT;
+        }
+        case CFG_STYPE_STRING: {
+            return CFG_EINVSTRING;
+        }
+        case CFG_STYPE_BOOL: {
+            return CFG_EINVBOOL;
+        }
+        case CFG_STYPE_ARRAY: {
+            return CFG_EARRAY;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return CFG_EHUH;
+}
+
+/**
+ * @brief writes the value of a setting to the field of a binding
+ * @param binding binding
+ * @param setting setting with the identifier of the binding
+ * @param out_struct struct holding the field
+ * @returns error number of the binding
+*/
+static int cfg_bind_setting(const cfg_binding_t* binding, const cfg_setting_t* setting, void* out_struct) {
+    void* field = (char*)out_struct + binding->offset;
+
+    if (setting->errnum != CFG_SUCCESS) {
+        return setting->errnum;
+    }
+
+    if (setting->type != binding->type) {
+        return cfg_bind_type_error(binding->type);
+    }
+
+    switch (setting->type) {
+        case CFG_STYPE_INT: {
+            memcpy(field, &setting->integer, sizeof(long long));
+            break;
+        }
+        case CFG_STYPE_FLOAT: {
+            memcpy(field, &setting->floating, sizeof(cfg_float_t));
+            break;
+        }
+        case CFG_STYPE_STRING: {
+            if (setting->view) {
+                return CFG_EVIEW;
+            }
+            memcpy(field, &setting->string, sizeof(char*));
+            break;
+        }
+        case CFG_STYPE_BOOL: {
+            memcpy(field, &setting->boolean, sizeof(bool));
+            break;
+        }
+        case CFG_STYPE_ARRAY: {
+            /* an array doesn't fit a field, it is read with cfg_get_array_ctx */
+            return CFG_EARRAY;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            return CFG_EHUH;
+        }
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief writes the default value of a binding to its field
+ * @param binding binding
+ * @param out_struct struct holding the field
+ * @returns error number of the binding
+*/
+static int cfg_bind_default(const cfg_binding_t* binding, void* out_struct) {
+    void* field = (char*)out_struct + binding->offset;
+
+    switch (binding->type) {
+        case CFG_STYPE_INT: {
+            memcpy(field, &binding->integer, sizeof(long long));
+            break;
+        }
+        case CFG_STYPE_FLOAT: {
+            memcpy(field, &binding->floating, sizeof(cfg_float_t));
+            break;
+        }
+        case CFG_STYPE_STRING: {
+            memcpy(field, &binding->string, sizeof(char*));
+            break;
+        }
+        case CFG_STYPE_BOOL: {
+            memcpy(field, &binding->boolean, sizeof(bool));
+            break;
+        }
+        case CFG_STYPE_ARRAY: {
+            return CFG_EARRAY;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            return CFG_EHUH;
+        }
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief fills a struct with the settings of a configuration in a single call, checking the types
+ * and reporting every missing or mistyped field. a field is only written when its binding succeeds,
+ * an optional binding whose setting is missing gets its default. strings are not copied
+ * @param cfg configuration object
+ * @param table bindings of the settings to the struct fields
+ * @param n number of bindings
+ * @param out_struct (out) struct to fill
+ * @param errors (out) error number of every binding, may be NULL: CFG_SUCCESS, CFG_ENEXIST for a missing
+ * setting, CFG_EINVINT, CFG_EINVFLOAT, CFG_EINVSTRING or CFG_EINVBOOL for a setting of another type
+ * than expected, CFG_EVIEW for a zero-copy string, CFG_EARRAY for a binding of an array
+ * @returns 0 on success, 1 otherwise with the configuration error set to the error of the first failed binding
+*/
+int cfg_bind_ctx(cfg_t* cfg, const cfg_binding_t* table, size_t n, void* out_struct, int* errors) {
+    int errnum = CFG_SUCCESS;
+    int status;
+    size_t misses = cfg->duplicates == 0 && cfg->image == NULL ? 0 : CFG_BIND_MAX_MISSES;
+    size_t cursor = 0;
+    size_t len;
+    size_t end;
+    cfg_setting_t tmp;
+    cfg_setting_t* setting;
+
+    for (size_t b = 0; b < n; b++) {
+        len = strlen(table[b].identifier);
+        setting = NULL;
+
+        end = misses < CFG_BIND_MAX_MISSES ? cursor + CFG_BIND_WINDOW : cursor;
+        for (size_t i = cursor; i < end && i < cfg->settings_len; i++) {
+            if (cfg->identifier_lens[i] == len && memcmp(cfg->identifiers[i], table[b].identifier, len) == 0
+                && (cfg->types[i] & CFG_SETTING_TYPE) != CFG_STYPE_UNKNOWN) {
+                setting = cfg_setting_at(cfg, i, &tmp);
+                cursor = i + 1;
+                misses = 0;
+                cfg_stats_lookup(cfg, setting);
+                break;
+            }
+        }
+
+        if (setting == NULL) {
+            setting = cfg_lookup(cfg, table[b].identifier, len, &tmp);
+            misses += misses < CFG_BIND_MAX_MISSES;
+
+            end = misses < CFG_BIND_MAX_MISSES ? cursor + CFG_BIND_RESYNC : cursor;
+            for (size_t i = cursor; setting != NULL && i < end && i < cfg->settings_len; i++) {
+                if (cfg->identifiers[i] == setting->identifier) {
+                    cursor = i + 1;
+                    break;
+                }
+            }
+        }
+
+        if (setting != NULL) {
+            status = cfg_bind_setting(&table[b], setting, out_struct);
+        } else if (table[b].optional) {
+            status = cfg_bind_default(&table[b], out_struct);
+        } else {
+            status = CFG_ENEXIST;
+        }
+
+        if (errors != NULL) {
+            errors[b] = status;
+        }
+        if (errnum == CFG_SUCCESS) {
+            errnum = status;
+        }
+    }
+
+    if (errnum != CFG_SUCCESS) {
+        cfg_set_errnum(cfg, errnum);
+        return 1;
+    }
+
+    return 0;
+}
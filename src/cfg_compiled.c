@@ -0,0 +1,556 @@
+/* st_mtim of struct stat, also with -std=c2x */
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <float.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cfg_private.h"
+
+/*
+ * compiled config layout, in native byte order, every section aligned on 16 bytes:
+ *  header       magic, version, build properties, section offsets, source stamp and a hash of the header
+ *  index        open addressing table of cfg_index_slot_t, hash of the identifier and record position + 1
+ *  records      one cfg_image_setting_t per identifier, first occurrence in file order, typed value inline
+ *  string pool  NUL terminated identifiers and strings, referenced by offset
+ * the image is trusted once its header checks out, lookups read it in place through the mapping
+*/
+
+#define CFG_IMAGE_MAGIC "libcfg\x1a\x0a"
+#define CFG_IMAGE_VERSION 1
+#define CFG_IMAGE_ENDIAN 0x01020304
+#define CFG_IMAGE_ALIGN 16
+
+#ifdef CFG_FLOAT_DOUBLE
+#define CFG_IMAGE_FLOAT_MANT_DIG DBL_MANT_DIG
+#else
+#define CFG_IMAGE_FLOAT_MANT_DIG LDBL_MANT_DIG
+#endif
+
+typedef struct cfg_image_header_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint32_t float_size; /* sizeof(cfg_float_t) and its mantissa, images are only valid for the same build */
+    uint32_t float_mant_dig;
+    uint64_t settings_len;
+    uint64_t index_cap;
+    uint64_t index_off;
+    uint64_t settings_off;
+    uint64_t pool_off;
+    uint64_t size;
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t source_hash;
+    uint64_t header_hash; /* hash of everything above */
+} cfg_image_header_t;
+
+typedef struct cfg_image_setting_s {
+    uint64_t identifier;
+    uint32_t identifier_len;
+    uint32_t type;
+    union {
+        long long integer;
+        cfg_float_t floating;
+        struct {
+            uint64_t string;
+            uint64_t string_len;
+        };
+        bool boolean;
+    };
+} cfg_image_setting_t;
+
+/**
+ * @brief hashes a buffer (64 bit FNV-1a)
+ * @param ptr pointer to the buffer
+ * @param len length of the buffer
+ * @returns hash of the buffer
+*/
+static uint64_t cfg_hash64(const void* ptr, size_t len) {
+    const unsigned char* str = ptr;
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= str[i];
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+/**
+ * @brief rounds an offset up to the image alignment
+ * @param off offset
+ * @returns aligned offset
+*/
+static size_t cfg_image_align(size_t off) {
+    return (off + CFG_IMAGE_ALIGN - 1) & ~(size_t)(CFG_IMAGE_ALIGN - 1);
+}
+
+/**
+ * @brief gets the number of settings in the compiled config of a configuration
+ * @param cfg configuration object
+ * @returns number of settings, 0 without compiled config
+*/
+size_t cfg_image_len(const cfg_t* cfg) {
+    if (cfg->image == NULL) {
+        return 0;
+    }
+
+    return (size_t)((const cfg_image_header_t*)(const void*)cfg->image)->settings_len;
+}
+
+/**
+ * @brief decodes a record of the compiled config, identifiers and strings keep pointing into the image
+ * @param cfg configuration object
+ * @param i position of the record
+ * @param hash hash of the identifier of the record
+ * @param tmp (out) decoded setting
+ * @returns tmp
+*/
+static cfg_setting_t* cfg_image_decode(const cfg_t* cfg, size_t i, uint32_t hash, cfg_setting_t* tmp) {
+    const cfg_image_header_t* header = (const void*)cfg->image;
+    const cfg_image_setting_t* record = (const void*)(cfg->image + header->settings_off);
+    const unsigned char* pool = cfg->image + header->pool_off;
+
+    record = &record[i];
+    tmp->type = (enum cfg_setting_type_e)record->type;
+    tmp->view = false;
+    tmp->lazy = false;
+    tmp->errnum = CFG_SUCCESS;
+    tmp->identifier = (char*)(uintptr_t)(pool + record->identifier);
+    tmp->identifier_len = record->identifier_len;
+    tmp->hash = hash;
+
+    switch (tmp->type) {
+        case CFG_STYPE_INT: {
+            tmp->integer = record->integer;
+            break;
+        }
+        case CFG_STYPE_FLOAT: {
+            tmp->floating = record->floating;
+            break;
+        }
+        case CFG_STYPE_STRING: {
+            tmp->string = (char*)(uintptr_t)(pool + record->string);
+            tmp->string_len = (size_t)record->string_len;
+            break;
+        }
+        case CFG_STYPE_BOOL: {
+            tmp->boolean = record->boolean;
+            break;
+        }
+        case CFG_STYPE_ARRAY:
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return tmp;
+}
+
+/**
+ * @brief decodes a record of the compiled config, identifiers and strings keep pointing into the image
+ * @param cfg configuration object
+ * @param i position of the record
+ * @param tmp (out) decoded setting
+ * @returns tmp
+*/
+cfg_setting_t* cfg_image_setting(const cfg_t* cfg, size_t i, cfg_setting_t* tmp) {
+    const cfg_image_header_t* header = (const void*)cfg->image;
+    const cfg_image_setting_t* record = (const void*)(cfg->image + header->settings_off);
+
+    /* the records don't store the hash, the index does */
+    record = &record[i];
+
+    return cfg_image_decode(cfg, i, cfg_hash((const char*)cfg->image + header->pool_off + record->identifier, record->identifier_len), tmp);
+}
+
+/**
+ * @brief finds a setting in the compiled config of a configuration
+ * @param cfg configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param hash hash of the identifier
+ * @param tmp (out) decoded setting
+ * @returns tmp, NULL if the setting doesn't exist
+*/
+cfg_setting_t* cfg_image_find(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash, cfg_setting_t* tmp) {
+    const cfg_image_header_t* header = (const void*)cfg->image;
+    const cfg_index_slot_t* index = (const void*)(cfg->image + header->index_off);
+    const cfg_image_setting_t* records = (const void*)(cfg->image + header->settings_off);
+    const unsigned char* pool = cfg->image + header->pool_off;
+    size_t mask = (size_t)header->index_cap - 1;
+    const cfg_image_setting_t* record;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        if (index[i].setting == 0) {
+            return NULL;
+        }
+
+        if (index[i].hash == hash) {
+            record = &records[index[i].setting - 1];
+            if (record->identifier_len == len && memcmp(pool + record->identifier, identifier, len) == 0) {
+                return cfg_image_decode(cfg, index[i].setting - 1, hash, tmp);
+            }
+        }
+    }
+}
+
+/**
+ * @brief writes a buffer to a file, replacing it atomically
+ * @param path path to the file
+ * @param buf pointer to the buffer
+ * @param len length of the buffer
+ * @returns 0 on success, an error number otherwise
+*/
+static int cfg_write_file(const char* path, const void* buf, size_t len) {
+    char* tmp_path = malloc(strlen(path) + 32);
+    const char* ptr = buf;
+    ssize_t written;
+    int errnum = CFG_SUCCESS;
+    int fd;
+
+    if (tmp_path == NULL) {
+        return CFG_EMEM;
+    }
+
+    /* processes mapping the previous file keep it, the new one appears at once */
+    sprintf(tmp_path, "%s.%ld.tmp", path, (long)getpid());
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        free(tmp_path);
+        return CFG_EOPEN;
+    }
+
+    while (len > 0) {
+        written = write(fd, ptr, len);
+        if (written <= 0) {
+            errnum = CFG_EWRITE;
+            break;
+        }
+        ptr += written;
+        len -= (size_t)written;
+    }
+
+    if (close(fd) != 0 && errnum == CFG_SUCCESS) {
+        errnum = CFG_EWRITE;
+    }
+
+    if (errnum == CFG_SUCCESS && rename(tmp_path, path) != 0) {
+        errnum = CFG_EWRITE;
+    }
+
+    if (errnum != CFG_SUCCESS) {
+        unlink(tmp_path);
+    }
+
+    free(tmp_path);
+
+    return errnum;
+}
+
+/**
+ * @brief serializes the settings of a configuration into a compiled config
+ * @param cfg configuration object
+ * @param header header holding the source stamp, completed here
+ * @param len (out) length of the image
+ * @returns image allocated with malloc, NULL on failure
+*/
+static unsigned char* cfg_image_build(const cfg_t* cfg, cfg_image_header_t* header, size_t* len) {
+    size_t index_cap = 16;
+    size_t pool_len = 0;
+    size_t pool_pos = 0;
+    size_t n = 0;
+    unsigned char* image;
+    cfg_index_slot_t* index;
+    cfg_image_setting_t* records;
+    cfg_image_setting_t* record;
+    unsigned char* pool;
+    cfg_setting_t tmp;
+    cfg_setting_t* setting;
+
+    /* duplicates are dropped, lookups only ever see the first occurrence */
+    for (size_t i = 0; i < cfg->settings_len; i++) {
+        setting = cfg_setting_at(cfg, i, &tmp);
+        if (cfg_find_setting(cfg, setting->identifier, setting->identifier_len, setting->hash) == i) {
+            n += 1;
+            pool_len += setting->identifier_len + 1;
+            pool_len += setting->type == CFG_STYPE_STRING ? setting->string_len + 1 : 0;
+        }
+    }
+
+    while (index_cap < n * 2) {
+        index_cap *= 2;
+    }
+
+    memcpy(header->magic, CFG_IMAGE_MAGIC, sizeof(header->magic));
+    header->version = CFG_IMAGE_VERSION;
+    header->endian = CFG_IMAGE_ENDIAN;
+    header->float_size = sizeof(cfg_float_t);
+    header->float_mant_dig = CFG_IMAGE_FLOAT_MANT_DIG;
+    header->settings_len = n;
+    header->index_cap = index_cap;
+    header->index_off = cfg_image_align(sizeof(cfg_image_header_t));
+    header->settings_off = cfg_image_align(header->index_off + index_cap * sizeof(cfg_index_slot_t));
+    header->pool_off = cfg_image_align(header->settings_off + n * sizeof(cfg_image_setting_t));
+    header->size = header->pool_off + pool_len;
+    header->header_hash = cfg_hash64(header, offsetof(cfg_image_header_t, header_hash));
+
+    /* zeroed so that padding bytes are deterministic */
+    image = calloc(1, (size_t)header->size);
+    if (image == NULL) {
+        return NULL;
+    }
+
+    memcpy(image, header, sizeof(cfg_image_header_t));
+    index = (void*)(image + header->index_off);
+    records = (void*)(image + header->settings_off);
+    pool = image + header->pool_off;
+
+    n = 0;
+    for (size_t i = 0; i < cfg->settings_len; i++) {
+        setting = cfg_setting_at(cfg, i, &tmp);
+        if (cfg_find_setting(cfg, setting->identifier, setting->identifier_len, setting->hash) != i) {
+            continue;
+        }
+
+        record = &records[n];
+        record->type = setting->type;
+        record->identifier = pool_pos;
+        record->identifier_len = (uint32_t)setting->identifier_len;
+        memcpy(&pool[pool_pos], setting->identifier, setting->identifier_len);
+        pool_pos += setting->identifier_len + 1;
+
+        switch (setting->type) {
+            case CFG_STYPE_INT: {
+                record->integer = setting->integer;
+                break;
+            }
+            case CFG_STYPE_FLOAT: {
+                record->floating = setting->floating;
+                break;
+            }
+            case CFG_STYPE_STRING: {
+                record->string = pool_pos;
+                record->string_len = setting->string_len;
+                memcpy(&pool[pool_pos], setting->string, setting->string_len);
+                pool_pos += setting->string_len + 1;
+                break;
+            }
+            case CFG_STYPE_BOOL: {
+                record->boolean = setting->boolean;
+                break;
+            }
+            case CFG_STYPE_ARRAY:
+            case CFG_STYPE_UNKNOWN: {
+                break;
+            }
+        }
+
+        n += 1;
+        cfg_index_insert(index, index_cap, setting->hash, (uint32_t)n);
+    }
+
+    *len = (size_t)header->size;
+
+    return image;
+}
+
+/**
+ * @brief parses a config file and writes it as a compiled config, loaded by cfg_load_compiled without parsing.
+ * the compiled config is tied to the source file and to the build of the library. a config holding arrays
+ * fails with CFG_EARRAY, cfg_load_compiled then parses it
+ * @param text_path path to the config file
+ * @param bin_path path to the compiled config, replaced atomically
+ * @returns 0 on success, 1 otherwise with cfg_errno set
+*/
+int cfg_compile(const char* text_path, const char* bin_path) {
+    cfg_image_header_t header;
+    struct stat st;
+    unsigned char* image = NULL;
+    char* raw_ptr;
+    size_t raw_len;
+    size_t len;
+    cfg_t cfg;
+    int status = 1;
+
+    cfg_init(&cfg);
+    memset(&header, 0, sizeof(header));
+
+    if (stat(text_path, &st) != 0) {
+        cfg.errnum = CFG_EOPEN;
+        goto cfg_compile_end;
+    }
+
+    if (cfg_map_file(&cfg, text_path, &raw_ptr, &raw_len) != 0) {
+        goto cfg_compile_end;
+    }
+
+    header.source_size = raw_len;
+    header.source_mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    header.source_mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    header.source_hash = cfg_hash64(raw_ptr, raw_len);
+
+    if (cfg_parse_ctx(&cfg, raw_ptr, raw_len, CFG_FLAG_NONE) != 0) {
+        munmap(raw_ptr, raw_len);
+        goto cfg_compile_end;
+    }
+    munmap(raw_ptr, raw_len);
+
+    /* a record holds a single value, arrays are left to the text parser */
+    for (size_t i = 0; i < cfg.settings_len; i++) {
+        if ((cfg.types[i] & CFG_SETTING_TYPE) == CFG_STYPE_ARRAY) {
+            cfg.errnum = CFG_EARRAY;
+            goto cfg_compile_end;
+        }
+    }
+
+    image = cfg_image_build(&cfg, &header, &len);
+    if (image == NULL) {
+        cfg.errnum = CFG_EMEM;
+        goto cfg_compile_end;
+    }
+
+    cfg.errnum = cfg_write_file(bin_path, image, len);
+    status = cfg.errnum != CFG_SUCCESS;
+
+cfg_compile_end:
+    if (status != 0) {
+        cfg_errno = cfg.errnum;
+    }
+
+    free(image);
+    cfg_clear(&cfg);
+
+    return status;
+}
+
+/**
+ * @brief checks that a compiled config was built from the current source file, by size and
+ * modification time, or by content when only the time changed
+ * @param header header of the compiled config
+ * @param text_path path to the config file
+ * @returns true if the compiled config is up to date
+*/
+static bool cfg_image_is_fresh(const cfg_image_header_t* header, const char* text_path) {
+    struct stat st;
+    void* raw_ptr;
+    bool fresh;
+    int fd;
+
+    fd = open(text_path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != header->source_size || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    if (st.st_mtim.tv_sec == header->source_mtime_sec && st.st_mtim.tv_nsec == header->source_mtime_nsec) {
+        close(fd);
+        return true;
+    }
+
+    raw_ptr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (raw_ptr == MAP_FAILED) {
+        return false;
+    }
+
+    fresh = cfg_hash64(raw_ptr, (size_t)st.st_size) == header->source_hash;
+    munmap(raw_ptr, (size_t)st.st_size);
+
+    return fresh;
+}
+
+/**
+ * @brief maps a compiled config into a configuration if it is valid and up to date
+ * @param cfg configuration object
+ * @param text_path path to the config file
+ * @param bin_path path to the compiled config
+ * @returns 0 on success, 1 if the text parser must be used instead
+*/
+static int cfg_image_open(cfg_t* cfg, const char* text_path, const char* bin_path) {
+    const cfg_image_header_t* header;
+    struct stat st;
+    unsigned char* image;
+    size_t len;
+    char* path;
+    int fd;
+
+    fd = open(bin_path, O_RDONLY);
+    if (fd == -1) {
+        return 1;
+    }
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(cfg_image_header_t)) {
+        close(fd);
+        return 1;
+    }
+
+    len = (size_t)st.st_size;
+    image = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        return 1;
+    }
+
+    header = (const void*)image;
+    if (memcmp(header->magic, CFG_IMAGE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != CFG_IMAGE_VERSION
+        || header->endian != CFG_IMAGE_ENDIAN
+        || header->float_size != sizeof(cfg_float_t)
+        || header->float_mant_dig != CFG_IMAGE_FLOAT_MANT_DIG
+        || header->header_hash != cfg_hash64(header, offsetof(cfg_image_header_t, header_hash))
+        || header->size != len
+        || header->index_cap == 0 || (header->index_cap & (header->index_cap - 1)) != 0
+        || header->index_off + header->index_cap * sizeof(cfg_index_slot_t) > header->settings_off
+        || header->settings_off + header->settings_len * sizeof(cfg_image_setting_t) > header->pool_off
+        || header->pool_off > len
+        || !cfg_image_is_fresh(header, text_path)) {
+        munmap(image, len);
+        return 1;
+    }
+
+    path = strdup(text_path);
+    if (path == NULL || cfg_keep_mapping(cfg, (char*)image, len) != 0) {
+        free(path);
+        munmap(image, len);
+        return 1;
+    }
+
+    free(cfg->path);
+    cfg->path = path;
+    cfg->image = image;
+
+    return 0;
+}
+
+/**
+ * @brief loads a compiled config into a configuration, nothing is parsed nor allocated per setting:
+ * the file is mapped and lookups read it in place. the text parser is used instead if the compiled
+ * config is missing, invalid, built by another version of the library or out of date with the config
+ * file, and if the configuration already holds settings or uses a schema
+ * @param cfg configuration object
+ * @param text_path path to the config file
+ * @param bin_path path to the compiled config
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_load_compiled_ctx(cfg_t* cfg, const char* text_path, const char* bin_path) {
+    cfg_tree_drop(cfg);
+
+    if (cfg->settings_len == 0 && cfg->image == NULL && cfg->schema == NULL && cfg_image_open(cfg, text_path, bin_path) == 0) {
+        return 0;
+    }
+
+    return cfg_load_ctx(cfg, text_path, CFG_FLAG_NONE);
+}
@@ -0,0 +1,341 @@
+#include <string.h>
+
+#include "cfg_private.h"
+#include "cfg_scan.h"
+
+/**
+ * @brief makes room for more lines in the line index, sentinel included
+ * @param cfg configuration object
+ * @param n number of lines the index must hold
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_reserve_lines(cfg_t* cfg, size_t n) {
+    size_t cap = cfg->lines_cap == 0 ? 64 : cfg->lines_cap;
+    void* tmp;
+
+    if (n + 1 <= cfg->lines_cap) {
+        return 0;
+    }
+
+    while (cap < n + 1) {
+        cap *= 2;
+    }
+
+    tmp = realloc(cfg->lines, sizeof(cfg_line_t) * cap);
+    if (tmp == NULL) {
+        cfg->errnum = CFG_EMEM;
+        return 1;
+    }
+
+    cfg->lines = tmp;
+    cfg->lines_cap = cap;
+
+    return 0;
+}
+
+/**
+ * @brief builds the line index of a buffer that was parsed successfully. every line that isn't
+ * blank or a comment then holds exactly one setting, in file order
+ * @param cfg configuration object
+ * @param str pointer to the buffer
+ * @param len length of the buffer
+ * @param base position of the first setting of the buffer
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_index_lines(cfg_t* cfg, const char* str, size_t len, size_t base) {
+    size_t pos = 0;
+    size_t end;
+    size_t c;
+    uint32_t before = (uint32_t)base;
+    cfg_line_t* line;
+
+    cfg->lines_len = 0;
+
+    while (pos < len) {
+        end = cfg_scan_find(str, pos, len, '\n', '\n');
+        end = end < len ? end + 1 : len;
+
+        if (cfg->lines_len + 1 >= cfg->lines_cap && cfg_reserve_lines(cfg, cfg->lines_len + 1) != 0) {
+            free(cfg->lines);
+            cfg->lines = NULL;
+            cfg->lines_len = 0;
+            cfg->lines_cap = 0;
+            return 1;
+        }
+
+        for (c = pos; c < end && (str[c] == ' ' || str[c] == '\t' || str[c] == '\r'); c++);
+
+        line = &cfg->lines[cfg->lines_len];
+        line->start = pos;
+        line->before = before;
+        line->setting = c < end && str[c] != '\n' && str[c] != '#';
+        before += line->setting;
+        cfg->lines_len += 1;
+        pos = end;
+    }
+
+    if (cfg_reserve_lines(cfg, cfg->lines_len) != 0) {
+        free(cfg->lines);
+        cfg->lines = NULL;
+        cfg->lines_len = 0;
+        cfg->lines_cap = 0;
+        return 1;
+    }
+
+    cfg->lines[cfg->lines_len].start = len;
+    cfg->lines[cfg->lines_len].before = before;
+    cfg->lines[cfg->lines_len].setting = false;
+    cfg->text_len = len;
+
+    return 0;
+}
+
+/**
+ * @brief finds the line holding a byte of the indexed buffer
+ * @param cfg configuration object
+ * @param pos offset of the byte
+ * @returns line index, the last line for offsets past the end
+*/
+static size_t cfg_find_line(const cfg_t* cfg, size_t pos) {
+    size_t low = 0;
+    size_t high = cfg->lines_len;
+    size_t mid;
+
+    /* the greatest line starting at or before pos */
+    while (high - low > 1) {
+        mid = low + (high - low) / 2;
+        if (cfg->lines[mid].start <= pos) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief removes the index slot of a setting, the following slots of the cluster are shifted back
+ * so that linear probing still finds them
+ * @param cfg configuration object
+ * @param setting position of the setting
+ * @returns true if the setting was indexed, false if it is a duplicate
+*/
+static bool cfg_index_remove(cfg_t* cfg, uint32_t setting) {
+    size_t mask = cfg->index_cap - 1;
+    size_t i = cfg->hashes[setting] & mask;
+    size_t j;
+    size_t home;
+
+    while (cfg->index[i].setting != setting + 1) {
+        if (cfg->index[i].setting == 0) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+
+    for (j = i;;) {
+        cfg->index[i].setting = 0;
+
+        for (;;) {
+            j = (j + 1) & mask;
+            if (cfg->index[j].setting == 0) {
+                cfg->index_len -= 1;
+                return true;
+            }
+
+            /* a slot whose home lies cyclically in (i, j] stays where it is */
+            home = cfg->index[j].hash & mask;
+            if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+                continue;
+            }
+            break;
+        }
+
+        cfg->index[i] = cfg->index[j];
+        i = j;
+    }
+}
+
+/**
+ * @brief rebuilds the index from the settings table, used when the edit involves duplicated identifiers
+ * or schema slots
+ * @param cfg configuration object
+*/
+static void cfg_index_rebuild(cfg_t* cfg) {
+    memset(cfg->index, 0, sizeof(cfg_index_slot_t) * cfg->index_cap);
+    if (cfg->slots != NULL) {
+        memset(cfg->slots, 0, sizeof(uint32_t) * cfg->schema->len);
+    }
+    cfg->index_len = 0;
+    cfg->duplicates = 0;
+
+    for (size_t i = 0; i < cfg->settings_len; i++) {
+        cfg_index_setting(cfg, i);
+    }
+}
+
+/**
+ * @brief replaces settings of the table with the ones of another configuration, in place.
+ * room must have been made for the new settings, in the table and in the index
+ * @param cfg configuration object
+ * @param from position of the first replaced setting
+ * @param to position after the last replaced setting
+ * @param part configuration object holding the new settings
+*/
+static void cfg_splice_settings(cfg_t* cfg, uint32_t from, uint32_t to, const cfg_t* part) {
+    size_t added = part->settings_len;
+    size_t removed = to - from;
+    bool rebuild = cfg->duplicates != 0 || cfg->slots != NULL;
+
+    cfg_tree_drop(cfg);
+    cfg_strings_drop(cfg);
+
+    /* removing the only occurrence of an identifier just frees its slot */
+    for (uint32_t i = from; i < to && !rebuild; i++) {
+        cfg_index_remove(cfg, i);
+    }
+
+    if (added != removed) {
+        cfg_move_settings(cfg, from + added, cfg, to, cfg->settings_len - to);
+    }
+    cfg_move_settings(cfg, from, part, 0, added);
+    cfg->settings_len = cfg->settings_len - removed + added;
+
+    if (rebuild) {
+        cfg_index_rebuild(cfg);
+        return;
+    }
+
+    /* the settings after the edit moved */
+    if (added != removed) {
+        for (size_t i = 0; i < cfg->index_cap; i++) {
+            if (cfg->index[i].setting > to) {
+                cfg->index[i].setting = (uint32_t)(cfg->index[i].setting - removed + added);
+            }
+        }
+    }
+
+    for (size_t i = from; i < from + added; i++) {
+        /* an identifier that exists elsewhere may shadow or be shadowed, let the rebuild sort it out */
+        if (cfg_find_setting(cfg, cfg->identifiers[i], cfg->identifier_lens[i], cfg->hashes[i]) != CFG_SETTING_NONE) {
+            cfg_index_rebuild(cfg);
+            return;
+        }
+
+        cfg_index_insert(cfg->index, cfg->index_cap, cfg->hashes[i], (uint32_t)(i + 1));
+        cfg->index_len += 1;
+    }
+}
+
+/**
+ * @brief replaces lines of the line index with the ones of another configuration
+ * @param cfg configuration object
+ * @param first first replaced line
+ * @param end line after the last replaced line
+ * @param part configuration object holding the new lines, relative to pos
+ * @param pos offset of the first replaced line
+ * @param len new length of the buffer
+*/
+static void cfg_splice_lines(cfg_t* cfg, size_t first, size_t end, const cfg_t* part, size_t pos, size_t len) {
+    uint32_t before = cfg->lines[first].before;
+    size_t removed = cfg->lines[end].before - before;
+    cfg_line_t* line;
+
+    /* the lines after the edit move, sentinel included */
+    if (part->lines_len != end - first) {
+        memmove(&cfg->lines[first + part->lines_len], &cfg->lines[end], sizeof(cfg_line_t) * (cfg->lines_len - end + 1));
+        cfg->lines_len = cfg->lines_len - (end - first) + part->lines_len;
+    }
+
+    for (size_t i = 0; i < part->lines_len; i++) {
+        line = &cfg->lines[first + i];
+        line->start = pos + part->lines[i].start;
+        line->before = before + part->lines[i].before;
+        line->setting = part->lines[i].setting;
+    }
+
+    /* and so do their offsets and settings unless the edit kept the same length and settings count */
+    for (size_t i = first + part->lines_len; i <= cfg->lines_len && (len != cfg->text_len || removed != part->settings_len); i++) {
+        line = &cfg->lines[i];
+        line->start = line->start - cfg->text_len + len;
+        line->before = (uint32_t)(line->before - removed + part->settings_len);
+    }
+
+    cfg->text_len = len;
+}
+
+/**
+ * @brief applies an edit to the buffer last parsed into a configuration with CFG_FLAG_INCREMENTAL.
+ * only the lines touched by the edit are parsed again, their settings are replaced in place and
+ * the others are kept, with the index patched rather than rebuilt. the configuration is left
+ * untouched if the edited lines don't parse, strings returned before stay valid until it is freed
+ * @param cfg configuration object
+ * @param str pointer to the edited buffer
+ * @param len length of the edited buffer
+ * @param edit_pos offset of the edit
+ * @param old_len number of bytes replaced at edit_pos
+ * @param new_len number of bytes replacing them
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_edit_ctx(cfg_t* cfg, const char* str, size_t len, size_t edit_pos, size_t old_len, size_t new_len) {
+    int status = 1;
+    size_t first = 0;
+    size_t end = 0;
+    size_t pos;
+    size_t removed;
+    cfg_t part;
+
+    if (cfg->lines == NULL || edit_pos > cfg->text_len || old_len > cfg->text_len - edit_pos
+        || len != cfg->text_len - old_len + new_len) {
+        cfg->errnum = CFG_EEDIT;
+        return 1;
+    }
+
+    /* the edited lines, plus the one right after since the edit may join it */
+    if (cfg->lines_len != 0) {
+        first = cfg_find_line(cfg, edit_pos);
+        end = cfg_find_line(cfg, edit_pos + old_len) + 1;
+    }
+    pos = cfg->lines[first].start;
+    removed = cfg->lines[end].before - cfg->lines[first].before;
+
+    /* identifiers missing from the schema are rejected by the part already */
+    cfg_init(&part);
+    part.schema = cfg->schema;
+    part.overflow = cfg->overflow;
+    if (cfg_parse_ctx(&part, &str[pos], cfg->lines[end].start - cfg->text_len + len - pos, CFG_FLAG_INCREMENTAL) != 0) {
+        cfg->errnum = part.errnum;
+        cfg->line = first + part.line;
+        cfg->col = part.col;
+        goto cfg_edit_end;
+    }
+
+    /* everything that can fail happens before the configuration is touched */
+    if (part.settings_len > removed) {
+        if (cfg_reserve_settings(cfg, part.settings_len - removed) != 0) {
+            goto cfg_edit_end;
+        }
+        while ((cfg->settings_len - removed + part.settings_len + 1) * 2 > cfg->index_cap) {
+            if (cfg_index_grow(cfg) != 0) {
+                goto cfg_edit_end;
+            }
+        }
+    }
+
+    if (cfg_reserve_lines(cfg, cfg->lines_len - (end - first) + part.lines_len) != 0) {
+        goto cfg_edit_end;
+    }
+
+    cfg_take_arena(cfg, &part);
+    cfg_stats_merge(cfg, &part, true);
+    cfg_splice_settings(cfg, cfg->lines[first].before, cfg->lines[end].before, &part);
+    cfg_splice_lines(cfg, first, end, &part, pos, len);
+
+    status = 0;
+
+cfg_edit_end:
+    cfg_clear(&part);
+
+    return status;
+}
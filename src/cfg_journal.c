@@ -0,0 +1,700 @@
+/* O_DIRECTORY, fsync and ftruncate, also with -std=c2x */
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "cfg_private.h"
+
+/*
+ * the journal is a file holding the changes made to a configuration since its config file was last
+ * rewritten, one line per change: a setting that is set is written as the writer does, a removed one
+ * is its identifier after a '!'. loading the config file then replaying the journal gives back the
+ * configuration, and a change costs a single append. a compaction writes the configuration to
+ * memory and sends the next changes to a fresh journal, then a thread writes the config file aside,
+ * syncs it and renames it over the old one, and renames the fresh journal over the old journal.
+ * until then both journals are replayed, the old one first. replaying changes the config file
+ * already holds sets the same values in the same order again, so a crash at any point loses no change.
+*/
+
+#define CFG_JOURNAL_REMOVED '!' /* first character of a removal, an identifier can't start with it */
+
+struct cfg_journal_s {
+    char* path;
+    char* next_path; /* fresh journal of a compaction, until it is renamed over the journal */
+    char* cfg_path; /* config file rewritten by a compaction */
+    char* tmp_path; /* config file being written */
+    int fd; /* receives the changes, the fresh journal during a compaction */
+    size_t bytes; /* bytes appended since the last compaction started */
+    size_t compact_bytes; /* bytes that start a compaction, 0 to compact only on demand */
+    char* line; /* record being appended */
+    size_t line_cap;
+    pthread_t thread;
+    bool compacting; /* a compaction thread is started and not joined */
+    bool done; /* the compaction thread finished, stored atomically */
+    bool split; /* a compaction failed, the changes are in both journals until they are joined */
+    char* snapshot; /* configuration written to memory, for the compaction thread */
+    size_t snapshot_len;
+    int errnum; /* error of the last compaction, until it is reported */
+};
+
+/**
+ * @brief context of the replay of a journal
+*/
+typedef struct cfg_replay_s {
+    cfg_t* cfg;
+    int errnum;
+} cfg_replay_t;
+
+/**
+ * @brief builds the path of a file next to another one
+ * @param path path of the file
+ * @param suffix suffix appended to the path
+ * @returns path allocated with malloc, NULL if out of memory
+*/
+static char* cfg_journal_path(const char* path, const char* suffix) {
+    size_t len = strlen(path);
+    size_t suffix_len = strlen(suffix);
+    char* out = malloc(len + suffix_len + 1);
+
+    if (out != NULL) {
+        memcpy(out, path, len);
+        memcpy(&out[len], suffix, suffix_len + 1);
+    }
+
+    return out;
+}
+
+/**
+ * @brief reads a whole file
+ * @param path path of the file
+ * @param buf (out) content allocated with malloc, NULL if the file doesn't exist or is empty
+ * @param len (out) length of the content
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_journal_read(const char* path, char** buf, size_t* len) {
+    int errnum = CFG_SUCCESS;
+    int fd = open(path, O_RDONLY);
+    struct stat s;
+    ssize_t n;
+
+    *buf = NULL;
+    *len = 0;
+
+    if (fd == -1) {
+        return errno == ENOENT ? CFG_SUCCESS : CFG_EOPEN;
+    }
+
+    if (fstat(fd, &s) != 0) {
+        errnum = CFG_ESIZE;
+        goto cfg_journal_read_end;
+    }
+    if (s.st_size == 0) {
+        goto cfg_journal_read_end;
+    }
+
+    *buf = malloc((size_t)s.st_size);
+    if (*buf == NULL) {
+        errnum = CFG_EMEM;
+        goto cfg_journal_read_end;
+    }
+
+    while (*len < (size_t)s.st_size) {
+        n = read(fd, &(*buf)[*len], (size_t)s.st_size - *len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        *len += (size_t)n;
+    }
+
+    if (*len < (size_t)s.st_size) {
+        free(*buf);
+        *buf = NULL;
+        errnum = CFG_EREAD;
+    }
+
+cfg_journal_read_end:
+    close(fd);
+
+    return errnum;
+}
+
+/**
+ * @brief sets a setting read from a journal, called by the parser
+ * @param identifier pointer to the identifier
+ * @param identifier_len length of the identifier
+ * @param value value of the setting
+ * @param user replay context
+ * @returns 0 to go on, 1 to stop the replay
+*/
+static int cfg_journal_replay_setting(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    cfg_replay_t* replay = user;
+
+    if (cfg_set_setting_len(replay->cfg, identifier, identifier_len, value) != 0) {
+        replay->errnum = replay->cfg->errnum;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief replays a run of settings of a journal, the removals are in between
+ * @param cfg configuration object
+ * @param str run of lines
+ * @param len length of the run
+ * @param line line of the journal the run starts at
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_journal_replay_run(cfg_t* cfg, const char* str, size_t len, size_t line) {
+    cfg_replay_t replay = { .cfg = cfg, .errnum = CFG_SUCCESS };
+    cfg_t scratch;
+
+    /* the parser reports its errors and its position to a configuration of its own */
+    cfg_init(&scratch);
+    scratch.line = line;
+    scratch.col = 1;
+    if (cfg_parse_cb_ctx(&scratch, str, len, cfg_journal_replay_setting, &replay) != 0 || replay.errnum != CFG_SUCCESS) {
+        cfg->errnum = replay.errnum != CFG_SUCCESS ? replay.errnum : scratch.errnum;
+        cfg->line = scratch.line;
+        cfg->col = scratch.col;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief replays the complete lines of a journal, a last line cut short by a crash is ignored
+ * @param cfg configuration object
+ * @param str content of the journal
+ * @param len length of the content
+ * @param valid (out) length of the complete lines
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_journal_replay(cfg_t* cfg, const char* str, size_t len, size_t* valid) {
+    size_t run = 0;
+    size_t run_line = 1;
+    size_t line = 1;
+    size_t end;
+    const char* newline;
+
+    *valid = 0;
+    for (size_t pos = 0; pos < len; pos = end + 1, line++) {
+        newline = memchr(&str[pos], '\n', len - pos);
+        if (newline == NULL) {
+            break;
+        }
+        end = (size_t)(newline - str);
+
+        if (str[pos] != CFG_JOURNAL_REMOVED) {
+            continue;
+        }
+
+        if (cfg_journal_replay_run(cfg, &str[run], pos - run, run_line) != 0) {
+            return 1;
+        }
+        /* the setting may already be gone from the rewritten config file */
+        if (cfg_remove_setting_len(cfg, &str[pos + 1], end - pos - 1) != 0) {
+            if (cfg->errnum != CFG_ENEXIST) {
+                cfg->line = line;
+                return 1;
+            }
+            cfg->errnum = CFG_SUCCESS;
+        }
+        run = end + 1;
+        run_line = line + 1;
+    }
+
+    for (*valid = len; *valid > 0 && str[*valid - 1] != '\n'; *valid -= 1);
+
+    return cfg_journal_replay_run(cfg, &str[run], *valid - run, run_line);
+}
+
+/**
+ * @brief syncs the directory of a file, so that a rename in it survives a crash. some file systems
+ * can't sync a directory, that isn't an error
+ * @param path path of the file
+*/
+static void cfg_journal_sync_dir(const char* path) {
+    const char* slash = strrchr(path, '/');
+    char* dir = slash == NULL ? strdup(".") : strndup(path, slash == path ? 1 : (size_t)(slash - path));
+    int fd = dir == NULL ? -1 : open(dir, O_RDONLY | O_DIRECTORY);
+
+    if (fd != -1) {
+        fsync(fd);
+        close(fd);
+    }
+
+    free(dir);
+}
+
+/**
+ * @brief compaction thread, writes the snapshot aside, syncs it, and renames it over the config file
+ * then the fresh journal over the old one
+ * @param arg journal
+ * @returns NULL
+*/
+static void* cfg_journal_rewrite(void* arg) {
+    cfg_journal_t* journal = arg;
+    int errnum = CFG_SUCCESS;
+    int fd = open(journal->tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1) {
+        errnum = CFG_EOPEN;
+    } else {
+        errnum = cfg_write_fd(fd, journal->snapshot, journal->snapshot_len);
+        if (errnum == CFG_SUCCESS && fsync(fd) != 0) {
+            errnum = CFG_EWRITE;
+        }
+        if (close(fd) != 0 && errnum == CFG_SUCCESS) {
+            errnum = CFG_EWRITE;
+        }
+    }
+
+    if (errnum == CFG_SUCCESS && rename(journal->tmp_path, journal->cfg_path) != 0) {
+        errnum = CFG_EWRITE;
+    }
+    if (errnum == CFG_SUCCESS && rename(journal->next_path, journal->path) != 0) {
+        errnum = CFG_EWRITE;
+    }
+
+    if (errnum == CFG_SUCCESS) {
+        cfg_journal_sync_dir(journal->cfg_path);
+        cfg_journal_sync_dir(journal->path);
+    } else {
+        unlink(journal->tmp_path);
+    }
+
+    free(journal->snapshot);
+    journal->snapshot = NULL;
+    journal->errnum = errnum;
+    __atomic_store_n(&journal->done, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/**
+ * @brief joins the changes of the fresh journal of a failed compaction to the old journal, which
+ * receives the next changes again
+ * @param journal journal
+ * @returns CFG_SUCCESS, or an error number with the changes still in both journals
+*/
+static int cfg_journal_join(cfg_journal_t* journal) {
+    char* buf;
+    size_t len;
+    int fd;
+    int errnum = cfg_journal_read(journal->next_path, &buf, &len);
+
+    if (errnum != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    fd = open(journal->path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd == -1) {
+        free(buf);
+        return CFG_EOPEN;
+    }
+
+    /* a crash in between replays some changes twice, in order */
+    errnum = cfg_write_fd(fd, buf, len);
+    if (errnum == CFG_SUCCESS && fsync(fd) != 0) {
+        errnum = CFG_EWRITE;
+    }
+    free(buf);
+
+    if (errnum != CFG_SUCCESS) {
+        close(fd);
+        return errnum;
+    }
+
+    close(journal->fd);
+    journal->fd = fd;
+    journal->split = false;
+    unlink(journal->next_path);
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief waits for the compaction thread, the changes of a failed compaction are joined back
+ * @param journal journal
+*/
+static void cfg_journal_wait(cfg_journal_t* journal) {
+    if (!journal->compacting) {
+        return;
+    }
+
+    pthread_join(journal->thread, NULL);
+    journal->compacting = false;
+
+    if (journal->errnum != CFG_SUCCESS) {
+        journal->split = true;
+        cfg_journal_join(journal);
+    }
+}
+
+/**
+ * @brief starts a compaction: writes the configuration to memory, sends the next changes to a fresh
+ * journal and hands the rest to a thread. the compaction runs on the calling thread if no thread starts
+ * @param cfg configuration object with a journal and no running compaction
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_journal_start(cfg_t* cfg) {
+    cfg_journal_t* journal = cfg->journal;
+    cfg_setting_t tmp;
+    size_t len = 0;
+    int errnum;
+    int fd;
+
+    journal->bytes = 0;
+    if (journal->split && (errnum = cfg_journal_join(journal)) != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    /* only the settings of this layer, the base layers have files of their own */
+    errnum = cfg_write_all(cfg, false, -1, &journal->snapshot, &journal->snapshot_len);
+    if (errnum != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    fd = open(journal->next_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd == -1) {
+        errnum = CFG_EOPEN;
+        goto cfg_journal_start_fail;
+    }
+
+    /* a config file can't hide the settings of a base layer, their removals stay in the journal */
+    for (size_t i = 0; i < cfg->settings_len && cfg->base != NULL; i++) {
+        if ((cfg->types[i] & CFG_SETTING_TYPE) == CFG_STYPE_UNKNOWN
+            && cfg_find_setting(cfg, cfg->identifiers[i], cfg->identifier_lens[i], cfg->hashes[i]) == i
+            && cfg_layer_find(cfg->base, cfg->identifiers[i], cfg->identifier_lens[i], cfg->hashes[i], &tmp) != NULL) {
+            len = cfg->identifier_lens[i];
+            errnum = cfg_write_fd(fd, "!", 1);
+            errnum = errnum != CFG_SUCCESS ? errnum : cfg_write_fd(fd, cfg->identifiers[i], len);
+            errnum = errnum != CFG_SUCCESS ? errnum : cfg_write_fd(fd, "\n", 1);
+            if (errnum != CFG_SUCCESS) {
+                close(fd);
+                unlink(journal->next_path);
+                goto cfg_journal_start_fail;
+            }
+            journal->bytes += len + 2;
+        }
+    }
+
+    close(journal->fd);
+    journal->fd = fd;
+    journal->done = false;
+    journal->compacting = true;
+
+    if (pthread_create(&journal->thread, NULL, cfg_journal_rewrite, journal) != 0) {
+        journal->compacting = false;
+        cfg_journal_rewrite(journal);
+        if (journal->errnum != CFG_SUCCESS) {
+            journal->split = true;
+            cfg_journal_join(journal);
+        }
+        return journal->errnum;
+    }
+
+    return CFG_SUCCESS;
+
+cfg_journal_start_fail:
+    free(journal->snapshot);
+    journal->snapshot = NULL;
+
+    return errnum;
+}
+
+/**
+ * @brief appends the record in the line buffer to the journal, and starts a compaction once the
+ * journal is large enough
+ * @param cfg configuration object
+ * @param len length of the record
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_journal_append(cfg_t* cfg, size_t len) {
+    cfg_journal_t* journal = cfg->journal;
+    int errnum;
+
+    if (cfg_write_fd(journal->fd, journal->line, len) != CFG_SUCCESS) {
+        cfg->errnum = CFG_EWRITE;
+        return 1;
+    }
+
+    journal->bytes += len;
+    if (journal->compacting && __atomic_load_n(&journal->done, __ATOMIC_ACQUIRE)) {
+        cfg_journal_wait(journal);
+    }
+    if (!journal->compacting && journal->compact_bytes != 0 && journal->bytes >= journal->compact_bytes) {
+        /* the error is reported by cfg_journal_sync_ctx, the change itself is recorded */
+        errnum = cfg_journal_start(cfg);
+        journal->errnum = errnum != CFG_SUCCESS ? errnum : journal->errnum;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief records a setting that was set
+ * @param cfg configuration object with a journal
+ * @param pos position of the setting
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_journal_set(cfg_t* cfg, size_t pos) {
+    cfg_journal_t* journal = cfg->journal;
+    cfg_setting_t tmp;
+    size_t len = 0;
+    int errnum = cfg_write_line(cfg_setting_at(cfg, pos, &tmp), &journal->line, &journal->line_cap, &len);
+
+    if (errnum != CFG_SUCCESS) {
+        cfg->errnum = errnum;
+        return 1;
+    }
+
+    return cfg_journal_append(cfg, len);
+}
+
+/**
+ * @brief records a setting that was removed
+ * @param cfg configuration object with a journal
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_journal_remove(cfg_t* cfg, const char* identifier, size_t len) {
+    cfg_journal_t* journal = cfg->journal;
+    char* line;
+
+    if (journal->line_cap < len + 2) {
+        line = realloc(journal->line, len + 2);
+        if (line == NULL) {
+            cfg->errnum = CFG_EMEM;
+            return 1;
+        }
+        journal->line = line;
+        journal->line_cap = len + 2;
+    }
+
+    journal->line[0] = CFG_JOURNAL_REMOVED;
+    memcpy(&journal->line[1], identifier, len);
+    journal->line[len + 1] = '\n';
+
+    return cfg_journal_append(cfg, len + 2);
+}
+
+/**
+ * @brief closes the journal of a configuration after waiting for its compaction, nothing is synced
+ * @param cfg configuration object
+*/
+void cfg_journal_drop(cfg_t* cfg) {
+    cfg_journal_t* journal = cfg->journal;
+
+    if (journal == NULL) {
+        return;
+    }
+
+    cfg_journal_wait(journal);
+    close(journal->fd);
+    free(journal->path);
+    free(journal->next_path);
+    free(journal->cfg_path);
+    free(journal->tmp_path);
+    free(journal->line);
+    free(journal);
+    cfg->journal = NULL;
+}
+
+/**
+ * @brief reads a journal and replays its changes
+ * @param cfg configuration object, without a journal
+ * @param path path of the journal
+ * @param buf (out) content of the journal, NULL if it doesn't exist
+ * @param valid (out) length of the complete lines of the journal
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_journal_load(cfg_t* cfg, const char* path, char** buf, size_t* valid) {
+    size_t len;
+    int errnum = cfg_journal_read(path, buf, &len);
+
+    *valid = 0;
+    if (errnum != CFG_SUCCESS) {
+        cfg->errnum = errnum;
+        return 1;
+    }
+
+    return *buf == NULL ? 0 : cfg_journal_replay(cfg, *buf, len, valid);
+}
+
+/**
+ * @brief opens the journal of a configuration loaded from a file, see cfg_journal_open_ctx
+ * @param cfg configuration object
+ * @param path path of the journal
+ * @param compact_bytes size of the journal that starts a compaction, 0 to compact only with cfg_journal_compact_ctx
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_journal_attach(cfg_t* cfg, const char* path, size_t compact_bytes) {
+    cfg_journal_t* journal = calloc(1, sizeof(cfg_journal_t));
+    char* next = NULL;
+    size_t next_len;
+    size_t len;
+    char* buf = NULL;
+    int status = 1;
+
+    if (journal == NULL || (journal->path = strdup(path)) == NULL || (journal->next_path = cfg_journal_path(path, ".next")) == NULL
+        || (journal->cfg_path = strdup(cfg->path)) == NULL || (journal->tmp_path = cfg_journal_path(cfg->path, ".tmp")) == NULL) {
+        cfg->errnum = CFG_EMEM;
+        goto cfg_journal_attach_end;
+    }
+    journal->fd = -1;
+    journal->compact_bytes = compact_bytes;
+
+    /* the journal, then the changes made while a compaction was cut short */
+    if (cfg_journal_load(cfg, journal->path, &buf, &len) != 0 || cfg_journal_load(cfg, journal->next_path, &next, &next_len) != 0) {
+        goto cfg_journal_attach_end;
+    }
+
+    journal->fd = open(journal->path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (journal->fd == -1) {
+        cfg->errnum = CFG_EOPEN;
+        goto cfg_journal_attach_end;
+    }
+
+    /* the next change starts on a line of its own, after the last complete one */
+    if (buf != NULL && ftruncate(journal->fd, (off_t)len) != 0) {
+        cfg->errnum = CFG_EWRITE;
+        goto cfg_journal_attach_end;
+    }
+
+    if (next != NULL) {
+        if (cfg_write_fd(journal->fd, next, next_len) != CFG_SUCCESS || fsync(journal->fd) != 0) {
+            cfg->errnum = CFG_EWRITE;
+            goto cfg_journal_attach_end;
+        }
+    }
+    unlink(journal->next_path);
+    unlink(journal->tmp_path);
+
+    journal->bytes = len + next_len;
+    cfg->journal = journal;
+    journal = NULL;
+    status = 0;
+
+cfg_journal_attach_end:
+    if (journal != NULL) {
+        if (journal->fd != -1) {
+            close(journal->fd);
+        }
+        free(journal->path);
+        free(journal->next_path);
+        free(journal->cfg_path);
+        free(journal->tmp_path);
+        free(journal);
+    }
+    free(buf);
+    free(next);
+
+    return status;
+}
+
+/**
+ * @brief opens the journal of a configuration loaded from a file and replays the changes it holds,
+ * the next cfg_set_setting_ctx and cfg_remove_setting_ctx are appended to it. once it reaches
+ * compact_bytes, a compaction rewrites the config file on a thread and empties the journal.
+ * a journal already open is closed first
+ * @param cfg configuration object loaded with cfg_load_ctx
+ * @param path path of the journal, created if it doesn't exist
+ * @param compact_bytes size of the journal that starts a compaction, 0 to compact only with cfg_journal_compact_ctx
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_journal_open_ctx(cfg_t* cfg, const char* path, size_t compact_bytes) {
+    if (cfg->image != NULL) {
+        cfg->errnum = CFG_EREADONLY;
+        return 1;
+    }
+    if (cfg->path == NULL) {
+        cfg->errnum = CFG_EJOURNAL;
+        return 1;
+    }
+
+    cfg_journal_drop(cfg);
+
+    return cfg_journal_attach(cfg, path, compact_bytes);
+}
+
+/**
+ * @brief starts a compaction of the journal of a configuration, after the running one. the configuration is
+ * written to memory on the calling thread, the config file is rewritten on another one, see cfg_journal_sync_ctx
+ * @param cfg configuration object
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_journal_compact_ctx(cfg_t* cfg) {
+    int errnum;
+
+    if (cfg->journal == NULL) {
+        cfg->errnum = CFG_EJOURNAL;
+        return 1;
+    }
+
+    cfg_journal_wait(cfg->journal);
+    errnum = cfg_journal_start(cfg);
+    if (errnum != CFG_SUCCESS) {
+        cfg->errnum = errnum;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief waits for the running compaction of the journal of a configuration, and syncs the journal
+ * so that the changes appended survive a crash of the system, not only of the process
+ * @param cfg configuration object
+ * @returns 0 on success, 1 otherwise with the configuration error set, to the error of a failed
+ * compaction whose changes are kept in the journal
+*/
+int cfg_journal_sync_ctx(cfg_t* cfg) {
+    cfg_journal_t* journal = cfg->journal;
+    int errnum;
+
+    if (journal == NULL) {
+        cfg->errnum = CFG_EJOURNAL;
+        return 1;
+    }
+
+    cfg_journal_wait(journal);
+    errnum = journal->errnum;
+    journal->errnum = CFG_SUCCESS;
+    if (errnum == CFG_SUCCESS && fsync(journal->fd) != 0) {
+        errnum = CFG_EWRITE;
+    }
+
+    if (errnum != CFG_SUCCESS) {
+        cfg->errnum = errnum;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief syncs and closes the journal of a configuration, the next changes aren't recorded.
+ * cfg_free_ctx closes it too, without syncing it
+ * @param cfg configuration object
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_journal_close_ctx(cfg_t* cfg) {
+    int status = cfg_journal_sync_ctx(cfg);
+
+    cfg_journal_drop(cfg);
+
+    return status;
+}
@@ -0,0 +1,101 @@
+#include <string.h>
+
+#include "cfg_private.h"
+
+/*
+ * a layer is a configuration parsed on its own, from the defaults, a cluster or a host file, and
+ * stacked over a base layer. a lookup hashes the identifier once and probes the index of every
+ * layer from the top, so the first layer holding a setting shadows the ones below it. the layers
+ * don't copy each other: a layer only holds the settings it parsed, and a base can be shared
+ * read-only by any number of layers, from any number of threads.
+*/
+
+/**
+ * @brief stacks a configuration over a base layer, the settings missing from the configuration are
+ * then looked up in the base, and in the base of the base. the base isn't copied nor modified, it
+ * can be shared by several configurations and must outlive them. cfg_free_ctx keeps the base
+ * @param cfg configuration object
+ * @param base lower layer, NULL to remove it
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_set_base_ctx(cfg_t* cfg, const cfg_t* base) {
+    for (const cfg_t* layer = base; layer != NULL; layer = layer->base) {
+        if (layer == cfg) {
+            cfg->errnum = CFG_ELAYER;
+            return 1;
+        }
+    }
+
+    cfg->base = base;
+
+    return 0;
+}
+
+/**
+ * @brief gets the base layer of a configuration
+ * @param cfg configuration object
+ * @returns base layer, NULL if the configuration isn't stacked
+*/
+const cfg_t* cfg_get_base_ctx(const cfg_t* cfg) {
+    return cfg->base;
+}
+
+/**
+ * @brief finds a setting in a single layer, in its compiled config first, then in its parsed settings
+ * @param layer configuration object
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param hash hash of the identifier
+ * @param tmp (out) decoded setting
+ * @returns tmp, NULL if the layer doesn't hold the setting
+*/
+static cfg_setting_t* cfg_layer_find_one(const cfg_t* layer, const char* identifier, size_t len, uint32_t hash, cfg_setting_t* tmp) {
+    size_t pos;
+
+    if (layer->image != NULL && cfg_image_find(layer, identifier, len, hash, tmp) != NULL) {
+        return tmp;
+    }
+
+    pos = cfg_find_setting(layer, identifier, len, hash);
+
+    return pos == CFG_SETTING_NONE ? NULL : cfg_setting_at(layer, pos, tmp);
+}
+
+/**
+ * @brief finds a setting in the layers of a configuration, from the top one down
+ * @param cfg top layer
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param hash hash of the identifier
+ * @param tmp (out) decoded setting
+ * @returns tmp holding the setting of the highest layer holding it, NULL if none does or if it was removed there
+*/
+cfg_setting_t* cfg_layer_find(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash, cfg_setting_t* tmp) {
+    cfg_setting_t* setting = NULL;
+
+    for (const cfg_t* layer = cfg; layer != NULL && setting == NULL; layer = layer->base) {
+        setting = cfg_layer_find_one(layer, identifier, len, hash, tmp);
+    }
+
+    /* a removed setting hides the ones of the layers below */
+    return setting != NULL && setting->type == CFG_STYPE_UNKNOWN ? NULL : setting;
+}
+
+/**
+ * @brief tells if a setting of a lower layer is shadowed by a layer above it
+ * @param cfg top layer
+ * @param layer layer holding the setting
+ * @param setting setting
+ * @returns true if a layer between cfg and layer holds the identifier of the setting
+*/
+bool cfg_layer_shadowed(const cfg_t* cfg, const cfg_t* layer, const cfg_setting_t* setting) {
+    cfg_setting_t tmp;
+
+    for (const cfg_t* above = cfg; above != layer; above = above->base) {
+        if (cfg_layer_find_one(above, setting->identifier, setting->identifier_len, setting->hash, &tmp) != NULL) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,305 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "cfg_private.h"
+
+/*
+ * snapshots are published with an atomic pointer swap and reclaimed with epochs.
+ * a reader pins a snapshot by announcing the current epoch before loading the pointer,
+ * a reload swaps the pointer, then retires the old snapshot with the epoch it replaced
+ * and bumps the epoch. a retired snapshot is freed once every pinned reader announced
+ * a later epoch, readers that announced it or an earlier one may still hold it.
+ * readers never lock nor wait, reloads never wait for readers.
+*/
+
+/**
+ * @brief snapshot waiting for its readers to go
+*/
+typedef struct cfg_retired_s {
+    struct cfg_retired_s* next;
+    cfg_t* cfg;
+    uint64_t epoch;
+} cfg_retired_t;
+
+struct cfg_reader_s {
+    cfg_reader_t* next;
+    cfg_live_t* live;
+    atomic_bool used;
+    _Atomic uint64_t epoch; /* epoch announced by the pinning reader, 0 when unpinned */
+};
+
+struct cfg_live_s {
+    _Atomic(cfg_t*) current;
+    _Atomic uint64_t epoch;
+    _Atomic(cfg_reader_t*) readers; /* reader slots are reused, not freed before the live configuration */
+    pthread_mutex_t lock; /* serializes reloads, never taken by readers */
+    cfg_retired_t* retired;
+    size_t line;
+    size_t col;
+    int errnum;
+};
+
+/**
+ * @brief creates an empty live configuration, readers get no snapshot until the first cfg_reload
+ * @returns live configuration, NULL on failure
+*/
+cfg_live_t* cfg_live_new(void) {
+    cfg_live_t* live = calloc(1, sizeof(cfg_live_t));
+
+    if (live == NULL) {
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&live->lock, NULL) != 0) {
+        free(live);
+        return NULL;
+    }
+
+    atomic_init(&live->current, NULL);
+    atomic_init(&live->epoch, 1);
+    atomic_init(&live->readers, NULL);
+    live->line = 1;
+    live->col = 1;
+
+    return live;
+}
+
+/**
+ * @brief frees the retired snapshots no pinned reader can still hold, must be called with the lock held
+ * @param live live configuration
+*/
+static void cfg_live_collect(cfg_live_t* live) {
+    uint64_t oldest = UINT64_MAX;
+    uint64_t epoch;
+    cfg_retired_t** link = &live->retired;
+    cfg_retired_t* retired;
+
+    for (cfg_reader_t* reader = atomic_load(&live->readers); reader != NULL; reader = reader->next) {
+        epoch = atomic_load(&reader->epoch);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    while (*link != NULL) {
+        retired = *link;
+        if (retired->epoch < oldest) {
+            *link = retired->next;
+            cfg_free_ctx(retired->cfg);
+            free(retired);
+        } else {
+            link = &retired->next;
+        }
+    }
+}
+
+/**
+ * @brief loads a config file into a new snapshot and publishes it, the previous snapshot
+ * stays valid for the readers holding it. on failure the current snapshot is kept
+ * @param live live configuration
+ * @param path path to the config file
+ * @param flags parsing flags, CFG_FLAG_LAZY is ignored
+ * @returns 0 on success, 1 otherwise with the live configuration error set
+*/
+int cfg_reload(cfg_live_t* live, const char* path, int flags) {
+    int status = 0;
+    cfg_t* cfg = cfg_new();
+    cfg_retired_t* retired = malloc(sizeof(cfg_retired_t));
+
+    pthread_mutex_lock(&live->lock);
+
+    if (cfg == NULL || retired == NULL) {
+        live->errnum = CFG_EMEM;
+        status = 1;
+        goto cfg_reload_end;
+    }
+
+    /* readers share the snapshot, the getters of a lazy configuration would write it */
+    if (cfg_load_ctx(cfg, path, flags & ~CFG_FLAG_LAZY) != 0) {
+        live->errnum = cfg->errnum;
+        live->line = cfg->line;
+        live->col = cfg->col;
+        status = 1;
+        goto cfg_reload_end;
+    }
+
+    live->errnum = CFG_SUCCESS;
+    live->line = cfg->line;
+    live->col = cfg->col;
+
+    retired->cfg = atomic_exchange(&live->current, cfg);
+    cfg = NULL;
+
+    if (retired->cfg != NULL) {
+        retired->epoch = atomic_fetch_add(&live->epoch, 1);
+        retired->next = live->retired;
+        live->retired = retired;
+        retired = NULL;
+    }
+
+    cfg_live_collect(live);
+
+cfg_reload_end:
+    pthread_mutex_unlock(&live->lock);
+
+    free(retired);
+    if (cfg != NULL) {
+        cfg_free_ctx(cfg);
+    }
+
+    return status;
+}
+
+/**
+ * @brief frees a live configuration with its snapshots and readers, no reader may be using it anymore
+ * @param live live configuration
+*/
+void cfg_live_free(cfg_live_t* live) {
+    cfg_reader_t* reader;
+    cfg_retired_t* retired;
+
+    if (live == NULL) {
+        return;
+    }
+
+    while (live->retired != NULL) {
+        retired = live->retired;
+        live->retired = retired->next;
+        cfg_free_ctx(retired->cfg);
+        free(retired);
+    }
+
+    if (atomic_load(&live->current) != NULL) {
+        cfg_free_ctx(atomic_load(&live->current));
+    }
+
+    while ((reader = atomic_load(&live->readers)) != NULL) {
+        atomic_store(&live->readers, reader->next);
+        free(reader);
+    }
+
+    pthread_mutex_destroy(&live->lock);
+    free(live);
+}
+
+/**
+ * @brief gets the error number of the latest reload
+ * @param live live configuration
+ * @returns error number
+*/
+int cfg_get_errno_live(cfg_live_t* live) {
+    int errnum;
+
+    pthread_mutex_lock(&live->lock);
+    errnum = live->errnum;
+    pthread_mutex_unlock(&live->lock);
+
+    return errnum;
+}
+
+/**
+ * @brief prints the provided error string to stderr, followed by the error string of the latest reload
+ * @param live live configuration
+ * @param error_string error string
+*/
+void cfg_perror_live(cfg_live_t* live, const char* error_string) {
+    fprintf(stderr, "%s: %s\n", error_string ? error_string : "", cfg_strerror(cfg_get_errno_live(live)));
+}
+
+/**
+ * @brief get the line at wich the parser stopped during the latest reload
+ * @param live live configuration
+ * @returns line number
+*/
+size_t cfg_get_error_line_live(cfg_live_t* live) {
+    size_t line;
+
+    pthread_mutex_lock(&live->lock);
+    line = live->line;
+    pthread_mutex_unlock(&live->lock);
+
+    return line;
+}
+
+/**
+ * @brief get the column at wich the parser stopped during the latest reload
+ * @param live live configuration
+ * @returns column number
+*/
+size_t cfg_get_error_col_live(cfg_live_t* live) {
+    size_t col;
+
+    pthread_mutex_lock(&live->lock);
+    col = live->col;
+    pthread_mutex_unlock(&live->lock);
+
+    return col;
+}
+
+/**
+ * @brief registers a reader of a live configuration, a free slot is reused without locking
+ * @param live live configuration
+ * @returns reader, NULL on failure
+*/
+cfg_reader_t* cfg_reader_new(cfg_live_t* live) {
+    cfg_reader_t* reader;
+    bool used;
+
+    for (reader = atomic_load(&live->readers); reader != NULL; reader = reader->next) {
+        used = false;
+        if (!atomic_load_explicit(&reader->used, memory_order_relaxed)
+            && atomic_compare_exchange_strong(&reader->used, &used, true)) {
+            return reader;
+        }
+    }
+
+    reader = malloc(sizeof(cfg_reader_t));
+    if (reader == NULL) {
+        return NULL;
+    }
+
+    reader->live = live;
+    atomic_init(&reader->used, true);
+    atomic_init(&reader->epoch, 0);
+    reader->next = atomic_load(&live->readers);
+    while (!atomic_compare_exchange_weak(&live->readers, &reader->next, reader));
+
+    return reader;
+}
+
+/**
+ * @brief pins the current snapshot, it stays valid until cfg_release even if a reload happens.
+ * lookups are done with the _ctx getters and several readers may share a snapshot
+ * @param reader reader
+ * @returns current snapshot, NULL before the first successful reload
+*/
+cfg_t* cfg_acquire(cfg_reader_t* reader) {
+    cfg_live_t* live = reader->live;
+
+    /* the epoch must be visible to reloads before the pointer is read, both are sequentially consistent */
+    atomic_store(&reader->epoch, atomic_load(&live->epoch));
+
+    return atomic_load(&live->current);
+}
+
+/**
+ * @brief unpins the snapshot returned by cfg_acquire, it must not be used anymore
+ * @param reader reader
+*/
+void cfg_release(cfg_reader_t* reader) {
+    atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief unregisters a reader, its slot can be reused by cfg_reader_new
+ * @param reader reader
+*/
+void cfg_reader_free(cfg_reader_t* reader) {
+    if (reader == NULL) {
+        return;
+    }
+
+    atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+    atomic_store_explicit(&reader->used, false, memory_order_release);
+}
@@ -0,0 +1,180 @@
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "cfg_private.h"
+#include "cfg_scan.h"
+
+/* chunks smaller than this are not worth a thread */
+#define CFG_PARALLEL_CHUNK_MIN (256 * 1024)
+
+typedef struct cfg_chunk_s {
+    pthread_t thread;
+    bool started;
+    const char* str;
+    size_t len;
+    int flags;
+    int status;
+    cfg_t part;
+} cfg_chunk_t;
+
+/**
+ * @brief parses a chunk of a config file into its own configuration
+ * @param arg pointer to the chunk
+ * @returns NULL
+*/
+static void* cfg_parse_chunk(void* arg) {
+    cfg_chunk_t* chunk = arg;
+
+    chunk->status = cfg_parse_ctx(&chunk->part, chunk->str, chunk->len, chunk->flags);
+
+    return NULL;
+}
+
+/**
+ * @brief splits a buffer into chunks of about the same size ending on a newline.
+ * a setting never spans several lines, so every chunk can be parsed on its own
+ * @param str buffer
+ * @param len length of the buffer
+ * @param chunks chunks to fill
+ * @param n number of chunks
+*/
+static void cfg_split_chunks(const char* str, size_t len, cfg_chunk_t* chunks, size_t n) {
+    size_t start = 0;
+    size_t end;
+
+    for (size_t i = 0; i < n; i++) {
+        if (i + 1 == n) {
+            end = len;
+        } else {
+            end = len / n * (i + 1);
+            end = end < start ? start : end;
+            end = cfg_scan_find(str, end, len, '\n', '\n');
+            end = end < len ? end + 1 : len;
+        }
+
+        chunks[i].str = &str[start];
+        chunks[i].len = end - start;
+        start = end;
+    }
+}
+
+/**
+ * @brief loads a supported config file into a configuration, parsing it on several threads.
+ * the file is split at line boundaries, every chunk is parsed into its own configuration
+ * and the results are merged in file order, so the outcome is the same as cfg_load_ctx
+ * @param cfg configuration object
+ * @param path path to the config file
+ * @param nthreads maximum number of threads, including the calling one
+ * @param flags parsing flags, with CFG_FLAG_ZEROCOPY the file stays mapped until the configuration is freed
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_load_parallel_ctx(cfg_t* cfg, const char* path, size_t nthreads, int flags) {
+    int status = 0;
+    char* raw_ptr;
+    size_t raw_len;
+    size_t n;
+    size_t line;
+    size_t col;
+    uint64_t start;
+    bool kept = false;
+    cfg_chunk_t* chunks;
+
+    if (cfg_map_file(cfg, path, &raw_ptr, &raw_len) != 0) {
+        return 1;
+    }
+
+    n = raw_len / CFG_PARALLEL_CHUNK_MIN;
+    n = n < nthreads ? n : nthreads;
+    n = n == 0 ? 1 : n;
+
+    chunks = calloc(n, sizeof(cfg_chunk_t));
+    if (chunks == NULL) {
+        cfg->errnum = CFG_EMEM;
+        munmap(raw_ptr, raw_len);
+        return 1;
+    }
+
+    /* in zero-copy mode the settings reference the mapping, it is released by cfg_free */
+    if ((flags & CFG_FLAG_ZEROCOPY) != 0) {
+        if (cfg_keep_mapping(cfg, raw_ptr, raw_len) != 0) {
+            status = 1;
+            goto cfg_load_parallel_unmap;
+        }
+        kept = true;
+    }
+
+    cfg_split_chunks(raw_ptr, raw_len, chunks, n);
+
+    /* the chunks reject identifiers missing from the schema where they are, the slots are filled by the merge */
+    for (size_t i = 0; i < n; i++) {
+        cfg_init(&chunks[i].part);
+        chunks[i].part.schema = cfg->schema;
+        chunks[i].part.overflow = cfg->overflow;
+        chunks[i].flags = flags;
+    }
+
+    /* the first chunk carries on from the current position, like cfg_parse_ctx does */
+    chunks[0].part.line = cfg->line;
+    chunks[0].part.col = cfg->col;
+
+    /* the calling thread takes the first chunk, a chunk whose thread can't be started is parsed here too */
+    start = cfg_now_ns();
+    for (size_t i = 1; i < n; i++) {
+        chunks[i].started = pthread_create(&chunks[i].thread, NULL, cfg_parse_chunk, &chunks[i]) == 0;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (chunks[i].started) {
+            pthread_join(chunks[i].thread, NULL);
+        } else {
+            cfg_parse_chunk(&chunks[i]);
+        }
+    }
+
+    /* every chunk but the first starts at line 1 column 1 of its own, its position is shifted
+    by the lines of the chunks before it. the settings parsed before an error are kept */
+    line = cfg->line;
+    col = cfg->col;
+
+    for (size_t i = 0; i < n; i++) {
+        if (chunks[i].len != 0) {
+            line = i == 0 ? chunks[i].part.line : line + chunks[i].part.line - 1;
+            col = chunks[i].part.col;
+        }
+
+        /* the chunks were parsed at the same time, the parse time is the one of the whole */
+        cfg_stats_merge(cfg, &chunks[i].part, false);
+        if (cfg_merge(cfg, &chunks[i].part) != 0) {
+            status = 1;
+            break;
+        }
+
+        if (chunks[i].status != 0) {
+            cfg->errnum = chunks[i].part.errnum;
+            status = 1;
+            break;
+        }
+    }
+
+    cfg->line = line;
+    cfg->col = col;
+
+    cfg_stats_add(&cfg->stats.parse_ns, cfg_now_ns() - start);
+    if (cfg->slow_hook != NULL) {
+        cfg_stats_slow(cfg, CFG_SLOW_PARSE, cfg->path, cfg->path == NULL ? 0 : strlen(cfg->path), start);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        cfg_clear(&chunks[i].part);
+    }
+
+cfg_load_parallel_unmap:
+    if (!kept) {
+        munmap(raw_ptr, raw_len);
+    }
+
+    free(chunks);
+
+    return status;
+}
@@ -0,0 +1,434 @@
+#pragma once
+
+#include <float.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "../include/cfg.h"
+
+/* internal functions, not exported from the shared library */
+#define CFG_INTERNAL __attribute__((visibility("hidden")))
+
+/**
+ * @brief array value of the settings table, allocated in the arena as a single block: the items, then
+ * the copied strings, each NUL terminated. zero-copy strings point into the parsed buffer
+*/
+typedef struct cfg_array_s {
+    size_t len; /* number of items */
+    enum cfg_setting_type_e type; /* type of the items, CFG_STYPE_UNKNOWN for an empty array */
+    alignas(max_align_t) unsigned char items[]; /* long long, cfg_float_t or cfg_string_span_t */
+} cfg_array_t;
+
+/**
+ * @brief setting decoded from the settings table or from a compiled config, see cfg_setting_at
+*/
+typedef struct cfg_setting_s {
+    enum cfg_setting_type_e type;
+    bool view; /* identifier and string point into the parsed buffer and are not NUL terminated */
+    bool lazy; /* number parsed with CFG_FLAG_LAZY, converted from its text by cfg_setting_at */
+    int errnum; /* CFG_SUCCESS, or the error of a lazy number that doesn't convert, string then holds its text */
+    char* identifier;
+    size_t identifier_len;
+    uint32_t hash; /* hash of the identifier */
+
+    union {
+        long long integer;
+        cfg_float_t floating;
+        struct {
+            char* string;
+            size_t string_len;
+        };
+        bool boolean;
+        const cfg_array_t* array;
+    };
+} cfg_setting_t;
+
+/**
+ * @brief copied string value of the settings table, allocated in the arena and shared by the settings
+ * with the same value
+*/
+typedef struct cfg_string_s {
+    size_t len;
+    char bytes[]; /* NUL terminated */
+} cfg_string_t;
+
+/**
+ * @brief zero-copy string value of the settings table, allocated in the arena
+*/
+typedef struct cfg_string_view_s {
+    size_t len;
+    char* ptr; /* into the parsed buffer */
+} cfg_string_view_t;
+
+/**
+ * @brief value of a setting in the settings table, 8 bytes whatever the type
+*/
+typedef union cfg_value_slot_u {
+    long long integer;
+    bool boolean;
+#ifdef CFG_FLOAT_DOUBLE
+    cfg_float_t floating;
+#else
+    const cfg_float_t* floating; /* a long double doesn't fit the slot, it is allocated in the arena */
+#endif
+    const cfg_string_t* string;
+    const cfg_string_view_t* string_view;
+    const cfg_array_t* array;
+    struct {
+        uint32_t offset; /* from the identifier */
+        uint32_t len;
+    } text; /* number parsed with CFG_FLAG_LAZY, not converted yet */
+} cfg_value_slot_t;
+
+/* flag of a type tag of the settings table: the identifier and string point into the parsed buffer */
+#define CFG_SETTING_VIEW 0x80
+
+/* flag of a type tag of the settings table: the value is the text of a number, the type is guessed from it */
+#define CFG_SETTING_LAZY 0x40
+
+/* bits of a type tag of the settings table holding the enum cfg_setting_type_e */
+#define CFG_SETTING_TYPE 0x3f
+
+#ifdef CFG_FLOAT_DOUBLE
+#define CFG_FLOAT_MANT_DIG DBL_MANT_DIG
+#define cfg_strtof strtod
+#else
+#define CFG_FLOAT_MANT_DIG LDBL_MANT_DIG
+#define cfg_strtof strtold
+#endif
+
+/* largest power of ten and largest integer exactly representable by cfg_float_t */
+#if CFG_FLOAT_MANT_DIG >= 64
+#define CFG_FLOAT_POW10_MAX 27
+#define CFG_FLOAT_MANTISSA_MAX UINT64_MAX
+#else
+#define CFG_FLOAT_POW10_MAX 22
+#define CFG_FLOAT_MANTISSA_MAX (1ULL << CFG_FLOAT_MANT_DIG)
+#endif
+
+/* bytes of a row of the settings table, over all of its arrays */
+#define CFG_SETTING_BYTES (sizeof(cfg_value_slot_t) + sizeof(char*) + sizeof(uint32_t) * 2 + sizeof(uint8_t))
+
+/* not a position of the settings table */
+#define CFG_SETTING_NONE SIZE_MAX
+
+/**
+ * @brief hash index slot, maps an identifier hash to its setting
+*/
+typedef struct cfg_index_slot_s {
+    uint32_t hash;
+    uint32_t setting; /* position of the setting + 1, 0 if the slot is empty */
+} cfg_index_slot_t;
+
+/**
+ * @brief arena chunk, settings, identifiers and strings are allocated from a list of those
+*/
+typedef struct cfg_arena_chunk_s cfg_arena_chunk_t;
+
+/**
+ * @brief file mapping kept alive by a zero-copy configuration
+*/
+typedef struct cfg_mapping_s cfg_mapping_t;
+
+/**
+ * @brief unfinished line of a config fed in pieces, see cfg_stream_feed_ctx
+*/
+typedef struct cfg_stream_s cfg_stream_t;
+
+/**
+ * @brief radix tree of the identifiers, see cfg_foreach_prefix_ctx
+*/
+typedef struct cfg_tree_s cfg_tree_t;
+
+/**
+ * @brief journal of the changes made to a configuration, see cfg_journal_open_ctx
+*/
+typedef struct cfg_journal_s cfg_journal_t;
+
+/**
+ * @brief line of a buffer parsed with CFG_FLAG_INCREMENTAL, the line index ends with a sentinel
+ * starting at the end of the buffer
+*/
+typedef struct cfg_line_s {
+    size_t start; /* offset of the line in the buffer */
+    uint32_t before; /* position of the first setting at or after this line */
+    bool setting; /* the line holds a setting, blank and comment lines don't */
+} cfg_line_t;
+
+/* threads counting their lookups without atomic read-modify-write, the next ones share a last shard */
+#define CFG_STATS_SHARDS 16
+
+/**
+ * @brief lookup counters of the threads owning a shard, on their own cache line
+*/
+typedef struct cfg_stats_shard_s {
+    alignas(64) uint64_t lookups;
+    uint64_t misses;
+} cfg_stats_shard_t;
+
+/**
+ * @brief cfg object
+*/
+struct cfg_s {
+    char* path;
+    cfg_arena_chunk_t* arena;
+    cfg_mapping_t* mappings;
+    /* settings table in file order, parallel arrays sharing a single allocation */
+    cfg_value_slot_t* values;
+    char** identifiers; /* in the arena, in the parsed buffer in zero-copy mode */
+    uint32_t* hashes; /* hash of every identifier */
+    uint32_t* identifier_lens;
+    uint8_t* types; /* enum cfg_setting_type_e, with CFG_SETTING_VIEW and CFG_SETTING_LAZY, CFG_STYPE_UNKNOWN for a removed setting */
+    size_t settings_len;
+    size_t settings_cap;
+    cfg_index_slot_t* index;
+    size_t index_cap;
+    size_t index_len;
+    size_t duplicates; /* settings shadowed by an earlier one with the same identifier */
+    bool lazy; /* the settings table may hold numbers not converted yet, until cfg_validate_ctx */
+    cfg_index_slot_t* strings; /* copied string values by hash, to share the repeated ones */
+    size_t strings_cap;
+    size_t strings_len;
+    cfg_line_t* lines; /* line index of the parsed buffer, with CFG_FLAG_INCREMENTAL */
+    size_t lines_len;
+    size_t lines_cap;
+    size_t text_len;
+    const unsigned char* image; /* compiled config mapped by cfg_load_compiled, looked up before the settings */
+    const cfg_schema_t* schema; /* identifiers known at build time, kept by cfg_clear */
+    uint32_t* slots; /* position + 1 of the first setting of every schema id, the other identifiers go to the index */
+    bool overflow; /* identifiers missing from the schema are allowed */
+    const cfg_t* base; /* lower layer, looked up when a setting is missing, kept by cfg_clear */
+    cfg_stream_t* stream; /* between cfg_stream_begin_ctx and cfg_stream_end_ctx */
+    cfg_tree_t* tree; /* built by the first prefix query, dropped when the settings change */
+    cfg_journal_t* journal; /* records the changes of cfg_set_setting_ctx and cfg_remove_setting_ctx, closed by cfg_clear */
+    cfg_stats_t stats; /* parse counters, the heap usage is computed and the lookups summed by cfg_get_stats_ctx */
+    cfg_stats_shard_t shards[CFG_STATS_SHARDS + 1]; /* lookup counters, one per thread and a shared one */
+    uint64_t slow_ns; /* threshold of the slow hook, kept by cfg_clear */
+    cfg_slow_cb_t slow_hook;
+    void* slow_user;
+    size_t line;
+    size_t col;
+    int errnum;
+};
+
+/**
+ * @brief sets the error of a lookup. lookups may run concurrently on a shared snapshot,
+ * so the error is stored atomically, without ordering
+ * @param cfg configuration object
+ * @param errnum error number
+*/
+static inline void cfg_set_errnum(cfg_t* cfg, int errnum) {
+    __atomic_store_n(&cfg->errnum, errnum, __ATOMIC_RELAXED);
+}
+
+/* shard of the calling thread + 1, 0 until it looks a setting up */
+CFG_INTERNAL extern _Thread_local size_t cfg_stats_shard_g;
+
+CFG_INTERNAL size_t cfg_stats_claim_shard(void);
+
+/**
+ * @brief adds to a parse counter, the parser has the configuration to itself. left out with CFG_NO_STATS
+ * @param counter counter of the statistics of a configuration
+ * @param n amount to add
+*/
+static inline void cfg_stats_add(uint64_t* counter, uint64_t n) {
+#ifdef CFG_NO_STATS
+    (void)counter;
+    (void)n;
+#else
+    *counter += n;
+#endif
+}
+
+/**
+ * @brief adds to a lookup counter of a shard owned by the calling thread, the only one writing it
+ * @param counter counter of the shard
+*/
+static inline void cfg_stats_bump(uint64_t* counter) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief counts a lookup of the getters. lookups may run concurrently on a shared snapshot, every thread
+ * counts them in its own shard with plain stores, the threads past CFG_STATS_SHARDS in a shared one with
+ * atomic additions. left out with CFG_NO_STATS
+ * @param cfg configuration object
+ * @param setting setting found, NULL for a miss
+*/
+static inline void cfg_stats_lookup(const cfg_t* cfg, const void* setting) {
+#ifdef CFG_NO_STATS
+    (void)cfg;
+    (void)setting;
+#else
+    size_t shard = cfg_stats_shard_g != 0 ? cfg_stats_shard_g : cfg_stats_claim_shard();
+    /* the getters take a const configuration, the counters are the only thing they write */
+    cfg_stats_shard_t* counters = (cfg_stats_shard_t*)&cfg->shards[shard - 1];
+
+    if (shard <= CFG_STATS_SHARDS) {
+        cfg_stats_bump(&counters->lookups);
+        if (setting == NULL) {
+            cfg_stats_bump(&counters->misses);
+        }
+    } else {
+        __atomic_fetch_add(&counters->lookups, 1, __ATOMIC_RELAXED);
+        if (setting == NULL) {
+            __atomic_fetch_add(&counters->misses, 1, __ATOMIC_RELAXED);
+        }
+    }
+#endif
+}
+
+CFG_INTERNAL void cfg_setting_convert(const cfg_t* cfg, size_t pos, cfg_setting_t* tmp);
+
+/**
+ * @brief decodes a setting of the settings table, a lazy number is converted but stays lazy in the table
+ * @param cfg configuration object
+ * @param pos position of the setting
+ * @param tmp (out) decoded setting
+ * @returns tmp
+*/
+static inline cfg_setting_t* cfg_setting_at(const cfg_t* cfg, size_t pos, cfg_setting_t* tmp) {
+    const cfg_value_slot_t* value = &cfg->values[pos];
+
+    tmp->type = (enum cfg_setting_type_e)(cfg->types[pos] & CFG_SETTING_TYPE);
+    tmp->view = (cfg->types[pos] & CFG_SETTING_VIEW) != 0;
+    tmp->lazy = (cfg->types[pos] & CFG_SETTING_LAZY) != 0;
+    tmp->errnum = CFG_SUCCESS;
+    tmp->identifier = cfg->identifiers[pos];
+    tmp->identifier_len = cfg->identifier_lens[pos];
+    tmp->hash = cfg->hashes[pos];
+
+    if (tmp->lazy) {
+        cfg_setting_convert(cfg, pos, tmp);
+        return tmp;
+    }
+
+    switch (tmp->type) {
+        case CFG_STYPE_INT: {
+            tmp->integer = value->integer;
+            break;
+        }
+        case CFG_STYPE_FLOAT: {
+#ifdef CFG_FLOAT_DOUBLE
+            tmp->floating = value->floating;
+#else
+            tmp->floating = *value->floating;
+#endif
+            break;
+        }
+        case CFG_STYPE_STRING: {
+            tmp->string = tmp->view ? value->string_view->ptr : (char*)value->string->bytes;
+            tmp->string_len = tmp->view ? value->string_view->len : value->string->len;
+            break;
+        }
+        case CFG_STYPE_BOOL: {
+            tmp->boolean = value->boolean;
+            break;
+        }
+        case CFG_STYPE_ARRAY: {
+            tmp->array = value->array;
+            break;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return tmp;
+}
+
+/* not an id of the schema */
+#define CFG_SCHEMA_NONE SIZE_MAX
+
+/**
+ * @brief gets the last 8 bytes of an identifier, they tell apart identifiers with the same hash
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @returns last bytes of the identifier
+*/
+static inline uint64_t cfg_schema_tail(const char* identifier, size_t len) {
+    uint64_t tail = 0;
+
+    memcpy(&tail, &identifier[len < 8 ? 0 : len - 8], len < 8 ? len : 8);
+
+    return tail;
+}
+
+/**
+ * @brief gets the position of an identifier in the perfect hash of a schema, the displacement of its
+ * bucket is chosen by cfg_gen so that no two identifiers of the schema share a position
+ * @param hash hash of the identifier
+ * @param tail last bytes of the identifier
+ * @param displacement displacement of the bucket of the identifier
+ * @param len number of positions
+ * @returns position
+*/
+static inline size_t cfg_schema_position(uint32_t hash, uint64_t tail, uint32_t displacement, size_t len) {
+    uint64_t x = (((uint64_t)hash << 32 | displacement) ^ (tail * 0xff51afd7ed558ccdULL)) * 0x9e3779b97f4a7c15ULL;
+
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+
+    return (size_t)(((x >> 32) * len) >> 32);
+}
+
+/**
+ * @brief gets the bucket of an identifier in the perfect hash of a schema
+ * @param hash hash of the identifier
+ * @param len number of buckets
+ * @returns bucket
+*/
+static inline size_t cfg_schema_bucket(uint32_t hash, size_t len) {
+    return (size_t)(((uint64_t)hash * len) >> 32);
+}
+
+CFG_INTERNAL uint32_t cfg_hash(const char* str, size_t len);
+CFG_INTERNAL size_t cfg_find_setting(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash);
+CFG_INTERNAL cfg_setting_t* cfg_lookup(const cfg_t* cfg, const char* identifier, size_t len, cfg_setting_t* tmp);
+CFG_INTERNAL size_t cfg_schema_find(const cfg_schema_t* schema, const char* identifier, size_t len, uint32_t hash);
+CFG_INTERNAL void cfg_index_setting(cfg_t* cfg, size_t pos);
+CFG_INTERNAL void cfg_index_insert(cfg_index_slot_t* index, size_t cap, uint32_t hash, uint32_t setting);
+CFG_INTERNAL void cfg_strings_drop(cfg_t* cfg);
+CFG_INTERNAL extern const cfg_float_t cfg_pow10_list[CFG_FLOAT_POW10_MAX + 1];
+CFG_INTERNAL int cfg_index_grow(cfg_t* cfg);
+CFG_INTERNAL int cfg_reserve_settings(cfg_t* cfg, size_t n);
+CFG_INTERNAL void cfg_move_settings(cfg_t* cfg, size_t pos, const cfg_t* from, size_t from_pos, size_t n);
+CFG_INTERNAL void cfg_take_arena(cfg_t* cfg, cfg_t* part);
+CFG_INTERNAL int cfg_index_lines(cfg_t* cfg, const char* str, size_t len, size_t base);
+CFG_INTERNAL cfg_setting_t* cfg_image_find(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash, cfg_setting_t* tmp);
+CFG_INTERNAL size_t cfg_image_len(const cfg_t* cfg);
+CFG_INTERNAL cfg_setting_t* cfg_image_setting(const cfg_t* cfg, size_t i, cfg_setting_t* tmp);
+CFG_INTERNAL void cfg_init(cfg_t* cfg);
+CFG_INTERNAL void cfg_clear(cfg_t* cfg);
+CFG_INTERNAL int cfg_map_file(cfg_t* cfg, const char* path, char** ptr, size_t* len);
+CFG_INTERNAL int cfg_keep_mapping(cfg_t* cfg, char* ptr, size_t len);
+CFG_INTERNAL int cfg_merge(cfg_t* cfg, cfg_t* part);
+CFG_INTERNAL int cfg_load_stream(cfg_t* cfg, const char* path);
+CFG_INTERNAL void cfg_tree_drop(cfg_t* cfg);
+CFG_INTERNAL size_t cfg_tree_size(const cfg_t* cfg);
+CFG_INTERNAL cfg_setting_t* cfg_layer_find(const cfg_t* cfg, const char* identifier, size_t len, uint32_t hash, cfg_setting_t* tmp);
+CFG_INTERNAL int cfg_write_all(const cfg_t* cfg, bool layers, int fd, char** str, size_t* len);
+CFG_INTERNAL int cfg_write_line(const cfg_setting_t* setting, char** buf, size_t* cap, size_t* len);
+CFG_INTERNAL int cfg_write_fd(int fd, const char* buf, size_t len);
+CFG_INTERNAL int cfg_set_setting_len(cfg_t* cfg, const char* identifier, size_t len, const cfg_value_t* value);
+CFG_INTERNAL int cfg_remove_setting_len(cfg_t* cfg, const char* identifier, size_t len);
+CFG_INTERNAL int cfg_journal_set(cfg_t* cfg, size_t pos);
+CFG_INTERNAL int cfg_journal_remove(cfg_t* cfg, const char* identifier, size_t len);
+CFG_INTERNAL void cfg_journal_drop(cfg_t* cfg);
+CFG_INTERNAL bool cfg_layer_shadowed(const cfg_t* cfg, const cfg_t* layer, const cfg_setting_t* setting);
+CFG_INTERNAL void cfg_arena_usage(const cfg_t* cfg, uint64_t* bytes, uint64_t* allocs);
+CFG_INTERNAL uint64_t cfg_now_ns(void);
+CFG_INTERNAL void cfg_stats_merge(cfg_t* cfg, const cfg_t* part, bool time);
+CFG_INTERNAL void cfg_stats_slow(const cfg_t* cfg, enum cfg_slow_e kind, const char* what, size_t len, uint64_t start);
+CFG_INTERNAL bool cfg_is_number_syntax_valid(const char* str, size_t len);
+CFG_INTERNAL int cfg_parse_integer_value(const char* str, size_t len, long long* result);
+CFG_INTERNAL int cfg_parse_floating_value(const char* str, size_t len, cfg_float_t* result);
+CFG_INTERNAL int cfg_bind_type_error(enum cfg_setting_type_e type);
+CFG_INTERNAL int cfg_array_measure(const char* str, size_t len, bool copy, cfg_array_t* shape, size_t* size);
+CFG_INTERNAL int cfg_array_decode(const char* str, size_t len, bool copy, cfg_array_t* array);
+CFG_INTERNAL int cfg_array_check(const cfg_value_t* value);
+CFG_INTERNAL size_t cfg_array_copy_size(const cfg_value_t* value);
+CFG_INTERNAL void cfg_array_copy(cfg_array_t* array, const cfg_value_t* value);
+CFG_INTERNAL void cfg_array_value(const cfg_array_t* array, cfg_value_t* value);
+CFG_INTERNAL bool cfg_array_equal(const cfg_array_t* a, const cfg_array_t* b);
@@ -0,0 +1,165 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "cfg_scan.h"
+
+/*
+ * structural character scanning. the parser looks for '=', '\n' and '#' through these
+ * functions, which compare 32 (AVX2, chosen at runtime) or 16 (SSE2) bytes at a time.
+ * build with CFG_NO_AVX2 or CFG_NO_SIMD to restrict them to SSE2 or to the scalar loops.
+*/
+
+#if !defined(CFG_NO_SIMD) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define CFG_SCAN_SSE2
+#include <immintrin.h>
+#if !defined(CFG_NO_AVX2) && (defined(__GNUC__) || defined(__clang__))
+#define CFG_SCAN_AVX2
+#endif
+#endif
+
+/**
+ * @brief finds the first occurrence of one of two characters, one byte at a time
+ * @param str pointer to the buffer
+ * @param pos position to start from
+ * @param len length of the buffer
+ * @param a first character to look for
+ * @param b second character to look for
+ * @returns position of the first occurrence, len if there is none
+*/
+static size_t cfg_scan_find_scalar(const char* str, size_t pos, size_t len, char a, char b) {
+    while (pos < len && str[pos] != a && str[pos] != b) {
+        pos += 1;
+    }
+
+    return pos;
+}
+
+/**
+ * @brief counts the occurrences of a character, one byte at a time
+ * @param str pointer to the buffer
+ * @param len length of the buffer
+ * @param c character to count
+ * @returns number of occurrences
+*/
+static size_t cfg_scan_count_scalar(const char* str, size_t len, char c) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        count += str[i] == c;
+    }
+
+    return count;
+}
+
+#ifdef CFG_SCAN_SSE2
+static size_t cfg_scan_find_sse2(const char* str, size_t pos, size_t len, char a, char b) {
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+    __m128i chunk;
+    unsigned mask;
+
+    for (; pos + 16 <= len; pos += 16) {
+        chunk = _mm_loadu_si128((const __m128i*)&str[pos]);
+        mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return cfg_scan_find_scalar(str, pos, len, a, b);
+}
+
+static size_t cfg_scan_count_sse2(const char* str, size_t len, char c) {
+    __m128i vc = _mm_set1_epi8(c);
+    size_t count = 0;
+    size_t pos = 0;
+
+    for (; pos + 16 <= len; pos += 16) {
+        count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&str[pos]), vc)));
+    }
+
+    return count + cfg_scan_count_scalar(&str[pos], len - pos, c);
+}
+#endif
+
+#ifdef CFG_SCAN_AVX2
+__attribute__((target("avx2")))
+static size_t cfg_scan_find_avx2(const char* str, size_t pos, size_t len, char a, char b) {
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+    __m256i chunk;
+    unsigned mask;
+
+    for (; pos + 32 <= len; pos += 32) {
+        chunk = _mm256_loadu_si256((const __m256i*)&str[pos]);
+        mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return cfg_scan_find_sse2(str, pos, len, a, b);
+}
+
+__attribute__((target("avx2")))
+static size_t cfg_scan_count_avx2(const char* str, size_t len, char c) {
+    __m256i vc = _mm256_set1_epi8(c);
+    size_t count = 0;
+    size_t pos = 0;
+
+    for (; pos + 32 <= len; pos += 32) {
+        count += (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&str[pos]), vc)));
+    }
+
+    return count + cfg_scan_count_sse2(&str[pos], len - pos, c);
+}
+
+/**
+ * @brief checks wether the cpu supports AVX2, the cpu features are read once by the compiler runtime
+ * @returns true if AVX2 can be used
+*/
+static bool cfg_scan_has_avx2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/**
+ * @brief finds the first occurrence of one of two characters
+ * @param str pointer to the buffer
+ * @param pos position to start from
+ * @param len length of the buffer
+ * @param a first character to look for
+ * @param b second character to look for, same as a to look for a single character
+ * @returns position of the first occurrence, len if there is none
+*/
+size_t cfg_scan_find(const char* str, size_t pos, size_t len, char a, char b) {
+#if defined(CFG_SCAN_AVX2)
+    if (cfg_scan_has_avx2()) {
+        return cfg_scan_find_avx2(str, pos, len, a, b);
+    }
+    return cfg_scan_find_sse2(str, pos, len, a, b);
+#elif defined(CFG_SCAN_SSE2)
+    return cfg_scan_find_sse2(str, pos, len, a, b);
+#else
+    return cfg_scan_find_scalar(str, pos, len, a, b);
+#endif
+}
+
+/**
+ * @brief counts the occurrences of a character, used to compute line numbers from newline masks
+ * @param str pointer to the buffer
+ * @param len length of the buffer
+ * @param c character to count
+ * @returns number of occurrences
+*/
+size_t cfg_scan_count(const char* str, size_t len, char c) {
+#if defined(CFG_SCAN_AVX2)
+    if (cfg_scan_has_avx2()) {
+        return cfg_scan_count_avx2(str, len, c);
+    }
+    return cfg_scan_count_sse2(str, len, c);
+#elif defined(CFG_SCAN_SSE2)
+    return cfg_scan_count_sse2(str, len, c);
+#else
+    return cfg_scan_count_scalar(str, len, c);
+#endif
+}
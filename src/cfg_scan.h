@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+#include "cfg_private.h"
+
+CFG_INTERNAL size_t cfg_scan_find(const char* str, size_t pos, size_t len, char a, char b);
+CFG_INTERNAL size_t cfg_scan_count(const char* str, size_t len, char c);
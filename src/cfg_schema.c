@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "cfg_private.h"
+
+/*
+ * a schema is generated by cfg_gen from the identifiers known at build time. it maps every
+ * identifier to an id with a perfect hash: the hash of the identifier picks a bucket, the
+ * displacement of the bucket along with the hash and the last bytes of the identifier pick
+ * the position, and the positions of the schema identifiers are all different. parsing stores
+ * the first setting of every schema identifier in a slot array indexed by id, so cfg_get_by_id
+ * is a single array access. the other identifiers go to the hash index as usual, unless the
+ * schema is used without overflow.
+*/
+
+/**
+ * @brief finds the id of an identifier in a schema
+ * @param schema schema
+ * @param identifier pointer to the identifier
+ * @param len length of the identifier
+ * @param hash hash of the identifier
+ * @returns id of the identifier, CFG_SCHEMA_NONE if it isn't part of the schema
+*/
+size_t cfg_schema_find(const cfg_schema_t* schema, const char* identifier, size_t len, uint32_t hash) {
+    uint32_t displacement = schema->displacements[cfg_schema_bucket(hash, schema->buckets_len)];
+    uint32_t id = schema->positions[cfg_schema_position(hash, cfg_schema_tail(identifier, len), displacement, schema->positions_len)];
+
+    /* a free position or another identifier */
+    if (id == 0 || schema->identifier_lens[id - 1] != len || memcmp(schema->identifiers[id - 1], identifier, len) != 0) {
+        return CFG_SCHEMA_NONE;
+    }
+
+    return id - 1;
+}
+
+/**
+ * @brief sets the schema a configuration is parsed with. the settings of its identifiers are then
+ * read by id with cfg_get_by_id_ctx, the getters taking an identifier string keep working.
+ * the schema must outlive the configuration, cfg_free_ctx keeps it. with a schema, edits rebuild the index
+ * @param cfg configuration object, without settings
+ * @param schema schema generated by cfg_gen, NULL to stop using one
+ * @param overflow true to index identifiers missing from the schema, false to fail parsing on them
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_use_schema_ctx(cfg_t* cfg, const cfg_schema_t* schema, bool overflow) {
+    uint32_t* slots = NULL;
+
+    if (cfg->settings_len != 0 || cfg->image != NULL) {
+        cfg->errnum = CFG_ESCHEMA;
+        return 1;
+    }
+
+    if (schema != NULL) {
+        if (schema->len == 0 || schema->buckets_len == 0 || schema->positions_len == 0) {
+            cfg->errnum = CFG_ESCHEMA;
+            return 1;
+        }
+
+        /* a schema generated against another hash function doesn't find its own identifiers */
+        for (size_t id = 0; id < schema->len; id++) {
+            if (cfg_schema_find(schema, schema->identifiers[id], schema->identifier_lens[id],
+                cfg_hash(schema->identifiers[id], schema->identifier_lens[id])) != id) {
+                cfg->errnum = CFG_ESCHEMA;
+                return 1;
+            }
+        }
+
+        slots = calloc(schema->len, sizeof(uint32_t));
+        if (slots == NULL) {
+            cfg->errnum = CFG_EMEM;
+            return 1;
+        }
+    }
+
+    free(cfg->slots);
+    cfg->slots = slots;
+    cfg->schema = schema;
+    cfg->overflow = overflow;
+
+    return 0;
+}
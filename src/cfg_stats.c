@@ -0,0 +1,150 @@
+#include <string.h>
+#include <time.h>
+
+#include "cfg_private.h"
+
+_Thread_local size_t cfg_stats_shard_g = 0;
+
+static size_t cfg_stats_shards_g = 0; /* shards handed out */
+
+/**
+ * @brief gives the calling thread the next lookup counter shard, for good. the threads past
+ * CFG_STATS_SHARDS get the shared one
+ * @returns shard of the thread + 1
+*/
+size_t cfg_stats_claim_shard(void) {
+    size_t shard = __atomic_fetch_add(&cfg_stats_shards_g, 1, __ATOMIC_RELAXED);
+
+    cfg_stats_shard_g = (shard < CFG_STATS_SHARDS ? shard : CFG_STATS_SHARDS) + 1;
+
+    return cfg_stats_shard_g;
+}
+
+/**
+ * @brief gets a monotonic time in nanoseconds
+ * @returns time in nanoseconds
+*/
+uint64_t cfg_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief calls the slow hook of a configuration if an operation took longer than its threshold
+ * @param cfg configuration object, with a slow hook
+ * @param kind operation
+ * @param what path or identifier the operation was about, may be NULL
+ * @param len length of what
+ * @param start time the operation started at
+*/
+void cfg_stats_slow(const cfg_t* cfg, enum cfg_slow_e kind, const char* what, size_t len, uint64_t start) {
+    uint64_t ns = cfg_now_ns() - start;
+
+    if (ns >= cfg->slow_ns) {
+        cfg->slow_hook(kind, what, len, ns, cfg->slow_user);
+    }
+}
+
+/**
+ * @brief adds the parse counters of a configuration parsed separately to the ones of another
+ * @param cfg configuration object
+ * @param part configuration object that parsed part of the text of cfg
+ * @param time true to add the parse time too, false when it overlaps with other parts
+*/
+void cfg_stats_merge(cfg_t* cfg, const cfg_t* part, bool time) {
+    if (time) {
+        cfg_stats_add(&cfg->stats.parse_ns, part->stats.parse_ns);
+    }
+    cfg_stats_add(&cfg->stats.parse_bytes, part->stats.parse_bytes);
+    cfg_stats_add(&cfg->stats.lines, part->stats.lines);
+    cfg_stats_add(&cfg->stats.integers, part->stats.integers);
+    cfg_stats_add(&cfg->stats.floats, part->stats.floats);
+    cfg_stats_add(&cfg->stats.strings, part->stats.strings);
+    cfg_stats_add(&cfg->stats.booleans, part->stats.booleans);
+    cfg_stats_add(&cfg->stats.arrays, part->stats.arrays);
+    cfg_stats_add(&cfg->stats.shared_strings, part->stats.shared_strings);
+}
+
+/**
+ * @brief gets the statistics of a configuration: what its parses took, the settings they found, the memory
+ * it holds and the lookups of its getters. the counters are kept since the configuration was created or
+ * last freed, all zero but the memory when built with CFG_NO_STATS. can be called while other threads
+ * look settings up, their latest lookups may then be missing
+ * @param cfg configuration object
+ * @returns statistics
+*/
+cfg_stats_t cfg_get_stats_ctx(const cfg_t* cfg) {
+    cfg_stats_t stats;
+    uint64_t arena_bytes;
+    uint64_t arena_allocs;
+
+    stats.parse_ns = cfg->stats.parse_ns;
+    stats.parse_bytes = cfg->stats.parse_bytes;
+    stats.lines = cfg->stats.lines;
+    stats.integers = cfg->stats.integers;
+    stats.floats = cfg->stats.floats;
+    stats.strings = cfg->stats.strings;
+    stats.booleans = cfg->stats.booleans;
+    stats.arrays = cfg->stats.arrays;
+    stats.shared_strings = cfg->stats.shared_strings;
+    stats.lookups = 0;
+    stats.misses = 0;
+
+    for (size_t i = 0; i <= CFG_STATS_SHARDS; i++) {
+        stats.lookups += __atomic_load_n(&cfg->shards[i].lookups, __ATOMIC_RELAXED);
+        stats.misses += __atomic_load_n(&cfg->shards[i].misses, __ATOMIC_RELAXED);
+    }
+
+    /* the arena, then every table that is allocated on its own */
+    cfg_arena_usage(cfg, &arena_bytes, &arena_allocs);
+    stats.heap_bytes = arena_bytes;
+    stats.heap_allocs = arena_allocs;
+
+    if (cfg->values != NULL) {
+        stats.heap_bytes += CFG_SETTING_BYTES * cfg->settings_cap;
+        stats.heap_allocs += 1;
+    }
+    if (cfg->index != NULL) {
+        stats.heap_bytes += sizeof(cfg_index_slot_t) * cfg->index_cap;
+        stats.heap_allocs += 1;
+    }
+    if (cfg->strings != NULL) {
+        stats.heap_bytes += sizeof(cfg_index_slot_t) * cfg->strings_cap;
+        stats.heap_allocs += 1;
+    }
+    if (cfg->lines != NULL) {
+        stats.heap_bytes += sizeof(cfg_line_t) * cfg->lines_cap;
+        stats.heap_allocs += 1;
+    }
+    if (cfg->slots != NULL) {
+        stats.heap_bytes += sizeof(uint32_t) * cfg->schema->len;
+        stats.heap_allocs += 1;
+    }
+    if (cfg_tree_size(cfg) != 0) {
+        stats.heap_bytes += cfg_tree_size(cfg);
+        stats.heap_allocs += 1;
+    }
+    if (cfg->path != NULL) {
+        stats.heap_bytes += strlen(cfg->path) + 1;
+        stats.heap_allocs += 1;
+    }
+
+    return stats;
+}
+
+/**
+ * @brief calls a hook when a parse or a lookup of a configuration takes longer than a threshold, to trace them.
+ * lookups are only timed while a hook is set. the hook stays when the configuration is freed
+ * with cfg_free. lookups may call it from several threads at once
+ * @param cfg configuration object
+ * @param threshold_ns duration from which the hook is called
+ * @param hook called with the operation and its duration, NULL to remove the hook
+ * @param user passed to the hook
+*/
+void cfg_set_slow_hook_ctx(cfg_t* cfg, uint64_t threshold_ns, cfg_slow_cb_t hook, void* user) {
+    cfg->slow_ns = threshold_ns;
+    cfg->slow_hook = hook;
+    cfg->slow_user = user;
+}
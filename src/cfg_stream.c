@@ -0,0 +1,304 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cfg_private.h"
+
+/*
+ * the grammar never looks past the end of a line, so a stream is parsed one run of complete lines
+ * at a time, straight from the fed buffer. only the unfinished line at the end of a feed is kept,
+ * and completed by the next feeds before being parsed on its own. once a line holds its assignment
+ * operator, or nothing but blanks, a '#' ends it for the parser, the rest is skipped rather than kept.
+ * the memory used is bounded by the longest line, not by the input size.
+*/
+
+/* size of the first line buffer */
+#define CFG_STREAM_LINE_MIN 256
+
+/* size of the reads of cfg_load_stream */
+#define CFG_STREAM_READ 16384
+
+/**
+ * @brief how far the kept line got
+*/
+enum cfg_stream_state_e {
+    CFG_STREAM_BLANK, /* blanks only */
+    CFG_STREAM_IDENTIFIER, /* before the assignment operator */
+    CFG_STREAM_VALUE, /* after the assignment operator */
+    CFG_STREAM_COMMENT, /* after the '#' ending the line, nothing more is kept */
+};
+
+struct cfg_stream_s {
+    enum cfg_stream_state_e state;
+    bool failed; /* the stream stopped on an error, ignores the next feeds */
+    int errnum;
+    size_t len;
+    size_t cap;
+    char line[]; /* unfinished line */
+};
+
+/**
+ * @brief makes room in the line buffer of the stream
+ * @param cfg configuration object
+ * @param n number of bytes the line buffer must hold
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_stream_reserve(cfg_t* cfg, size_t n) {
+    size_t cap = cfg->stream->cap;
+    cfg_stream_t* stream;
+
+    if (n <= cap) {
+        return 0;
+    }
+
+    while (cap < n) {
+        cap *= 2;
+    }
+
+    stream = realloc(cfg->stream, sizeof(cfg_stream_t) + cap);
+    if (stream == NULL) {
+        cfg->errnum = CFG_EMEM;
+        return 1;
+    }
+
+    stream->cap = cap;
+    cfg->stream = stream;
+
+    return 0;
+}
+
+/**
+ * @brief appends the beginning of a line to the unfinished line of the stream, up to the '#' ending it
+ * @param cfg configuration object
+ * @param str pointer to the bytes, without newline
+ * @param len number of bytes
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_stream_keep(cfg_t* cfg, const char* str, size_t len) {
+    cfg_stream_t* stream = cfg->stream;
+    size_t i;
+
+    if (stream->state == CFG_STREAM_COMMENT) {
+        return 0;
+    }
+
+    for (i = 0; i < len && stream->state != CFG_STREAM_COMMENT; i++) {
+        switch (str[i]) {
+            case '\r':
+            case '\t':
+            case ' ': {
+                break;
+            }
+            case '=': {
+                stream->state = CFG_STREAM_VALUE;
+                break;
+            }
+            /* a '#' in an identifier makes it invalid, and is kept so that the error is reported the same */
+            case '#': {
+                if (stream->state != CFG_STREAM_IDENTIFIER) {
+                    stream->state = CFG_STREAM_COMMENT;
+                    len = i;
+                }
+                break;
+            }
+            default: {
+                if (stream->state == CFG_STREAM_BLANK) {
+                    stream->state = CFG_STREAM_IDENTIFIER;
+                }
+                break;
+            }
+        }
+    }
+
+    if (cfg_stream_reserve(cfg, cfg->stream->len + len + 1) != 0) {
+        return 1;
+    }
+
+    stream = cfg->stream;
+    memcpy(&stream->line[stream->len], str, len);
+    stream->len += len;
+
+    return 0;
+}
+
+/**
+ * @brief parses the unfinished line of the stream and empties it
+ * @param cfg configuration object
+ * @param newline true if the line was completed by a newline
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+static int cfg_stream_flush(cfg_t* cfg, bool newline) {
+    cfg_stream_t* stream = cfg->stream;
+    size_t len = stream->len;
+
+    /* the newline moves the position of the configuration to the next line, the buffer has room for it */
+    if (newline) {
+        stream->line[len++] = '\n';
+    }
+
+    stream->len = 0;
+    stream->state = CFG_STREAM_BLANK;
+
+    return len != 0 && cfg_parse_ctx(cfg, stream->line, len, CFG_FLAG_NONE) != 0;
+}
+
+/**
+ * @brief starts parsing a config fed in pieces with cfg_stream_feed_ctx, from a pipe or a socket for instance.
+ * the settings are added to the configuration like cfg_parse_ctx does, identifiers and strings are copied
+ * @param cfg configuration object
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_stream_begin_ctx(cfg_t* cfg) {
+    if (cfg->stream == NULL) {
+        cfg->stream = malloc(sizeof(cfg_stream_t) + CFG_STREAM_LINE_MIN);
+        if (cfg->stream == NULL) {
+            cfg->errnum = CFG_EMEM;
+            return 1;
+        }
+        cfg->stream->cap = CFG_STREAM_LINE_MIN;
+    }
+
+    cfg->stream->state = CFG_STREAM_BLANK;
+    cfg->stream->failed = false;
+    cfg->stream->errnum = CFG_SUCCESS;
+    cfg->stream->len = 0;
+
+    return 0;
+}
+
+/**
+ * @brief parses the next piece of a config, pieces may end anywhere, in the middle of an identifier,
+ * a string or a comment. the complete lines are parsed in place, only the unfinished one is copied.
+ * after an error the next pieces are ignored until cfg_stream_end_ctx
+ * @param cfg configuration object
+ * @param buf pointer to the piece, only used during the call
+ * @param len length of the piece
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_stream_feed_ctx(cfg_t* cfg, const char* buf, size_t len) {
+    const char* newline;
+    size_t pos = 0;
+    size_t end = len;
+
+    if (cfg->stream == NULL) {
+        cfg->errnum = CFG_ESTREAM;
+        return 1;
+    }
+
+    if (cfg->stream->failed) {
+        cfg->errnum = cfg->stream->errnum;
+        return 1;
+    }
+
+    /* the line left unfinished by the previous pieces */
+    if (cfg->stream->len != 0 || cfg->stream->state != CFG_STREAM_BLANK) {
+        newline = memchr(buf, '\n', len);
+        pos = newline == NULL ? len : (size_t)(newline - buf);
+
+        if (cfg_stream_keep(cfg, buf, pos) != 0) {
+            goto cfg_stream_feed_fail;
+        }
+        if (newline == NULL) {
+            return 0;
+        }
+        if (cfg_stream_flush(cfg, true) != 0) {
+            goto cfg_stream_feed_fail;
+        }
+        pos += 1;
+    }
+
+    /* the complete lines, then the start of the next one */
+    while (end > pos && buf[end - 1] != '\n') {
+        end -= 1;
+    }
+
+    if (end > pos && cfg_parse_ctx(cfg, &buf[pos], end - pos, CFG_FLAG_NONE) != 0) {
+        goto cfg_stream_feed_fail;
+    }
+
+    if (cfg_stream_keep(cfg, &buf[end], len - end) != 0) {
+        goto cfg_stream_feed_fail;
+    }
+
+    return 0;
+
+cfg_stream_feed_fail:
+    cfg->stream->failed = true;
+    cfg->stream->errnum = cfg->errnum;
+
+    return 1;
+}
+
+/**
+ * @brief parses the last line of a config fed with cfg_stream_feed_ctx and releases the stream
+ * @param cfg configuration object
+ * @returns 0 on success, 1 otherwise with the configuration error set, to the first error of the stream
+*/
+int cfg_stream_end_ctx(cfg_t* cfg) {
+    int status = 1;
+
+    if (cfg->stream == NULL) {
+        cfg->errnum = CFG_ESTREAM;
+        return 1;
+    }
+
+    if (cfg->stream->failed) {
+        cfg->errnum = cfg->stream->errnum;
+    } else {
+        status = cfg_stream_flush(cfg, false);
+    }
+
+    free(cfg->stream);
+    cfg->stream = NULL;
+
+    return status;
+}
+
+/**
+ * @brief loads a config file that can't be mapped, a pipe, a socket or a file that doesn't report its size,
+ * with buffered reads fed to a stream
+ * @param cfg configuration object
+ * @param path path to the config file
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_load_stream(cfg_t* cfg, const char* path) {
+    int status = 1;
+    int fd;
+    ssize_t n;
+    char buf[CFG_STREAM_READ];
+
+    free(cfg->path);
+    cfg->path = strdup(path);
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        cfg->errnum = CFG_EOPEN;
+        return 1;
+    }
+
+    if (cfg_stream_begin_ctx(cfg) != 0) {
+        goto cfg_load_stream_close_fd;
+    }
+
+    do {
+        n = read(fd, buf, sizeof(buf));
+        if (n > 0 && cfg_stream_feed_ctx(cfg, buf, (size_t)n) != 0) {
+            break;
+        }
+    } while (n > 0 || (n == -1 && errno == EINTR));
+
+    if (n == -1 && errno != EINTR) {
+        free(cfg->stream);
+        cfg->stream = NULL;
+        cfg->errnum = CFG_EREAD;
+        goto cfg_load_stream_close_fd;
+    }
+
+    status = cfg_stream_end_ctx(cfg);
+
+cfg_load_stream_close_fd:
+    close(fd);
+
+    return status;
+}
@@ -0,0 +1,428 @@
+#include <string.h>
+
+#include "cfg_private.h"
+
+/*
+ * the prefix tree is a radix tree over the identifiers a lookup can find, built on the first
+ * prefix query and dropped when the settings change. every edge is labelled with a run of bytes
+ * pointing into one of the identifiers, so a prefix shared by many identifiers is stored once,
+ * as a single node, and nothing is copied. the nodes are laid out in preorder: the subtree of a
+ * node is the range of nodes that follows it, so the identifiers under a prefix are enumerated
+ * in sorted order by walking that range, and counted by reading the node. the tree is built from
+ * the sorted identifiers without any insertion, a node for every run of identifiers sharing the
+ * next byte, which gives at most two nodes per identifier.
+*/
+
+/**
+ * @brief node of the prefix tree
+*/
+typedef struct cfg_tree_node_s {
+    const char* label; /* bytes of the edge leading to the node, inside an identifier */
+    uint32_t label_len;
+    uint32_t setting; /* position + 1 of the setting whose identifier ends at the node, 0 if none */
+    uint32_t size; /* nodes in the subtree, the node included */
+    uint32_t count; /* settings in the subtree */
+} cfg_tree_node_t;
+
+struct cfg_tree_s {
+    size_t len;
+    cfg_tree_node_t nodes[]; /* root first, in preorder */
+};
+
+/**
+ * @brief identifier to place in the tree, with the position of its setting
+*/
+typedef struct cfg_tree_entry_s {
+    const char* identifier;
+    uint32_t len;
+    uint32_t setting; /* position in the compiled config, then in the settings table after it */
+} cfg_tree_entry_t;
+
+/**
+ * @brief node of the tree being built, with the identifiers under it that aren't in a child yet
+*/
+typedef struct cfg_tree_frame_s {
+    uint32_t node;
+    uint32_t depth; /* length of the prefix of the node */
+    size_t cursor;
+    size_t end;
+} cfg_tree_frame_t;
+
+/**
+ * @brief orders identifiers bytewise, a prefix before the identifiers it starts
+ * @param a first entry
+ * @param b second entry
+ * @returns negative, zero or positive like memcmp
+*/
+static int cfg_tree_compare(const void* a, const void* b) {
+    const cfg_tree_entry_t* x = a;
+    const cfg_tree_entry_t* y = b;
+    int order = memcmp(x->identifier, y->identifier, x->len < y->len ? x->len : y->len);
+
+    if (order != 0) {
+        return order;
+    }
+
+    return (x->len > y->len) - (x->len < y->len);
+}
+
+/**
+ * @brief gets a setting of a configuration by its position in the tree
+ * @param cfg configuration object
+ * @param pos position in the compiled config, then in the settings table after it
+ * @param tmp (out) decoded setting
+ * @returns tmp
+*/
+static const cfg_setting_t* cfg_tree_setting(const cfg_t* cfg, size_t pos, cfg_setting_t* tmp) {
+    size_t image_len = cfg_image_len(cfg);
+
+    return pos < image_len ? cfg_image_setting(cfg, pos, tmp) : cfg_setting_at(cfg, pos - image_len, tmp);
+}
+
+/**
+ * @brief lists the identifiers a lookup can find, the compiled config shadows the parsed settings
+ * and the first occurrence of an identifier shadows the next ones, removed settings are left out
+ * @param cfg configuration object
+ * @param len (out) number of identifiers
+ * @returns sorted identifiers, NULL if out of memory
+*/
+static cfg_tree_entry_t* cfg_tree_entries(const cfg_t* cfg, size_t* len) {
+    size_t image_len = cfg_image_len(cfg);
+    cfg_tree_entry_t* entries = malloc(sizeof(cfg_tree_entry_t) * (image_len + cfg->settings_len + 1));
+    const cfg_setting_t* setting;
+    cfg_setting_t tmp;
+    cfg_setting_t found;
+
+    if (entries == NULL) {
+        return NULL;
+    }
+
+    *len = 0;
+    for (size_t i = 0; i < image_len + cfg->settings_len; i++) {
+        setting = cfg_tree_setting(cfg, i, &tmp);
+
+        if (i >= image_len && (setting->type == CFG_STYPE_UNKNOWN
+            || (image_len != 0 && cfg_image_find(cfg, setting->identifier, setting->identifier_len, setting->hash, &found) != NULL)
+            || cfg_find_setting(cfg, setting->identifier, setting->identifier_len, setting->hash) != i - image_len)) {
+            continue;
+        }
+
+        entries[*len].identifier = setting->identifier;
+        entries[*len].len = (uint32_t)setting->identifier_len;
+        entries[*len].setting = (uint32_t)i;
+        *len += 1;
+    }
+
+    qsort(entries, *len, sizeof(cfg_tree_entry_t), cfg_tree_compare);
+
+    return entries;
+}
+
+/**
+ * @brief builds the prefix tree of a configuration
+ * @param cfg configuration object
+ * @returns tree, NULL if out of memory
+*/
+static cfg_tree_t* cfg_tree_build(const cfg_t* cfg) {
+    size_t n = 0;
+    size_t a;
+    size_t b;
+    size_t lcp;
+    size_t frames_len = 1;
+    size_t frames_cap = 64;
+    cfg_tree_entry_t* entries = cfg_tree_entries(cfg, &n);
+    cfg_tree_frame_t* frames = malloc(sizeof(cfg_tree_frame_t) * frames_cap);
+    cfg_tree_frame_t* frame;
+    cfg_tree_node_t* child;
+    cfg_tree_t* tree = malloc(sizeof(cfg_tree_t) + sizeof(cfg_tree_node_t) * (2 * n + 1));
+    void* tmp;
+
+    if (entries == NULL || frames == NULL || tree == NULL) {
+        goto cfg_tree_build_fail;
+    }
+
+    /* identifiers aren't empty, the root holds no setting */
+    tree->len = 1;
+    tree->nodes[0] = (cfg_tree_node_t){ .label = NULL, .label_len = 0, .setting = 0, .size = 1, .count = (uint32_t)n };
+    frames[0] = (cfg_tree_frame_t){ .node = 0, .depth = 0, .cursor = 0, .end = n };
+
+    while (frames_len != 0) {
+        frame = &frames[frames_len - 1];
+        if (frame->cursor == frame->end) {
+            tree->nodes[frame->node].size = (uint32_t)(tree->len - frame->node);
+            frames_len -= 1;
+            continue;
+        }
+
+        /* the identifiers sharing the next byte make a child, labelled up to where they diverge */
+        a = frame->cursor;
+        b = a + 1;
+        while (b < frame->end && entries[b].identifier[frame->depth] == entries[a].identifier[frame->depth]) {
+            b += 1;
+        }
+        for (lcp = frame->depth + 1; lcp < entries[a].len && lcp < entries[b - 1].len
+            && entries[a].identifier[lcp] == entries[b - 1].identifier[lcp]; lcp++);
+        frame->cursor = b;
+
+        child = &tree->nodes[tree->len];
+        child->label = &entries[a].identifier[frame->depth];
+        child->label_len = (uint32_t)(lcp - frame->depth);
+        child->setting = 0;
+        child->size = 1;
+        child->count = (uint32_t)(b - a);
+
+        /* the identifier ending at the child sorts first */
+        if (entries[a].len == lcp) {
+            child->setting = entries[a].setting + 1;
+            a += 1;
+        }
+
+        if (frames_len == frames_cap) {
+            frames_cap *= 2;
+            tmp = realloc(frames, sizeof(cfg_tree_frame_t) * frames_cap);
+            if (tmp == NULL) {
+                goto cfg_tree_build_fail;
+            }
+            frames = tmp;
+        }
+        frames[frames_len++] = (cfg_tree_frame_t){ .node = (uint32_t)tree->len, .depth = (uint32_t)lcp, .cursor = a, .end = b };
+        tree->len += 1;
+    }
+
+    free(entries);
+    free(frames);
+
+    tmp = realloc(tree, sizeof(cfg_tree_t) + sizeof(cfg_tree_node_t) * tree->len);
+
+    return tmp != NULL ? tmp : tree;
+
+cfg_tree_build_fail:
+    free(entries);
+    free(frames);
+    free(tree);
+
+    return NULL;
+}
+
+/**
+ * @brief gets the prefix tree of a configuration, building it if the settings changed since the last
+ * prefix query. queries may run concurrently on a shared snapshot, the first tree published wins
+ * @param cfg configuration object
+ * @returns tree, NULL if out of memory
+*/
+static const cfg_tree_t* cfg_tree_get(const cfg_t* cfg) {
+    cfg_tree_t* tree = __atomic_load_n(&cfg->tree, __ATOMIC_ACQUIRE);
+    cfg_tree_t* expected = NULL;
+
+    if (tree != NULL) {
+        return tree;
+    }
+
+    tree = cfg_tree_build(cfg);
+    if (tree == NULL) {
+        return NULL;
+    }
+
+    /* the tree is a cache, the only thing a prefix query writes */
+    if (!__atomic_compare_exchange_n((cfg_tree_t**)&cfg->tree, &expected, tree, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(tree);
+        tree = expected;
+    }
+
+    return tree;
+}
+
+/**
+ * @brief frees the prefix tree of a configuration, its settings changed
+ * @param cfg configuration object
+*/
+void cfg_tree_drop(cfg_t* cfg) {
+    free(cfg->tree);
+    cfg->tree = NULL;
+}
+
+/**
+ * @brief finds the node under which every identifier starts with a prefix
+ * @param tree prefix tree
+ * @param prefix pointer to the prefix
+ * @param len length of the prefix
+ * @returns position of the node, 0 for the root, SIZE_MAX if no identifier starts with the prefix
+*/
+static size_t cfg_tree_find(const cfg_tree_t* tree, const char* prefix, size_t len) {
+    const cfg_tree_node_t* nodes = tree->nodes;
+    size_t node = 0;
+    size_t depth = 0;
+    size_t child;
+    size_t n;
+
+    while (depth < len) {
+        /* the children follow their parent, each after the subtree of the previous one */
+        for (child = node + 1; child < node + nodes[node].size && nodes[child].label[0] != prefix[depth]; child += nodes[child].size);
+
+        if (child == node + nodes[node].size) {
+            return SIZE_MAX;
+        }
+
+        n = len - depth < nodes[child].label_len ? len - depth : nodes[child].label_len;
+        if (memcmp(nodes[child].label, &prefix[depth], n) != 0) {
+            return SIZE_MAX;
+        }
+
+        depth += nodes[child].label_len;
+        node = child;
+    }
+
+    return node;
+}
+
+/**
+ * @brief hands the settings of a layer starting with a prefix to a callback, in identifier order,
+ * skipping the ones shadowed by the layers above it
+ * @param cfg top layer
+ * @param layer configuration object
+ * @param prefix pointer to the prefix
+ * @param len length of the prefix
+ * @param callback called for every setting, returns non-zero to stop, NULL to count the settings
+ * @param user passed to the callback
+ * @param count (out) number of settings found, incremented
+ * @returns 0 on success, 1 when stopped by the callback, minus an error number otherwise: out of memory,
+ * or a lazy number that doesn't convert
+*/
+static int cfg_tree_walk(const cfg_t* cfg, const cfg_t* layer, const char* prefix, size_t len,
+    cfg_setting_cb_t callback, void* user, size_t* count) {
+    const cfg_tree_t* tree = cfg_tree_get(layer);
+    const cfg_setting_t* setting;
+    cfg_setting_t tmp;
+    cfg_value_t value;
+    size_t node;
+
+    if (tree == NULL) {
+        return -CFG_EMEM;
+    }
+
+    node = cfg_tree_find(tree, prefix, len);
+    if (node == SIZE_MAX) {
+        return 0;
+    }
+
+    /* counting a single layer doesn't need the settings */
+    if (callback == NULL && layer == cfg && cfg->base == NULL) {
+        *count += tree->nodes[node].count;
+        return 0;
+    }
+
+    for (size_t i = node; i < node + tree->nodes[node].size; i++) {
+        if (tree->nodes[i].setting == 0) {
+            continue;
+        }
+
+        setting = cfg_tree_setting(layer, tree->nodes[i].setting - 1, &tmp);
+        if (layer != cfg && cfg_layer_shadowed(cfg, layer, setting)) {
+            continue;
+        }
+
+        *count += 1;
+        if (callback == NULL) {
+            continue;
+        }
+
+        if (setting->errnum != CFG_SUCCESS) {
+            return -setting->errnum;
+        }
+
+        value.type = setting->type;
+        switch (setting->type) {
+            case CFG_STYPE_INT: {
+                value.integer = setting->integer;
+                break;
+            }
+            case CFG_STYPE_FLOAT: {
+                value.floating = setting->floating;
+                break;
+            }
+            case CFG_STYPE_STRING: {
+                value.string = setting->string;
+                value.string_len = setting->string_len;
+                break;
+            }
+            case CFG_STYPE_BOOL: {
+                value.boolean = setting->boolean;
+                break;
+            }
+            case CFG_STYPE_ARRAY: {
+                cfg_array_value(setting->array, &value);
+                break;
+            }
+            case CFG_STYPE_UNKNOWN: {
+                break;
+            }
+        }
+
+        if (callback(setting->identifier, setting->identifier_len, &value, user) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief hands every setting whose identifier starts with a prefix to a callback, in identifier order,
+ * "server.http." lists the settings of that namespace. the first query builds a prefix tree of the
+ * identifiers, kept until the settings change, then a query takes a time proportional to the number
+ * of settings it finds. with base layers, the settings of every layer follow the ones of the layer above
+ * @param cfg configuration object
+ * @param prefix prefix of the identifiers, "" for every setting
+ * @param callback called for every setting, the identifier isn't NUL terminated in zero-copy mode, returns non-zero to stop
+ * @param user passed to the callback
+ * @returns 0 on success or when stopped by the callback, 1 otherwise with the configuration error set
+*/
+int cfg_foreach_prefix_ctx(cfg_t* cfg, const char* prefix, cfg_setting_cb_t callback, void* user) {
+    size_t len = strlen(prefix);
+    size_t count = 0;
+    int status = 0;
+
+    for (const cfg_t* layer = cfg; layer != NULL && status == 0; layer = layer->base) {
+        status = cfg_tree_walk(cfg, layer, prefix, len, callback, user, &count);
+    }
+
+    if (status < 0) {
+        cfg_set_errnum(cfg, -status);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief counts the settings whose identifier starts with a prefix, read from the prefix tree
+ * without visiting the settings unless the configuration has base layers
+ * @param cfg configuration object
+ * @param prefix prefix of the identifiers, "" for every setting
+ * @param count (out) number of settings
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_count_prefix_ctx(cfg_t* cfg, const char* prefix, size_t* count) {
+    size_t len = strlen(prefix);
+
+    *count = 0;
+    for (const cfg_t* layer = cfg; layer != NULL; layer = layer->base) {
+        if (cfg_tree_walk(cfg, layer, prefix, len, NULL, NULL, count) != 0) {
+            cfg_set_errnum(cfg, CFG_EMEM);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief gets the memory held by the prefix tree of a configuration
+ * @param cfg configuration object
+ * @returns size of the tree in bytes, 0 if it isn't built
+*/
+size_t cfg_tree_size(const cfg_t* cfg) {
+    const cfg_tree_t* tree = __atomic_load_n(&cfg->tree, __ATOMIC_ACQUIRE);
+
+    return tree == NULL ? 0 : sizeof(cfg_tree_t) + sizeof(cfg_tree_node_t) * tree->len;
+}
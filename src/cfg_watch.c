@@ -0,0 +1,335 @@
+#include <errno.h>
+#include <poll.h>
+#include <stdalign.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "cfg_private.h"
+
+/* events that may leave a new version of the file, editors often write a copy and rename it over the original */
+#define CFG_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO)
+
+struct cfg_watch_s {
+    cfg_live_t* live;
+    cfg_reader_t* old_reader;
+    cfg_reader_t* new_reader;
+    char* path;
+    const char* name; /* file name in path, the watch is on the directory so it survives renames */
+    int fd;
+    int flags;
+    int debounce_ms;
+    cfg_change_cb_t callback;
+    void* user;
+    int errnum;
+};
+
+/**
+ * @brief starts watching a config file, cfg_watch_process reloads it into the live configuration
+ * when it changes and reports the settings that changed
+ * @param live live configuration
+ * @param path path to the config file
+ * @param flags parsing flags, with CFG_FLAG_ZEROCOPY the file must be replaced by renames only
+ * @param debounce_ms how long the file must stay untouched before it is reloaded
+ * @param callback called for every added, removed or changed setting
+ * @param user passed to the callback
+ * @returns watcher, NULL on failure with errno set
+*/
+cfg_watch_t* cfg_watch_new(cfg_live_t* live, const char* path, int flags, int debounce_ms, cfg_change_cb_t callback, void* user) {
+    cfg_watch_t* watch = calloc(1, sizeof(cfg_watch_t));
+    char* slash;
+
+    if (watch == NULL) {
+        return NULL;
+    }
+
+    watch->live = live;
+    watch->flags = flags;
+    watch->debounce_ms = debounce_ms;
+    watch->callback = callback;
+    watch->user = user;
+    watch->fd = -1;
+
+    watch->path = strdup(path);
+    watch->old_reader = cfg_reader_new(live);
+    watch->new_reader = cfg_reader_new(live);
+    if (watch->path == NULL || watch->old_reader == NULL || watch->new_reader == NULL) {
+        errno = ENOMEM;
+        goto cfg_watch_new_fail;
+    }
+
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd == -1) {
+        goto cfg_watch_new_fail;
+    }
+
+    /* the directory is watched with the path cut at the last slash, then restored */
+    slash = strrchr(watch->path, '/');
+    if (slash == NULL) {
+        watch->name = watch->path;
+        if (inotify_add_watch(watch->fd, ".", CFG_WATCH_EVENTS) == -1) {
+            goto cfg_watch_new_fail;
+        }
+    } else {
+        watch->name = slash + 1;
+        *slash = '\0';
+        if (inotify_add_watch(watch->fd, slash == watch->path ? "/" : watch->path, CFG_WATCH_EVENTS) == -1) {
+            *slash = '/';
+            goto cfg_watch_new_fail;
+        }
+        *slash = '/';
+    }
+
+    return watch;
+
+cfg_watch_new_fail:
+    cfg_watch_free(watch);
+
+    return NULL;
+}
+
+/**
+ * @brief stops watching and frees the watcher, the live configuration is left as is
+ * @param watch watcher
+*/
+void cfg_watch_free(cfg_watch_t* watch) {
+    int saved_errno = errno;
+
+    if (watch == NULL) {
+        return;
+    }
+
+    if (watch->fd != -1) {
+        close(watch->fd);
+    }
+
+    cfg_reader_free(watch->old_reader);
+    cfg_reader_free(watch->new_reader);
+    free(watch->path);
+    free(watch);
+
+    errno = saved_errno;
+}
+
+/**
+ * @brief gets the inotify file descriptor of a watcher, it becomes readable when the directory changes
+ * @param watch watcher
+ * @returns file descriptor
+*/
+int cfg_watch_fd(const cfg_watch_t* watch) {
+    return watch->fd;
+}
+
+/**
+ * @brief gets the error number of the latest cfg_watch_process call
+ * @param watch watcher
+ * @returns error number
+*/
+int cfg_get_errno_watch(const cfg_watch_t* watch) {
+    return watch->errnum;
+}
+
+/**
+ * @brief drains the pending inotify events
+ * @param watch watcher
+ * @returns 1 if one of them concerns the config file, 0 if none does, -1 on failure
+*/
+static int cfg_watch_read(cfg_watch_t* watch) {
+    alignas(struct inotify_event) char buf[4096];
+    const struct inotify_event* event;
+    int matched = 0;
+    ssize_t len;
+
+    for (;;) {
+        len = read(watch->fd, buf, sizeof(buf));
+        if (len == -1 && errno == EINTR) {
+            continue;
+        }
+        if (len == -1 && errno == EAGAIN) {
+            return matched;
+        }
+        if (len <= 0) {
+            return -1;
+        }
+
+        for (char* ptr = buf; ptr < buf + len; ptr += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event*)ptr;
+
+            /* after an overflow the events are lost, assume the file changed */
+            if ((event->mask & IN_Q_OVERFLOW) != 0 || (event->len != 0 && strcmp(event->name, watch->name) == 0)) {
+                matched = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief compares the values of two settings
+ * @param a setting
+ * @param b setting
+ * @returns true if both have the same type and value
+*/
+static bool cfg_setting_equal(const cfg_setting_t* a, const cfg_setting_t* b) {
+    if (a->type != b->type) {
+        return false;
+    }
+
+    switch (a->type) {
+        case CFG_STYPE_INT: {
+            return a->integer == b->integer;
+        }
+        case CFG_STYPE_FLOAT: {
+            /* parsed numbers are never NaN */
+            return !(a->floating < b->floating || a->floating > b->floating);
+        }
+        case CFG_STYPE_STRING: {
+            return a->string_len == b->string_len && memcmp(a->string, b->string, a->string_len) == 0;
+        }
+        case CFG_STYPE_BOOL: {
+            return a->boolean == b->boolean;
+        }
+        case CFG_STYPE_ARRAY: {
+            return cfg_array_equal(a->array, b->array);
+        }
+        case CFG_STYPE_UNKNOWN: {
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief reports the differences between two snapshots, additions and changes in the order
+ * of the new file then removals in the order of the old one. duplicates are ignored like in lookups
+ * @param watch watcher
+ * @param old_cfg previous snapshot, NULL if there was none
+ * @param new_cfg new snapshot
+*/
+static void cfg_watch_diff(cfg_watch_t* watch, cfg_t* old_cfg, cfg_t* new_cfg) {
+    cfg_setting_t tmp;
+    cfg_setting_t other_tmp;
+    cfg_setting_t* setting;
+    size_t other;
+
+    for (size_t i = 0; i < new_cfg->settings_len; i++) {
+        setting = cfg_setting_at(new_cfg, i, &tmp);
+        if (cfg_find_setting(new_cfg, setting->identifier, setting->identifier_len, setting->hash) != i) {
+            continue;
+        }
+
+        other = old_cfg == NULL ? CFG_SETTING_NONE : cfg_find_setting(old_cfg, setting->identifier, setting->identifier_len, setting->hash);
+        if (other == CFG_SETTING_NONE) {
+            watch->callback(CFG_CHANGE_ADDED, setting->identifier, setting->identifier_len, old_cfg, new_cfg, watch->user);
+        } else if (!cfg_setting_equal(cfg_setting_at(old_cfg, other, &other_tmp), setting)) {
+            watch->callback(CFG_CHANGE_CHANGED, setting->identifier, setting->identifier_len, old_cfg, new_cfg, watch->user);
+        }
+    }
+
+    for (size_t i = 0; old_cfg != NULL && i < old_cfg->settings_len; i++) {
+        setting = cfg_setting_at(old_cfg, i, &tmp);
+        if (cfg_find_setting(old_cfg, setting->identifier, setting->identifier_len, setting->hash) == i
+            && cfg_find_setting(new_cfg, setting->identifier, setting->identifier_len, setting->hash) == CFG_SETTING_NONE) {
+            watch->callback(CFG_CHANGE_REMOVED, setting->identifier, setting->identifier_len, old_cfg, new_cfg, watch->user);
+        }
+    }
+}
+
+/**
+ * @brief reloads the watched file and reports what changed
+ * @param watch watcher
+ * @returns 0 on success, 1 otherwise with the watcher error set
+*/
+static int cfg_watch_reload(cfg_watch_t* watch) {
+    cfg_t* old_cfg = cfg_acquire(watch->old_reader);
+    cfg_t* new_cfg;
+
+    if (cfg_reload(watch->live, watch->path, watch->flags) != 0) {
+        watch->errnum = cfg_get_errno_live(watch->live);
+        cfg_release(watch->old_reader);
+        return 1;
+    }
+
+    new_cfg = cfg_acquire(watch->new_reader);
+    if (watch->callback != NULL) {
+        cfg_watch_diff(watch, old_cfg, new_cfg);
+    }
+
+    cfg_release(watch->new_reader);
+    cfg_release(watch->old_reader);
+
+    return 0;
+}
+
+/**
+ * @brief gets a monotonic time in milliseconds
+ * @returns time in milliseconds
+*/
+static long long cfg_now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief waits for the watched file to change, then reloads it once it has been left untouched
+ * for the debounce delay, so a burst of writes or a rename-replace leads to a single reload.
+ * the callback is called from here, for the settings that changed
+ * @param watch watcher
+ * @param timeout_ms how long to wait for a first change, -1 to wait forever, 0 to only check
+ * @returns 0 on success, even if nothing changed, 1 otherwise with the watcher error set.
+ * a failed reload keeps the current snapshot
+*/
+int cfg_watch_process(cfg_watch_t* watch, int timeout_ms) {
+    struct pollfd pfd = { .fd = watch->fd, .events = POLLIN, .revents = 0 };
+    long long deadline = cfg_now_ms() + timeout_ms;
+    bool pending = false;
+    int wait_ms;
+    int ready;
+
+    watch->errnum = CFG_SUCCESS;
+
+    for (;;) {
+        if (pending) {
+            wait_ms = watch->debounce_ms;
+        } else if (timeout_ms < 0) {
+            wait_ms = -1;
+        } else {
+            wait_ms = deadline > cfg_now_ms() ? (int)(deadline - cfg_now_ms()) : 0;
+        }
+
+        ready = poll(&pfd, 1, wait_ms);
+        if (ready == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ready == -1) {
+            watch->errnum = CFG_EWATCH;
+            return 1;
+        }
+        if (ready == 0) {
+            break;
+        }
+
+        switch (cfg_watch_read(watch)) {
+            case 1: {
+                pending = true;
+                break;
+            }
+            case 0: {
+                break;
+            }
+            default: {
+                watch->errnum = CFG_EWATCH;
+                return 1;
+            }
+        }
+    }
+
+    if (!pending) {
+        return 0;
+    }
+
+    return cfg_watch_reload(watch);
+}
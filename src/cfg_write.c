@@ -0,0 +1,518 @@
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cfg_private.h"
+
+/*
+ * the writer formats the settings into a single buffer, written out in large pieces to a file
+ * descriptor or handed to the caller whole. integers are formatted two digits at a time, and floats
+ * with the fewest fraction digits that read back to the same value, so that parsing the output
+ * gives back the same settings table.
+*/
+
+#define CFG_WRITE_CHUNK (64 * 1024) /* size of the buffer, written out whenever it is full */
+#define CFG_WRITE_NUMBER_MAX 32 /* longest integer or float of the fast path, with its sign and dot */
+
+#ifdef CFG_FLOAT_DOUBLE
+#define CFG_FLOAT_FORMAT "%.*f"
+#define CFG_FLOAT_MIN_10_EXP DBL_MIN_10_EXP
+#define CFG_FLOAT_DIG DBL_DECIMAL_DIG
+#else
+#define CFG_FLOAT_FORMAT "%.*Lf"
+#define CFG_FLOAT_MIN_10_EXP LDBL_MIN_10_EXP
+#define CFG_FLOAT_DIG LDBL_DECIMAL_DIG
+#endif
+
+/* the parser reads numbers of at most 19 digits exactly */
+#define CFG_FLOAT_EXACT_DIGITS 19
+#define CFG_FLOAT_EXACT_MAX 10000000000000000000ULL
+
+/* the smallest subnormal has this many fraction digits before its significant ones run out */
+#define CFG_FLOAT_FRACTION_MAX (CFG_FLOAT_DIG - CFG_FLOAT_MIN_10_EXP + CFG_FLOAT_MANT_DIG)
+
+typedef struct cfg_writer_s {
+    char* buf;
+    size_t len;
+    size_t cap;
+    int fd; /* -1 to keep the whole output in the buffer */
+} cfg_writer_t;
+
+static const char cfg_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * @brief writes a whole buffer to a file descriptor, retrying short and interrupted writes
+ * @param fd file descriptor
+ * @param buf buffer
+ * @param len length of the buffer
+ * @returns CFG_SUCCESS, or CFG_EWRITE if the file descriptor failed
+*/
+int cfg_write_fd(int fd, const char* buf, size_t len) {
+    ssize_t written;
+
+    while (len > 0) {
+        written = write(fd, buf, len);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return CFG_EWRITE;
+        }
+        buf += written;
+        len -= (size_t)written;
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief writes the buffer out to the file descriptor and empties it
+ * @param writer writer
+ * @returns CFG_SUCCESS, or CFG_EWRITE if the file descriptor failed
+*/
+static int cfg_writer_flush(cfg_writer_t* writer) {
+    if (cfg_write_fd(writer->fd, writer->buf, writer->len) != CFG_SUCCESS) {
+        return CFG_EWRITE;
+    }
+
+    writer->len = 0;
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief makes room in the buffer, writing it out first if it goes to a file descriptor
+ * @param writer writer
+ * @param n number of bytes about to be written
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_writer_reserve(cfg_writer_t* writer, size_t n) {
+    size_t cap = writer->cap == 0 ? CFG_WRITE_CHUNK : writer->cap;
+    char* buf;
+
+    if (writer->len + n <= writer->cap) {
+        return CFG_SUCCESS;
+    }
+
+    if (writer->fd != -1 && writer->len > 0 && cfg_writer_flush(writer) != CFG_SUCCESS) {
+        return CFG_EWRITE;
+    }
+
+    while (cap < writer->len + n) {
+        cap *= 2;
+    }
+
+    if (cap != writer->cap) {
+        buf = realloc(writer->buf, cap);
+        if (buf == NULL) {
+            return CFG_EMEM;
+        }
+        writer->buf = buf;
+        writer->cap = cap;
+    }
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief formats an integer, two digits at a time from the end
+ * @param out (out) at least 21 bytes
+ * @param magnitude absolute value
+ * @param negative whether a minus sign comes first
+ * @returns number of bytes written
+*/
+static size_t cfg_format_integer(char* out, uint64_t magnitude, bool negative) {
+    char tmp[20];
+    size_t i = sizeof(tmp);
+    size_t len = 0;
+
+    while (magnitude >= 100) {
+        i -= 2;
+        memcpy(&tmp[i], &cfg_digit_pairs[(magnitude % 100) * 2], 2);
+        magnitude /= 100;
+    }
+    if (magnitude >= 10) {
+        i -= 2;
+        memcpy(&tmp[i], &cfg_digit_pairs[magnitude * 2], 2);
+    } else {
+        tmp[--i] = (char)('0' + magnitude);
+    }
+
+    if (negative) {
+        out[len++] = '-';
+    }
+    memcpy(&out[len], &tmp[i], sizeof(tmp) - i);
+
+    return len + sizeof(tmp) - i;
+}
+
+/**
+ * @brief formats a float with the fewest fraction digits that the parser reads back exactly, when
+ * it has at most 19 significant digits, like most of the floats of configuration files
+ * @param out (out) at least CFG_WRITE_NUMBER_MAX bytes
+ * @param value float
+ * @returns number of bytes written, 0 if the float needs the libc
+*/
+static size_t cfg_format_float_fast(char* out, cfg_float_t value) {
+    bool negative = signbit(value) != 0;
+    cfg_float_t magnitude = negative ? -value : value;
+    cfg_float_t scaled;
+    uint64_t mantissa = 0;
+    uint64_t candidates[3];
+    bool found = magnitude == 0;
+    size_t k = 0;
+    size_t len = 0;
+    size_t digits;
+    char tmp[20];
+
+    /*
+     * the parser divides the digits by a power of ten, correctly rounded. the first count of
+     * fraction digits for which that division gives the value back is the shortest output
+    */
+    while (!found) {
+        if (k > CFG_FLOAT_EXACT_DIGITS || k > CFG_FLOAT_POW10_MAX) {
+            return 0;
+        }
+
+        scaled = magnitude * cfg_pow10_list[k];
+        if (scaled >= (cfg_float_t)CFG_FLOAT_EXACT_MAX || scaled >= (cfg_float_t)CFG_FLOAT_MANTISSA_MAX) {
+            return 0;
+        }
+
+        /* the product is rounded, the digits may be one off */
+        candidates[0] = (uint64_t)(scaled + (cfg_float_t)0.5);
+        candidates[1] = candidates[0] + 1;
+        candidates[2] = candidates[0] - 1;
+        for (size_t i = 0; i < 3 && !found; i++) {
+            if (candidates[i] != 0 && candidates[i] < CFG_FLOAT_EXACT_MAX
+                && (cfg_float_t)candidates[i] / cfg_pow10_list[k] == magnitude) {
+                mantissa = candidates[i];
+                found = true;
+            }
+        }
+
+        k += !found;
+    }
+
+    digits = cfg_format_integer(tmp, mantissa, false);
+    if (negative) {
+        out[len++] = '-';
+    }
+
+    if (digits > k) {
+        memcpy(&out[len], tmp, digits - k);
+        len += digits - k;
+    } else {
+        out[len++] = '0';
+    }
+    out[len++] = '.';
+
+    if (k == 0) {
+        out[len++] = '0';
+    } else if (digits >= k) {
+        memcpy(&out[len], &tmp[digits - k], k);
+        len += k;
+    } else {
+        memset(&out[len], '0', k - digits);
+        memcpy(&out[len + k - digits], tmp, digits);
+        len += k;
+    }
+
+    return len;
+}
+
+/**
+ * @brief formats a float with the libc, with the fewest fraction digits that read back to the same value
+ * @param writer writer, the float is written at its end
+ * @param value float
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_write_float_slow(cfg_writer_t* writer, cfg_float_t value) {
+    int low = 1;
+    int high = CFG_FLOAT_FRACTION_MAX;
+    int mid;
+    int errnum;
+    int len;
+    char* end;
+
+    /* enough fraction digits always read back, fewer may; the grammar has no exponent */
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        len = snprintf(NULL, 0, CFG_FLOAT_FORMAT, mid, value);
+        errnum = cfg_writer_reserve(writer, (size_t)len + 1);
+        if (errnum != CFG_SUCCESS) {
+            return errnum;
+        }
+
+        snprintf(&writer->buf[writer->len], (size_t)len + 1, CFG_FLOAT_FORMAT, mid, value);
+        if (cfg_strtof(&writer->buf[writer->len], &end) == value) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    len = snprintf(NULL, 0, CFG_FLOAT_FORMAT, low, value);
+    errnum = cfg_writer_reserve(writer, (size_t)len + 1);
+    if (errnum != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    writer->len += (size_t)snprintf(&writer->buf[writer->len], (size_t)len + 1, CFG_FLOAT_FORMAT, low, value);
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief writes the items of an array between brackets, separated by commas
+ * @param writer writer, the array is written at its end
+ * @param array array
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_write_array(cfg_writer_t* writer, const cfg_array_t* array) {
+    const long long* integers = (const long long*)(const void*)array->items;
+    const cfg_float_t* floats = (const cfg_float_t*)(const void*)array->items;
+    const cfg_string_span_t* spans = (const cfg_string_span_t*)(const void*)array->items;
+    size_t item_len;
+    char* out;
+    int errnum;
+
+    for (size_t i = 0; i < array->len; i++) {
+        /* the item, the separator before it and the closing bracket after the last one */
+        item_len = array->type == CFG_STYPE_STRING ? spans[i].len + 2 : CFG_WRITE_NUMBER_MAX;
+        errnum = cfg_writer_reserve(writer, item_len + 3);
+        if (errnum != CFG_SUCCESS) {
+            return errnum;
+        }
+
+        out = &writer->buf[writer->len];
+        if (i == 0) {
+            *out++ = '[';
+        } else {
+            *out++ = ',';
+            *out++ = ' ';
+        }
+        writer->len = (size_t)(out - writer->buf);
+
+        switch (array->type) {
+            case CFG_STYPE_INT: {
+                writer->len += cfg_format_integer(out, integers[i] < 0 ? 0 - (uint64_t)integers[i] : (uint64_t)integers[i], integers[i] < 0);
+                break;
+            }
+            case CFG_STYPE_FLOAT: {
+                item_len = cfg_format_float_fast(out, floats[i]);
+                writer->len += item_len;
+                if (item_len == 0 && (errnum = cfg_write_float_slow(writer, floats[i])) != CFG_SUCCESS) {
+                    return errnum;
+                }
+                break;
+            }
+            case CFG_STYPE_STRING: {
+                out[0] = '"';
+                memcpy(&out[1], spans[i].ptr, spans[i].len);
+                out[spans[i].len + 1] = '"';
+                writer->len += spans[i].len + 2;
+                break;
+            }
+            case CFG_STYPE_BOOL:
+            case CFG_STYPE_ARRAY:
+            case CFG_STYPE_UNKNOWN: {
+                break;
+            }
+        }
+    }
+
+    errnum = cfg_writer_reserve(writer, 2);
+    if (errnum != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    if (array->len == 0) {
+        writer->buf[writer->len++] = '[';
+    }
+    writer->buf[writer->len++] = ']';
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief writes a setting, as a line the parser reads back
+ * @param writer writer
+ * @param setting setting
+ * @returns CFG_SUCCESS, or an error number
+*/
+static int cfg_write_setting(cfg_writer_t* writer, const cfg_setting_t* setting) {
+    size_t value_len = setting->type == CFG_STYPE_STRING ? setting->string_len + 2 : CFG_WRITE_NUMBER_MAX;
+    int errnum = setting->errnum;
+    char* out;
+    size_t len;
+
+    /* a lazy number that doesn't convert is reported, not written as it was */
+    if (errnum != CFG_SUCCESS || (errnum = cfg_writer_reserve(writer, setting->identifier_len + value_len + 2)) != CFG_SUCCESS) {
+        return errnum;
+    }
+
+    out = &writer->buf[writer->len];
+    memcpy(out, setting->identifier, setting->identifier_len);
+    len = setting->identifier_len;
+    out[len++] = '=';
+
+    switch (setting->type) {
+        case CFG_STYPE_INT: {
+            len += cfg_format_integer(&out[len], setting->integer < 0 ? 0 - (uint64_t)setting->integer : (uint64_t)setting->integer,
+                setting->integer < 0);
+            break;
+        }
+        case CFG_STYPE_FLOAT: {
+            value_len = cfg_format_float_fast(&out[len], setting->floating);
+            if (value_len == 0) {
+                writer->len += len;
+                errnum = cfg_write_float_slow(writer, setting->floating);
+                if (errnum != CFG_SUCCESS || (errnum = cfg_writer_reserve(writer, 1)) != CFG_SUCCESS) {
+                    return errnum;
+                }
+                writer->buf[writer->len++] = '\n';
+                return CFG_SUCCESS;
+            }
+            len += value_len;
+            break;
+        }
+        case CFG_STYPE_STRING: {
+            out[len++] = '"';
+            memcpy(&out[len], setting->string, setting->string_len);
+            len += setting->string_len;
+            out[len++] = '"';
+            break;
+        }
+        case CFG_STYPE_BOOL: {
+            memcpy(&out[len], setting->boolean ? "true" : "false", setting->boolean ? 4 : 5);
+            len += setting->boolean ? 4 : 5;
+            break;
+        }
+        case CFG_STYPE_ARRAY: {
+            writer->len += len;
+            errnum = cfg_write_array(writer, setting->array);
+            if (errnum != CFG_SUCCESS || (errnum = cfg_writer_reserve(writer, 1)) != CFG_SUCCESS) {
+                return errnum;
+            }
+            writer->buf[writer->len++] = '\n';
+            return CFG_SUCCESS;
+        }
+        case CFG_STYPE_UNKNOWN: {
+            return CFG_SUCCESS;
+        }
+    }
+
+    out[len++] = '\n';
+    writer->len += len;
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief formats a setting at the end of a buffer, as a line the parser reads back
+ * @param setting setting
+ * @param buf (in, out) buffer allocated with malloc, grown as needed
+ * @param cap (in, out) capacity of the buffer
+ * @param len (in, out) length of the buffer
+ * @returns CFG_SUCCESS, or an error number
+*/
+int cfg_write_line(const cfg_setting_t* setting, char** buf, size_t* cap, size_t* len) {
+    cfg_writer_t writer = { .buf = *buf, .len = *len, .cap = *cap, .fd = -1 };
+    int errnum = cfg_write_setting(&writer, setting);
+
+    *buf = writer.buf;
+    *cap = writer.cap;
+    *len = writer.len;
+
+    return errnum;
+}
+
+/**
+ * @brief writes the settings of a configuration, then the ones of its base layers it doesn't shadow
+ * @param cfg configuration object
+ * @param layers false to write the settings of the configuration only, without its base layers
+ * @param fd file descriptor, -1 to hand the output back
+ * @param str (out) output allocated with malloc and NUL terminated when fd is -1
+ * @param len (out) length of the output when fd is -1
+ * @returns CFG_SUCCESS, or an error number
+*/
+int cfg_write_all(const cfg_t* cfg, bool layers, int fd, char** str, size_t* len) {
+    cfg_writer_t writer = { .buf = NULL, .len = 0, .cap = 0, .fd = fd };
+    int errnum = CFG_SUCCESS;
+    size_t image_len;
+    cfg_setting_t tmp;
+    cfg_setting_t* setting;
+
+    for (const cfg_t* layer = cfg; layer != NULL && errnum == CFG_SUCCESS; layer = layers ? layer->base : NULL) {
+        image_len = cfg_image_len(layer);
+
+        for (size_t i = 0; i < image_len + layer->settings_len && errnum == CFG_SUCCESS; i++) {
+            setting = i < image_len ? cfg_image_setting(layer, i, &tmp) : cfg_setting_at(layer, i - image_len, &tmp);
+            if (layer == cfg || !cfg_layer_shadowed(cfg, layer, setting)) {
+                errnum = cfg_write_setting(&writer, setting);
+            }
+        }
+    }
+
+    if (errnum == CFG_SUCCESS && fd != -1) {
+        errnum = cfg_writer_flush(&writer);
+    }
+    if (errnum == CFG_SUCCESS && fd == -1) {
+        errnum = cfg_writer_reserve(&writer, 1);
+    }
+
+    if (errnum != CFG_SUCCESS || fd != -1) {
+        free(writer.buf);
+        return errnum;
+    }
+
+    writer.buf[writer.len] = '\0';
+    *str = writer.buf;
+    *len = writer.len;
+
+    return CFG_SUCCESS;
+}
+
+/**
+ * @brief writes a configuration to a file descriptor, one setting per line, in an order and with
+ * values that parse back to the same settings. with base layers, the settings of every layer follow
+ * the ones of the layer above that they aren't shadowed by, like cfg_dump_ctx
+ * @param cfg configuration object
+ * @param fd file descriptor, written in pieces of 64 KB
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_write_ctx(cfg_t* cfg, int fd) {
+    int errnum = fd < 0 ? CFG_EWRITE : cfg_write_all(cfg, true, fd, NULL, NULL);
+
+    if (errnum != CFG_SUCCESS) {
+        cfg_set_errnum(cfg, errnum);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief writes a configuration to memory, see cfg_write_ctx
+ * @param cfg configuration object
+ * @param str (out) output, NUL terminated, to release with free
+ * @param len (out) length of the output
+ * @returns 0 on success, 1 otherwise with the configuration error set
+*/
+int cfg_write_buffer_ctx(cfg_t* cfg, char** str, size_t* len) {
+    int errnum = cfg_write_all(cfg, true, -1, str, len);
+
+    if (errnum != CFG_SUCCESS) {
+        cfg_set_errnum(cfg, errnum);
+        return 1;
+    }
+
+    return 0;
+}
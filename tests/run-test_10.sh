@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# the schema headers are generated from a key list and from a sample config, as a build would do
+clang -std=gnu2x -Wall -Wextra -O1 ../tools/cfg_gen.c ../src/*.c -pthread -o cfg_gen.out || exit 1
+{ echo "# test_10 keys"; echo "server.port"; echo "log-level"; echo "ratio"; echo "name"; seq -f "key_%g" 0 19999; } > test_10.keys
+./cfg_gen.out -p app -o test_10_app.h test_10.keys && ./cfg_gen.out -p sample -o test_10_sample.h test_1.cfg && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined -I../include test_10.c ../src/*.c -pthread -o test_10.out && ./test_10.out
+status=$?
+rm -f cfg_gen.out test_10.keys test_10_app.h test_10_sample.h
+exit ${status}
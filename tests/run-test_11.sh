@@ -0,0 +1,4 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined test_11.c ../src/*.c -pthread -o test_11.out && ./test_11.out && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined -DCFG_FLOAT_DOUBLE test_11.c ../src/*.c -pthread -o test_11.out && ./test_11.out
@@ -0,0 +1,4 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined test_12.c ../src/*.c -pthread -o test_12.out && ./test_12.out && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined -DCFG_FLOAT_DOUBLE test_12.c ../src/*.c -pthread -o test_12.out && ./test_12.out
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined test_14.c ../src/*.c -pthread -o test_14.out && ./test_14.out && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined -DCFG_FLOAT_DOUBLE test_14.c ../src/*.c -pthread -o test_14.out && ./test_14.out && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined -DCFG_NO_STATS test_14.c ../src/*.c -pthread -o test_14.out && ./test_14.out
@@ -0,0 +1,4 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined test_15.c ../src/*.c -pthread -o test_15.out && ./test_15.out && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined -DCFG_FLOAT_DOUBLE test_15.c ../src/*.c -pthread -o test_15.out && ./test_15.out
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+# runs the differential number test with both floating point storage types
+clang -std=gnu2x -Weverything -Wno-unsafe-buffer-usage -Wno-pre-c2x-compat -Wno-padded -g -O1 -fsanitize=address,undefined test_2.c ../src/*.c -pthread -lm -o test_2.out && ./test_2.out && \
+clang -std=gnu2x -Weverything -Wno-unsafe-buffer-usage -Wno-pre-c2x-compat -Wno-padded -g -O1 -fsanitize=address,undefined -DCFG_FLOAT_DOUBLE test_2.c ../src/*.c -pthread -lm -o test_2.out && ./test_2.out
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+# the AVX2, SSE2 and scalar scanners must give identical results
+for variant in "" "-DCFG_NO_AVX2" "-DCFG_NO_SIMD"; do
+    clang -std=gnu2x -Weverything -Wno-unsafe-buffer-usage -Wno-pre-c2x-compat -Wno-padded -g -O1 -fsanitize=address ${variant} test_3.c ../src/*.c -pthread -o test_3.out && ./test_3.out > "test_3${variant}.txt" || exit 1
+done
+
+cmp test_3.txt test_3-DCFG_NO_AVX2.txt && cmp test_3.txt test_3-DCFG_NO_SIMD.txt && echo "scanners agree on $(grep -c '^run' test_3.txt) configs"
+status=$?
+rm -f test_3*.txt
+exit ${status}
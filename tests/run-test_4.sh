@@ -0,0 +1,3 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=thread test_4.c ../src/*.c -pthread -o test_4.out && ./test_4.out
@@ -0,0 +1,4 @@
+#!/bin/bash
+
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=thread test_6.c ../src/*.c -pthread -o test_6.out && ./test_6.out && \
+clang -std=gnu2x -Wall -Wextra -g -O1 -fsanitize=address,undefined test_6.c ../src/*.c -pthread -o test_6.out && ./test_6.out
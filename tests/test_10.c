@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+#include "test_10_app.h"
+#include "test_10_sample.h"
+
+/* schema test: lookups by id must agree with the lookups by identifier, whatever the configuration went through */
+
+#define KEYS 20000
+#define EXTRA 500
+
+static char dir[] = "/tmp/libcfg_test_10_XXXXXX";
+static char path[64];
+static char* buf;
+static size_t len;
+static int failures = 0;
+
+/* every key but key_7, key_5 twice, extra keys missing from the schema from line extra_line on */
+static size_t extra_line;
+
+static void write_buffer(void) {
+    size_t cap = (KEYS + EXTRA) * 64;
+    size_t line = 1;
+
+    buf = malloc(cap);
+    len = (size_t)snprintf(buf, cap, "server.port = 8080\nlog-level = \"debug\"\nratio = 0.5\n# comment\nname = \"app\"\n");
+    line += 5;
+
+    for (int i = 0; i < KEYS; i++) {
+        if (i == 7) {
+            continue;
+        }
+        len += (size_t)snprintf(&buf[len], cap - len, "key_%d = %d\n", i, i * 3);
+        line += 1;
+    }
+
+    extra_line = line;
+    for (int i = 0; i < EXTRA; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, "extra_%d = %s\n", i, i % 2 == 0 ? "true" : "false");
+    }
+    len += (size_t)snprintf(&buf[len], cap - len, "key_5 = -1\n");
+}
+
+/* every identifier of the buffer, looked up by id and by identifier, against a configuration without schema */
+static void compare(cfg_t* expected, cfg_t* actual, const char* what) {
+    char id[32];
+    long long a, b;
+    bool bool_a, bool_b;
+    char* str;
+    int errors = 0;
+
+    for (size_t i = 0; i < app_schema.len; i++) {
+        snprintf(id, sizeof(id), "%s", app_identifiers[i]);
+        if (cfg_get_setting_type_ctx(expected, id) != cfg_get_setting_type_ctx(actual, id)) {
+            errors += 1;
+            continue;
+        }
+
+        switch (cfg_get_setting_type_ctx(expected, id)) {
+            case CFG_STYPE_INT:
+                errors += cfg_get_setting_ctx(expected, id, &a) != 0 || cfg_get_by_id_ctx(actual, i, &b) != 0 || a != b;
+                errors += cfg_get_setting_ctx(actual, id, &b) != 0 || a != b;
+                break;
+            case CFG_STYPE_UNKNOWN:
+                errors += cfg_get_by_id_ctx(actual, i, &b) == 0 || cfg_get_errno_ctx(actual) != CFG_ENEXIST;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (int i = 0; i < EXTRA; i++) {
+        snprintf(id, sizeof(id), "extra_%d", i);
+        errors += cfg_get_setting_ctx(expected, id, &bool_a) != 0 || cfg_get_setting_ctx(actual, id, &bool_b) != 0 || bool_a != bool_b;
+    }
+
+    errors += cfg_get_by_id_ctx(actual, APP_NAME, &str) != 0 || strcmp(str, "app") != 0;
+    errors += cfg_get_by_id_ctx(actual, APP_KEY_5, &a) != 0 || a != 15;
+    errors += cfg_get_by_id_ctx(actual, APP_COUNT, &a) == 0;
+
+    if (errors != 0) {
+        fprintf(stderr, "%s: %d errors\n", what, errors);
+        failures += 1;
+    }
+}
+
+static cfg_t* new_with_schema(bool overflow) {
+    cfg_t* cfg = cfg_new();
+
+    if (cfg_use_schema_ctx(cfg, &app_schema, overflow) != 0) {
+        cfg_perror_ctx(cfg, "cfg_use_schema_ctx");
+        exit(1);
+    }
+
+    return cfg;
+}
+
+static void test_sample(void) {
+    cfg_t* cfg = cfg_new();
+    long long integer;
+    char* str;
+    bool boolean;
+
+    if (cfg_use_schema_ctx(cfg, &sample_schema, false) != 0 || cfg_load_ctx(cfg, "test_1.cfg", CFG_FLAG_NONE) != 0
+        || cfg_get_by_id_ctx(cfg, SAMPLE_MY_INT, &integer) != 0 || integer != 1337
+        || cfg_get_by_id_ctx(cfg, SAMPLE_MY_STRING, &str) != 0 || strcmp(str, "mystère") != 0
+        || cfg_get_by_id_ctx(cfg, SAMPLE_MY_BOOL, &boolean) != 0 || !boolean
+        || cfg_get_setting_ctx(cfg, "my_int", &integer) != 0 || integer != 1337) {
+        cfg_perror_ctx(cfg, "sample");
+        failures += 1;
+    }
+
+    /* a schema can't be set on a configuration holding settings */
+    if (cfg_use_schema_ctx(cfg, &app_schema, true) == 0 || cfg_get_errno_ctx(cfg) != CFG_ESCHEMA) {
+        fprintf(stderr, "schema set on a non-empty configuration\n");
+        failures += 1;
+    }
+    cfg_free_ctx(cfg);
+}
+
+static void test_invalid_schema(void) {
+    uint32_t displacements[sizeof(app_displacements) / sizeof(app_displacements[0])];
+    cfg_schema_t schema = app_schema;
+    cfg_t* cfg = cfg_new();
+
+    /* as if the schema was generated against another hash function */
+    for (size_t i = 0; i < schema.buckets_len; i++) {
+        displacements[i] = app_displacements[i] + 1;
+    }
+    schema.displacements = displacements;
+
+    if (cfg_use_schema_ctx(cfg, &schema, true) == 0 || cfg_get_errno_ctx(cfg) != CFG_ESCHEMA) {
+        fprintf(stderr, "invalid schema accepted\n");
+        failures += 1;
+    }
+    cfg_free_ctx(cfg);
+}
+
+static void test_parse(cfg_t* expected) {
+    cfg_t* cfg = new_with_schema(true);
+
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(cfg, "parse");
+        failures += 1;
+    }
+    compare(expected, cfg, "parse");
+    cfg_free_ctx(cfg);
+
+    /* without overflow the first extra key fails */
+    cfg = new_with_schema(false);
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_NONE) == 0 || cfg_get_errno_ctx(cfg) != CFG_EUNKNOWN || cfg_get_error_line_ctx(cfg) != extra_line) {
+        fprintf(stderr, "strict parse: error %d at line %zu\n", cfg_get_errno_ctx(cfg), cfg_get_error_line_ctx(cfg));
+        failures += 1;
+    }
+    cfg_free_ctx(cfg);
+
+    /* zero-copy settings in slots */
+    cfg = new_with_schema(true);
+    long long value;
+    if (cfg_parse_ctx(cfg, buf, len, CFG_FLAG_ZEROCOPY) != 0 || cfg_get_by_id_ctx(cfg, APP_KEY_19999, &value) != 0 || value != 19999 * 3) {
+        fprintf(stderr, "zero-copy parse\n");
+        failures += 1;
+    }
+    cfg_free_ctx(cfg);
+}
+
+static void test_parallel(cfg_t* expected) {
+    FILE* file = fopen(path, "w");
+    cfg_t* cfg;
+    cfg_t* strict;
+
+    fwrite(buf, 1, len, file);
+    fclose(file);
+
+    for (size_t threads = 1; threads <= 4; threads++) {
+        cfg = new_with_schema(true);
+        if (cfg_load_parallel_ctx(cfg, path, threads, CFG_FLAG_NONE) != 0) {
+            cfg_perror_ctx(cfg, "parallel");
+            failures += 1;
+        }
+        compare(expected, cfg, "parallel");
+        cfg_free_ctx(cfg);
+
+        strict = new_with_schema(false);
+        if (cfg_load_parallel_ctx(strict, path, threads, CFG_FLAG_NONE) == 0 || cfg_get_errno_ctx(strict) != CFG_EUNKNOWN
+            || cfg_get_error_line_ctx(strict) != extra_line) {
+            fprintf(stderr, "strict parallel: error %d at line %zu\n", cfg_get_errno_ctx(strict), cfg_get_error_line_ctx(strict));
+            failures += 1;
+        }
+        cfg_free_ctx(strict);
+    }
+}
+
+static void test_edit(void) {
+    cfg_t* cfg = new_with_schema(true);
+    char* edited = malloc(len + 64);
+    size_t edited_len;
+    char* pos;
+    long long value;
+
+    memcpy(edited, buf, len);
+    cfg_parse_ctx(cfg, edited, len, CFG_FLAG_INCREMENTAL);
+
+    /* "key_5 = 15\n" goes away, the duplicate at the end takes over */
+    pos = strstr(edited, "key_5 = 15\n");
+    memmove(pos, pos + 11, len - (size_t)(pos - edited) - 11);
+    edited_len = len - 11;
+    if (cfg_edit_ctx(cfg, edited, edited_len, (size_t)(pos - edited), 11, 0) != 0
+        || cfg_get_by_id_ctx(cfg, APP_KEY_5, &value) != 0 || value != -1) {
+        fprintf(stderr, "edit: key_5 didn't go\n");
+        failures += 1;
+    }
+
+    /* key_7 comes back, an unknown key is rejected without overflow */
+    memmove(&edited[12], edited, edited_len);
+    memcpy(edited, "key_7 = 777\n", 12);
+    edited_len += 12;
+    if (cfg_edit_ctx(cfg, edited, edited_len, 0, 0, 12) != 0 || cfg_get_by_id_ctx(cfg, APP_KEY_7, &value) != 0 || value != 777
+        || cfg_get_setting_ctx(cfg, "key_7", &value) != 0 || value != 777 || cfg_get_by_id_ctx(cfg, APP_KEY_19999, &value) != 0) {
+        fprintf(stderr, "edit: key_7 didn't come\n");
+        failures += 1;
+    }
+
+    free(edited);
+    cfg_free_ctx(cfg);
+}
+
+static void test_default(void) {
+    long long value = 0;
+    char* str;
+
+    /* cfg_free keeps the schema */
+    for (int round = 0; round < 2; round++) {
+        if ((round == 0 && cfg_use_schema(&sample_schema, true) != 0) || cfg_load("test_1.cfg") != 0
+            || cfg_get_by_id(SAMPLE_MY_INT, &value) != 0 || value != 1337 || cfg_get_by_id(SAMPLE_MY_STRING, &str) != 0) {
+            cfg_perror("default");
+            failures += 1;
+        }
+        cfg_free();
+    }
+
+    if (cfg_use_schema(NULL, true) != 0 || cfg_get_by_id(SAMPLE_MY_INT, &value) == 0 || cfg_errno != CFG_ENEXIST) {
+        fprintf(stderr, "schema still used\n");
+        failures += 1;
+    }
+}
+
+int main(void) {
+    cfg_t* expected = cfg_new();
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/test.cfg", dir);
+
+    write_buffer();
+    if (cfg_parse_ctx(expected, buf, len, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(expected, "expected");
+        return 1;
+    }
+
+    test_sample();
+    test_invalid_schema();
+    test_parse(expected);
+    test_parallel(expected);
+    test_edit();
+    test_default();
+
+    cfg_free_ctx(expected);
+    free(buf);
+    unlink(path);
+    rmdir(dir);
+
+    printf("schema of %zu ids, %d failures\n", app_schema.len, failures);
+
+    return failures != 0;
+}
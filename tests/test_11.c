@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* binding test: cfg_bind must fill a struct like the getters would, whichever way it walks the configuration */
+
+typedef struct config_s {
+    long long port;
+    long long workers;
+    long long retries;
+    cfg_float_t ratio;
+    char* name;
+    char* mode;
+    bool verbose;
+    bool debug;
+    long long port_again;
+    long long untouched;
+} config_t;
+
+static const cfg_binding_t bindings[] = {
+    { "server.port", CFG_STYPE_INT, offsetof(config_t, port), false, .integer = 0 },
+    { "workers", CFG_STYPE_INT, offsetof(config_t, workers), true, .integer = 4 },
+    { "retries", CFG_STYPE_INT, offsetof(config_t, retries), false, .integer = 0 },
+    { "ratio", CFG_STYPE_FLOAT, offsetof(config_t, ratio), false, .floating = 0 },
+    { "name", CFG_STYPE_STRING, offsetof(config_t, name), false, .string = NULL },
+    { "mode", CFG_STYPE_STRING, offsetof(config_t, mode), true, .string = "fast" },
+    { "verbose", CFG_STYPE_BOOL, offsetof(config_t, verbose), false, .boolean = false },
+    { "debug", CFG_STYPE_BOOL, offsetof(config_t, debug), true, .boolean = true },
+    { "server.port", CFG_STYPE_INT, offsetof(config_t, port_again), false, .integer = 0 },
+    { "untouched", CFG_STYPE_STRING, offsetof(config_t, untouched), false, .string = NULL },
+};
+
+#define N (sizeof(bindings) / sizeof(bindings[0]))
+
+/* retries is missing, verbose has the wrong type, untouched is an integer bound as a string */
+static const char config[] =
+    "server.port = 8080\n"
+    "ratio = 0.25\n"
+    "name = \"app\"\n"
+    "verbose = 1\n"
+    "untouched = 5\n"
+    "server.port = 9090\n"
+    "mode = \"slow\"\n";
+
+static const int expected_errors[N] = {
+    CFG_SUCCESS, CFG_SUCCESS, CFG_ENEXIST, CFG_SUCCESS, CFG_SUCCESS,
+    CFG_SUCCESS, CFG_EINVBOOL, CFG_SUCCESS, CFG_SUCCESS, CFG_EINVSTRING,
+};
+
+static int failures = 0;
+
+static void check(cfg_t* cfg, const char* what) {
+    config_t out;
+    int errors[N];
+
+    memset(&out, 0, sizeof(out));
+    out.retries = -7;
+    out.untouched = -7;
+
+    if (cfg_bind_ctx(cfg, bindings, N, &out, errors) == 0 || cfg_get_errno_ctx(cfg) != CFG_ENEXIST) {
+        fprintf(stderr, "%s: expected the error of retries, got %d\n", what, cfg_get_errno_ctx(cfg));
+        failures += 1;
+    }
+
+    for (size_t i = 0; i < N; i++) {
+        if (errors[i] != expected_errors[i]) {
+            fprintf(stderr, "%s: %s: error %d, expected %d\n", what, bindings[i].identifier, errors[i], expected_errors[i]);
+            failures += 1;
+        }
+    }
+
+    if (out.port != 8080 || out.port_again != 8080 || out.workers != 4 || out.retries != -7 || out.ratio != (cfg_float_t)0.25
+        || strcmp(out.name, "app") != 0 || strcmp(out.mode, "slow") != 0 || out.verbose || !out.debug || out.untouched != -7) {
+        fprintf(stderr, "%s: wrong values\n", what);
+        failures += 1;
+    }
+
+    /* without the failing bindings, and without an error array */
+    static const size_t good[] = { 0, 1, 3, 4, 5, 7, 8 };
+    cfg_binding_t subset[sizeof(good) / sizeof(good[0])];
+    for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); i++) {
+        subset[i] = bindings[good[i]];
+    }
+    memset(&out, 0, sizeof(out));
+    if (cfg_bind_ctx(cfg, subset, sizeof(good) / sizeof(good[0]), &out, NULL) != 0 || out.port != 8080 || strcmp(out.mode, "slow") != 0) {
+        fprintf(stderr, "%s: the good bindings failed\n", what);
+        failures += 1;
+    }
+}
+
+int main(void) {
+    char big[1 << 16];
+    size_t len;
+    char dir[] = "/tmp/libcfg_test_11_XXXXXX";
+    char text_path[64];
+    char bin_path[64];
+    FILE* file;
+    cfg_t* cfg;
+    config_t out;
+    int errors[N];
+
+    /* with a duplicated identifier every binding is looked up */
+    cfg = cfg_new();
+    cfg_parse_ctx(cfg, config, sizeof(config) - 1, CFG_FLAG_NONE);
+    check(cfg, "lookups");
+    cfg_free_ctx(cfg);
+
+    /* without, the cursor finds them in file order, with other settings in between or not */
+    for (int step = 0; step < 4; step++) {
+        len = 0;
+        for (const char* line = config; *line != '\0'; line = strchr(line, '\n') + 1) {
+            for (int i = 0; i < step * 3; i++) {
+                len += (size_t)snprintf(&big[len], sizeof(big) - len, "other_%zu = %d\n", len, i);
+            }
+            if (strncmp(line, "server.port = 9090", 18) != 0) {
+                len += (size_t)snprintf(&big[len], sizeof(big) - len, "%.*s", (int)(strchr(line, '\n') + 1 - line), line);
+            }
+        }
+        cfg = cfg_new();
+        cfg_parse_ctx(cfg, big, len, CFG_FLAG_NONE);
+        check(cfg, "cursor");
+        cfg_free_ctx(cfg);
+    }
+
+    /* a compiled config is walked record by record */
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(text_path, sizeof(text_path), "%s/app.cfg", dir);
+    snprintf(bin_path, sizeof(bin_path), "%s/app.cfgc", dir);
+    file = fopen(text_path, "w");
+    fwrite(config, 1, sizeof(config) - 1, file);
+    fclose(file);
+    cfg = cfg_new();
+    if (cfg_compile(text_path, bin_path) != 0 || cfg_load_compiled_ctx(cfg, text_path, bin_path) != 0) {
+        cfg_perror_ctx(cfg, "compiled");
+        failures += 1;
+    }
+    check(cfg, "compiled");
+    cfg_free_ctx(cfg);
+    unlink(text_path);
+    unlink(bin_path);
+    rmdir(dir);
+
+    /* zero-copy strings can't be bound */
+    cfg = cfg_new();
+    cfg_parse_ctx(cfg, config, sizeof(config) - 1, CFG_FLAG_ZEROCOPY);
+    if (cfg_bind_ctx(cfg, bindings, N, &out, errors) == 0 || errors[4] != CFG_EVIEW || errors[0] != CFG_SUCCESS || out.port != 8080) {
+        fprintf(stderr, "zero-copy: name bound\n");
+        failures += 1;
+    }
+    cfg_free_ctx(cfg);
+
+    /* the default configuration */
+    if (cfg_parse(config, sizeof(config) - 1) != 0 || cfg_bind(bindings, 2, &out, NULL) != 0 || out.workers != 4
+        || cfg_bind(bindings, N, &out, errors) == 0 || cfg_errno != CFG_ENEXIST) {
+        fprintf(stderr, "default configuration\n");
+        failures += 1;
+    }
+    cfg_free();
+
+    printf("%zu bindings, %d failures\n", N, failures);
+
+    return failures != 0;
+}
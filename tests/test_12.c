@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* streaming test: feeds random configs in random pieces and compares with a parse of the whole buffer */
+
+#define CONFIGS 3000
+#define KEYS 32
+#define CAP 4096
+
+static int failures = 0;
+
+static const char* fragments[] = {
+    "key_%d = %d\n", "key_%d = \"v%d\"\n", "key_%d = %d.5\n", "key_%d = true\n", "# key_%d %d\n",
+    "key_%d = %d # comment = \"x\"\n", "  # key_%d = %d\n", "key_%d = \"v%d\" # \"#\"\n",
+    "key_%d = \"a # b\" # %d\n", "\n", " ", "\t", "=", "%d", "\"", "#", "key_%d", " = ", "x%d\n", "\r\n",
+};
+
+static size_t random_config(char* buf, size_t cap, bool valid) {
+    size_t len = 0;
+    int n = rand() % 40;
+    int count = (int)(sizeof(fragments) / sizeof(fragments[0]));
+
+    for (int i = 0; i < n && len + 64 < cap; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, fragments[rand() % (valid ? 8 : count)], rand() % KEYS, rand() % 1000);
+    }
+
+    return len;
+}
+
+static void compare(cfg_t* expected, cfg_t* actual, size_t config) {
+    char id[32];
+    const char* a;
+    const char* b;
+    size_t a_len, b_len;
+    long long int_a, int_b;
+    cfg_float_t float_a, float_b;
+    bool bool_a, bool_b;
+    enum cfg_setting_type_e type;
+    int differs;
+
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(id, sizeof(id), "key_%d", i);
+        type = cfg_get_setting_type_ctx(expected, id);
+        differs = type != cfg_get_setting_type_ctx(actual, id);
+
+        switch (differs ? CFG_STYPE_UNKNOWN : type) {
+            case CFG_STYPE_INT:
+                differs = cfg_get_setting_ctx(expected, id, &int_a) != 0 || cfg_get_setting_ctx(actual, id, &int_b) != 0 || int_a != int_b;
+                break;
+            case CFG_STYPE_FLOAT:
+                differs = cfg_get_setting_ctx(expected, id, &float_a) != 0 || cfg_get_setting_ctx(actual, id, &float_b) != 0 || float_a < float_b || float_a > float_b;
+                break;
+            case CFG_STYPE_BOOL:
+                differs = cfg_get_setting_ctx(expected, id, &bool_a) != 0 || cfg_get_setting_ctx(actual, id, &bool_b) != 0 || bool_a != bool_b;
+                break;
+            case CFG_STYPE_STRING:
+                differs = cfg_get_string_view_ctx(expected, id, &a, &a_len) != 0 || cfg_get_string_view_ctx(actual, id, &b, &b_len) != 0
+                    || a_len != b_len || memcmp(a, b, a_len) != 0;
+                break;
+            default:
+                break;
+        }
+
+        if (differs) {
+            fprintf(stderr, "config %zu: %s differs\n", config, id);
+            failures += 1;
+        }
+    }
+}
+
+/* feeds a buffer in pieces of random length, one byte at a time or all at once included */
+static int feed(cfg_t* cfg, const char* buf, size_t len) {
+    size_t pos = 0;
+    size_t piece;
+    size_t max = (size_t)rand() % 3 == 0 ? 1 : (size_t)rand() % 64 + 1;
+    int status = 0;
+
+    if (cfg_stream_begin_ctx(cfg) != 0) {
+        return 1;
+    }
+
+    while (pos < len) {
+        piece = rand() % 8 == 0 ? 0 : (size_t)rand() % max + 1;
+        piece = piece > len - pos ? len - pos : piece;
+        status |= cfg_stream_feed_ctx(cfg, &buf[pos], piece);
+        pos += piece;
+    }
+
+    return cfg_stream_end_ctx(cfg) | status;
+}
+
+int main(void) {
+    char text[CAP];
+    char path[64];
+    size_t len;
+    size_t failed = 0;
+    int status;
+    int fds[2];
+    long long value;
+    cfg_t* expected;
+    cfg_t* cfg;
+    FILE* file;
+
+    srand(4242);
+
+    for (size_t config = 0; config < CONFIGS && failures < 10; config++) {
+        len = random_config(text, sizeof(text), config % 2 == 0);
+
+        expected = cfg_new();
+        status = cfg_parse_ctx(expected, text, len, CFG_FLAG_NONE);
+
+        cfg = cfg_new();
+        if (feed(cfg, text, len) != status) {
+            fprintf(stderr, "config %zu: status differs\n", config);
+            failures += 1;
+        }
+
+        if (status == 0) {
+            compare(expected, cfg, config);
+        } else if (cfg_get_errno_ctx(cfg) != cfg_get_errno_ctx(expected)
+            || cfg_get_error_line_ctx(cfg) != cfg_get_error_line_ctx(expected)
+            || cfg_get_error_col_ctx(cfg) != cfg_get_error_col_ctx(expected)) {
+            fprintf(stderr, "config %zu: error %d %zu:%zu, expected %d %zu:%zu\n", config,
+                cfg_get_errno_ctx(cfg), cfg_get_error_line_ctx(cfg), cfg_get_error_col_ctx(cfg),
+                cfg_get_errno_ctx(expected), cfg_get_error_line_ctx(expected), cfg_get_error_col_ctx(expected));
+            failures += 1;
+        } else {
+            failed += 1;
+        }
+
+        cfg_free_ctx(expected);
+        cfg_free_ctx(cfg);
+    }
+
+    /* feeding needs a stream */
+    cfg = cfg_new();
+    if (cfg_stream_feed_ctx(cfg, "a = 1\n", 6) == 0 || cfg_get_errno_ctx(cfg) != CFG_ESTREAM) {
+        failures += 1;
+    }
+
+    /* a pipe can't be mapped, it is read instead */
+    len = (size_t)snprintf(text, sizeof(text), "key_1 = 42\n# %0500d\nkey_2 = \"pipe\"", 0);
+    if (pipe(fds) != 0 || write(fds[1], text, len) != (ssize_t)len) {
+        return 1;
+    }
+    close(fds[1]);
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fds[0]);
+    if (cfg_load_ctx(cfg, path, CFG_FLAG_NONE) != 0 || cfg_get_setting_ctx(cfg, "key_1", &value) != 0 || value != 42
+        || cfg_get_setting_type_ctx(cfg, "key_2") != CFG_STYPE_STRING) {
+        cfg_perror_ctx(cfg, "pipe");
+        failures += 1;
+    }
+    close(fds[0]);
+    cfg_free_ctx(cfg);
+
+    /* and so is an empty file */
+    file = fopen("test_12.cfg", "w");
+    fclose(file);
+    if (cfg_load("test_12.cfg") != 0) {
+        cfg_perror("test_12.cfg");
+        failures += 1;
+    }
+    remove("test_12.cfg");
+
+    /* the global stream */
+    if (cfg_stream_begin() != 0 || cfg_stream_feed("key_3 = 1", 9) != 0 || cfg_stream_feed("7\nkey_", 6) != 0
+        || cfg_stream_feed("4 = x", 5) != 0 || cfg_stream_end() == 0 || cfg_errno != CFG_EINVNULL
+        || cfg_get_error_line() != 2 || cfg_get_setting("key_3", &value) != 0 || value != 17) {
+        failures += 1;
+    }
+    cfg_free();
+
+    printf("%d configs, %zu failed to parse, %d failures\n", CONFIGS, failed, failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/cfg.h"
+
+/* callback parse test: the settings handed to the callback are the ones cfg_parse stores */
+
+static const char config[] =
+    "# header\n"
+    "name = \"libcfg\"   # trailing comment\n"
+    "version = 3\n"
+    "ratio = -0.25\n"
+    "enabled = true\n"
+    "\n"
+    "empty = \"\"\n"
+    "name = \"shadowed\"\n"
+    "last = false";
+
+typedef struct collector_s {
+    cfg_t* expected;
+    size_t seen;
+    size_t stop_after; /* 0 to go through */
+    int failures;
+} collector_t;
+
+static int collect(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    collector_t* collector = user;
+    char id[64];
+    const char* str;
+    size_t str_len;
+    long long integer;
+    cfg_float_t floating;
+    bool boolean;
+    int differs = 1;
+
+    snprintf(id, sizeof(id), "%.*s", (int)identifier_len, identifier);
+    collector->seen += 1;
+
+    /* the table keeps the first of duplicated identifiers, the callback sees them all */
+    if (strcmp(id, "name") == 0 && collector->seen > 1) {
+        differs = value->type != CFG_STYPE_STRING || value->string_len != 8 || memcmp(value->string, "shadowed", 8) != 0;
+    } else if (cfg_get_setting_type_ctx(collector->expected, id) == value->type) {
+        switch (value->type) {
+            case CFG_STYPE_INT:
+                differs = cfg_get_setting_ctx(collector->expected, id, &integer) != 0 || integer != value->integer;
+                break;
+            case CFG_STYPE_FLOAT:
+                differs = cfg_get_setting_ctx(collector->expected, id, &floating) != 0 || floating < value->floating || floating > value->floating;
+                break;
+            case CFG_STYPE_BOOL:
+                differs = cfg_get_setting_ctx(collector->expected, id, &boolean) != 0 || boolean != value->boolean;
+                break;
+            case CFG_STYPE_STRING:
+                differs = cfg_get_string_view_ctx(collector->expected, id, &str, &str_len) != 0
+                    || str_len != value->string_len || memcmp(str, value->string, str_len) != 0;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (differs) {
+        fprintf(stderr, "%s differs\n", id);
+        collector->failures += 1;
+    }
+
+    return collector->stop_after != 0 && collector->seen == collector->stop_after;
+}
+
+int main(void) {
+    int failures = 0;
+    collector_t collector = { 0 };
+    cfg_t* cfg = cfg_new();
+
+    collector.expected = cfg_new();
+    if (cfg_parse_ctx(collector.expected, config, sizeof(config) - 1, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(collector.expected, "cfg_parse_ctx");
+        return 1;
+    }
+
+    /* every setting, in file order, and none stored */
+    if (cfg_parse_cb_ctx(cfg, config, sizeof(config) - 1, collect, &collector) != 0 || collector.seen != 7
+        || cfg_get_setting_type_ctx(cfg, "version") != CFG_STYPE_UNKNOWN) {
+        failures += 1;
+    }
+    failures += collector.failures;
+
+    /* stopped after the third setting, on its line */
+    cfg_free_ctx(cfg);
+    cfg = cfg_new();
+    collector.seen = 0;
+    collector.stop_after = 3;
+    collector.failures = 0;
+    if (cfg_parse_cb_ctx(cfg, config, sizeof(config) - 1, collect, &collector) != 0 || collector.seen != 3
+        || cfg_get_error_line_ctx(cfg) != 4) {
+        fprintf(stderr, "stop: %zu settings, line %zu\n", collector.seen, cfg_get_error_line_ctx(cfg));
+        failures += 1;
+    }
+    failures += collector.failures;
+
+    /* errors are reported like cfg_parse does */
+    cfg_free_ctx(cfg);
+    cfg = cfg_new();
+    collector.seen = 0;
+    collector.stop_after = 0;
+    if (cfg_parse_cb_ctx(cfg, "version = 3\nbroken = fals\n", 26, collect, &collector) == 0 || collector.seen != 1
+        || cfg_get_errno_ctx(cfg) != CFG_EINVBOOL || cfg_get_error_line_ctx(cfg) != 2 || cfg_get_error_col_ctx(cfg) != 14) {
+        fprintf(stderr, "error: %d %zu:%zu\n", cfg_get_errno_ctx(cfg), cfg_get_error_line_ctx(cfg), cfg_get_error_col_ctx(cfg));
+        failures += 1;
+    }
+
+    /* the global variant */
+    collector.seen = 0;
+    if (cfg_parse_cb("version = 3\n= 2\n", 16, collect, &collector) == 0 || cfg_errno != CFG_EINVID || collector.seen != 1) {
+        failures += 1;
+    }
+
+    cfg_free_ctx(collector.expected);
+    cfg_free_ctx(cfg);
+    cfg_free();
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
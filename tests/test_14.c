@@ -0,0 +1,128 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "../include/cfg.h"
+
+/* statistics test: parse and lookup counters, heap usage, slow hook, concurrent lookups */
+
+#define THREADS 4
+#define LOOKUPS 10000
+
+static const char config[] =
+    "# statistics\n"
+    "a = 1\n"
+    "b = 2\n"
+    "c = 0.5\n"
+    "d = \"text\"\n"
+    "\n"
+    "e = true\n"
+    "f = false";
+
+typedef struct slow_s {
+    size_t parses;
+    size_t lookups;
+    char last[32];
+} slow_t;
+
+static void on_slow(enum cfg_slow_e kind, const char* what, size_t what_len, uint64_t ns, void* user) {
+    slow_t* slow = user;
+
+    (void)ns;
+    if (kind == CFG_SLOW_PARSE) {
+        slow->parses += 1;
+    } else {
+        slow->lookups += 1;
+        snprintf(slow->last, sizeof(slow->last), "%.*s", (int)what_len, what);
+    }
+}
+
+static void* look_up(void* arg) {
+    cfg_t* cfg = arg;
+    long long value;
+
+    for (int i = 0; i < LOOKUPS; i++) {
+        cfg_get_setting_ctx(cfg, i % 2 == 0 ? "a" : "missing", &value);
+    }
+
+    return NULL;
+}
+
+int main(void) {
+    int failures = 0;
+    long long value;
+    cfg_stats_t stats;
+    slow_t slow = { 0 };
+    pthread_t threads[THREADS];
+    cfg_t* cfg = cfg_new();
+
+    if (cfg_parse_ctx(cfg, config, sizeof(config) - 1, CFG_FLAG_NONE) != 0) {
+        cfg_perror_ctx(cfg, "cfg_parse_ctx");
+        return 1;
+    }
+    cfg_get_setting_ctx(cfg, "a", &value);
+    cfg_get_setting_ctx(cfg, "z", &value);
+    cfg_get_setting_type_ctx(cfg, "y");
+
+    stats = cfg_get_stats_ctx(cfg);
+#ifdef CFG_NO_STATS
+    if (stats.parse_bytes != 0 || stats.lookups != 0 || stats.integers != 0) {
+        failures += 1;
+    }
+#else
+    if (stats.parse_bytes != sizeof(config) - 1 || stats.lines != 7 || stats.integers != 2 || stats.floats != 1
+        || stats.strings != 1 || stats.booleans != 2 || stats.lookups != 3 || stats.misses != 2 || stats.parse_ns == 0) {
+        fprintf(stderr, "bytes %llu lines %llu types %llu %llu %llu %llu lookups %llu misses %llu\n",
+            (unsigned long long)stats.parse_bytes, (unsigned long long)stats.lines, (unsigned long long)stats.integers,
+            (unsigned long long)stats.floats, (unsigned long long)stats.strings, (unsigned long long)stats.booleans,
+            (unsigned long long)stats.lookups, (unsigned long long)stats.misses);
+        failures += 1;
+    }
+#endif
+    /* the arena, the settings table, the index and the shared strings */
+    if (stats.heap_allocs != 4 || stats.heap_bytes < 6 * sizeof(void*)) {
+        fprintf(stderr, "heap %llu bytes in %llu blocks\n", (unsigned long long)stats.heap_bytes, (unsigned long long)stats.heap_allocs);
+        failures += 1;
+    }
+
+    /* lookups from several threads at once are all counted */
+    for (int i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, look_up, cfg);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    stats = cfg_get_stats_ctx(cfg);
+#ifndef CFG_NO_STATS
+    if (stats.lookups != 3 + THREADS * LOOKUPS || stats.misses != 2 + THREADS * LOOKUPS / 2) {
+        failures += 1;
+    }
+#endif
+
+    /* a zero threshold reports everything, the hook survives cfg_free */
+    cfg_set_slow_hook(0, on_slow, &slow);
+    cfg_parse("x = 1\n", 6);
+    cfg_get_setting("x", &value);
+    cfg_free();
+    stats = cfg_get_stats();
+    cfg_parse("y = 1\n", 6);
+    cfg_get_setting("nope", &value);
+    if (slow.parses != 2 || slow.lookups != 2 || strcmp(slow.last, "nope") != 0 || stats.lookups != 0 || stats.heap_allocs != 0) {
+        failures += 1;
+    }
+
+    /* a high one nothing */
+    cfg_set_slow_hook(UINT64_MAX, on_slow, &slow);
+    cfg_get_setting("y", &value);
+    cfg_set_slow_hook(0, NULL, NULL);
+    cfg_get_setting("y", &value);
+    if (slow.lookups != 2) {
+        failures += 1;
+    }
+
+    cfg_free();
+    cfg_free_ctx(cfg);
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* layering test: higher layers shadow lower ones, a shared base is neither copied nor modified */
+
+#define DEFAULTS 20000
+#define THREADS 4
+#define LOOKUPS 20000
+
+static int failures = 0;
+
+/* host over cluster over defaults, duplicates within a layer still resolve to the first */
+static const char cluster_text[] = "key_1 = 100\nkey_2 = 200\nzone = \"eu\"\n";
+static const char host_text[] = "key_2 = 2000\nkey_2 = 9\nname = \"host\"\n";
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+static long long get_int(cfg_t* cfg, const char* identifier) {
+    long long value = -1;
+
+    if (cfg_get_setting_ctx(cfg, identifier, &value) != 0) {
+        return -1;
+    }
+
+    return value;
+}
+
+typedef struct worker_s {
+    const cfg_t* defaults;
+    int n;
+    int failures;
+} worker_t;
+
+/* every thread stacks its own host layer over the shared defaults */
+static void* worker(void* arg) {
+    worker_t* w = arg;
+    cfg_t* host = cfg_new();
+    char text[64];
+    char id[32];
+    int len = snprintf(text, sizeof(text), "key_7 = %d\nthread = %d\n", 1000 + w->n, w->n);
+
+    if (host == NULL || cfg_set_base_ctx(host, w->defaults) != 0 || cfg_parse_ctx(host, text, (size_t)len, CFG_FLAG_NONE) != 0) {
+        w->failures += 1;
+        cfg_free_ctx(host);
+        return NULL;
+    }
+
+    for (int i = 0; i < LOOKUPS; i++) {
+        snprintf(id, sizeof(id), "key_%d", i % DEFAULTS);
+        w->failures += get_int(host, id) != (i % DEFAULTS == 7 ? 1000 + w->n : i % DEFAULTS);
+    }
+    w->failures += get_int(host, "thread") != w->n;
+
+    cfg_free_ctx(host);
+
+    return NULL;
+}
+
+/* counts the lines cfg_dump_ctx outputs, and checks that one of them is there */
+static size_t dump_lines(const cfg_t* cfg, const char* expected) {
+    char line[128];
+    size_t lines = 0;
+    bool found = false;
+    int out = dup(STDOUT_FILENO);
+    FILE* file = freopen("test_15.txt", "w", stdout);
+
+    if (file == NULL) {
+        return 0;
+    }
+    cfg_dump_ctx(cfg);
+    fflush(stdout);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+
+    file = fopen("test_15.txt", "r");
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lines += 1;
+        found |= strcmp(line, expected) == 0;
+    }
+    fclose(file);
+    remove("test_15.txt");
+
+    return found ? lines : 0;
+}
+
+int main(void) {
+    size_t cap = DEFAULTS * 32;
+    char* text = malloc(cap);
+    size_t len = 0;
+    const char* str;
+    size_t str_len;
+    char* value;
+    long long number;
+    cfg_t* defaults = cfg_new();
+    cfg_t* cluster = cfg_new();
+    cfg_t* host = cfg_new();
+    cfg_t* small = cfg_new();
+    cfg_stats_t before;
+    cfg_stats_t after;
+    pthread_t threads[THREADS];
+    worker_t workers[THREADS];
+
+    for (int i = 0; i < DEFAULTS; i++) {
+        len += (size_t)snprintf(&text[len], cap - len, "key_%d = %d\n", i, i);
+    }
+    len += (size_t)snprintf(&text[len], cap - len, "name = \"defaults\"\n");
+    check(cfg_parse_ctx(defaults, text, len, CFG_FLAG_NONE) == 0, "parse defaults");
+    before = cfg_get_stats_ctx(defaults);
+
+    check(cfg_set_base_ctx(cluster, defaults) == 0, "stack cluster");
+    check(cfg_parse_ctx(cluster, cluster_text, strlen(cluster_text), CFG_FLAG_NONE) == 0, "parse cluster");
+    check(cfg_set_base_ctx(host, cluster) == 0, "stack host");
+    check(cfg_parse_ctx(host, host_text, strlen(host_text), CFG_FLAG_NONE) == 0, "parse host");
+    check(cfg_get_base_ctx(host) == cluster && cfg_get_base_ctx(defaults) == NULL, "get base");
+
+    check(get_int(host, "key_0") == 0, "defaults show through");
+    check(get_int(host, "key_1") == 100, "cluster shadows defaults");
+    check(get_int(host, "key_2") == 2000, "host shadows cluster");
+    check(get_int(cluster, "key_2") == 200, "cluster unchanged");
+    check(get_int(defaults, "key_2") == 2, "defaults unchanged");
+    check(get_int(host, "missing") == -1 && cfg_get_errno_ctx(host) == CFG_ENEXIST, "missing everywhere");
+    check(cfg_get_setting_ctx(host, "name", &value) == 0 && strcmp(value, "host") == 0, "string shadowed");
+    check(cfg_get_string_view_ctx(host, "zone", &str, &str_len) == 0 && str_len == 2 && memcmp(str, "eu", 2) == 0, "string view");
+    check(cfg_get_setting_type_ctx(host, "zone") == CFG_STYPE_STRING, "type through layers");
+    check(cfg_get_setting_type_ctx(host, "key_9") == CFG_STYPE_INT, "type from defaults");
+
+    /* the merged view lists every identifier once */
+    check(dump_lines(host, "key_2=2000\n") == DEFAULTS + 1 + 1 + 1, "dump merged view");
+    check(dump_lines(defaults, "key_2=2\n") == DEFAULTS + 1, "dump defaults alone");
+
+    /* a layer holds its own settings only, whatever the size of its base */
+    cfg_parse_ctx(small, host_text, strlen(host_text), CFG_FLAG_NONE);
+    check(cfg_get_stats_ctx(host).heap_bytes == cfg_get_stats_ctx(small).heap_bytes, "layer memory");
+    cfg_free_ctx(small);
+
+    /* no cycles */
+    check(cfg_set_base_ctx(defaults, host) == 1 && cfg_get_errno_ctx(defaults) == CFG_ELAYER, "cycle");
+    check(cfg_set_base_ctx(host, host) == 1 && cfg_get_base_ctx(host) == cluster, "self");
+
+    /* freeing a layer leaves its base alone */
+    cfg_free_ctx(host);
+    check(get_int(cluster, "key_0") == 0, "base survives");
+
+    /* a shared base read by several threads at once */
+    for (int i = 0; i < THREADS; i++) {
+        workers[i] = (worker_t){ .defaults = defaults, .n = i, .failures = 0 };
+        pthread_create(&threads[i], NULL, worker, &workers[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        check(workers[i].failures == 0, "thread lookups");
+    }
+
+    /* the base was only read, its lookups are counted by the layers above */
+    after = cfg_get_stats_ctx(defaults);
+    check(after.heap_bytes == before.heap_bytes && after.lookups == 1, "base untouched");
+
+    /* the global configuration over a layer */
+    check(cfg_set_base(cluster) == 0, "global stack");
+    check(cfg_parse("key_1 = 1\n", 10) == 0, "global parse");
+    check(cfg_get_setting("key_1", &number) == 0 && number == 1, "global shadows");
+    cfg_free();
+    check(cfg_get_setting("key_2", &number) == 0 && number == 200, "global base kept");
+    check(cfg_set_base(NULL) == 0 && cfg_get_setting("key_2", &number) == 1 && cfg_errno == CFG_ENEXIST, "global unstacked");
+
+    cfg_free_ctx(cluster);
+    cfg_free_ctx(defaults);
+    free(text);
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
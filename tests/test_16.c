@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "../include/cfg.h"
+
+/* prefix test: cfg_foreach_prefix must list what a scan of every identifier would, sorted, once each */
+
+#define KEYS 3000
+#define THREADS 4
+
+static int failures = 0;
+
+static const char* const prefixes[] = {
+    "", "s", "svc_1", "svc_1.", "svc_1.http", "svc_1.http.", "svc_1.http.port", "svc_1.http.port_1",
+    "svc_2.db.pool.", "svc_0.db.pool.max_2", "svc_9", "svc_1.x", "svc_1.http.portz", "t", "extra.", "extra",
+};
+
+typedef struct list_s {
+    char ids[KEYS + 16][48];
+    size_t len;
+    size_t stop; /* stops after this many settings, 0 never */
+} list_t;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+static int collect(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    list_t* list = user;
+
+    (void)value;
+    snprintf(list->ids[list->len++], sizeof(list->ids[0]), "%.*s", (int)identifier_len, identifier);
+
+    return list->stop != 0 && list->len == list->stop;
+}
+
+static int compare(const void* a, const void* b) {
+    return strcmp(a, b);
+}
+
+/* the identifiers of a config text starting with a prefix, sorted, first occurrence only */
+static void scan(const char* text, const char* prefix, list_t* list) {
+    char id[48];
+    const char* line = text;
+    size_t n = 0;
+
+    list->len = 0;
+    while (sscanf(line, "%47[^ =] =", id) == 1) {
+        if (strncmp(id, prefix, strlen(prefix)) == 0) {
+            for (n = 0; n < list->len && strcmp(list->ids[n], id) != 0; n++);
+            if (n == list->len) {
+                strcpy(list->ids[list->len++], id);
+            }
+        }
+        line = strchr(line, '\n') + 1;
+    }
+
+    qsort(list->ids, list->len, sizeof(list->ids[0]), compare);
+}
+
+/* lists are equal when they hold the same identifiers in the same order */
+static bool equal(const list_t* a, const list_t* b) {
+    for (size_t i = 0; i < a->len && i < b->len; i++) {
+        if (strcmp(a->ids[i], b->ids[i]) != 0) {
+            return false;
+        }
+    }
+
+    return a->len == b->len;
+}
+
+static void check_prefixes(cfg_t* cfg, const char* text, const char* what) {
+    static list_t expected;
+    static list_t actual;
+    size_t count;
+
+    for (size_t p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+        scan(text, prefixes[p], &expected);
+        actual.len = 0;
+        actual.stop = 0;
+
+        if (cfg_foreach_prefix_ctx(cfg, prefixes[p], collect, &actual) != 0 || !equal(&actual, &expected)) {
+            fprintf(stderr, "%s: prefix \"%s\" lists %zu settings, expected %zu\n", what, prefixes[p], actual.len, expected.len);
+            failures += 1;
+        }
+
+        if (cfg_count_prefix_ctx(cfg, prefixes[p], &count) != 0 || count != expected.len) {
+            fprintf(stderr, "%s: prefix \"%s\" counts %zu settings, expected %zu\n", what, prefixes[p], count, expected.len);
+            failures += 1;
+        }
+    }
+}
+
+static size_t generate(char* buf, size_t cap, int keys) {
+    size_t len = 0;
+
+    for (int i = 0; i < keys; i++) {
+        switch (i % 4) {
+            case 0: {
+                len += (size_t)snprintf(&buf[len], cap - len, "svc_%d.http.port_%d = %d\n", i % 7, i / 28, i);
+                break;
+            }
+            case 1: {
+                len += (size_t)snprintf(&buf[len], cap - len, "svc_%d.db.pool.max_%d = %d.5\n", i % 3, i / 12, i);
+                break;
+            }
+            case 2: {
+                len += (size_t)snprintf(&buf[len], cap - len, "svc_%d.http = \"v%d\"\n", i % 11, i);
+                break;
+            }
+            default: {
+                len += (size_t)snprintf(&buf[len], cap - len, "svc_%d = true\n", i % 13);
+                break;
+            }
+        }
+    }
+
+    return len;
+}
+
+static void* worker(void* arg) {
+    size_t count = 0;
+
+    if (cfg_count_prefix_ctx(arg, "svc_1.", &count) != 0 || count == 0) {
+        return arg;
+    }
+
+    return NULL;
+}
+
+int main(void) {
+    static char text[KEYS * 48];
+    static list_t list;
+    char* edited;
+    size_t len = generate(text, sizeof(text), KEYS);
+    size_t count;
+    cfg_t* cfg = cfg_new();
+    cfg_t* base = cfg_new();
+    cfg_t* shared = cfg_new();
+    pthread_t threads[THREADS];
+    void* result;
+    FILE* file;
+
+    /* copied and zero-copy identifiers, with duplicates */
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_NONE) == 0, "parse");
+    check_prefixes(cfg, text, "copied");
+    cfg_free_ctx(cfg);
+
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_ZEROCOPY) == 0, "parse zero-copy");
+    check_prefixes(cfg, text, "zero-copy");
+
+    /* stopping early */
+    list.len = 0;
+    list.stop = 3;
+    check(cfg_foreach_prefix_ctx(cfg, "svc_1.", collect, &list) == 0 && list.len == 3, "stop");
+    cfg_free_ctx(cfg);
+
+    /* new settings and edits drop the tree */
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_INCREMENTAL) == 0, "parse incremental");
+    check(cfg_count_prefix_ctx(cfg, "extra", &count) == 0 && count == 0, "no extra");
+    edited = malloc(len + 32);
+    memcpy(edited, "extra.a = 1\nextra.b = 2\n", 24);
+    memcpy(&edited[24], text, len);
+    check(cfg_edit_ctx(cfg, edited, len + 24, 0, 0, 24) == 0, "edit");
+    check(cfg_count_prefix_ctx(cfg, "extra.", &count) == 0 && count == 2, "edited count");
+    check_prefixes(cfg, edited, "edited");
+    check(cfg_parse_ctx(cfg, "extra.c = 3\n", 12, CFG_FLAG_NONE) == 0, "parse more");
+    check(cfg_count_prefix_ctx(cfg, "extra.", &count) == 0 && count == 3, "appended count");
+    cfg_free_ctx(cfg);
+    free(edited);
+
+    /* layers list the settings of the base that aren't shadowed */
+    cfg = cfg_new();
+    check(cfg_parse_ctx(base, text, len, CFG_FLAG_NONE) == 0, "parse base");
+    check(cfg_set_base_ctx(cfg, base) == 0 && cfg_parse_ctx(cfg, "svc_1 = false\nextra.x = 1\n", 26, CFG_FLAG_NONE) == 0, "parse layer");
+    check(cfg_count_prefix_ctx(cfg, "svc_1", &count) == 0 && cfg_count_prefix_ctx(base, "svc_1", &len) == 0 && count == len, "layer count");
+    check(cfg_count_prefix_ctx(cfg, "", &count) == 0 && cfg_count_prefix_ctx(base, "", &len) == 0 && count == len + 1, "layer total");
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(base);
+
+    /* a compiled config */
+    file = fopen("test_16.cfg", "w");
+    fwrite(text, 1, generate(text, sizeof(text), KEYS), file);
+    fclose(file);
+    check(cfg_compile("test_16.cfg", "test_16.bin") == 0, "compile");
+    cfg = cfg_new();
+    check(cfg_load_compiled_ctx(cfg, "test_16.cfg", "test_16.bin") == 0, "load compiled");
+    check_prefixes(cfg, text, "compiled");
+    cfg_free_ctx(cfg);
+    remove("test_16.bin");
+
+    /* the first query of several threads at once */
+    cfg_parse_ctx(shared, text, strlen(text), CFG_FLAG_NONE);
+    for (int i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, worker, shared);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], &result);
+        check(result == NULL, "threads");
+    }
+    cfg_free_ctx(shared);
+
+    /* the global configuration */
+    check(cfg_load("test_16.cfg") == 0 && cfg_count_prefix("svc_2.db.", &count) == 0 && count > 0, "global count");
+    list.len = 0;
+    list.stop = 0;
+    check(cfg_foreach_prefix("svc_2.db.", collect, &list) == 0 && list.len == count, "global foreach");
+    cfg_free();
+    remove("test_16.cfg");
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../include/cfg.h"
+
+/* shared strings test: repeated values share one copy, and the strings handed out stay valid as the config grows */
+
+#define KEYS 5000
+
+static int failures = 0;
+
+static const char* const levels[] = { "debug", "info", "warn", "error" };
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+static char* get_string(cfg_t* cfg, const char* identifier) {
+    char* value = NULL;
+
+    cfg_get_setting_ctx(cfg, identifier, &value);
+
+    return value;
+}
+
+int main(void) {
+    static char text[KEYS * 64];
+    static char more[KEYS * 32];
+    static char longer[300];
+    char id[32];
+    char* level;
+    char* first;
+    const char* view;
+    size_t view_len;
+    size_t len = 0;
+    size_t more_len = 0;
+    size_t edit_len;
+    char* edited;
+    cfg_stats_t stats;
+    cfg_t* cfg = cfg_new();
+
+    /* four levels, a unique path, and a long value repeated */
+    memset(longer, 'x', 200);
+    for (int i = 0; i < KEYS; i++) {
+        len += (size_t)snprintf(&text[len], sizeof(text) - len, "level_%d = \"%s\"\npath_%d = \"/srv/%d\"\n", i, levels[i % 4], i, i);
+    }
+    len += (size_t)snprintf(&text[len], sizeof(text) - len, "long_1 = \"%.200s\"\nlong_2 = \"%.200s\"\nempty_1 = \"\"\nempty_2 = \"\"\n", longer, longer);
+
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_INCREMENTAL) == 0, "parse");
+    stats = cfg_get_stats_ctx(cfg);
+    check(stats.strings == KEYS * 2 + 4 && stats.shared_strings == KEYS - 4 + 1, "shared count");
+
+    /* equal values, one copy */
+    level = get_string(cfg, "level_1");
+    check(level != NULL && strcmp(level, "info") == 0 && level == get_string(cfg, "level_5"), "same copy");
+    check(strcmp(get_string(cfg, "level_2"), "warn") == 0 && get_string(cfg, "level_2") != level, "other value");
+    check(strcmp(get_string(cfg, "path_7"), "/srv/7") == 0, "unique value");
+    check(strlen(get_string(cfg, "long_2")) == 200 && get_string(cfg, "long_1") != get_string(cfg, "long_2"), "long values copied");
+    check(get_string(cfg, "empty_2") == get_string(cfg, "empty_1") && strcmp(get_string(cfg, "empty_1"), "") == 0, "empty value");
+
+    /* the settings table grows, and settings are edited, the strings stay where they are */
+    first = get_string(cfg, "path_0");
+    edited = malloc(len + 64);
+    edit_len = (size_t)snprintf(edited, 64, "level_x = \"info\"\n");
+    memcpy(&edited[edit_len], text, len);
+    check(cfg_edit_ctx(cfg, edited, len + edit_len, 0, 0, edit_len) == 0, "edit");
+    check(get_string(cfg, "level_x") != NULL && strcmp(get_string(cfg, "level_x"), "info") == 0, "edited value");
+    for (int i = 0; i < KEYS; i++) {
+        more_len += (size_t)snprintf(&more[more_len], sizeof(more) - more_len, "more_%d = \"%s\"\n", i, levels[i % 4]);
+    }
+    check(cfg_parse_ctx(cfg, more, more_len, CFG_FLAG_NONE) == 0, "parse more");
+    check(get_string(cfg, "path_0") == first && strcmp(first, "/srv/0") == 0, "stable pointer");
+    check(get_string(cfg, "level_1") == level && strcmp(level, "info") == 0, "stable shared pointer");
+    snprintf(id, sizeof(id), "more_%d", KEYS - 3);
+    check(strcmp(get_string(cfg, id), "info") == 0, "new shared value");
+    cfg_free_ctx(cfg);
+    free(edited);
+
+    /* zero-copy strings point into the buffer, nothing is shared */
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_ZEROCOPY) == 0, "parse zero-copy");
+    check(cfg_get_string_view_ctx(cfg, "level_3", &view, &view_len) == 0 && view_len == 5 && memcmp(view, "error", 5) == 0, "view");
+    check(view > text && view < &text[len] && cfg_get_stats_ctx(cfg).shared_strings == 0, "view into buffer");
+    cfg_free_ctx(cfg);
+
+    /* the global configuration */
+    check(cfg_parse(text, len) == 0 && cfg_get_stats().shared_strings == KEYS - 4 + 1, "global");
+    cfg_free();
+    check(cfg_get_stats().shared_strings == 0, "global freed");
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
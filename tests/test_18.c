@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../include/cfg.h"
+
+/* writer test: the output of cfg_write parses back to the same settings, floats keep every bit */
+
+#define RANDOM_FLOATS 20000
+
+static int failures = 0;
+
+static const char fixed[] =
+    "zero = 0\n"
+    "min = -9223372036854775808\n"
+    "max = 9223372036854775807\n"
+    "negative = -42\n"
+    "tenth = 0.1\n"
+    "half = 2.50\n"
+    "whole = 100.0\n"
+    "negative_zero = -0.0\n"
+    "tiny = 0.000000000000000000000000000001\n"
+    "huge = 1000000000000000000000000000000000000000.0\n"
+    "pi = 3.14159265358979323846264338327950288\n"
+    "empty = \"\"\n"
+    "text = \"a = b, with spaces \"\n"
+    "yes = true\n"
+    "no = false\n"
+    "zero = 1\n";
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+/* the output is the same once parsed back and written again, and the values read back are the same bits */
+static void check_round_trip(cfg_t* cfg, const char* what) {
+    char* out = NULL;
+    char* again = NULL;
+    size_t len = 0;
+    size_t again_len = 0;
+    cfg_t* copy = cfg_new();
+
+    if (cfg_write_buffer_ctx(cfg, &out, &len) != 0 || strlen(out) != len
+        || cfg_parse_ctx(copy, out, len, CFG_FLAG_NONE) != 0 || cfg_write_buffer_ctx(copy, &again, &again_len) != 0
+        || len != again_len || memcmp(out, again, len) != 0) {
+        fprintf(stderr, "%s: the output doesn't read back\n", what);
+        failures += 1;
+    }
+
+    cfg_free_ctx(copy);
+    free(out);
+    free(again);
+}
+
+static cfg_float_t get_float(cfg_t* cfg, const char* identifier) {
+    cfg_float_t value = -1;
+
+    cfg_get_setting_ctx(cfg, identifier, &value);
+
+    return value;
+}
+
+int main(void) {
+    static char text[RANDOM_FLOATS * 48];
+    char expected[64];
+    char* out = NULL;
+    char* file_out;
+    size_t len = 0;
+    size_t out_len;
+    long long integer;
+    cfg_float_t a;
+    cfg_float_t b;
+    int fd;
+    cfg_t* cfg = cfg_new();
+    cfg_t* copy = cfg_new();
+    cfg_t* base = cfg_new();
+
+    /* every type, duplicates, the extremes */
+    check(cfg_parse_ctx(cfg, fixed, strlen(fixed), CFG_FLAG_NONE) == 0, "parse");
+    check(cfg_write_buffer_ctx(cfg, &out, &out_len) == 0, "write");
+    check(strstr(out, "tenth=0.1\n") != NULL && strstr(out, "half=2.5\n") != NULL && strstr(out, "whole=100.0\n") != NULL, "shortest floats");
+    check(strstr(out, "min=-9223372036854775808\n") != NULL && strstr(out, "negative_zero=-0.0\n") != NULL, "extremes");
+    check(strstr(out, "text=\"a = b, with spaces \"\n") != NULL && strstr(out, "zero=0\n") != NULL && strstr(out, "zero=1\n") != NULL, "strings and duplicates");
+    check(cfg_parse_ctx(copy, out, out_len, CFG_FLAG_NONE) == 0, "parse back");
+    check(cfg_get_setting_ctx(copy, "min", &integer) == 0 && integer == -9223372036854775807LL - 1, "integer back");
+    a = get_float(cfg, "pi");
+    b = get_float(copy, "pi");
+    check(memcmp(&a, &b, sizeof(cfg_float_t)) == 0 && get_float(copy, "tiny") == get_float(cfg, "tiny")
+        && get_float(copy, "huge") == get_float(cfg, "huge"), "floats back");
+    check_round_trip(cfg, "fixed");
+    free(out);
+    cfg_free_ctx(copy);
+
+    /* the same bytes through a file descriptor */
+    fd = open("test_18.cfg", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    check(fd != -1 && cfg_write_ctx(cfg, fd) == 0 && close(fd) == 0, "write fd");
+    check(cfg_write_buffer_ctx(cfg, &out, &out_len) == 0, "write again");
+    file_out = malloc(out_len + 1);
+    fd = open("test_18.cfg", O_RDONLY);
+    check(read(fd, file_out, out_len + 1) == (ssize_t)out_len && memcmp(file_out, out, out_len) == 0, "same bytes");
+    close(fd);
+    free(file_out);
+    free(out);
+    check(cfg_write_ctx(cfg, -1) == 1 && cfg_get_errno_ctx(cfg) == CFG_EWRITE, "bad fd");
+    cfg_free_ctx(cfg);
+
+    /* decimals of every length, which the writer must not round */
+    srand(18);
+    for (int i = 0; i < RANDOM_FLOATS; i++) {
+        len += (size_t)snprintf(&text[len], sizeof(text) - len, "f_%d = %s%d.%0*d%d\n", i, rand() % 2 ? "-" : "",
+            rand() % (i % 3 == 0 ? 10 : 1000000), rand() % 12, 0, rand());
+    }
+    cfg = cfg_new();
+    copy = cfg_new();
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_ZEROCOPY) == 0, "parse random");
+    check(cfg_write_buffer_ctx(cfg, &out, &out_len) == 0 && cfg_parse_ctx(copy, out, out_len, CFG_FLAG_NONE) == 0, "random back");
+    for (int i = 0; i < RANDOM_FLOATS; i++) {
+        snprintf(expected, sizeof(expected), "f_%d", i);
+        a = get_float(cfg, expected);
+        b = get_float(copy, expected);
+        if (memcmp(&a, &b, sizeof(cfg_float_t)) != 0) {
+            fprintf(stderr, "%s changed\n", expected);
+            failures += 1;
+        }
+    }
+    check_round_trip(cfg, "random");
+    free(out);
+    cfg_free_ctx(copy);
+    cfg_free_ctx(cfg);
+
+    /* layers, the merged view */
+    cfg = cfg_new();
+    cfg_parse_ctx(base, "a = 1\nb = 2\n", 12, CFG_FLAG_NONE);
+    cfg_set_base_ctx(cfg, base);
+    cfg_parse_ctx(cfg, "b = 3\n", 6, CFG_FLAG_NONE);
+    check(cfg_write_buffer_ctx(cfg, &out, &out_len) == 0 && strcmp(out, "b=3\na=1\n") == 0, "layers");
+    free(out);
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(base);
+
+    /* the global configuration, and an empty one */
+    check(cfg_write_buffer(&out, &out_len) == 0 && out_len == 0 && out[0] == '\0', "empty");
+    free(out);
+    check(cfg_load("test_18.cfg") == 0 && cfg_write_buffer(&out, &out_len) == 0 && strstr(out, "pi=3.14159") != NULL, "global");
+    free(out);
+    cfg_free();
+    remove("test_18.cfg");
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "../include/cfg.h"
+
+/* mutation test: settings set and removed in place, recorded in a journal replayed over the config file */
+
+#define FLIPS 20000
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+static long long get_integer(cfg_t* cfg, const char* identifier) {
+    long long value = -1;
+
+    cfg_get_setting_ctx(cfg, identifier, &value);
+
+    return value;
+}
+
+static char* get_string(cfg_t* cfg, const char* identifier) {
+    char* value = NULL;
+
+    cfg_get_setting_ctx(cfg, identifier, &value);
+
+    return value;
+}
+
+static bool written(cfg_t* cfg, const char* expected) {
+    char* out = NULL;
+    size_t len;
+    bool same = cfg_write_buffer_ctx(cfg, &out, &len) == 0 && strcmp(out, expected) == 0;
+
+    if (!same) {
+        fprintf(stderr, "written: %s", out == NULL ? "(null)\n" : out);
+    }
+    free(out);
+
+    return same;
+}
+
+static void write_file(const char* path, const char* str) {
+    FILE* file = fopen(path, "w");
+
+    fputs(str, file);
+    fclose(file);
+}
+
+static size_t file_size(const char* path) {
+    struct stat s;
+
+    return stat(path, &s) == 0 ? (size_t)s.st_size : SIZE_MAX;
+}
+
+static int count_setting(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    (void)identifier;
+    (void)identifier_len;
+    (void)value;
+    *(size_t*)user += 1;
+
+    return 0;
+}
+
+int main(void) {
+    static const char text[] = "port = 80\nhost = \"a\"\nratio = 0.5\nenabled = false\n";
+    cfg_value_t value;
+    const char* view;
+    size_t view_len;
+    size_t count = 0;
+    int fd;
+    char* host;
+    char id[32];
+    bool enabled = true;
+    cfg_float_t ratio = 0;
+    cfg_t* cfg = cfg_new();
+    cfg_t* base = cfg_new();
+
+    /* values replaced in place, types changed, settings added */
+    check(cfg_parse_ctx(cfg, text, strlen(text), CFG_FLAG_INCREMENTAL) == 0, "parse");
+    host = get_string(cfg, "host");
+    check(cfg_set_setting_ctx(cfg, "port", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 8080 }) == 0 && get_integer(cfg, "port") == 8080, "set integer");
+    check(cfg_set_setting_ctx(cfg, "host", &(cfg_value_t){ .type = CFG_STYPE_STRING, .string = "b.example", .string_len = 9 }) == 0
+        && strcmp(get_string(cfg, "host"), "b.example") == 0 && strcmp(host, "a") == 0, "set string");
+    check(cfg_set_setting_ctx(cfg, "ratio", &(cfg_value_t){ .type = CFG_STYPE_FLOAT, .floating = 0.25 }) == 0
+        && cfg_get_setting_ctx(cfg, "ratio", &ratio) == 0 && ratio == (cfg_float_t)0.25, "set float");
+    check(cfg_set_setting_ctx(cfg, "enabled", &(cfg_value_t){ .type = CFG_STYPE_BOOL, .boolean = true }) == 0
+        && cfg_get_setting_ctx(cfg, "enabled", &enabled) == 0 && enabled, "set boolean");
+    check(cfg_set_setting_ctx(cfg, "port", &(cfg_value_t){ .type = CFG_STYPE_STRING, .string = "http", .string_len = 4 }) == 0
+        && cfg_get_setting_type_ctx(cfg, "port") == CFG_STYPE_STRING, "change type");
+    check(cfg_set_setting_ctx(cfg, "mode", &(cfg_value_t){ .type = CFG_STYPE_STRING, .string = "http", .string_len = 4 }) == 0
+        && get_string(cfg, "mode") == get_string(cfg, "port"), "add shared string");
+    check(written(cfg, "port=\"http\"\nhost=\"b.example\"\nratio=0.25\nenabled=true\nmode=\"http\"\n"), "write");
+    check(cfg_edit_ctx(cfg, text, strlen(text), 0, 0, 0) == 1 && cfg_get_errno_ctx(cfg) == CFG_EEDIT, "no edit after a change");
+
+    /* values the syntax can't hold */
+    check(cfg_set_setting_ctx(cfg, "bad id", &(cfg_value_t){ .type = CFG_STYPE_INT }) == 1 && cfg_get_errno_ctx(cfg) == CFG_EINVID, "invalid identifier");
+    check(cfg_set_setting_ctx(cfg, "", &(cfg_value_t){ .type = CFG_STYPE_INT }) == 1 && cfg_get_errno_ctx(cfg) == CFG_EINVID, "empty identifier");
+    check(cfg_set_setting_ctx(cfg, "s", &(cfg_value_t){ .type = CFG_STYPE_STRING, .string = "a#b", .string_len = 3 }) == 1
+        && cfg_get_errno_ctx(cfg) == CFG_EINVSTRING, "comment in string");
+    check(cfg_set_setting_ctx(cfg, "f", &(cfg_value_t){ .type = CFG_STYPE_FLOAT, .floating = 1.0 / 0.0 }) == 1
+        && cfg_get_errno_ctx(cfg) == CFG_EINVFLOAT, "infinite float");
+    check(cfg_set_setting_ctx(cfg, "u", &(cfg_value_t){ .type = CFG_STYPE_UNKNOWN }) == 1 && cfg_get_errno_ctx(cfg) == CFG_EINVNULL, "no type");
+
+    /* removed settings are gone from the getters, the writer and the prefix queries, and come back in place */
+    check(cfg_remove_setting_ctx(cfg, "host") == 0 && get_string(cfg, "host") == NULL && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "remove");
+    check(cfg_get_setting_type_ctx(cfg, "host") == CFG_STYPE_UNKNOWN, "removed type");
+    check(cfg_remove_setting_ctx(cfg, "host") == 1 && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "remove twice");
+    check(cfg_remove_setting_ctx(cfg, "missing") == 1 && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "remove missing");
+    check(cfg_foreach_prefix_ctx(cfg, "", count_setting, &count) == 0 && count == 4, "prefix without removed");
+    check(written(cfg, "port=\"http\"\nratio=0.25\nenabled=true\nmode=\"http\"\n"), "write without removed");
+    check(cfg_set_setting_ctx(cfg, "host", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 3 }) == 0 && get_integer(cfg, "host") == 3, "set removed");
+    check(cfg_count_prefix_ctx(cfg, "", &count) == 0 && count == 5, "prefix with set again");
+    check(written(cfg, "port=\"http\"\nhost=3\nratio=0.25\nenabled=true\nmode=\"http\"\n"), "same place");
+    cfg_free_ctx(cfg);
+
+    /* duplicates go with the setting, zero-copy settings get views of copies */
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, "a = 1\nb = \"x\"\na = 2\n", 20, CFG_FLAG_ZEROCOPY) == 0, "parse duplicates");
+    check(cfg_remove_setting_ctx(cfg, "a") == 0 && written(cfg, "b=\"x\"\n"), "remove duplicates");
+    check(cfg_set_setting_ctx(cfg, "b", &(cfg_value_t){ .type = CFG_STYPE_STRING, .string = "yz", .string_len = 2 }) == 0
+        && cfg_get_string_view_ctx(cfg, "b", &view, &view_len) == 0 && view_len == 2 && memcmp(view, "yz", 2) == 0, "set view");
+    cfg_free_ctx(cfg);
+
+    /* a removed setting hides the one of the base, the base is left alone */
+    cfg = cfg_new();
+    cfg_parse_ctx(base, "a = 1\nb = 2\n", 12, CFG_FLAG_NONE);
+    cfg_set_base_ctx(cfg, base);
+    cfg_parse_ctx(cfg, "c = 3\n", 6, CFG_FLAG_NONE);
+    check(cfg_remove_setting_ctx(cfg, "a") == 0 && get_integer(cfg, "a") == -1 && get_integer(base, "a") == 1, "remove base setting");
+    check(cfg_count_prefix_ctx(cfg, "", &count) == 0 && count == 2 && written(cfg, "c=3\nb=2\n"), "hidden base setting");
+    check(cfg_set_setting_ctx(cfg, "a", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 5 }) == 0 && get_integer(cfg, "a") == 5, "override base setting");
+    cfg_free_ctx(cfg);
+
+    /* compiled configs can't change */
+    write_file("test_19.cfg", text);
+    check(cfg_compile("test_19.cfg", "test_19.bin") == 0, "compile");
+    cfg = cfg_new();
+    check(cfg_load_compiled_ctx(cfg, "test_19.cfg", "test_19.bin") == 0, "load compiled");
+    check(cfg_set_setting_ctx(cfg, "port", &(cfg_value_t){ .type = CFG_STYPE_INT }) == 1 && cfg_get_errno_ctx(cfg) == CFG_EREADONLY, "compiled set");
+    check(cfg_remove_setting_ctx(cfg, "port") == 1 && cfg_get_errno_ctx(cfg) == CFG_EREADONLY, "compiled remove");
+    cfg_free_ctx(cfg);
+    remove("test_19.bin");
+
+    /* the journal records the changes, loading the file and replaying it gives them back */
+    remove("test_19.journal");
+    cfg = cfg_new();
+    check(cfg_journal_open_ctx(cfg, "test_19.journal", 0) == 1 && cfg_get_errno_ctx(cfg) == CFG_EJOURNAL, "journal without file");
+    check(cfg_journal_sync_ctx(cfg) == 1 && cfg_get_errno_ctx(cfg) == CFG_EJOURNAL, "sync without journal");
+    check(cfg_load_ctx(cfg, "test_19.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_19.journal", 0) == 0, "journal open");
+    cfg_set_setting_ctx(cfg, "port", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 443 });
+    cfg_set_setting_ctx(cfg, "tls", &(cfg_value_t){ .type = CFG_STYPE_BOOL, .boolean = true });
+    cfg_remove_setting_ctx(cfg, "host");
+    check(cfg_journal_close_ctx(cfg) == 0, "journal close");
+    cfg_set_setting_ctx(cfg, "unrecorded", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 1 });
+    cfg_free_ctx(cfg);
+    check(file_size("test_19.journal") == strlen("port=443\ntls=true\n!host\n"), "journal records");
+
+    cfg = cfg_new();
+    check(cfg_load_ctx(cfg, "test_19.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_19.journal", 0) == 0, "replay");
+    check(written(cfg, "port=443\nratio=0.5\nenabled=false\ntls=true\n"), "replayed");
+
+    /* a compaction rewrites the file and empties the journal */
+    check(cfg_journal_compact_ctx(cfg) == 0 && cfg_journal_sync_ctx(cfg) == 0, "compact");
+    check(file_size("test_19.journal") == 0 && file_size("test_19.cfg") == strlen("port=443\nratio=0.5\nenabled=false\ntls=true\n"), "compacted");
+    check(access("test_19.journal.next", F_OK) != 0 && access("test_19.cfg.tmp", F_OK) != 0, "no leftovers");
+    cfg_set_setting_ctx(cfg, "ratio", &(cfg_value_t){ .type = CFG_STYPE_FLOAT, .floating = 0.75 });
+    cfg_free_ctx(cfg);
+
+    /* a change cut short by a crash is dropped, a compaction cut short is replayed from both journals */
+    fd = open("test_19.journal", O_WRONLY | O_APPEND);
+    check(fd != -1 && write(fd, "enabled=tr", 10) == 10 && close(fd) == 0, "torn record");
+    write_file("test_19.journal.next", "tls=false\n!port\n");
+    cfg = cfg_new();
+    check(cfg_load_ctx(cfg, "test_19.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_19.journal", 0) == 0, "recover");
+    check(written(cfg, "ratio=0.75\nenabled=false\ntls=false\n"), "recovered");
+    check(access("test_19.journal.next", F_OK) != 0 && file_size("test_19.journal") == strlen("ratio=0.75\ntls=false\n!port\n"), "journals joined");
+    cfg_free_ctx(cfg);
+
+    /* flags flipped over and over, compacted on the way */
+    cfg = cfg_new();
+    check(cfg_load_ctx(cfg, "test_19.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_19.journal", 4096) == 0, "open compacting");
+    for (int i = 0; i < FLIPS; i++) {
+        snprintf(id, sizeof(id), "flag_%d", i % 100);
+        value = (cfg_value_t){ .type = CFG_STYPE_BOOL, .boolean = i % 3 == 0 };
+        if (cfg_set_setting_ctx(cfg, id, &value) != 0) {
+            check(false, "flip");
+            break;
+        }
+    }
+    check(cfg_journal_sync_ctx(cfg) == 0 && file_size("test_19.journal") < FLIPS * 4 && file_size("test_19.cfg") > 1000, "compacted while flipping");
+    cfg_free_ctx(cfg);
+    cfg = cfg_new();
+    check(cfg_load_ctx(cfg, "test_19.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_19.journal", 0) == 0, "reopen");
+    for (int i = FLIPS - 100; i < FLIPS; i++) {
+        snprintf(id, sizeof(id), "flag_%d", i % 100);
+        enabled = i % 3 != 0;
+        if (cfg_get_setting_ctx(cfg, id, &enabled) != 0 || enabled != (i % 3 == 0)) {
+            check(false, "last flips");
+            break;
+        }
+    }
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(base);
+
+    /* the global configuration */
+    remove("test_19.journal");
+    check(cfg_load("test_19.cfg") == 0 && cfg_journal_open("test_19.journal", 0) == 0, "global open");
+    check(cfg_set_setting("ratio", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 2 }) == 0 && cfg_remove_setting("enabled") == 0, "global change");
+    check(cfg_journal_compact() == 0 && cfg_journal_close() == 0 && file_size("test_19.journal") == 0, "global compact");
+    cfg_free();
+    check(cfg_load("test_19.cfg") == 0 && cfg_get_setting_type("enabled") == CFG_STYPE_UNKNOWN && cfg_get_setting_type("ratio") == CFG_STYPE_INT, "global reload");
+    cfg_free();
+    remove("test_19.cfg");
+    remove("test_19.journal");
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
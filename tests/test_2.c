@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "../include/cfg.h"
+
+/* differential test: the in place number parsers must agree with strtoll and strtold (strtod with CFG_FLOAT_DOUBLE) */
+
+#ifdef CFG_FLOAT_DOUBLE
+#define reference_strtof strtod
+#else
+#define reference_strtof strtold
+#endif
+
+static const char* corpus[] = {
+    "0", "-0", "7", "-7", "1337", "00000000000000000000000000042", "-000",
+    "9223372036854775807", "-9223372036854775808", "9223372036854775808", "-9223372036854775809",
+    "18446744073709551615", "18446744073709551616", "99999999999999999999", "1000000000000000000",
+    "0.0", "-0.0", "1.", "-1.", "-.5", "3.14", "3.456789", "0.1", "0.2", "0.30000000000000004",
+    "1.7976931348623157", "2.2250738585072014", "4.9406564584124654", "123456789012345678.9",
+    "9007199254740993.0", "9007199254740992.0", "18446744073709551615.0", "18446744073709551616.5",
+    "0.000000000000000000000000001", "0.0000000000000000000000000001", "3.1400000000000000000000000000000",
+    "1234567890123456789012345678901234567890.5", "-", "-.",
+};
+
+static unsigned long long seed_g = 88172645463325252ULL;
+
+static unsigned next_random(unsigned bound) {
+    seed_g ^= seed_g << 13;
+    seed_g ^= seed_g >> 7;
+    seed_g ^= seed_g << 17;
+    return (unsigned)(seed_g % bound);
+}
+
+/* generates a token that passes the number syntax check and starts like a number */
+static void random_token(char* buf) {
+    size_t len = 0;
+    unsigned int_len = next_random(24);
+    unsigned fraction_len = next_random(3) == 0 ? 0 : next_random(30);
+
+    /* values starting with a dot aren't numbers for the parser */
+    if (int_len == 0 || next_random(2) == 0) {
+        buf[len++] = '-';
+    }
+    for (unsigned i = 0; i < int_len; i++) {
+        buf[len++] = (char)('0' + (i == 0 && next_random(4) != 0 ? 1 + next_random(9) : next_random(10)));
+    }
+    if (fraction_len > 0 || int_len == 0) {
+        buf[len++] = '.';
+        for (unsigned i = 0; i < fraction_len; i++) {
+            buf[len++] = (char)('0' + (next_random(5) == 0 ? 0 : next_random(10)));
+        }
+    }
+    buf[len] = '\0';
+}
+
+static int check(const char* token) {
+    char buf[128];
+    char* endptr;
+    int len = snprintf(buf, sizeof(buf), "v = %s", token);
+    int status = cfg_parse(buf, (size_t)len);
+    int expected_errno = CFG_SUCCESS;
+    long long expected_integer = 0;
+    long long integer;
+    cfg_float_t expected_floating = 0;
+    cfg_float_t floating;
+    bool is_floating = strchr(token, '.') != NULL;
+    bool ok = true;
+
+    /* what cfg_parse_integer and cfg_parse_floating used to do */
+    errno = 0;
+    if (is_floating) {
+        expected_floating = reference_strtof(token, &endptr);
+        if (endptr == token) {
+            expected_errno = CFG_EINVFLOAT;
+        } else if (errno == ERANGE || errno == EINVAL) {
+            expected_errno = CFG_ERANGE;
+        }
+    } else {
+        expected_integer = strtoll(token, &endptr, 10);
+        if (endptr == token) {
+            expected_errno = CFG_EINVINT;
+        } else if (errno == ERANGE || errno == EINVAL) {
+            expected_errno = CFG_ERANGE;
+        }
+    }
+
+    if (expected_errno != CFG_SUCCESS || status != 0) {
+        ok = status != 0 && cfg_errno == expected_errno;
+    } else if (is_floating) {
+        ok = cfg_get_setting("v", &floating) == 0
+            && floating == expected_floating
+            && signbit(floating) == signbit(expected_floating);
+    } else {
+        ok = cfg_get_setting("v", &integer) == 0 && integer == expected_integer;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "mismatch on \"%s\": status %d (%s), expected %s\n",
+            token,
+            status,
+            cfg_strerror(cfg_errno),
+            cfg_strerror(expected_errno)
+        );
+    }
+
+    cfg_free();
+
+    return ok ? 0 : 1;
+}
+
+int main(void) {
+    char token[64];
+    size_t failures = 0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++, count++) {
+        failures += (size_t)check(corpus[i]);
+    }
+
+    for (size_t i = 0; i < 200000; i++, count++) {
+        random_token(token);
+        failures += (size_t)check(token);
+    }
+
+    printf("%zu numbers checked, %zu mismatches\n", count, failures);
+
+    return failures != 0;
+}
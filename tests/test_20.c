@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "../include/cfg.h"
+
+/* lazy test: numbers kept as text read back like parsed ones, converted once, their errors reported when read */
+
+#define RANDOM_NUMBERS 20000
+
+static int failures = 0;
+
+typedef struct config_s {
+    long long port;
+    cfg_float_t ratio;
+} config_t;
+
+static const cfg_binding_t bindings[] = {
+    { "port", CFG_STYPE_INT, offsetof(config_t, port), false, .integer = 0 },
+    { "ratio", CFG_STYPE_FLOAT, offsetof(config_t, ratio), false, .floating = 0 },
+};
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+static long long get_integer(cfg_t* cfg, const char* identifier) {
+    long long value = -1;
+
+    cfg_get_setting_ctx(cfg, identifier, &value);
+
+    return value;
+}
+
+static int stop(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    (void)identifier;
+    (void)identifier_len;
+    (void)value;
+    (void)user;
+
+    return 0;
+}
+
+/* the lazy configuration writes the same output as the eager one */
+static bool same_output(cfg_t* lazy, cfg_t* eager) {
+    char* a = NULL;
+    char* b = NULL;
+    size_t a_len;
+    size_t b_len;
+    bool same = cfg_write_buffer_ctx(lazy, &a, &a_len) == 0 && cfg_write_buffer_ctx(eager, &b, &b_len) == 0
+        && a_len == b_len && memcmp(a, b, a_len) == 0;
+
+    free(a);
+    free(b);
+
+    return same;
+}
+
+int main(void) {
+    static char text[RANDOM_NUMBERS * 48];
+    static char mutable[] = "a = 1\nb = 2\nc = -3.25\n";
+    static const char invalid[] = "a = 1\nbig = 99999999999999999999\nbad = 1-2\n";
+    static const char layered[] = "a = 1\nb = 2.5\nc = 1x\n";
+    static const char fixed[] = "port = 8080\nratio = 0.125\nname = \"x\"\nyes = true\nnegative = -42\nzero = 0.0\n";
+    char id[32];
+    const char* bad;
+    size_t bad_len;
+    size_t count;
+    size_t len = 0;
+    long long a;
+    long long b;
+    cfg_float_t x;
+    cfg_float_t y;
+    char* str;
+    bool flag;
+    config_t config;
+    int errors[2];
+    FILE* file;
+    cfg_t* cfg = cfg_new();
+    cfg_t* eager = cfg_new();
+    cfg_t* base = cfg_new();
+
+    /* every type, read like an eager parse */
+    check(cfg_parse_ctx(cfg, fixed, strlen(fixed), CFG_FLAG_LAZY) == 0, "parse");
+    check(cfg_get_setting_type_ctx(cfg, "port") == CFG_STYPE_INT && cfg_get_setting_type_ctx(cfg, "ratio") == CFG_STYPE_FLOAT, "guessed types");
+    check(get_integer(cfg, "port") == 8080 && get_integer(cfg, "port") == 8080 && get_integer(cfg, "negative") == -42, "integers");
+    check(cfg_get_setting_ctx(cfg, "ratio", &x) == 0 && x == (cfg_float_t)0.125, "float");
+    check(cfg_get_setting_ctx(cfg, "name", &str) == 0 && strcmp(str, "x") == 0 && cfg_get_setting_ctx(cfg, "yes", &flag) == 0 && flag, "eager types");
+    check(cfg_parse_ctx(eager, fixed, strlen(fixed), CFG_FLAG_NONE) == 0 && same_output(cfg, eager), "written");
+    check(cfg_bind_ctx(cfg, bindings, 2, &config, errors) == 0 && config.port == 8080 && config.ratio == (cfg_float_t)0.125, "bind");
+    check(cfg_validate_ctx(cfg, &bad, &bad_len) == 0 && get_integer(cfg, "port") == 8080, "validate");
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(eager);
+
+    /* numbers of every length and sign, the same values as the eager parse */
+    srand(20);
+    for (int i = 0; i < RANDOM_NUMBERS; i++) {
+        if (i % 2 == 0) {
+            len += (size_t)snprintf(&text[len], sizeof(text) - len, "n_%d = %s%d%d\n", i, rand() % 2 ? "-" : "", rand(), rand() % 1000);
+        } else {
+            len += (size_t)snprintf(&text[len], sizeof(text) - len, "n_%d = %s%d.%0*d%d\n", i, rand() % 2 ? "-" : "",
+                rand() % 1000000, rand() % 12, 0, rand());
+        }
+    }
+    cfg = cfg_new();
+    eager = cfg_new();
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_LAZY | CFG_FLAG_ZEROCOPY) == 0 && cfg_parse_ctx(eager, text, len, CFG_FLAG_NONE) == 0, "parse random");
+    for (int i = 0; i < RANDOM_NUMBERS; i++) {
+        snprintf(id, sizeof(id), "n_%d", i);
+        if (i % 2 == 0) {
+            if (cfg_get_setting_ctx(cfg, id, &a) != 0 || cfg_get_setting_ctx(eager, id, &b) != 0 || a != b) {
+                fprintf(stderr, "%s changed\n", id);
+                failures += 1;
+            }
+        } else {
+            if (cfg_get_setting_ctx(cfg, id, &x) != 0 || cfg_get_setting_ctx(eager, id, &y) != 0 || x != y) {
+                fprintf(stderr, "%s changed\n", id);
+                failures += 1;
+            }
+        }
+    }
+    check(same_output(cfg, eager), "random written");
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(eager);
+
+    /* a number is converted once: in zero-copy mode, changing the buffer only changes the numbers not read yet */
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, mutable, strlen(mutable), CFG_FLAG_LAZY | CFG_FLAG_ZEROCOPY) == 0 && get_integer(cfg, "a") == 1, "zero-copy");
+    mutable[4] = '7';
+    mutable[10] = '8';
+    check(get_integer(cfg, "a") == 1 && get_integer(cfg, "b") == 8, "converted once");
+    check(cfg_validate_ctx(cfg, NULL, NULL) == 0, "validate zero-copy");
+    mutable[19] = '7';
+    check(cfg_get_setting_ctx(cfg, "c", &x) == 0 && x == (cfg_float_t)-3.25, "validated");
+    cfg_free_ctx(cfg);
+
+    /* a number that doesn't convert fails when it is read, with the error the parse would have failed with */
+    cfg = cfg_new();
+    eager = cfg_new();
+    check(cfg_parse_ctx(eager, invalid, strlen(invalid), CFG_FLAG_NONE) == 1 && cfg_get_errno_ctx(eager) == CFG_ERANGE, "eager range");
+    check(cfg_parse_ctx(cfg, invalid, strlen(invalid), CFG_FLAG_LAZY) == 0, "lazy range");
+    check(get_integer(cfg, "a") == 1, "good number");
+    check(cfg_get_setting_ctx(cfg, "big", &a) == 1 && cfg_get_errno_ctx(cfg) == CFG_ERANGE, "range when read");
+    check(cfg_get_setting_ctx(cfg, "big", &a) == 1 && cfg_get_errno_ctx(cfg) == CFG_ERANGE, "range when read again");
+    check(cfg_get_setting_ctx(cfg, "bad", &a) == 1 && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "syntax when read");
+    check(cfg_validate_ctx(cfg, &bad, &bad_len) == 1 && cfg_get_errno_ctx(cfg) == CFG_ERANGE && bad_len == 3 && memcmp(bad, "big", 3) == 0, "validate range");
+    str = NULL;
+    check(cfg_write_buffer_ctx(cfg, &str, &len) == 1 && cfg_get_errno_ctx(cfg) == CFG_ERANGE, "not written");
+    free(str);
+    check(cfg_foreach_prefix_ctx(cfg, "b", stop, NULL) == 1 && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "prefix query");
+    check(cfg_count_prefix_ctx(cfg, "", &count) == 0 && count == 3, "counted");
+    check(cfg_set_setting_ctx(cfg, "big", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 5 }) == 0 && cfg_remove_setting_ctx(cfg, "bad") == 0, "changed");
+    check(cfg_validate_ctx(cfg, &bad, &bad_len) == 0 && get_integer(cfg, "big") == 5, "validate changed");
+    cfg_free_ctx(eager);
+    cfg_free_ctx(cfg);
+
+    /* a lazy base is converted by every read and left as it is */
+    cfg = cfg_new();
+    cfg_parse_ctx(base, layered, strlen(layered), CFG_FLAG_LAZY);
+    cfg_set_base_ctx(cfg, base);
+    cfg_parse_ctx(cfg, "b = 3\n", 6, CFG_FLAG_LAZY);
+    check(get_integer(cfg, "a") == 1 && get_integer(cfg, "a") == 1 && get_integer(cfg, "b") == 3, "layers");
+    check(cfg_get_setting_ctx(cfg, "c", &a) == 1 && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "base error");
+    check(cfg_validate_ctx(cfg, NULL, NULL) == 0 && cfg_validate_ctx(base, NULL, NULL) == 1, "validate layers");
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(base);
+
+    /* files, in parallel, and the global configuration */
+    file = fopen("test_20.cfg", "w");
+    fwrite(text, 1, strlen(text), file);
+    fclose(file);
+    cfg = cfg_new();
+    eager = cfg_new();
+    check(cfg_load_parallel_ctx(cfg, "test_20.cfg", 4, CFG_FLAG_LAZY) == 0 && cfg_load_ctx(eager, "test_20.cfg", CFG_FLAG_NONE) == 0, "parallel");
+    check(cfg_validate_ctx(cfg, NULL, NULL) == 0 && same_output(cfg, eager), "parallel written");
+    cfg_free_ctx(cfg);
+    cfg_free_ctx(eager);
+    check(cfg_load_ex("test_20.cfg", CFG_FLAG_LAZY | CFG_FLAG_ZEROCOPY) == 0 && cfg_get_setting("n_0", &a) == 0, "global");
+    check(cfg_validate(&bad, &bad_len) == 0, "global validate");
+    cfg_free();
+    remove("test_20.cfg");
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
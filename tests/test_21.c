@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../include/cfg.h"
+
+/* array test: arrays read back as contiguous items, written back, changed and rejected when invalid */
+
+#define RANDOM_ITEMS 20000
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "failed: %s\n", what);
+        failures += 1;
+    }
+}
+
+/* the array has the expected strings */
+static bool same_strings(const cfg_string_span_t* items, size_t len, const char* const* expected, size_t expected_len) {
+    if (len != expected_len) {
+        return false;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (items[i].len != strlen(expected[i]) || memcmp(items[i].ptr, expected[i], items[i].len) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool written(cfg_t* cfg, const char* expected) {
+    char* out = NULL;
+    size_t len;
+    bool same = cfg_write_buffer_ctx(cfg, &out, &len) == 0 && strcmp(out, expected) == 0;
+
+    if (!same) {
+        fprintf(stderr, "written: %s", out == NULL ? "(null)\n" : out);
+    }
+    free(out);
+
+    return same;
+}
+
+/* the configuration parses back from its output to the same output */
+static bool round_trip(cfg_t* cfg) {
+    char* a = NULL;
+    char* b = NULL;
+    size_t a_len;
+    size_t b_len;
+    cfg_t* copy = cfg_new();
+    bool same = cfg_write_buffer_ctx(cfg, &a, &a_len) == 0 && cfg_parse_ctx(copy, a, a_len, CFG_FLAG_NONE) == 0
+        && cfg_write_buffer_ctx(copy, &b, &b_len) == 0 && a_len == b_len && memcmp(a, b, a_len) == 0;
+
+    free(a);
+    free(b);
+    cfg_free_ctx(copy);
+
+    return same;
+}
+
+static int sum_cb(const char* identifier, size_t identifier_len, const cfg_value_t* value, void* user) {
+    (void)identifier;
+    (void)identifier_len;
+
+    for (size_t i = 0; value->type == CFG_STYPE_ARRAY && value->array_type == CFG_STYPE_INT && i < value->array_len; i++) {
+        *(long long*)user += ((const long long*)value->array)[i];
+    }
+
+    return 0;
+}
+
+static int invalid(const char* str) {
+    cfg_t* cfg = cfg_new();
+    int errnum = cfg_parse_ctx(cfg, str, strlen(str), CFG_FLAG_NONE) == 0 ? CFG_SUCCESS : cfg_get_errno_ctx(cfg);
+
+    cfg_free_ctx(cfg);
+
+    return errnum;
+}
+
+int main(void) {
+    static char text[RANDOM_ITEMS * 24];
+    static long long expected[RANDOM_ITEMS];
+    static const char fixed[] = "ids = [1, -2, 3]\nweights=[0.5,1,-2.25] # comment\n"
+        "hosts = [ \"a.example\", \"b,c\" ,\"\" ]\nnone = []\nport = 80\n";
+    static const char* const hosts[] = { "a.example", "b,c", "" };
+    static const long long set_ids[] = { 7, 8 };
+    static const cfg_string_span_t set_names[] = { { "x", 1 }, { "y\"", 2 } };
+    const long long* integers;
+    const cfg_float_t* floats;
+    const cfg_string_span_t* strings;
+    const void* items;
+    size_t len = 0;
+    size_t count;
+    long long integer;
+    long long sum = 0;
+    cfg_stats_t stats;
+    FILE* file;
+    cfg_t* cfg = cfg_new();
+    cfg_t* copy = cfg_new();
+
+    /* every type of item, and an empty array */
+    check(cfg_parse_ctx(cfg, fixed, strlen(fixed), CFG_FLAG_NONE) == 0, "parse");
+    check(cfg_get_setting_type_ctx(cfg, "ids") == CFG_STYPE_ARRAY, "type");
+    check(cfg_get_array_ctx(cfg, "ids", CFG_STYPE_INT, (const void**)&integers, &len) == 0 && len == 3
+        && integers[0] == 1 && integers[1] == -2 && integers[2] == 3, "integers");
+    check(cfg_get_array_ctx(cfg, "weights", CFG_STYPE_FLOAT, (const void**)&floats, &len) == 0 && len == 3
+        && floats[0] == (cfg_float_t)0.5 && floats[1] == 1 && floats[2] == (cfg_float_t)-2.25, "floats");
+    check(cfg_get_array_ctx(cfg, "hosts", CFG_STYPE_STRING, (const void**)&strings, &len) == 0
+        && same_strings(strings, len, hosts, 3) && strcmp(strings[0].ptr, "a.example") == 0, "strings");
+    check(cfg_get_array_ctx(cfg, "none", CFG_STYPE_FLOAT, &items, &len) == 0 && len == 0, "empty");
+    check(cfg_get_array_ctx(cfg, "ids", CFG_STYPE_FLOAT, &items, &len) == 1 && cfg_get_errno_ctx(cfg) == CFG_EINVFLOAT, "item type");
+    check(cfg_get_array_ctx(cfg, "port", CFG_STYPE_INT, &items, &len) == 1 && cfg_get_errno_ctx(cfg) == CFG_EARRAY, "not an array");
+    check(cfg_get_array_ctx(cfg, "nope", CFG_STYPE_INT, &items, &len) == 1 && cfg_get_errno_ctx(cfg) == CFG_ENEXIST, "missing");
+    check(cfg_get_setting_ctx(cfg, "ids", &integer) == 1 && cfg_get_errno_ctx(cfg) == CFG_EARRAY, "single value");
+    stats = cfg_get_stats_ctx(cfg);
+    check(stats.arrays == 4 && stats.integers == 1, "stats");
+    check(written(cfg, "ids=[1, -2, 3]\nweights=[0.5, 1.0, -2.25]\nhosts=[\"a.example\", \"b,c\", \"\"]\nnone=[]\nport=80\n"), "written");
+    check(round_trip(cfg), "round trip");
+
+    /* handed to a callback, and to a prefix query */
+    check(cfg_parse_cb_ctx(copy, fixed, strlen(fixed), sum_cb, &sum) == 0 && sum == 2, "callback");
+    sum = 0;
+    check(cfg_foreach_prefix_ctx(cfg, "id", sum_cb, &sum) == 0 && sum == 2, "prefix query");
+    cfg_free_ctx(copy);
+
+    /* replaced and added with a copy of the items, checked like single values */
+    check(cfg_set_setting_ctx(cfg, "port", &(cfg_value_t){ .type = CFG_STYPE_ARRAY, .array = set_ids, .array_len = 2, .array_type = CFG_STYPE_INT }) == 0
+        && cfg_get_array_ctx(cfg, "port", CFG_STYPE_INT, (const void**)&integers, &len) == 0 && len == 2 && integers != set_ids && integers[1] == 8, "set");
+    check(cfg_set_setting_ctx(cfg, "ids", &(cfg_value_t){ .type = CFG_STYPE_INT, .integer = 4 }) == 0 && cfg_get_setting_ctx(cfg, "ids", &integer) == 0, "set single value");
+    check(cfg_set_setting_ctx(cfg, "names", &(cfg_value_t){ .type = CFG_STYPE_ARRAY, .array = set_names, .array_len = 1, .array_type = CFG_STYPE_STRING }) == 0
+        && cfg_get_array_ctx(cfg, "names", CFG_STYPE_STRING, (const void**)&strings, &len) == 0 && len == 1 && strcmp(strings[0].ptr, "x") == 0, "set strings");
+    check(cfg_set_setting_ctx(cfg, "names", &(cfg_value_t){ .type = CFG_STYPE_ARRAY, .array = set_names, .array_len = 2, .array_type = CFG_STYPE_STRING }) == 1
+        && cfg_get_errno_ctx(cfg) == CFG_EINVSTRING, "quote");
+    check(cfg_set_setting_ctx(cfg, "names", &(cfg_value_t){ .type = CFG_STYPE_ARRAY, .array = NULL, .array_len = 1, .array_type = CFG_STYPE_BOOL }) == 1
+        && cfg_get_errno_ctx(cfg) == CFG_EARRAY, "booleans");
+    check(round_trip(cfg), "changed round trip");
+    cfg_free_ctx(cfg);
+
+    /* numbers of every length and sign, with and without spaces, like numbered settings */
+    srand(21);
+    len = (size_t)snprintf(text, sizeof(text), "big = [");
+    for (int i = 0; i < RANDOM_ITEMS; i++) {
+        expected[i] = (long long)rand() * (rand() % 1000) * (rand() % 2 ? -1 : 1);
+        len += (size_t)snprintf(&text[len], sizeof(text) - len, "%s%lld", i == 0 ? "" : i % 3 == 0 ? " , " : ",", expected[i]);
+    }
+    len += (size_t)snprintf(&text[len], sizeof(text) - len, "]\n");
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, text, len, CFG_FLAG_ZEROCOPY) == 0 && cfg_get_array_ctx(cfg, "big", CFG_STYPE_INT, (const void**)&integers, &count) == 0
+        && count == RANDOM_ITEMS && memcmp(integers, expected, sizeof(expected)) == 0, "random");
+    check(round_trip(cfg), "random round trip");
+    cfg_free_ctx(cfg);
+
+    /* zero-copy strings point into the buffer */
+    cfg = cfg_new();
+    check(cfg_parse_ctx(cfg, fixed, strlen(fixed), CFG_FLAG_ZEROCOPY) == 0 && cfg_get_array_ctx(cfg, "hosts", CFG_STYPE_STRING, (const void**)&strings, &len) == 0
+        && same_strings(strings, len, hosts, 3) && strings[0].ptr > fixed && strings[0].ptr < fixed + sizeof(fixed), "zero-copy");
+    cfg_free_ctx(cfg);
+
+    /* invalid arrays fail the parse */
+    check(invalid("a = [1, \"b\"]\n") == CFG_EARRAY && invalid("a = [\"b\", 1]\n") == CFG_EARRAY, "mixed");
+    check(invalid("a = [1,,2]\n") == CFG_EARRAY && invalid("a = [1, 2,]\n") == CFG_EARRAY && invalid("a = [,]\n") == CFG_EARRAY, "empty items");
+    check(invalid("a = [1, 2\n") == CFG_EARRAY && invalid("a = [1] 2\n") == CFG_EARRAY && invalid("a = [\"b]\n") == CFG_EARRAY, "unclosed");
+    check(invalid("a = [true]\n") == CFG_EARRAY && invalid("a = [[1]]\n") == CFG_EARRAY && invalid("a = [1 2]\n") == CFG_EARRAY, "items");
+    check(invalid("a = [1.2.3]\n") == CFG_EARRAY && invalid("a = [-]\n") == CFG_EARRAY && invalid("a = [\"b\" \"c\"]\n") == CFG_EARRAY, "syntax");
+    check(invalid("a = [1, 99999999999999999999]\n") == CFG_ERANGE, "range");
+
+    /* files, the journal, compiled configs and the global configuration */
+    file = fopen("test_21.cfg", "w");
+    fputs(fixed, file);
+    fclose(file);
+    remove("test_21.log");
+    cfg = cfg_new();
+    check(cfg_load_ctx(cfg, "test_21.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_21.log", 0) == 0, "journal");
+    check(cfg_set_setting_ctx(cfg, "port", &(cfg_value_t){ .type = CFG_STYPE_ARRAY, .array = set_names, .array_len = 1, .array_type = CFG_STYPE_STRING }) == 0
+        && cfg_journal_close_ctx(cfg) == 0, "journaled");
+    cfg_free_ctx(cfg);
+    cfg = cfg_new();
+    check(cfg_load_ctx(cfg, "test_21.cfg", CFG_FLAG_NONE) == 0 && cfg_journal_open_ctx(cfg, "test_21.log", 0) == 0
+        && cfg_get_array_ctx(cfg, "port", CFG_STYPE_STRING, (const void**)&strings, &len) == 0 && len == 1 && strcmp(strings[0].ptr, "x") == 0, "replayed");
+    cfg_journal_close_ctx(cfg);
+    cfg_free_ctx(cfg);
+    remove("test_21.log");
+    check(cfg_compile("test_21.cfg", "test_21.bin") == 1 && cfg_errno == CFG_EARRAY, "not compiled");
+    cfg = cfg_new();
+    check(cfg_load_compiled_ctx(cfg, "test_21.cfg", "test_21.bin") == 0 && cfg_get_array_ctx(cfg, "ids", CFG_STYPE_INT, &items, &len) == 0 && len == 3, "parsed instead");
+    cfg_free_ctx(cfg);
+    check(cfg_load("test_21.cfg") == 0 && cfg_get_array("weights", CFG_STYPE_FLOAT, &items, &len) == 0 && len == 3, "global");
+    check(cfg_get_array("port", CFG_STYPE_INT, &items, &len) == 1 && cfg_errno == CFG_EARRAY, "global error");
+    cfg_free();
+    remove("test_21.cfg");
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
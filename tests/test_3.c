@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/cfg.h"
+
+/*
+ * tokenizer test: parses generated configs, valid or broken at a random line, and prints the
+ * outcome. run-test_3.sh builds it with the AVX2, SSE2 and scalar scanners and compares outputs.
+*/
+
+static unsigned long long seed_g = 0x2545f4914f6cdd1dULL;
+
+static unsigned next_random(unsigned bound) {
+    seed_g ^= seed_g << 13;
+    seed_g ^= seed_g >> 7;
+    seed_g ^= seed_g << 17;
+    return (unsigned)(seed_g % bound);
+}
+
+static size_t append_padding(char* buf, size_t len) {
+    static const char padding[] = { ' ', '\t', '\r' };
+    unsigned count = next_random(3) == 0 ? next_random(40) : 0;
+
+    for (unsigned i = 0; i < count; i++) {
+        buf[len++] = padding[next_random(3)];
+    }
+
+    return len;
+}
+
+static size_t append_line(char* buf, size_t len, size_t n, bool broken, bool last) {
+    static const char* broken_lines[] = {
+        "= 1", "key", "bad key = 1", "key = ", "key = \"open", "key = tru", "key = 1-2", "key = nope", "k\x01y = 1",
+    };
+    unsigned kind = next_random(6);
+
+    len = append_padding(buf, len);
+    if (broken) {
+        len += (size_t)sprintf(&buf[len], "%s", broken_lines[next_random(sizeof(broken_lines) / sizeof(broken_lines[0]))]);
+    } else if (kind == 0) {
+        len += (size_t)sprintf(&buf[len], "# comment %zu with = and \"quotes\" %*s", n, (int)next_random(80), "#");
+    } else {
+        len += (size_t)sprintf(&buf[len], "section.key_%zu", n);
+        len = append_padding(buf, len);
+        buf[len++] = '=';
+        len = append_padding(buf, len);
+        switch (kind) {
+            case 1: {
+                len += (size_t)sprintf(&buf[len], "%d", (int)next_random(1000000) - 500000);
+                break;
+            }
+            case 2: {
+                len += (size_t)sprintf(&buf[len], "%u.%u", next_random(1000), next_random(1000));
+                break;
+            }
+            case 3: {
+                len += (size_t)sprintf(&buf[len], "\"%.*s\"", (int)next_random(70), "a fairly long string value that spans more than one vector register..");
+                break;
+            }
+            default: {
+                len += (size_t)sprintf(&buf[len], "%s", next_random(2) ? "true" : "false");
+                break;
+            }
+        }
+        len = append_padding(buf, len);
+        if (next_random(4) == 0) {
+            len += (size_t)sprintf(&buf[len], "# trailing comment");
+        }
+    }
+    if (!last || next_random(2) == 0) {
+        buf[len++] = '\n';
+    }
+
+    return len;
+}
+
+int main(void) {
+    static char buf[1 << 16];
+    size_t len;
+    size_t lines;
+    size_t broken_line;
+    int status;
+
+    for (size_t run = 0; run < 2000; run++) {
+        len = 0;
+        lines = 1 + next_random(200);
+        broken_line = next_random(2) == 0 ? next_random((unsigned)lines) : lines;
+
+        for (size_t i = 0; i < lines; i++) {
+            len = append_line(buf, len, i, i == broken_line, i + 1 == lines);
+        }
+
+        status = cfg_parse(buf, len);
+        printf("run %zu: status=%d errno=%s line=%zu col=%zu\n", run, status, cfg_strerror(cfg_errno), cfg_get_error_line(), cfg_get_error_col());
+        if (status == 0) {
+            cfg_dump();
+        }
+
+        cfg_errno = CFG_SUCCESS;
+        cfg_free();
+    }
+
+    return 0;
+}
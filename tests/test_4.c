@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/cfg.h"
+
+/* stress test: N threads load N different files into their own configuration objects */
+
+#define THREADS 8
+#define ROUNDS 200
+#define KEYS 500
+
+typedef struct worker_s {
+    pthread_t thread;
+    size_t n;
+    char path[64];
+    int failures;
+} worker_t;
+
+static int write_config(const worker_t* worker) {
+    FILE* file = fopen(worker->path, "w");
+
+    if (file == NULL) {
+        return 1;
+    }
+
+    fprintf(file, "# config of worker %zu\n", worker->n);
+    for (size_t i = 0; i < KEYS; i++) {
+        fprintf(file, "worker.key_%zu = %zu\n", i, worker->n * 100000 + i);
+    }
+    fprintf(file, "worker.name = \"worker %zu\"\n", worker->n);
+    fclose(file);
+
+    return 0;
+}
+
+static void* run_worker(void* arg) {
+    worker_t* worker = arg;
+    char expected[32];
+    char id[32];
+    char* name;
+    long long value;
+    cfg_t* cfg;
+
+    snprintf(expected, sizeof(expected), "worker %zu", worker->n);
+
+    for (size_t round = 0; round < ROUNDS; round++) {
+        cfg = cfg_new();
+        if (cfg == NULL) {
+            worker->failures += 1;
+            continue;
+        }
+
+        if (cfg_load_ctx(cfg, worker->path, round % 2 == 0 ? CFG_FLAG_NONE : CFG_FLAG_ZEROCOPY) != 0) {
+            cfg_perror_ctx(cfg, worker->path);
+            worker->failures += 1;
+        }
+
+        for (size_t i = 0; i < KEYS; i += 7) {
+            snprintf(id, sizeof(id), "worker.key_%zu", i);
+            if (cfg_get_setting_ctx(cfg, id, &value) != 0 || value != (long long)(worker->n * 100000 + i)) {
+                worker->failures += 1;
+            }
+        }
+
+        if (round % 2 == 0 && (cfg_get_setting_ctx(cfg, "worker.name", &name) != 0 || strcmp(name, expected) != 0)) {
+            worker->failures += 1;
+        }
+
+        /* errors stay in the configuration they happened in */
+        if (cfg_get_setting_ctx(cfg, "missing", &value) == 0 || cfg_get_errno_ctx(cfg) != CFG_ENEXIST) {
+            worker->failures += 1;
+        }
+        if (cfg_parse_ctx(cfg, "\nbroken", 7, CFG_FLAG_NONE) == 0
+            || cfg_get_errno_ctx(cfg) != CFG_EINVID
+            || cfg_get_error_line_ctx(cfg) != KEYS + 4) {
+            worker->failures += 1;
+        }
+
+        cfg_free_ctx(cfg);
+    }
+
+    return NULL;
+}
+
+int main(void) {
+    worker_t workers[THREADS];
+    char dir[] = "/tmp/libcfg_test_4_XXXXXX";
+    int failures = 0;
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    for (size_t i = 0; i < THREADS; i++) {
+        workers[i].n = i;
+        workers[i].failures = 0;
+        snprintf(workers[i].path, sizeof(workers[i].path), "%s/%zu.cfg", dir, i);
+        if (write_config(&workers[i]) != 0) {
+            perror(workers[i].path);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < THREADS; i++) {
+        pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]);
+    }
+
+    for (size_t i = 0; i < THREADS; i++) {
+        pthread_join(workers[i].thread, NULL);
+        failures += workers[i].failures;
+        unlink(workers[i].path);
+    }
+
+    rmdir(dir);
+
+    printf("%d threads x %d rounds, %d failures\n", THREADS, ROUNDS, failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* parallel loading must give the same settings, errors and positions as sequential loading */
+
+#define KEYS 60000
+#define MAX_THREADS 8
+
+static char dir[] = "/tmp/libcfg_test_5_XXXXXX";
+static char path[64];
+static int failures = 0;
+
+/* the generated file is over 1 MiB so it is split in several chunks */
+static int write_config(size_t broken_line) {
+    FILE* file = fopen(path, "w");
+    size_t line = 1;
+
+    if (file == NULL) {
+        return 1;
+    }
+
+    fprintf(file, "# generated by test_5\n");
+    for (size_t i = 0; i < KEYS; i++) {
+        if (i % 6 == 4) {
+            fprintf(file, "# key_%zu = 1\n\n", i);
+            line += 2;
+        }
+
+        line += 1;
+        if (line == broken_line) {
+            fprintf(file, "key_%zu = tru\n", i);
+            continue;
+        }
+
+        switch (i % 6) {
+            case 0: fprintf(file, "key_%zu = %zu # trailing comment\n", i, i * 7); break;
+            case 1: fprintf(file, "key_%zu = \"value %zu\"\n", i, i); break;
+            case 2: fprintf(file, "\tkey_%zu   =   %zu.25\n", i, i); break;
+            case 3: fprintf(file, "key_%zu = %s\n", i, i % 4 == 0 ? "true" : "false"); break;
+            case 4: fprintf(file, "key_%zu = -%zu\n", i, i); break;
+            default: fprintf(file, "dup_%zu = %zu\n", i % 97, i); break;
+        }
+    }
+    fclose(file);
+
+    return 0;
+}
+
+static void compare(cfg_t* expected, cfg_t* actual, const char* what) {
+    char id[32];
+    const char* a;
+    const char* b;
+    size_t a_len, b_len;
+    long long int_a, int_b;
+    cfg_float_t float_a, float_b;
+    bool bool_a, bool_b;
+    enum cfg_setting_type_e type;
+
+    if (cfg_get_errno_ctx(expected) != cfg_get_errno_ctx(actual)
+        || cfg_get_error_line_ctx(expected) != cfg_get_error_line_ctx(actual)
+        || cfg_get_error_col_ctx(expected) != cfg_get_error_col_ctx(actual)) {
+        fprintf(stderr, "%s: error %d %zu:%zu, expected %d %zu:%zu\n", what,
+            cfg_get_errno_ctx(actual), cfg_get_error_line_ctx(actual), cfg_get_error_col_ctx(actual),
+            cfg_get_errno_ctx(expected), cfg_get_error_line_ctx(expected), cfg_get_error_col_ctx(expected));
+        failures += 1;
+    }
+
+    for (size_t i = 0; i < KEYS + 97; i++) {
+        if (i < KEYS) {
+            snprintf(id, sizeof(id), "key_%zu", i);
+        } else {
+            snprintf(id, sizeof(id), "dup_%zu", i - KEYS);
+        }
+
+        type = cfg_get_setting_type_ctx(expected, id);
+        if (type != cfg_get_setting_type_ctx(actual, id)) {
+            fprintf(stderr, "%s: %s has a different type\n", what, id);
+            failures += 1;
+            continue;
+        }
+
+        switch (type) {
+            case CFG_STYPE_INT:
+                if (cfg_get_setting_ctx(expected, id, &int_a) != 0 || cfg_get_setting_ctx(actual, id, &int_b) != 0 || int_a != int_b) {
+                    fprintf(stderr, "%s: %s differs\n", what, id);
+                    failures += 1;
+                }
+                break;
+            case CFG_STYPE_FLOAT:
+                if (cfg_get_setting_ctx(expected, id, &float_a) != 0 || cfg_get_setting_ctx(actual, id, &float_b) != 0 || float_a != float_b) {
+                    fprintf(stderr, "%s: %s differs\n", what, id);
+                    failures += 1;
+                }
+                break;
+            case CFG_STYPE_BOOL:
+                if (cfg_get_setting_ctx(expected, id, &bool_a) != 0 || cfg_get_setting_ctx(actual, id, &bool_b) != 0 || bool_a != bool_b) {
+                    fprintf(stderr, "%s: %s differs\n", what, id);
+                    failures += 1;
+                }
+                break;
+            case CFG_STYPE_STRING:
+                if (cfg_get_string_view_ctx(expected, id, &a, &a_len) != 0 || cfg_get_string_view_ctx(actual, id, &b, &b_len) != 0
+                    || a_len != b_len || memcmp(a, b, a_len) != 0) {
+                    fprintf(stderr, "%s: %s differs\n", what, id);
+                    failures += 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void run(size_t broken_line) {
+    char what[64];
+    cfg_t* expected;
+    cfg_t* actual;
+
+    for (int flags = CFG_FLAG_NONE; flags <= CFG_FLAG_ZEROCOPY; flags++) {
+        expected = cfg_new();
+        cfg_load_ctx(expected, path, flags);
+
+        if (broken_line != 0 && (cfg_get_errno_ctx(expected) != CFG_EINVBOOL || cfg_get_error_line_ctx(expected) != broken_line)) {
+            fprintf(stderr, "line %zu: the broken line was not reported\n", broken_line);
+            failures += 1;
+        }
+
+        for (size_t threads = 1; threads <= MAX_THREADS; threads++) {
+            snprintf(what, sizeof(what), "line %zu, flags %d, %zu threads", broken_line, flags, threads);
+
+            actual = cfg_new();
+            if ((cfg_load_parallel_ctx(actual, path, threads, flags) != 0) != (cfg_get_errno_ctx(expected) != CFG_SUCCESS)) {
+                fprintf(stderr, "%s: status differs\n", what);
+                failures += 1;
+            }
+            compare(expected, actual, what);
+            cfg_free_ctx(actual);
+        }
+
+        cfg_free_ctx(expected);
+    }
+}
+
+int main(void) {
+    size_t broken_lines[] = { 0, 2, 5001, 31337, 44444, 70000, 80001 };
+    long long value;
+    size_t runs = 0;
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/test.cfg", dir);
+
+    /* 0 is a file without errors, the others break a line in the first, middle or last chunk */
+    for (size_t i = 0; i < sizeof(broken_lines) / sizeof(broken_lines[0]); i++) {
+        if (write_config(broken_lines[i]) != 0) {
+            perror(path);
+            return 1;
+        }
+        run(broken_lines[i]);
+        runs += 1;
+    }
+
+    /* the default configuration */
+    write_config(0);
+    if (cfg_load_parallel(path, 4) != 0 || cfg_get_setting("key_0", &value) != 0 || value != 0
+        || cfg_get_setting("dup_5", &value) != 0 || value != 5) {
+        cfg_perror("cfg_load_parallel");
+        failures += 1;
+    }
+    cfg_free();
+
+    unlink(path);
+    rmdir(dir);
+
+    printf("%zu files x %d threads, %d failures\n", runs, MAX_THREADS, failures);
+
+    return failures != 0;
+}
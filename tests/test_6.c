@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/cfg.h"
+
+/* hot reload test: readers check that every snapshot they pin is consistent while a writer reloads */
+
+#define READERS 4
+#define RELOADS 300
+#define KEYS 200
+
+typedef struct reader_s {
+    pthread_t thread;
+    cfg_live_t* live;
+    size_t pins;
+    int failures;
+} reader_t;
+
+static char dir[] = "/tmp/libcfg_test_6_XXXXXX";
+static atomic_bool done;
+
+/* every setting of version n holds n, so a reader can tell when it sees two versions mixed.
+the file is replaced by a rename, zero-copy snapshots still map the previous one */
+static int write_config(const char* path, size_t version) {
+    char tmp[80];
+    FILE* file;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    file = fopen(tmp, "w");
+
+    if (file == NULL) {
+        return 1;
+    }
+
+    fprintf(file, "version = %zu\n", version);
+    fprintf(file, "name = \"version %zu\"\n", version);
+    for (size_t i = 0; i < KEYS; i++) {
+        fprintf(file, "key_%zu = %zu\n", i, version * 1000 + i);
+    }
+    fclose(file);
+
+    return rename(tmp, path);
+}
+
+static void* run_reader(void* arg) {
+    reader_t* state = arg;
+    cfg_reader_t* reader = cfg_reader_new(state->live);
+    char expected[32];
+    char id[32];
+    const char* name;
+    size_t name_len;
+    long long version;
+    long long value;
+    cfg_t* cfg;
+
+    if (reader == NULL) {
+        state->failures += 1;
+        return NULL;
+    }
+
+    while (!atomic_load(&done)) {
+        cfg = cfg_acquire(reader);
+        if (cfg == NULL || cfg_get_setting_ctx(cfg, "version", &version) != 0 || cfg_get_string_view_ctx(cfg, "name", &name, &name_len) != 0) {
+            state->failures += 1;
+            cfg_release(reader);
+            continue;
+        }
+
+        snprintf(expected, sizeof(expected), "version %lld", version);
+        if (name_len != strlen(expected) || memcmp(name, expected, name_len) != 0) {
+            state->failures += 1;
+        }
+
+        for (size_t i = 0; i < KEYS; i += 13) {
+            snprintf(id, sizeof(id), "key_%zu", i);
+            if (cfg_get_setting_ctx(cfg, id, &value) != 0 || value != version * 1000 + (long long)i) {
+                state->failures += 1;
+            }
+        }
+
+        /* lookups of a shared snapshot may fail concurrently */
+        if (cfg_get_setting_ctx(cfg, "missing", &value) == 0 || cfg_get_errno_ctx(cfg) != CFG_ENEXIST) {
+            state->failures += 1;
+        }
+
+        cfg_release(reader);
+        state->pins += 1;
+    }
+
+    cfg_reader_free(reader);
+
+    return NULL;
+}
+
+int main(void) {
+    reader_t readers[READERS];
+    char path[64];
+    char broken[64];
+    cfg_live_t* live = cfg_live_new();
+    cfg_reader_t* reader;
+    cfg_t* cfg;
+    long long version;
+    size_t pins = 0;
+    int failures = 0;
+
+    if (live == NULL || mkdtemp(dir) == NULL) {
+        perror("setup");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/live.cfg", dir);
+    snprintf(broken, sizeof(broken), "%s/broken.cfg", dir);
+
+    /* nothing is published before the first reload */
+    reader = cfg_reader_new(live);
+    if (reader == NULL || cfg_acquire(reader) != NULL) {
+        failures += 1;
+    }
+    cfg_release(reader);
+    cfg_reader_free(reader);
+
+    write_config(path, 0);
+    if (cfg_reload(live, path, CFG_FLAG_NONE) != 0) {
+        cfg_perror_live(live, path);
+        return 1;
+    }
+
+    for (size_t i = 0; i < READERS; i++) {
+        readers[i].live = live;
+        readers[i].pins = 0;
+        readers[i].failures = 0;
+        pthread_create(&readers[i].thread, NULL, run_reader, &readers[i]);
+    }
+
+    for (size_t version = 1; version <= RELOADS; version++) {
+        write_config(path, version);
+        if (cfg_reload(live, path, version % 2 == 0 ? CFG_FLAG_NONE : CFG_FLAG_ZEROCOPY) != 0) {
+            cfg_perror_live(live, path);
+            failures += 1;
+        }
+    }
+
+    atomic_store(&done, true);
+    for (size_t i = 0; i < READERS; i++) {
+        pthread_join(readers[i].thread, NULL);
+        failures += readers[i].failures;
+        pins += readers[i].pins;
+    }
+
+    /* a failed reload reports its error and keeps the current snapshot */
+    FILE* file = fopen(broken, "w");
+    fprintf(file, "version = 1\nbroken\n");
+    fclose(file);
+
+    if (cfg_reload(live, broken, CFG_FLAG_NONE) == 0
+        || cfg_get_errno_live(live) != CFG_EINVID
+        || cfg_get_error_line_live(live) != 2) {
+        failures += 1;
+    }
+
+    reader = cfg_reader_new(live);
+    cfg = cfg_acquire(reader);
+    if (cfg == NULL || cfg_get_setting_ctx(cfg, "version", &version) != 0 || version != RELOADS) {
+        failures += 1;
+    }
+    cfg_release(reader);
+    cfg_reader_free(reader);
+
+    cfg_live_free(live);
+    unlink(path);
+    unlink(broken);
+    rmdir(dir);
+
+    printf("%d readers, %d reloads, %zu pins, %d failures\n", READERS, RELOADS, pins, failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../include/cfg.h"
+
+/* watcher test: rewrites and replaces a file in a temporary directory and checks the reported changes */
+
+#define DEBOUNCE_MS 50
+#define TIMEOUT_MS 2000
+
+static char dir[] = "/tmp/libcfg_test_7_XXXXXX";
+static char path[64];
+static char changes[1024];
+static size_t calls = 0;
+static int failures = 0;
+
+/* records the changes as "+id", "-id" or "~id" separated by spaces */
+static void on_change(enum cfg_change_e change, const char* identifier, size_t identifier_len, cfg_t* old_cfg, cfg_t* new_cfg, void* user) {
+    static const char marks[] = { [CFG_CHANGE_ADDED] = '+', [CFG_CHANGE_REMOVED] = '-', [CFG_CHANGE_CHANGED] = '~' };
+    size_t len = strlen(changes);
+
+    (void)old_cfg;
+    (void)new_cfg;
+    (void)user;
+
+    snprintf(&changes[len], sizeof(changes) - len, "%s%c%.*s", len == 0 ? "" : " ", marks[change], (int)identifier_len, identifier);
+    calls += 1;
+}
+
+static void write_file(const char* file_path, const char* content) {
+    FILE* file = fopen(file_path, "w");
+
+    if (file == NULL) {
+        perror(file_path);
+        exit(1);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+static void replace_file(const char* content) {
+    char tmp[80];
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    write_file(tmp, content);
+    rename(tmp, path);
+}
+
+static void expect(cfg_watch_t* watch, const char* what, const char* expected) {
+    changes[0] = '\0';
+    if (cfg_watch_process(watch, TIMEOUT_MS) != 0) {
+        fprintf(stderr, "%s: %s\n", what, cfg_strerror(cfg_get_errno_watch(watch)));
+        failures += 1;
+    }
+
+    if (strcmp(changes, expected) != 0) {
+        fprintf(stderr, "%s: got \"%s\", expected \"%s\"\n", what, changes, expected);
+        failures += 1;
+    }
+}
+
+int main(void) {
+    cfg_live_t* live = cfg_live_new();
+    cfg_watch_t* watch;
+    cfg_reader_t* reader;
+    cfg_t* cfg;
+    long long value;
+    char other[64];
+
+    if (live == NULL || mkdtemp(dir) == NULL) {
+        perror("setup");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/app.cfg", dir);
+    snprintf(other, sizeof(other), "%s/other.cfg", dir);
+
+    watch = cfg_watch_new(live, path, CFG_FLAG_NONE, DEBOUNCE_MS, on_change, NULL);
+    if (watch == NULL) {
+        perror("cfg_watch_new");
+        return 1;
+    }
+
+    /* the first load reports every setting as added, duplicates once */
+    write_file(path, "a = 1\nb = \"two\"\nc = 3.5\nd = true\na = 9\n");
+    expect(watch, "first load", "+a +b +c +d");
+
+    /* nothing happened */
+    changes[0] = '\0';
+    if (cfg_watch_process(watch, DEBOUNCE_MS) != 0 || changes[0] != '\0') {
+        fprintf(stderr, "idle: got \"%s\"\n", changes);
+        failures += 1;
+    }
+
+    /* a burst of writes is reloaded once, with the last content */
+    calls = 0;
+    for (int i = 0; i < 5; i++) {
+        char content[128];
+        snprintf(content, sizeof(content), "a = %d\nb = \"two\"\nc = 3.5\nd = true\n", 100 + i);
+        write_file(path, content);
+    }
+    expect(watch, "burst", "~a");
+    if (calls != 1) {
+        fprintf(stderr, "burst: %zu calls\n", calls);
+        failures += 1;
+    }
+
+    /* editors write a copy and rename it over the file */
+    replace_file("a = 104\nb = \"three\"\nc = 3.50\nd = true\ne = 5\n");
+    expect(watch, "rename", "~b +e");
+
+    /* removed settings and type changes */
+    replace_file("a = 104\nb = \"three\"\nc = 3\n");
+    expect(watch, "remove", "~c -d -e");
+
+    /* other files of the directory are ignored */
+    write_file(other, "x = 1\n");
+    expect(watch, "other file", "");
+    unlink(other);
+    cfg_watch_process(watch, 0);
+
+    /* a broken file keeps the current snapshot */
+    replace_file("a = 1\nbroken\n");
+    changes[0] = '\0';
+    if (cfg_watch_process(watch, TIMEOUT_MS) == 0 || cfg_get_errno_watch(watch) != CFG_EINVID || changes[0] != '\0') {
+        fprintf(stderr, "broken: no error reported\n");
+        failures += 1;
+    }
+
+    reader = cfg_reader_new(live);
+    cfg = cfg_acquire(reader);
+    if (cfg == NULL || cfg_get_setting_ctx(cfg, "a", &value) != 0 || value != 104) {
+        fprintf(stderr, "broken: snapshot not kept\n");
+        failures += 1;
+    }
+    cfg_release(reader);
+    cfg_reader_free(reader);
+
+    /* and the fix is compared with the last good snapshot */
+    replace_file("a = 104\nb = \"three\"\nc = 4\n");
+    expect(watch, "fixed", "~c");
+
+    cfg_watch_free(watch);
+    cfg_live_free(live);
+    unlink(path);
+    rmdir(dir);
+
+    printf("watcher: %d failures\n", failures);
+
+    return failures != 0;
+}
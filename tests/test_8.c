@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../include/cfg.h"
+
+/* incremental reparse test: applies random edits and compares with a full parse of the edited buffer */
+
+#define EDITS 20000
+#define KEYS 64
+#define CAP 65536
+
+static char text[CAP];
+static size_t text_len = 0;
+static int failures = 0;
+
+static const char* fragments[] = {
+    "key_%d = %d\n", "key_%d = \"v%d\"\n", "key_%d = %d.5\n", "key_%d = true\n", "# key_%d %d\n",
+    "\n", " ", "\t", "=", "%d", "\"", "#", "key_%d", " = ", "x%d\n", "\r\n",
+};
+
+static void random_fragment(char* buf, size_t cap) {
+    size_t len = 0;
+    int n = rand() % 4;
+
+    buf[0] = '\0';
+    for (int i = 0; i <= n && len < cap; i++) {
+        len += (size_t)snprintf(&buf[len], cap - len, fragments[rand() % (int)(sizeof(fragments) / sizeof(fragments[0]))], rand() % KEYS, rand() % 1000);
+    }
+}
+
+static void compare(cfg_t* expected, cfg_t* actual, size_t edit) {
+    char id[32];
+    const char* a;
+    const char* b;
+    size_t a_len, b_len;
+    long long int_a, int_b;
+    cfg_float_t float_a, float_b;
+    bool bool_a, bool_b;
+    enum cfg_setting_type_e type;
+    int differs;
+
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(id, sizeof(id), "key_%d", i);
+        type = cfg_get_setting_type_ctx(expected, id);
+        differs = type != cfg_get_setting_type_ctx(actual, id);
+
+        switch (differs ? CFG_STYPE_UNKNOWN : type) {
+            case CFG_STYPE_INT:
+                differs = cfg_get_setting_ctx(expected, id, &int_a) != 0 || cfg_get_setting_ctx(actual, id, &int_b) != 0 || int_a != int_b;
+                break;
+            case CFG_STYPE_FLOAT:
+                differs = cfg_get_setting_ctx(expected, id, &float_a) != 0 || cfg_get_setting_ctx(actual, id, &float_b) != 0 || float_a < float_b || float_a > float_b;
+                break;
+            case CFG_STYPE_BOOL:
+                differs = cfg_get_setting_ctx(expected, id, &bool_a) != 0 || cfg_get_setting_ctx(actual, id, &bool_b) != 0 || bool_a != bool_b;
+                break;
+            case CFG_STYPE_STRING:
+                differs = cfg_get_string_view_ctx(expected, id, &a, &a_len) != 0 || cfg_get_string_view_ctx(actual, id, &b, &b_len) != 0
+                    || a_len != b_len || memcmp(a, b, a_len) != 0;
+                break;
+            default:
+                break;
+        }
+
+        if (differs) {
+            fprintf(stderr, "edit %zu: %s differs\n", edit, id);
+            failures += 1;
+        }
+    }
+}
+
+int main(void) {
+    char fragment[256];
+    char next[CAP];
+    size_t next_len;
+    size_t pos;
+    size_t old_len;
+    size_t new_len;
+    size_t applied = 0;
+    cfg_t* cfg = cfg_new();
+    cfg_t* expected;
+    int status;
+
+    srand(1337);
+
+    for (int i = 0; i < KEYS; i++) {
+        text_len += (size_t)snprintf(&text[text_len], CAP - text_len, i % 7 == 0 ? "# comment %d\n" : "key_%d = %d\n", i % KEYS, i);
+    }
+
+    if (cfg_parse_ctx(cfg, text, text_len, CFG_FLAG_INCREMENTAL) != 0) {
+        cfg_perror_ctx(cfg, "cfg_parse_ctx");
+        return 1;
+    }
+
+    for (size_t edit = 0; edit < EDITS && failures < 10; edit++) {
+        random_fragment(fragment, sizeof(fragment));
+        pos = text_len == 0 ? 0 : (size_t)rand() % (text_len + 1);
+        old_len = (size_t)rand() % 40;
+        old_len = old_len > text_len - pos ? text_len - pos : old_len;
+        new_len = strlen(fragment);
+
+        /* keep the text from growing without bound */
+        if (text_len - old_len + new_len >= CAP / 2) {
+            new_len = 0;
+        }
+
+        memcpy(next, text, pos);
+        memcpy(&next[pos], fragment, new_len);
+        memcpy(&next[pos + new_len], &text[pos + old_len], text_len - pos - old_len);
+        next_len = text_len - old_len + new_len;
+
+        expected = cfg_new();
+        status = cfg_parse_ctx(expected, next, next_len, CFG_FLAG_NONE);
+
+        if (cfg_edit_ctx(cfg, next, next_len, pos, old_len, new_len) != status) {
+            fprintf(stderr, "edit %zu: status differs\n", edit);
+            failures += 1;
+        }
+
+        if (status == 0) {
+            memcpy(text, next, next_len);
+            text_len = next_len;
+            applied += 1;
+            compare(expected, cfg, edit);
+        } else if (cfg_get_errno_ctx(cfg) != cfg_get_errno_ctx(expected)
+            || cfg_get_error_line_ctx(cfg) != cfg_get_error_line_ctx(expected)
+            || cfg_get_error_col_ctx(cfg) != cfg_get_error_col_ctx(expected)) {
+            fprintf(stderr, "edit %zu: error %d %zu:%zu, expected %d %zu:%zu\n", edit,
+                cfg_get_errno_ctx(cfg), cfg_get_error_line_ctx(cfg), cfg_get_error_col_ctx(cfg),
+                cfg_get_errno_ctx(expected), cfg_get_error_line_ctx(expected), cfg_get_error_col_ctx(expected));
+            failures += 1;
+        }
+
+        cfg_free_ctx(expected);
+    }
+
+    /* edits need the line index */
+    expected = cfg_new();
+    cfg_parse_ctx(expected, "a = 1\n", 6, CFG_FLAG_NONE);
+    if (cfg_edit_ctx(expected, "a = 2\n", 6, 4, 1, 1) == 0 || cfg_get_errno_ctx(expected) != CFG_EEDIT) {
+        failures += 1;
+    }
+    cfg_free_ctx(expected);
+    cfg_free_ctx(cfg);
+
+    printf("%d edits, %zu applied, %d failures\n", EDITS, applied, failures);
+
+    return failures != 0;
+}
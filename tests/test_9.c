@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "../include/cfg.h"
+
+/* compiled config test: compiled and text loads must agree, stale or broken compiled configs fall back to the text */
+
+#define KEYS 3000
+
+static char dir[] = "/tmp/libcfg_test_9_XXXXXX";
+static char text_path[64];
+static char bin_path[64];
+static int failures = 0;
+
+static void write_config(int seed) {
+    FILE* file = fopen(text_path, "w");
+
+    if (file == NULL) {
+        perror(text_path);
+        exit(1);
+    }
+
+    fprintf(file, "# compiled config test\n");
+    for (int i = 0; i < KEYS; i++) {
+        switch (i % 5) {
+            case 0: fprintf(file, "int_%d = %d\n", i, i * seed); break;
+            case 1: fprintf(file, "float_%d = %d.125\n", i, i + seed); break;
+            case 2: fprintf(file, "string_%d = \"value %04d\"\n", i, (i + seed) % 10000); break;
+            case 3: fprintf(file, "bool_%d = %s\n", i, (i + seed) % 2 == 0 ? "true" : "false"); break;
+            default: fprintf(file, "int_%d = -1\n", i - 5); break; /* duplicates, the first one wins */
+        }
+    }
+    fprintf(file, "empty = \"\"\n");
+    fclose(file);
+}
+
+/* replaces bytes of the config file in place, the size doesn't change */
+static void patch(const char* from, const char* to) {
+    char buf[1 << 17];
+    char* found;
+    size_t len;
+    FILE* file = fopen(text_path, "r+");
+
+    len = fread(buf, 1, sizeof(buf) - 1, file);
+    buf[len] = '\0';
+    found = strstr(buf, from);
+    fseek(file, found - buf, SEEK_SET);
+    fwrite(to, 1, strlen(to), file);
+    fclose(file);
+}
+
+static void check_string(const char* id, const char* expected, const char* what) {
+    cfg_t* cfg = cfg_new();
+    char* str;
+
+    if (cfg_load_compiled_ctx(cfg, text_path, bin_path) != 0 || cfg_get_setting_ctx(cfg, id, &str) != 0 || strcmp(str, expected) != 0) {
+        fprintf(stderr, "%s: %s isn't \"%s\"\n", what, id, expected);
+        failures += 1;
+    }
+    cfg_free_ctx(cfg);
+}
+
+static void check(cfg_t* cfg, int seed, const char* what) {
+    char id[32];
+    char expected[32];
+    char* str;
+    long long integer;
+    cfg_float_t floating;
+    bool boolean;
+    int errors = 0;
+
+    for (int i = 0; i < KEYS; i++) {
+        switch (i % 5) {
+            case 0:
+                snprintf(id, sizeof(id), "int_%d", i);
+                errors += cfg_get_setting_ctx(cfg, id, &integer) != 0 || integer != (long long)i * seed;
+                break;
+            case 1:
+                snprintf(id, sizeof(id), "float_%d", i);
+                errors += cfg_get_setting_ctx(cfg, id, &floating) != 0 || floating != (cfg_float_t)(i + seed) + (cfg_float_t)0.125;
+                break;
+            case 2:
+                snprintf(id, sizeof(id), "string_%d", i);
+                snprintf(expected, sizeof(expected), "value %04d", (i + seed) % 10000);
+                errors += cfg_get_setting_ctx(cfg, id, &str) != 0 || strcmp(str, expected) != 0;
+                break;
+            case 3:
+                snprintf(id, sizeof(id), "bool_%d", i);
+                errors += cfg_get_setting_ctx(cfg, id, &boolean) != 0 || boolean != ((i + seed) % 2 == 0);
+                break;
+            default:
+                break;
+        }
+    }
+
+    errors += cfg_get_setting_ctx(cfg, "empty", &str) != 0 || str[0] != '\0';
+    errors += cfg_get_setting_ctx(cfg, "missing", &integer) == 0 || cfg_get_errno_ctx(cfg) != CFG_ENEXIST;
+    errors += cfg_get_setting_type_ctx(cfg, "bool_3") != CFG_STYPE_BOOL;
+    errors += strcmp(cfg_get_path_ctx(cfg), text_path) != 0;
+
+    if (errors != 0) {
+        fprintf(stderr, "%s: %d errors\n", what, errors);
+        failures += 1;
+    }
+}
+
+static void load(int seed, const char* what) {
+    cfg_t* cfg = cfg_new();
+
+    if (cfg_load_compiled_ctx(cfg, text_path, bin_path) != 0) {
+        cfg_perror_ctx(cfg, what);
+        failures += 1;
+    } else {
+        check(cfg, seed, what);
+    }
+    cfg_free_ctx(cfg);
+}
+
+int main(void) {
+    struct stat st;
+    struct timespec times[2];
+    int fd;
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(text_path, sizeof(text_path), "%s/app.cfg", dir);
+    snprintf(bin_path, sizeof(bin_path), "%s/app.cfgc", dir);
+
+    /* no compiled config yet */
+    write_config(7);
+    load(7, "missing compiled config");
+
+    if (cfg_compile(text_path, bin_path) != 0) {
+        cfg_perror("cfg_compile");
+        return 1;
+    }
+    load(7, "compiled config");
+
+    /* the default configuration, dumped the same way */
+    if (cfg_load_compiled(text_path, bin_path) != 0) {
+        cfg_perror("cfg_load_compiled");
+        failures += 1;
+    }
+    cfg_free();
+
+    /* same size and modification time: the compiled config is trusted, even though it is stale */
+    stat(text_path, &st);
+    times[0] = st.st_atim;
+    times[1] = st.st_mtim;
+    patch("\"value 0009\"", "\"value 9999\"");
+    utimensat(AT_FDCWD, text_path, times, 0);
+    check_string("string_2", "value 0009", "same stamp");
+
+    /* a newer file with other content falls back to the text */
+    times[1].tv_sec += 10;
+    utimensat(AT_FDCWD, text_path, times, 0);
+    check_string("string_2", "value 9999", "changed content");
+
+    /* a newer file with the same content still uses the compiled config */
+    write_config(8);
+    cfg_compile(text_path, bin_path);
+    stat(text_path, &st);
+    times[1] = st.st_mtim;
+    times[1].tv_sec += 10;
+    utimensat(AT_FDCWD, text_path, times, 0);
+    load(8, "touched");
+
+    /* a damaged header falls back to the text */
+    fd = open(bin_path, O_WRONLY);
+    pwrite(fd, "\xff", 1, 40);
+    close(fd);
+    load(8, "damaged header");
+
+    /* compiling a broken file fails and leaves the compiled config alone */
+    FILE* file = fopen(text_path, "a");
+    fprintf(file, "broken\n");
+    fclose(file);
+    if (cfg_compile(text_path, bin_path) == 0 || cfg_errno != CFG_EINVID) {
+        fprintf(stderr, "broken: compiled\n");
+        failures += 1;
+    }
+
+    unlink(text_path);
+    unlink(bin_path);
+    rmdir(dir);
+
+    printf("compiled configs: %d failures\n", failures);
+
+    return failures != 0;
+}
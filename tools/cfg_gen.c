@@ -0,0 +1,475 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/cfg_private.h"
+
+/*
+ * cfg_gen reads the identifiers known at build time, from a key list (one identifier per line,
+ * blank lines and # comments ignored) or from a sample config file (*.cfg), and writes a header
+ * with an enum of ids and the cfg_schema_t mapping them with a perfect hash:
+ *
+ *     cfg_gen [-p prefix] [-o header.h] keys.txt|sample.cfg
+*/
+
+/* tries per bucket before the perfect hash gets more positions */
+#define CFG_GEN_MAX_DISPLACEMENT (1u << 20)
+
+/**
+ * @brief identifier of the schema
+*/
+typedef struct cfg_gen_key_s {
+    const char* identifier;
+    size_t len;
+    uint32_t hash;
+    uint64_t tail;
+    char* name; /* enum constant */
+} cfg_gen_key_t;
+
+/**
+ * @brief perfect hash under construction
+*/
+typedef struct cfg_gen_hash_s {
+    uint32_t* displacements;
+    size_t buckets_len;
+    uint32_t* positions;
+    size_t positions_len;
+} cfg_gen_hash_t;
+
+static cfg_gen_key_t* keys = NULL;
+static size_t keys_len = 0;
+static size_t keys_cap = 0;
+
+/**
+ * @brief adds an identifier to the schema
+ * @param identifier pointer to the identifier, kept
+ * @param len length of the identifier
+ * @returns 0 on success, 1 if out of memory
+*/
+static int cfg_gen_add(const char* identifier, size_t len) {
+    void* tmp;
+
+    if (keys_len == keys_cap) {
+        keys_cap = keys_cap == 0 ? 64 : keys_cap * 2;
+        tmp = realloc(keys, sizeof(cfg_gen_key_t) * keys_cap);
+        if (tmp == NULL) {
+            return 1;
+        }
+        keys = tmp;
+    }
+
+    keys[keys_len].identifier = identifier;
+    keys[keys_len].len = len;
+    keys[keys_len].hash = cfg_hash(identifier, len);
+    keys[keys_len].tail = cfg_schema_tail(identifier, len);
+    keys[keys_len].name = NULL;
+    keys_len += 1;
+
+    return 0;
+}
+
+/**
+ * @brief reads the identifiers of a sample config file, the first occurrence of each in file order
+ * @param path path to the config file
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_gen_read_cfg(const char* path) {
+    cfg_t* cfg = cfg_new();
+
+    /* the configuration is never freed, the identifiers stay in its arena */
+    if (cfg == NULL || cfg_load_ctx(cfg, path, CFG_FLAG_NONE) != 0) {
+        fprintf(stderr, "%s:%zu:%zu: %s\n", path, cfg == NULL ? 0 : cfg->line, cfg == NULL ? 0 : cfg->col,
+            cfg_strerror(cfg == NULL ? CFG_EMEM : cfg->errnum));
+        return 1;
+    }
+
+    for (size_t i = 0; i < cfg->settings_len; i++) {
+        if (cfg_find_setting(cfg, cfg->identifiers[i], cfg->identifier_lens[i], cfg->hashes[i]) == i
+            && cfg_gen_add(cfg->identifiers[i], cfg->identifier_lens[i]) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief reads a key list, one identifier per line
+ * @param path path to the key list
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_gen_read_list(const char* path) {
+    FILE* file = fopen(path, "rb");
+    char* buf;
+    long size;
+    size_t start;
+    size_t end;
+    size_t line = 1;
+
+    if (file == NULL || fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        perror(path);
+        return 1;
+    }
+
+    /* the buffer is never freed, the identifiers point into it */
+    buf = malloc((size_t)size + 1);
+    if (buf == NULL || fread(buf, 1, (size_t)size, file) != (size_t)size) {
+        perror(path);
+        fclose(file);
+        return 1;
+    }
+    buf[size] = '\n';
+    fclose(file);
+
+    for (size_t pos = 0; pos < (size_t)size; pos = end + 1, line++) {
+        end = (size_t)((char*)memchr(&buf[pos], '\n', (size_t)size + 1 - pos) - buf);
+
+        for (start = pos; start < end && isspace((unsigned char)buf[start]); start++);
+        if (start == end || buf[start] == '#') {
+            continue;
+        }
+
+        for (pos = start; pos < end && !isspace((unsigned char)buf[pos]); pos++) {
+            if (!isalnum((unsigned char)buf[pos]) && buf[pos] != '.' && buf[pos] != '_' && buf[pos] != '-') {
+                fprintf(stderr, "%s:%zu: %s\n", path, line, cfg_strerror(CFG_EINVID));
+                return 1;
+            }
+        }
+
+        if (cfg_gen_add(&buf[start], pos - start) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief orders keys by hash and last bytes, then by identifier
+*/
+static int cfg_gen_compare_hash(const void* a, const void* b) {
+    const cfg_gen_key_t* x = *(const cfg_gen_key_t* const*)a;
+    const cfg_gen_key_t* y = *(const cfg_gen_key_t* const*)b;
+
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    if (x->tail != y->tail) {
+        return x->tail < y->tail ? -1 : 1;
+    }
+    if (x->len != y->len) {
+        return x->len < y->len ? -1 : 1;
+    }
+
+    return memcmp(x->identifier, y->identifier, x->len);
+}
+
+/**
+ * @brief orders keys by enum constant
+*/
+static int cfg_gen_compare_name(const void* a, const void* b) {
+    return strcmp((*(const cfg_gen_key_t* const*)a)->name, (*(const cfg_gen_key_t* const*)b)->name);
+}
+
+/**
+ * @brief names the enum constants and checks that identifiers, names and hashes along with last bytes are all unique
+ * @param prefix prefix of the generated names
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_gen_check(const char* prefix) {
+    cfg_gen_key_t** sorted = malloc(sizeof(cfg_gen_key_t*) * keys_len);
+    size_t prefix_len = strlen(prefix);
+    int status = 1;
+
+    if (sorted == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < keys_len; i++) {
+        keys[i].name = malloc(prefix_len + 1 + keys[i].len + 1);
+        if (keys[i].name == NULL) {
+            goto cfg_gen_check_end;
+        }
+
+        /* PREFIX_SERVER_PORT for server.port */
+        for (size_t c = 0; c < prefix_len; c++) {
+            keys[i].name[c] = (char)toupper((unsigned char)prefix[c]);
+        }
+        keys[i].name[prefix_len] = '_';
+        for (size_t c = 0; c < keys[i].len; c++) {
+            keys[i].name[prefix_len + 1 + c] = isalnum((unsigned char)keys[i].identifier[c]) ? (char)toupper((unsigned char)keys[i].identifier[c]) : '_';
+        }
+        keys[i].name[prefix_len + 1 + keys[i].len] = '\0';
+        sorted[i] = &keys[i];
+    }
+
+    qsort(sorted, keys_len, sizeof(cfg_gen_key_t*), cfg_gen_compare_hash);
+    for (size_t i = 1; i < keys_len; i++) {
+        if (sorted[i - 1]->hash == sorted[i]->hash && sorted[i - 1]->tail == sorted[i]->tail) {
+            fprintf(stderr, sorted[i - 1]->len == sorted[i]->len && memcmp(sorted[i - 1]->identifier, sorted[i]->identifier, sorted[i]->len) == 0
+                ? "%.*s is listed twice\n" : "%.*s and %.*s have the same hash, rename one of them\n",
+                (int)sorted[i - 1]->len, sorted[i - 1]->identifier, (int)sorted[i]->len, sorted[i]->identifier);
+            goto cfg_gen_check_end;
+        }
+    }
+
+    qsort(sorted, keys_len, sizeof(cfg_gen_key_t*), cfg_gen_compare_name);
+    for (size_t i = 0; i < keys_len; i++) {
+        if ((i > 0 && strcmp(sorted[i - 1]->name, sorted[i]->name) == 0)
+            || (strncmp(sorted[i]->name + prefix_len, "_COUNT", 7) == 0)) {
+            fprintf(stderr, "%.*s: %s is already taken\n", (int)sorted[i]->len, sorted[i]->identifier, sorted[i]->name);
+            goto cfg_gen_check_end;
+        }
+    }
+
+    status = 0;
+
+cfg_gen_check_end:
+    free(sorted);
+
+    return status;
+}
+
+/**
+ * @brief builds the perfect hash: buckets are placed from the largest to the smallest, each with
+ * the first displacement sending all its keys to free positions
+ * @param hash (out) perfect hash
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_gen_build(cfg_gen_hash_t* hash) {
+    size_t* bucket_start;
+    size_t* bucket_keys;
+    size_t* order;
+    size_t* placed;
+    size_t max_size = 0;
+    size_t n;
+    size_t b;
+    size_t pos;
+    uint32_t d;
+    int status = 1;
+
+    hash->buckets_len = keys_len / 4 + 1;
+    hash->positions_len = keys_len + keys_len / 4 + 1;
+
+    bucket_start = calloc(hash->buckets_len + 1, sizeof(size_t));
+    bucket_keys = malloc(sizeof(size_t) * keys_len);
+    order = malloc(sizeof(size_t) * hash->buckets_len);
+    placed = malloc(sizeof(size_t) * (keys_len + 1));
+    hash->displacements = calloc(hash->buckets_len, sizeof(uint32_t));
+    hash->positions = NULL;
+    if (bucket_start == NULL || bucket_keys == NULL || order == NULL || placed == NULL || hash->displacements == NULL) {
+        goto cfg_gen_build_end;
+    }
+
+    /* keys grouped by bucket, order is used as a cursor until the buckets are sorted */
+    for (size_t i = 0; i < keys_len; i++) {
+        bucket_start[cfg_schema_bucket(keys[i].hash, hash->buckets_len) + 1] += 1;
+    }
+    for (b = 0; b < hash->buckets_len; b++) {
+        max_size = bucket_start[b + 1] > max_size ? bucket_start[b + 1] : max_size;
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    for (b = 0; b < hash->buckets_len; b++) {
+        order[b] = bucket_start[b];
+    }
+    for (size_t i = 0; i < keys_len; i++) {
+        b = cfg_schema_bucket(keys[i].hash, hash->buckets_len);
+        bucket_keys[order[b]++] = i;
+    }
+
+    /* largest buckets first */
+    n = 0;
+    for (size_t size = max_size; size > 0; size--) {
+        for (b = 0; b < hash->buckets_len; b++) {
+            if (bucket_start[b + 1] - bucket_start[b] == size) {
+                order[n++] = b;
+            }
+        }
+    }
+
+    for (;;) {
+        free(hash->positions);
+        hash->positions = calloc(hash->positions_len, sizeof(uint32_t));
+        if (hash->positions == NULL) {
+            goto cfg_gen_build_end;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            b = order[i];
+
+            for (d = 0; d < CFG_GEN_MAX_DISPLACEMENT; d++) {
+                size_t count = 0;
+
+                for (size_t k = bucket_start[b]; k < bucket_start[b + 1]; k++) {
+                    pos = cfg_schema_position(keys[bucket_keys[k]].hash, keys[bucket_keys[k]].tail, d, hash->positions_len);
+                    if (hash->positions[pos] != 0) {
+                        break;
+                    }
+                    hash->positions[pos] = (uint32_t)(bucket_keys[k] + 1);
+                    placed[count++] = pos;
+                }
+
+                if (count == bucket_start[b + 1] - bucket_start[b]) {
+                    break;
+                }
+
+                /* a position taken by the bucket itself or by an earlier one, try the next displacement */
+                while (count > 0) {
+                    hash->positions[placed[--count]] = 0;
+                }
+            }
+
+            if (d == CFG_GEN_MAX_DISPLACEMENT) {
+                break;
+            }
+            hash->displacements[b] = d;
+        }
+
+        if (d != CFG_GEN_MAX_DISPLACEMENT) {
+            break;
+        }
+
+        /* out of luck, start over with more room */
+        hash->positions_len += hash->positions_len / 8 + 1;
+        memset(hash->displacements, 0, sizeof(uint32_t) * hash->buckets_len);
+    }
+
+    status = 0;
+
+cfg_gen_build_end:
+    free(bucket_start);
+    free(bucket_keys);
+    free(order);
+    free(placed);
+
+    return status;
+}
+
+/**
+ * @brief writes an array of numbers as C
+*/
+static void cfg_gen_write_array(FILE* out, const char* prefix, const char* name, const uint32_t* values, size_t len) {
+    fprintf(out, "static const uint32_t %s_%s[] = {", prefix, name);
+    for (size_t i = 0; i < len; i++) {
+        fprintf(out, i % 12 == 0 ? "\n    %" PRIu32 "," : " %" PRIu32 ",", values[i]);
+    }
+    fprintf(out, "\n};\n\n");
+}
+
+/**
+ * @brief writes the generated header
+ * @returns 0 on success, 1 otherwise
+*/
+static int cfg_gen_write(FILE* out, const char* source, const char* prefix, const cfg_gen_hash_t* hash) {
+    uint32_t* lens = malloc(sizeof(uint32_t) * keys_len);
+    char* upper = strdup(prefix);
+
+    if (lens == NULL || upper == NULL) {
+        free(lens);
+        free(upper);
+        return 1;
+    }
+
+    for (char* c = upper; *c != '\0'; c++) {
+        *c = (char)toupper((unsigned char)*c);
+    }
+
+    fprintf(out, "/* generated by cfg_gen from %s, do not edit */\n\n#pragma once\n\n#include \"cfg.h\"\n\n", source);
+
+    fprintf(out, "enum %s_e {\n", prefix);
+    for (size_t i = 0; i < keys_len; i++) {
+        fprintf(out, "    %s, /* %.*s */\n", keys[i].name, (int)keys[i].len, keys[i].identifier);
+        lens[i] = (uint32_t)keys[i].len;
+    }
+    fprintf(out, "    %s_COUNT\n};\n\n", upper);
+
+    fprintf(out, "static const char* const %s_identifiers[] = {", prefix);
+    for (size_t i = 0; i < keys_len; i++) {
+        fprintf(out, "\n    \"%.*s\",", (int)keys[i].len, keys[i].identifier);
+    }
+    fprintf(out, "\n};\n\n");
+
+    cfg_gen_write_array(out, prefix, "identifier_lens", lens, keys_len);
+    cfg_gen_write_array(out, prefix, "displacements", hash->displacements, hash->buckets_len);
+    cfg_gen_write_array(out, prefix, "positions", hash->positions, hash->positions_len);
+
+    fprintf(out, "static const cfg_schema_t %s_schema = {\n", prefix);
+    fprintf(out, "    .identifiers = %s_identifiers,\n", prefix);
+    fprintf(out, "    .identifier_lens = %s_identifier_lens,\n", prefix);
+    fprintf(out, "    .len = %zu,\n", keys_len);
+    fprintf(out, "    .displacements = %s_displacements,\n", prefix);
+    fprintf(out, "    .buckets_len = %zu,\n", hash->buckets_len);
+    fprintf(out, "    .positions = %s_positions,\n", prefix);
+    fprintf(out, "    .positions_len = %zu,\n", hash->positions_len);
+    fprintf(out, "};\n");
+
+    free(lens);
+    free(upper);
+
+    return ferror(out) != 0;
+}
+
+int main(int argc, char** argv) {
+    const char* prefix = "cfg_key";
+    const char* output = NULL;
+    const char* input = NULL;
+    size_t input_len;
+    cfg_gen_hash_t hash;
+    FILE* out = stdout;
+    int status;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            prefix = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (input == NULL && argv[i][0] != '-') {
+            input = argv[i];
+        } else {
+            input = NULL;
+            break;
+        }
+    }
+
+    if (input == NULL) {
+        fprintf(stderr, "usage: %s [-p prefix] [-o header.h] keys.txt|sample.cfg\n", argv[0]);
+        return 1;
+    }
+
+    for (const char* c = prefix; *c != '\0'; c++) {
+        if (!isalnum((unsigned char)*c) && *c != '_') {
+            fprintf(stderr, "%s: the prefix must be a C identifier\n", prefix);
+            return 1;
+        }
+    }
+
+    input_len = strlen(input);
+    status = input_len > 4 && strcmp(&input[input_len - 4], ".cfg") == 0 ? cfg_gen_read_cfg(input) : cfg_gen_read_list(input);
+    if (status != 0) {
+        return 1;
+    }
+
+    if (keys_len == 0 || keys_len >= UINT32_MAX / 2) {
+        fprintf(stderr, "%s: %s identifiers\n", input, keys_len == 0 ? "no" : "too many");
+        return 1;
+    }
+
+    if (cfg_gen_check(prefix) != 0 || cfg_gen_build(&hash) != 0) {
+        return 1;
+    }
+
+    if (output != NULL && (out = fopen(output, "w")) == NULL) {
+        perror(output);
+        return 1;
+    }
+
+    status = cfg_gen_write(out, input, prefix, &hash);
+    if (output != NULL && fclose(out) != 0) {
+        status = 1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "%s: failed to write\n", output != NULL ? output : "stdout");
+    }
+
+    return status;
+}